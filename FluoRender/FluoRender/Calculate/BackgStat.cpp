@@ -1,4 +1,4 @@
-/*
+﻿/*
 For more information, please see: http://software.sci.utah.edu
 
 The MIT License
@@ -27,13 +27,19 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <BackgStat.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <VolumeRenderer.h>
 #include <KernelProgram.h>
 #include <TextureBrick.h>
 #include <Texture.h>
 #include <KernelFactory.h>
 #include <VolumeData.h>
+#include <HistSelect.h>
+#include <Parallel.h>
+#include <base_vol_reader.h>
+#include <msk_reader.h>
 #include <algorithm>
+#include <cmath>
 
 using namespace flrd;
 
@@ -203,25 +209,6 @@ __kernel void kernel_3(
 	minv[index] = (uint)(lminv);
 	maxv[index] = (uint)(lmaxv);
 }
-//histogram in background
-__kernel void kernel_4(
-	__global DWL* bkg,
-	unsigned int dnxy, 
-	unsigned int dnx,
-	unsigned int minv,
-	unsigned int maxv,
-	unsigned int bin,
-	__global unsigned int* hist)
-{
-	int4 coord = (int4)(get_global_id(0),
-		get_global_id(1), get_global_id(2), 1);
-	unsigned int index = dnxy* coord.z + dnx*coord.y + coord.x;
-	unsigned int val = bkg[index];
-	if (val < minv || val > maxv)
-		return;
-	index = (val - minv) * (bin - 1) / (maxv - minv);
-	atomic_inc(hist+index);
-};
 )CLKER";
 
 BackgStat::BackgStat(VolumeData* vd)
@@ -233,12 +220,7 @@ BackgStat::BackgStat(VolumeData* vd)
 	m_kz(10),
 	m_varth(0.0001f),
 	m_gauth(2),
-	m_sum(0),
-	m_wsum(0),
-	m_minv(0),
-	m_maxv(0),
-	m_medv(0),
-	m_modv(0)
+	m_pct(50.0)
 {
 }
 
@@ -287,7 +269,7 @@ void BackgStat::Run()
 		kernel_index0 = kernel_prog->createKernel("kernel_1");
 	else
 		kernel_index0 = kernel_prog->createKernel("kernel_0");
-	int kernel_index1, kernel_index2;
+	int kernel_index1;
 	switch (m_type)
 	{
 	case 0:
@@ -300,21 +282,20 @@ void BackgStat::Run()
 		break;
 	case 2:
 		//median
+		//histogram on the cpu from the extracted background
 		kernel_index1 = kernel_prog->createKernel("kernel_3");
-		kernel_index2 = kernel_prog->createKernel("kernel_4");
 		break;
 	}
 
 	size_t brick_num = m_vd->GetTexture()->get_brick_list_size();
 	std::vector<flvr::TextureBrick*> *bricks = m_vd->GetTexture()->get_bricks();
 
-	m_sum = 0;
-	m_wsum = 0.0;
-	m_minv = std::numeric_limits<unsigned int>::max();
-	m_maxv = 0;
-	m_medv = m_modv = 0;
-	m_hist.clear();
-	m_hist_acc.clear();
+	m_result = Result();
+	m_result.minv = std::numeric_limits<unsigned int>::max();
+	//background values are counted brick by brick
+	HistSelect hs;
+	hs.SetIgnoreZero(true);
+	std::vector<unsigned char> bkg;
 
 	for (size_t i = 0; i < brick_num; ++i)
 	{
@@ -357,6 +338,14 @@ void BackgStat::Run()
 
 		//execute
 		kernel_prog->executeKernel(kernel_index0, 3, global_size, local_size);
+		if (m_type == 2)
+		{
+			//count the background, the buffer is reused for the next brick
+			size_t n = size_t(nx) * ny * nz;
+			bkg.resize(n * chars);
+			kernel_prog->readBuffer(arg_bkg, bkg.data());
+			hs.Accumulate(bkg.data(), chars, n);
+		}
 
 		//brick min and max
 		unsigned int bminv = std::numeric_limits<unsigned int>::max();
@@ -390,8 +379,8 @@ void BackgStat::Run()
 			//sum
 			for (size_t ii = 0; ii < gsize.gsxyz; ++ii)
 			{
-				m_sum += sum[ii];
-				m_wsum += wsum[ii];
+				m_result.sum += sum[ii];
+				m_result.wsum += wsum[ii];
 			}
 			delete[] sum;
 			delete[] wsum;
@@ -429,83 +418,205 @@ void BackgStat::Run()
 			}
 			if (bminv == std::numeric_limits<unsigned int>::max())
 				bminv = bmaxv;
-			m_minv = bminv ? std::min(m_minv, bminv) : m_minv;
-			m_maxv = std::max(m_maxv, bmaxv);
-			if (m_minv == std::numeric_limits<unsigned int>::max())
-				m_minv = m_maxv;
+			m_result.minv = bminv ? std::min(m_result.minv, bminv) : m_result.minv;
+			m_result.maxv = std::max(m_result.maxv, bmaxv);
+			if (m_result.minv == std::numeric_limits<unsigned int>::max())
+				m_result.minv = m_result.maxv;
 
 			delete[] minv;
 			delete[] maxv;
 		}
 
-		if (m_type == 2)
-		{
-			//meidan mode with known minmax
-			unsigned int bin = bmaxv - bminv + 1;
-			unsigned int* hist = new unsigned int[bin]();
-			kernel_prog->beginArgs(kernel_index2);
-			kernel_prog->bindArg(arg_bkg);
-			kernel_prog->setConst(sizeof(unsigned int), (void*)(&dnxy));
-			kernel_prog->setConst(sizeof(unsigned int), (void*)(&dnx));
-			kernel_prog->setConst(sizeof(unsigned int), (void*)(&bminv));
-			kernel_prog->setConst(sizeof(unsigned int), (void*)(&bmaxv));
-			kernel_prog->setConst(sizeof(unsigned int), (void*)(&bin));
-			auto arg_hist =
-				kernel_prog->setBufNew(CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, "", sizeof(unsigned int) * (bin), (void*)(hist));
-
-			//execute
-			kernel_prog->executeKernel(kernel_index2, 3, global_size, local_size);
-			//read back
-			kernel_prog->readBuffer(arg_hist, hist);
+		kernel_prog->releaseAllArgs();
+	}
 
-			//collect
-			for (size_t ii = 0; ii < bin; ++ii)
-			{
-				unsigned int key = static_cast<unsigned int>(ii + bminv);
-				auto it = m_hist.find(key);
-				if (it == m_hist.end())
-					m_hist.insert(std::pair<unsigned int, unsigned int>(key, hist[ii]));
-				else
-					it->second += hist[ii];
-			}
-			delete[] hist;
-		}
+	glbin_kernel_factory.clear(kernel_prog);
 
-		kernel_prog->releaseAllArgs();
+	//exact median and mode from all bricks
+	if (m_type == 2)
+	{
+		Result r;
+		GetStats(hs, r);
+		m_result.medv = r.medv;
+		m_result.modv = r.modv;
+		m_result.pctv = r.pctv;
 	}
+}
 
-	//median and mode from histogram
-	if (m_hist.empty())
+void BackgStat::RunSeries(int t0, int t1)
+{
+	m_series.clear();
+	m_frames.clear();
+	if (!m_vd)
+		return;
+	auto reader = m_vd->GetReader();
+	if (!reader)
 		return;
+	int tn = reader->GetTimeNum();
+	t0 = std::max(t0, 0);
+	t1 = std::min(t1, tn - 1);
+	int chan = m_vd->GetCurChannel();
+	int cur = m_vd->GetCurTime();
 
-	unsigned int hm = 0;
-	unsigned int ii = 0;
-	for (auto it = m_hist.begin(); it != m_hist.end(); ++it)
+	for (int t = t0; t <= t1; ++t)
 	{
-		if (it->second > hm)
+		//the current frame is already in memory, with its mask
+		//other frames are read with their saved masks
+		//frames without a mask are skipped when it is used
+		Nrrd* data = 0;
+		Nrrd* mask = 0;
+		bool loaded = false;
+		if (t == cur)
 		{
-			hm = it->second;
-			m_modv = it->first;
+			data = m_vd->GetVolume(false);
+			if (m_use_mask)
+				mask = m_vd->GetMask(true);
 		}
-		if (it == m_hist.begin())
-			m_hist_acc.push_back(it->second);
 		else
-			m_hist_acc.push_back(it->second + m_hist_acc[ii-1]);
-		ii++;
-	}
-	unsigned int half = m_hist_acc.back() / 2;
-	ii = 0;
-	for (auto it = m_hist_acc.begin(); it != m_hist_acc.end(); ++it)
-	{
-		if (*it >= half)
 		{
-			m_medv = ii;
-			break;
+			data = reader->Convert(t, chan, false);
+			loaded = true;
+			if (m_use_mask)
+			{
+				MSKReader msk_reader;
+				msk_reader.SetFile(reader->GetCurMaskName(t, chan));
+				mask = msk_reader.Convert(t, chan, true);
+			}
+		}
+		bool valid = data && data->data && data->dim == 3;
+		if (valid && m_use_mask)
+			valid = mask && mask->data && mask->dim == 3 &&
+				mask->type == nrrdTypeUChar &&
+				mask->axis[0].size == data->axis[0].size &&
+				mask->axis[1].size == data->axis[1].size &&
+				mask->axis[2].size == data->axis[2].size;
+		if (!valid)
+		{
+			if (loaded && data)
+				glbin_buffer_pool.Nuke(data);
+			if (loaded && mask)
+				glbin_buffer_pool.Nuke(mask);
+			continue;
 		}
-		ii++;
+		int bytes = 0;
+		if (data->type == nrrdTypeUChar)
+			bytes = 1;
+		else if (data->type == nrrdTypeUShort)
+			bytes = 2;
+		size_t nx = data->axis[0].size;
+		size_t ny = data->axis[1].size;
+		size_t nz = data->axis[2].size;
+
+		Result r;
+		if (bytes)
+		{
+			HistSelect hs;
+			hs.SetIgnoreZero(true);
+			ExtractBkg(data->data, bytes, nx, ny, nz,
+				mask ? (unsigned char*)(mask->data) : 0, hs);
+			GetStats(hs, r);
+		}
+		if (loaded)
+		{
+			glbin_buffer_pool.Nuke(data);
+			if (mask)
+				glbin_buffer_pool.Nuke(mask);
+		}
+		m_series.push_back(r);
+		m_frames.push_back(t);
 	}
-	m_medv += m_minv;
+}
 
-	glbin_kernel_factory.clear(kernel_prog);
+void BackgStat::ExtractBkg(const void* data, int bytes,
+	size_t nx, size_t ny, size_t nz,
+	const unsigned char* mask, HistSelect& hs)
+{
+	size_t kx = std::max(m_kx, 1);
+	size_t ky = std::max(m_ky, 1);
+	float kxy = float(kx * ky);
+	float vscl = bytes == 1 ? 255.0f : 65535.0f;
+	size_t nxy = nx * ny;
+
+	//each slice has its own buffers for the box sums
+	//and each thread its own histogram
+	unsigned int tn = GetThreadNum(0);
+	std::vector<std::vector<unsigned long long>> part(tn);
+	ParallelFor(nz, [&](size_t z0, size_t z1, unsigned int t)
+	{
+		std::vector<unsigned long long>& hist = part[t];
+		hist.assign(bytes == 1 ? 256 : 65536, 0);
+		std::vector<float> f(nxy);
+		std::vector<double> hs(nxy), hs2(nxy);
+		std::vector<double> ps(std::max(nx, ny) + std::max(kx, ky) + 1);
+		std::vector<double> ps2(ps.size());
+		for (size_t k = z0; k < z1; ++k)
+		{
+			size_t base = k * nxy;
+			for (size_t i = 0; i < nxy; ++i)
+				f[i] = bytes == 1 ?
+				((const unsigned char*)data)[base + i] / 255.0f :
+				((const unsigned short*)data)[base + i] / 65535.0f;
+			//horizontal window sums, clamped to edge
+			for (size_t j = 0; j < ny; ++j)
+			{
+				const float* row = &f[j * nx];
+				ps[0] = ps2[0] = 0.0;
+				for (size_t e = 0; e < nx + kx; ++e)
+				{
+					long long x = (long long)e - (long long)(kx / 2);
+					x = std::min(std::max(x, 0ll), (long long)nx - 1);
+					double v = row[x];
+					ps[e + 1] = ps[e] + v;
+					ps2[e + 1] = ps2[e] + v * v;
+				}
+				for (size_t i = 0; i < nx; ++i)
+				{
+					hs[j * nx + i] = ps[i + kx] - ps[i];
+					hs2[j * nx + i] = ps2[i + kx] - ps2[i];
+				}
+			}
+			//vertical window sums and the background test
+			for (size_t i = 0; i < nx; ++i)
+			{
+				ps[0] = ps2[0] = 0.0;
+				for (size_t e = 0; e < ny + ky; ++e)
+				{
+					long long y = (long long)e - (long long)(ky / 2);
+					y = std::min(std::max(y, 0ll), (long long)ny - 1);
+					ps[e + 1] = ps[e] + hs[y * nx + i];
+					ps2[e + 1] = ps2[e] + hs2[y * nx + i];
+				}
+				for (size_t j = 0; j < ny; ++j)
+				{
+					size_t index = base + j * nx + i;
+					if (mask && !mask[index])
+						continue;
+					float sumi = float(ps[j + ky] - ps[j]);
+					float sumi2 = float(ps2[j + ky] - ps2[j]);
+					float mean = sumi / kxy;
+					float var = std::sqrt(std::max(
+						(sumi2 + kxy * mean * mean - 2.0f * mean * sumi) / kxy, 0.0f));
+					float cvalue = f[j * nx + i];
+					cvalue = (var < m_varth) || (cvalue - mean < var * m_gauth) ? cvalue : 0.0f;
+					hist[(unsigned int)(cvalue * vscl)]++;
+				}
+			}
+		}
+	}, tn);
+	for (auto& h : part)
+		if (!h.empty())
+			hs.AddCounts(h);
 }
 
+void BackgStat::GetStats(HistSelect& hs, Result& r)
+{
+	std::vector<double> pcts = { 50.0, m_pct };
+	hs.Compute(pcts);
+	r.sum = (unsigned int)(hs.GetCount());
+	r.wsum = float(hs.GetSum());
+	r.minv = hs.GetMin();
+	r.maxv = hs.GetMax();
+	r.medv = hs.GetPercentile(0);
+	r.pctv = hs.GetPercentile(1);
+	r.modv = hs.GetMode();
+}
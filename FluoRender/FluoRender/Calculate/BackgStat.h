@@ -30,7 +30,6 @@ DEALINGS IN THE SOFTWARE.
 
 #include <vector>
 #include <string>
-#include <map>
 
 class VolumeData;
 namespace flvr
@@ -39,6 +38,7 @@ namespace flvr
 }
 namespace flrd
 {
+	class HistSelect;
 	class BackgStat
 	{
 	public:
@@ -74,7 +74,29 @@ namespace flrd
 			m_gauth = gauth;
 		}
 
+		//percentile reported with the median
+		void SetPercentile(double val)
+		{
+			m_pct = val;
+		}
+		double GetPercentile()
+		{
+			return m_pct;
+		}
+
 		void Run();
+		//compute on the cpu for every time point in [t0, t1]
+		//frames are read from the file, results are stored per frame
+		void RunSeries(int t0, int t1);
+		size_t GetFrameNum()
+		{
+			return m_series.size();
+		}
+		int GetFrame(size_t i)
+		{
+			return i < m_frames.size() ? m_frames[i] : 0;
+		}
+
 		std::string GetTypeName(int index = 0)
 		{
 			std::string result = "n/a";
@@ -103,26 +125,31 @@ namespace flrd
 				case 1:
 					result = "bkg_mode";
 					break;
+				case 2:
+					result = "bkg_percentile";
+					break;
 				}
 				break;
 			}
 			return result;
 		}
-		float GetResultf(int index = 0)
+		//frame is an index into the series results, -1 for the last Run()
+		float GetResultf(int index = 0, int frame = -1)
 		{
+			const Result& r = GetResult(frame);
 			switch (m_type)
 			{
 			case 0:
-				return m_sum > 0 ? m_wsum / m_sum : 0;
+				return r.sum > 0 ? r.wsum / r.sum : 0;
 			case 1:
 				switch (index)
 				{
 				case 0:
 					//min
-					return float(m_minv);
+					return float(r.minv);
 				case 1:
 					//max
-					return float(m_maxv);
+					return float(r.maxv);
 				}
 				break;
 			case 2:
@@ -130,30 +157,34 @@ namespace flrd
 				{
 				case 0:
 					//median
-					return float(m_medv);
+					return float(r.medv);
 				case 1:
 					//mode
-					return float(m_modv);
+					return float(r.modv);
+				case 2:
+					//percentile
+					return float(r.pctv);
 				}
 				break;
 			}
 			return 0;
 		}
-		unsigned int GetResulti(int index = 0)
+		unsigned int GetResulti(int index = 0, int frame = -1)
 		{
+			const Result& r = GetResult(frame);
 			switch (m_type)
 			{
 			case 0:
-				return m_sum > 0 ? (unsigned int)(m_wsum / m_sum + 0.5) : 0;
+				return r.sum > 0 ? (unsigned int)(r.wsum / r.sum + 0.5) : 0;
 			case 1:
 				switch (index)
 				{
 				case 0:
 					//min
-					return m_minv;
+					return r.minv;
 				case 1:
 					//max
-					return m_maxv;
+					return r.maxv;
 				}
 				break;
 			case 2:
@@ -161,10 +192,13 @@ namespace flrd
 				{
 				case 0:
 					//median
-					return m_medv;
+					return r.medv;
 				case 1:
 					//mode
-					return m_modv;
+					return r.modv;
+				case 2:
+					//percentile
+					return r.pctv;
 				}
 				break;
 			}
@@ -172,21 +206,41 @@ namespace flrd
 		}
 
 	private:
+		struct Result
+		{
+			unsigned int sum = 0;
+			float wsum = 0;
+			unsigned int minv = 0;
+			unsigned int maxv = 0;
+			unsigned int medv = 0;
+			unsigned int modv = 0;
+			unsigned int pctv = 0;
+		};
+
 		VolumeData *m_vd;
 		bool m_use_mask;//use mask instead of data
 		int m_type;//0-mean; 1-minmax; 2-median
 		int m_kx, m_ky, m_kz;
 		float m_varth, m_gauth;
+		double m_pct;
 		//result
-		unsigned int m_sum;
-		float m_wsum;
-		unsigned int m_minv;
-		unsigned int m_maxv;
-		unsigned int m_medv;
-		unsigned int m_modv;
-		std::map<unsigned int, unsigned int> m_hist;
-		std::vector<unsigned int> m_hist_acc;
+		Result m_result;
+		std::vector<Result> m_series;
+		std::vector<int> m_frames;
 
+		const Result& GetResult(int frame)
+		{
+			if (frame >= 0 && frame < int(m_series.size()))
+				return m_series[frame];
+			return m_result;
+		}
+		//same as the extraction kernel, with box sums per slice
+		//background values are counted into hs, not stored
+		void ExtractBkg(const void* data, int bytes,
+			size_t nx, size_t ny, size_t nz,
+			const unsigned char* mask, HistSelect& hs);
+		//statistics of nonzero background values
+		void GetStats(HistSelect& hs, Result& r);
 		bool CheckBricks();
 		bool GetInfo(flvr::TextureBrick* b,
 			long &bits, long &nx, long &ny, long &nz);
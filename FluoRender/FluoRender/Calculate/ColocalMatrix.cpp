@@ -0,0 +1,263 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <ColocalMatrix.h>
+#include <Parallel.h>
+#include <cmath>
+#include <algorithm>
+
+using namespace flrd;
+
+void ColocalMatrix::Sums::resize(size_t n2)
+{
+	prod.assign(n2, 0.0);
+	prod_n.assign(n2, 0.0);
+	minv.assign(n2, 0.0);
+	min_n.assign(n2, 0.0);
+	thr.assign(n2, 0.0);
+	thr_n.assign(n2, 0.0);
+	sum.assign(n2, 0.0);
+	sum2.assign(n2, 0.0);
+	num.assign(n2, 0.0);
+	mand.assign(n2, 0.0);
+}
+
+void ColocalMatrix::Sums::add(const Sums& s)
+{
+	for (size_t i = 0; i < prod.size(); ++i)
+	{
+		prod[i] += s.prod[i];
+		prod_n[i] += s.prod_n[i];
+		minv[i] += s.minv[i];
+		min_n[i] += s.min_n[i];
+		thr[i] += s.thr[i];
+		thr_n[i] += s.thr_n[i];
+		sum[i] += s.sum[i];
+		sum2[i] += s.sum2[i];
+		num[i] += s.num[i];
+		mand[i] += s.mand[i];
+	}
+}
+
+ColocalMatrix::ColocalMatrix()
+{
+}
+
+ColocalMatrix::~ColocalMatrix()
+{
+}
+
+void ColocalMatrix::AddChannel(void* data, int bytes, float scale,
+	unsigned char* mask, float th_low, float th_high)
+{
+	Channel c;
+	c.data = data;
+	c.bytes = bytes;
+	c.scale = scale;
+	c.mask = mask;
+	c.th_low = th_low;
+	c.th_high = th_high;
+	m_chann.push_back(c);
+}
+
+bool ColocalMatrix::Compute()
+{
+	size_t n = m_chann.size();
+	m_sums.resize(n * n);
+	if (!n || !m_nx || !m_ny || !m_nz)
+		return false;
+	for (auto& c : m_chann)
+	{
+		if (c.bytes != 1 && c.bytes != 2)
+			c.data = nullptr;
+		//a pair is skipped when a mask is missing
+		if (m_use_mask && !c.mask)
+			c.data = nullptr;
+	}
+
+	size_t rows = m_ny * m_nz;
+	unsigned int tn = GetThreadNum(m_thread_num);
+	if (tn > rows)
+		tn = static_cast<unsigned int>(rows);
+	std::vector<Sums> part(tn);
+
+	ParallelFor(rows, [&](size_t r0, size_t r1, unsigned int t)
+	{
+		part[t].resize(n * n);
+		ScanRows(r0, r1, part[t]);
+	}, tn);
+
+	//reduce in slab order
+	for (auto& s : part)
+		if (!s.prod.empty())
+			m_sums.add(s);
+
+	//symmetric sums are accumulated in the upper triangle
+	for (size_t i = 0; i < n; ++i)
+	for (size_t j = i + 1; j < n; ++j)
+	{
+		size_t ij = i * n + j;
+		size_t ji = j * n + i;
+		m_sums.prod[ji] = m_sums.prod[ij];
+		m_sums.prod_n[ji] = m_sums.prod_n[ij];
+		m_sums.minv[ji] = m_sums.minv[ij];
+		m_sums.min_n[ji] = m_sums.min_n[ij];
+		m_sums.thr_n[ji] = m_sums.thr_n[ij];
+		m_sums.num[ji] = m_sums.num[ij];
+	}
+	return true;
+}
+
+void ColocalMatrix::ScanRows(size_t r0, size_t r1, Sums& s)
+{
+	size_t n = m_chann.size();
+	std::vector<float> v(n, 0.0f);
+	std::vector<char> valid(n, 0);
+	std::vector<char> inth(n, 0);
+	std::vector<char> above(n, 0);
+
+	for (size_t r = r0; r < r1; ++r)
+	{
+		unsigned long long index = (unsigned long long)r * m_nx;
+		for (size_t i = 0; i < m_nx; ++i, ++index)
+		{
+			//load all channels of this voxel once
+			bool any = false;
+			for (size_t c = 0; c < n; ++c)
+			{
+				const Channel& ch = m_chann[c];
+				valid[c] = 0;
+				if (!ch.data)
+					continue;
+				if (m_use_mask && !ch.mask[index])
+					continue;
+				float val;
+				if (ch.bytes == 1)
+					val = ((unsigned char*)ch.data)[index] / 255.0f;
+				else
+					val = ((unsigned short*)ch.data)[index] / 65535.0f;
+				val *= ch.scale;
+				v[c] = val;
+				valid[c] = 1;
+				inth[c] = val > ch.th_low && val <= ch.th_high;
+				above[c] = val > ch.th_low;
+				any = true;
+			}
+			if (!any)
+				continue;
+
+			for (size_t a = 0; a < n; ++a)
+			{
+				if (!valid[a])
+					continue;
+				float va = v[a];
+				size_t row = a * n;
+				for (size_t b = 0; b < n; ++b)
+				{
+					if (!valid[b])
+						continue;
+					float vb = v[b];
+					size_t ab = row + b;
+					bool th = inth[a] && inth[b];
+					if (th)
+						s.thr[ab] += va;
+					s.sum[ab] += va;
+					s.sum2[ab] += double(va) * va;
+					if (above[b])
+						s.mand[ab] += va;
+					if (b < a)
+						continue;
+					float p = va * vb;
+					float m = std::min(va, vb);
+					s.prod[ab] += p;
+					if (p > 0.0f)
+						s.prod_n[ab] += 1.0;
+					s.minv[ab] += m;
+					if (m > 0.0f)
+						s.min_n[ab] += 1.0;
+					if (th)
+						s.thr_n[ab] += 1.0;
+					s.num[ab] += 1.0;
+				}
+			}
+		}
+	}
+}
+
+double ColocalMatrix::GetProduct(size_t i, size_t j, bool weighted)
+{
+	size_t n = m_chann.size();
+	if (i >= n || j >= n)
+		return 0.0;
+	return weighted ? m_sums.prod[i * n + j] : m_sums.prod_n[i * n + j];
+}
+
+double ColocalMatrix::GetMinValue(size_t i, size_t j, bool weighted)
+{
+	size_t n = m_chann.size();
+	if (i >= n || j >= n)
+		return 0.0;
+	return weighted ? m_sums.minv[i * n + j] : m_sums.min_n[i * n + j];
+}
+
+double ColocalMatrix::GetThreshold(size_t i, size_t j, bool weighted)
+{
+	size_t n = m_chann.size();
+	if (i >= n || j >= n)
+		return 0.0;
+	return weighted ? m_sums.thr[i * n + j] : m_sums.thr_n[i * n + j];
+}
+
+double ColocalMatrix::GetPearson(size_t i, size_t j)
+{
+	size_t n = m_chann.size();
+	if (i >= n || j >= n)
+		return 0.0;
+	size_t ij = i * n + j;
+	size_t ji = j * n + i;
+	double num = m_sums.num[ij];
+	if (num < 2.0)
+		return 0.0;
+	double sx = m_sums.sum[ij];
+	double sy = m_sums.sum[ji];
+	double vx = num * m_sums.sum2[ij] - sx * sx;
+	double vy = num * m_sums.sum2[ji] - sy * sy;
+	if (vx <= 0.0 || vy <= 0.0)
+		return 0.0;
+	return (num * m_sums.prod[ij] - sx * sy) / std::sqrt(vx * vy);
+}
+
+double ColocalMatrix::GetManders(size_t i, size_t j)
+{
+	size_t n = m_chann.size();
+	if (i >= n || j >= n)
+		return 0.0;
+	size_t ij = i * n + j;
+	if (m_sums.sum[ij] <= 0.0)
+		return 0.0;
+	return m_sums.mand[ij] / m_sums.sum[ij];
+}
@@ -0,0 +1,118 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_ColocalMatrix_h
+#define FL_ColocalMatrix_h
+
+#include <vector>
+#include <cstddef>
+
+namespace flrd
+{
+	//colocalization of n channels in one pass over the data
+	//all channel pairs are accumulated together for each voxel
+	//rows of the volume are split into slabs, one per thread,
+	//and the slabs are reduced in order
+	//values and tests follow the pairwise gpu kernels in Compare.cpp
+	class ColocalMatrix
+	{
+	public:
+		ColocalMatrix();
+		~ColocalMatrix();
+
+		void SetSize(size_t nx, size_t ny, size_t nz)
+		{
+			m_nx = nx; m_ny = ny; m_nz = nz;
+		}
+		//only voxels in both masks count for a pair
+		void SetUseMask(bool val) { m_use_mask = val; }
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+		//data can be null for a channel excluded from computing
+		//bytes: 1 or 2; thresholds are normalized
+		void AddChannel(void* data, int bytes, float scale,
+			unsigned char* mask, float th_low, float th_high);
+		void ClearChannels() { m_chann.clear(); }
+		size_t GetChannelNum() { return m_chann.size(); }
+
+		bool Compute();
+
+		//weighted: sum of intensity products, otherwise count of product > 0
+		double GetProduct(size_t i, size_t j, bool weighted);
+		//weighted: sum of min values, otherwise count of min > 0
+		double GetMinValue(size_t i, size_t j, bool weighted);
+		//voxels within both threshold ranges
+		//weighted: sum of the intensity of channel i, not symmetric
+		double GetThreshold(size_t i, size_t j, bool weighted);
+		//pearson's correlation coefficient
+		double GetPearson(size_t i, size_t j);
+		//manders' coefficient of channel i over channel j above threshold
+		double GetManders(size_t i, size_t j);
+
+	private:
+		struct Channel
+		{
+			void* data;
+			int bytes;
+			float scale;
+			unsigned char* mask;
+			float th_low;
+			float th_high;
+		};
+
+		//n by n sums, row major
+		struct Sums
+		{
+			std::vector<double> prod;//also cross products for pearson
+			std::vector<double> prod_n;
+			std::vector<double> minv;
+			std::vector<double> min_n;
+			std::vector<double> thr;//sum of i
+			std::vector<double> thr_n;
+			std::vector<double> sum;//sum of i in the region of the pair
+			std::vector<double> sum2;
+			std::vector<double> num;
+			std::vector<double> mand;//sum of i where j is above threshold
+
+			void resize(size_t n2);
+			void add(const Sums& s);
+		};
+
+		size_t m_nx = 0;
+		size_t m_ny = 0;
+		size_t m_nz = 0;
+		bool m_use_mask = false;
+		unsigned int m_thread_num = 0;
+		std::vector<Channel> m_chann;
+
+		Sums m_sums;
+
+	private:
+		void ScanRows(size_t r0, size_t r1, Sums& s);
+	};
+}
+
+#endif//FL_ColocalMatrix_h
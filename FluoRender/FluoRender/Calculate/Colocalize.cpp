@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 #include <ColocalDefault.h>
 #include <AutomateDefault.h>
 #include <Compare.h>
+#include <ColocalMatrix.h>
 #include <string>
 
 using namespace flrd;
@@ -121,8 +122,22 @@ void Colocalize::Compute()
 	m_tps.clear();
 
 	//fill the matrix
-	if (glbin_colocal_def.m_method == 0 || glbin_colocal_def.m_method == 1 ||
-		(glbin_colocal_def.m_method == 2 && !glbin_colocal_def.m_int_weighted))
+	bool single_pass = false;
+	if (glbin_colocal_def.m_single_pass ||
+		glbin_colocal_def.m_method > 2)
+		single_pass = ComputeMatrix(rm);
+	if (!single_pass && glbin_colocal_def.m_method > 2)
+	{
+		//coefficients have no pairwise path
+		m_titles = L"Error\n";
+		m_values = L"Coefficients need displayed channels in memory "
+			L"with the same size and 8 or 16 bits.\n";
+		return;
+	}
+	//single pass fills all pairs in rm
+	if (!single_pass &&
+		(glbin_colocal_def.m_method == 0 || glbin_colocal_def.m_method == 1 ||
+		(glbin_colocal_def.m_method == 2 && !glbin_colocal_def.m_int_weighted)))
 	{
 		//dot product and min value
 		//symmetric matrix
@@ -170,7 +185,8 @@ void Colocalize::Compute()
 			}
 		}
 	}
-	else if (glbin_colocal_def.m_method == 2 && glbin_colocal_def.m_int_weighted)
+	else if (!single_pass &&
+		glbin_colocal_def.m_method == 2 && glbin_colocal_def.m_int_weighted)
 	{
 		//threshold, asymmetrical
 		for (int it1 = 0; it1 < num; ++it1)
@@ -213,7 +229,8 @@ void Colocalize::Compute()
 		glbin_colocal_def.ResetMinMax();
 		for (size_t i = 0; i < num; ++i)
 		{
-			if (glbin_colocal_def.m_get_ratio)
+			if (glbin_colocal_def.m_get_ratio &&
+				glbin_colocal_def.m_method <= 2)
 				m_titles += std::to_wstring(i+1) + L" (%%)";
 			else
 				m_titles += std::to_wstring(i+1);
@@ -231,7 +248,14 @@ void Colocalize::Compute()
 		for (int it1 = 0; it1 < num; ++it1)
 			for (int it2 = 0; it2 < num; ++it2)
 			{
-				if (glbin_colocal_def.m_get_ratio)
+				if (glbin_colocal_def.m_method > 2)
+				{
+					//coefficients
+					v = rm[it1][it2];
+					glbin_colocal_def.SetMinMax(v);
+					m_values += std::to_wstring(v);
+				}
+				else if (glbin_colocal_def.m_get_ratio)
 				{
 					if (rm[it2][it2])
 					{
@@ -272,6 +296,90 @@ void Colocalize::Compute()
 	}
 }
 
+bool Colocalize::ComputeMatrix(std::vector<std::vector<double>>& rm)
+{
+	auto group = glbin_current.vol_group.lock();
+	if (!group)
+		return false;
+	int num = group->GetVolumeNum();
+
+	//all channels are streamed together from memory
+	//bricked files and different sizes use the pairwise path
+	flrd::ColocalMatrix matrix;
+	matrix.SetUseMask(glbin_colocal_def.m_use_mask);
+	fluo::Vector res0;
+	bool first = true;
+	for (int i = 0; i < num; ++i)
+	{
+		auto vd = group->GetVolumeData(i);
+		if (!vd || !vd->GetDisp())
+		{
+			matrix.AddChannel(0, 1, 1.0f, 0, 0.0f, 1.0f);
+			continue;
+		}
+		if (vd->isBrxml())
+			return false;
+		Nrrd* nrrd_data = vd->GetVolume(false);
+		if (!nrrd_data || !nrrd_data->data)
+			return false;
+		int bits = vd->GetBits();
+		if (bits != 8 && bits != 16)
+			return false;
+		fluo::Vector res = vd->GetResolution();
+		if (first)
+		{
+			res0 = res;
+			first = false;
+		}
+		else if (res != res0)
+			return false;
+		unsigned char* mask = 0;
+		if (glbin_colocal_def.m_use_mask)
+		{
+			Nrrd* nrrd_mask = vd->GetMask(true);
+			if (nrrd_mask)
+				mask = (unsigned char*)(nrrd_mask->data);
+		}
+		matrix.AddChannel(nrrd_data->data, bits / 8,
+			(float)(vd->GetScalarScale()), mask,
+			(float)(vd->GetLeftThresh()),
+			(float)(vd->GetRightThresh()));
+	}
+	if (first)
+		return false;
+	matrix.SetSize(res0.intx(), res0.inty(), res0.intz());
+
+	StartTimer("");
+	if (!matrix.Compute())
+		return false;
+	StopTimer(__FUNCTION__);
+
+	bool weighted = glbin_colocal_def.m_int_weighted;
+	for (int it1 = 0; it1 < num; ++it1)
+	for (int it2 = 0; it2 < num; ++it2)
+	{
+		switch (glbin_colocal_def.m_method)
+		{
+		case 0://dot product
+			rm[it1][it2] = matrix.GetProduct(it1, it2, weighted);
+			break;
+		case 1://min value
+			rm[it1][it2] = matrix.GetMinValue(it1, it2, weighted);
+			break;
+		case 2://threshold
+			rm[it1][it2] = matrix.GetThreshold(it1, it2, weighted);
+			break;
+		case 3://pearson
+			rm[it1][it2] = matrix.GetPearson(it1, it2);
+			break;
+		case 4://manders
+			rm[it1][it2] = matrix.GetManders(it1, it2);
+			break;
+		}
+	}
+	return true;
+}
+
 void Colocalize::StartTimer(const std::string& str)
 {
 	if (m_test_speed)
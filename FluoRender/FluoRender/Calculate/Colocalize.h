@@ -52,6 +52,8 @@ namespace flrd
 		std::vector<std::chrono::high_resolution_clock::time_point> m_tps;
 
 	private:
+		//all channel pairs from memory in one pass
+		bool ComputeMatrix(std::vector<std::vector<double>>& rm);
 		//speed test
 		void StartTimer(const std::string& str);
 		void StopTimer(const std::string& str);
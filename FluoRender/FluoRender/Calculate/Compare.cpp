@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Texture.h>
 #include <KernelFactory.h>
 #include <VolumeData.h>
+#include <Utils.h>
 #include <algorithm>
 
 using namespace flrd;
@@ -657,6 +658,8 @@ void ChannelCompare::Product()
 	std::vector<flvr::TextureBrick*> *bricks2 = m_vd2->GetTexture()->get_bricks();
 	float ss1 = (float)(m_vd1->GetScalarScale());
 	float ss2 = (float)(m_vd2->GetScalarScale());
+	m_vd1->GetTexture()->update_brick_stats();
+	m_vd2->GetTexture()->update_brick_stats();
 
 	for (size_t i = 0; i < brick_num; ++i)
 	{
@@ -668,6 +671,9 @@ void ChannelCompare::Product()
 				!b2->is_mask_valid())
 				continue;
 		}
+		//zero in either channel adds nothing
+		if (b1->is_empty() || b2->is_empty())
+			continue;
 		long nx, ny, nz, bits1, bits2;
 		if (!GetInfo(b1, b2, bits1, bits2, nx, ny, nz))
 			continue;
@@ -770,6 +776,8 @@ void ChannelCompare::MinValue()
 	std::vector<flvr::TextureBrick*> *bricks2 = m_vd2->GetTexture()->get_bricks();
 	float ss1 = (float)(m_vd1->GetScalarScale());
 	float ss2 = (float)(m_vd2->GetScalarScale());
+	m_vd1->GetTexture()->update_brick_stats();
+	m_vd2->GetTexture()->update_brick_stats();
 
 	for (size_t i = 0; i < brick_num; ++i)
 	{
@@ -781,6 +789,9 @@ void ChannelCompare::MinValue()
 				!b2->is_mask_valid())
 				continue;
 		}
+		//zero in either channel adds nothing
+		if (b1->is_empty() || b2->is_empty())
+			continue;
 		long nx, ny, nz, bits1, bits2;
 		if (!GetInfo(b1, b2, bits1, bits2, nx, ny, nz))
 			continue;
@@ -883,6 +894,14 @@ void ChannelCompare::Threshold(float th1, float th2, float th3, float th4)
 	std::vector<flvr::TextureBrick*> *bricks2 = m_vd2->GetTexture()->get_bricks();
 	float ss1 = (float)(m_vd1->GetScalarScale());
 	float ss2 = (float)(m_vd2->GetScalarScale());
+	m_vd1->GetTexture()->update_brick_stats();
+	m_vd2->GetTexture()->update_brick_stats();
+	//value ranges passing the thresholds
+	double eps = fluo::Epsilon();
+	double lo1 = ss1 > 0.0f ? th1 / ss1 - eps : 0.0;
+	double hi1 = ss1 > 0.0f ? th2 / ss1 + eps : 0.0;
+	double lo2 = ss2 > 0.0f ? th3 / ss2 - eps : 0.0;
+	double hi2 = ss2 > 0.0f ? th4 / ss2 + eps : 0.0;
 
 	for (size_t i = 0; i < brick_num; ++i)
 	{
@@ -896,6 +915,10 @@ void ChannelCompare::Threshold(float th1, float th2, float th3, float th4)
 				!b2->is_mask_valid())
 				continue;
 		}
+		//no voxel passes the thresholds
+		if (ss1 > 0.0f && ss2 > 0.0f &&
+			(b1->is_outside(lo1, hi1) || b2->is_outside(lo2, hi2)))
+			continue;
 		long nx, ny, nz, bits1, bits2;
 		if (!GetInfo(b1, b2, bits1, bits2, nx, ny, nz))
 			continue;
@@ -157,6 +157,10 @@ void CountVoxels::Count()
 		unsigned int nx, ny, nz, bits;
 		if (!GetInfo(b, bits, nx, ny, nz))
 			continue;
+		//mask is up to date in memory and has nothing
+		if (!b->is_mask_valid() &&
+			b->is_comp_empty(flvr::CompType::Mask))
+			continue;
 		//get tex ids
 		GLint tid = vd->GetVR()->load_brick(b);
 		GLint mid = vd->GetVR()->load_brick_mask(b);
@@ -0,0 +1,335 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <HistSelect.h>
+#include <Parallel.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace flrd;
+
+HistSelect::HistSelect()
+{
+}
+
+HistSelect::~HistSelect()
+{
+}
+
+void HistSelect::AddRegion(const void* data, int bytes,
+	size_t nx, size_t ny, size_t nz,
+	const unsigned char* mask)
+{
+	Region r;
+	r.data = data;
+	r.bytes = bytes;
+	r.nx = nx; r.ny = ny; r.nz = nz;
+	r.mask = mask;
+	r.x0 = r.y0 = r.z0 = 0;
+	r.x1 = nx; r.y1 = ny; r.z1 = nz;
+	m_regions.push_back(r);
+}
+
+void HistSelect::SetWindow(size_t x0, size_t y0, size_t z0,
+	size_t x1, size_t y1, size_t z1)
+{
+	if (m_regions.empty())
+		return;
+	Region& r = m_regions.back();
+	r.x0 = std::min(x0, r.nx);
+	r.y0 = std::min(y0, r.ny);
+	r.z0 = std::min(z0, r.nz);
+	r.x1 = std::min(std::max(x1, r.x0), r.nx);
+	r.y1 = std::min(std::max(y1, r.y0), r.ny);
+	r.z1 = std::min(std::max(z1, r.z0), r.nz);
+}
+
+void HistSelect::Accumulate(const void* data, int bytes, size_t n,
+	const unsigned char* mask)
+{
+	if (!data || (bytes != 1 && bytes != 2) || !n)
+		return;
+	Region r;
+	r.data = data;
+	r.bytes = bytes;
+	r.nx = n; r.ny = 1; r.nz = 1;
+	r.mask = mask;
+	r.x0 = r.y0 = r.z0 = 0;
+	r.x1 = n; r.y1 = 1; r.z1 = 1;
+	//split the single row into chunks for the threads
+	unsigned int tn = GetThreadNum(m_thread_num);
+	size_t bins = bytes == 1 ? 256 : 65536;
+	std::vector<std::vector<unsigned long long>> part(tn);
+	ParallelFor(n, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		std::vector<unsigned long long>& h = part[t];
+		h.assign(bins, 0);
+		Region c = r;
+		c.x0 = i0; c.x1 = i1;
+		ScanRows(c, 0, 1, [&](unsigned int val) { h[val]++; });
+	}, tn);
+	for (auto& h : part)
+		if (!h.empty())
+			AddCounts(h);
+}
+
+void HistSelect::AddCounts(const std::vector<unsigned long long>& hist)
+{
+	if (hist.size() > m_counts.size())
+		m_counts.resize(hist.size(), 0);
+	for (size_t i = 0; i < hist.size(); ++i)
+		m_counts[i] += hist[i];
+}
+
+bool HistSelect::Compute(const std::vector<double>& pcts)
+{
+	if (!m_counts.empty())
+		return ComputeCounts(pcts);
+
+	m_count = 0;
+	m_sum = 0.0;
+	m_minv = m_maxv = m_modv = 0;
+	m_values.assign(pcts.size(), 0);
+
+	m_wide = false;
+	for (auto& r : m_regions)
+	{
+		if (!r.data || (r.bytes != 1 && r.bytes != 2))
+			return false;
+		if (r.bytes == 2)
+			m_wide = true;
+	}
+	int shift = m_wide ? 8 : 0;
+	unsigned int tn = GetThreadNum(m_thread_num);
+
+	//coarse pass
+	std::vector<unsigned long long> hist(256, 0);
+	unsigned int minv = 0xffffffff;
+	unsigned int maxv = 0;
+	for (auto& r : m_regions)
+	{
+		size_t rows = (r.y1 - r.y0) * (r.z1 - r.z0);
+		if (!rows || r.x1 <= r.x0)
+			continue;
+		std::vector<Coarse> part(tn);
+		ParallelFor(rows, [&](size_t r0, size_t r1, unsigned int t)
+		{
+			Coarse& c = part[t];
+			c.hist.assign(256, 0);
+			ScanRows(r, r0, r1, [&](unsigned int val)
+			{
+				c.hist[val >> shift]++;
+				c.count++;
+				c.sum += val;
+				if (val < c.minv) c.minv = val;
+				if (val > c.maxv) c.maxv = val;
+			});
+		}, tn);
+		for (auto& c : part)
+		{
+			if (c.hist.empty())
+				continue;
+			for (size_t i = 0; i < 256; ++i)
+				hist[i] += c.hist[i];
+			m_count += c.count;
+			m_sum += c.sum;
+			minv = std::min(minv, c.minv);
+			maxv = std::max(maxv, c.maxv);
+		}
+	}
+	if (!m_count)
+		return true;
+	m_minv = minv;
+	m_maxv = maxv;
+
+	//coarse bins holding the ranks
+	size_t pn = pcts.size();
+	std::vector<int> bin(pn, 0);
+	std::vector<unsigned long long> rank(pn, 0);
+	for (size_t i = 0; i < pn; ++i)
+	{
+		double p = std::min(std::max(pcts[i], 0.0), 100.0);
+		unsigned long long k = (unsigned long long)
+			std::ceil(p / 100.0 * double(m_count));
+		k = std::min(std::max(k, 1ull), m_count);
+		unsigned long long acc = 0;
+		int b = 0;
+		for (; b < 255; ++b)
+		{
+			if (acc + hist[b] >= k)
+				break;
+			acc += hist[b];
+		}
+		bin[i] = b;
+		rank[i] = k - acc;
+	}
+	int dense = int(std::max_element(hist.begin(), hist.end()) - hist.begin());
+
+	if (!m_wide)
+	{
+		for (size_t i = 0; i < pn; ++i)
+			m_values[i] = bin[i];
+		m_modv = dense;
+		return true;
+	}
+
+	//fine pass on the low bytes of the selected bins
+	std::vector<int> slot(256, -1);
+	std::vector<int> bins;
+	auto add_bin = [&](int b)
+	{
+		if (slot[b] < 0)
+		{
+			slot[b] = int(bins.size());
+			bins.push_back(b);
+		}
+	};
+	for (size_t i = 0; i < pn; ++i)
+		add_bin(bin[i]);
+	add_bin(dense);
+	size_t fn = bins.size() * 256;
+	std::vector<unsigned long long> fine(fn, 0);
+	for (auto& r : m_regions)
+	{
+		size_t rows = (r.y1 - r.y0) * (r.z1 - r.z0);
+		if (!rows || r.x1 <= r.x0)
+			continue;
+		std::vector<std::vector<unsigned long long>> part(tn);
+		ParallelFor(rows, [&](size_t r0, size_t r1, unsigned int t)
+		{
+			std::vector<unsigned long long>& h = part[t];
+			h.assign(fn, 0);
+			ScanRows(r, r0, r1, [&](unsigned int val)
+			{
+				int s = slot[val >> 8];
+				if (s >= 0)
+					h[size_t(s) * 256 + (val & 0xff)]++;
+			});
+		}, tn);
+		for (auto& h : part)
+		{
+			if (h.empty())
+				continue;
+			for (size_t i = 0; i < fn; ++i)
+				fine[i] += h[i];
+		}
+	}
+
+	for (size_t i = 0; i < pn; ++i)
+	{
+		const unsigned long long* h = &fine[size_t(slot[bin[i]]) * 256];
+		unsigned long long acc = 0;
+		int f = 0;
+		for (; f < 255; ++f)
+		{
+			acc += h[f];
+			if (acc >= rank[i])
+				break;
+		}
+		m_values[i] = (static_cast<unsigned int>(bin[i]) << 8) |
+			static_cast<unsigned int>(f);
+	}
+	const unsigned long long* h = &fine[size_t(slot[dense]) * 256];
+	int f = int(std::max_element(h, h + 256) - h);
+	m_modv = (static_cast<unsigned int>(dense) << 8) |
+		static_cast<unsigned int>(f);
+
+	return true;
+}
+
+bool HistSelect::ComputeCounts(const std::vector<double>& pcts)
+{
+	m_count = 0;
+	m_sum = 0.0;
+	m_minv = m_maxv = m_modv = 0;
+	m_values.assign(pcts.size(), 0);
+
+	unsigned int tn = GetThreadNum(m_thread_num);
+	for (auto& r : m_regions)
+	{
+		if (!r.data || (r.bytes != 1 && r.bytes != 2))
+			return false;
+		size_t rows = (r.y1 - r.y0) * (r.z1 - r.z0);
+		if (!rows || r.x1 <= r.x0)
+			continue;
+		size_t bins = r.bytes == 1 ? 256 : 65536;
+		std::vector<std::vector<unsigned long long>> part(tn);
+		ParallelFor(rows, [&](size_t r0, size_t r1, unsigned int t)
+		{
+			std::vector<unsigned long long>& h = part[t];
+			h.assign(bins, 0);
+			ScanRows(r, r0, r1, [&](unsigned int val) { h[val]++; });
+		}, tn);
+		for (auto& h : part)
+			if (!h.empty())
+				AddCounts(h);
+	}
+
+	size_t start = m_ignore_zero ? 1 : 0;
+	size_t bins = m_counts.size();
+	unsigned long long peak = 0;
+	bool first = true;
+	for (size_t v = start; v < bins; ++v)
+	{
+		unsigned long long c = m_counts[v];
+		if (!c)
+			continue;
+		if (first)
+		{
+			m_minv = static_cast<unsigned int>(v);
+			first = false;
+		}
+		m_maxv = static_cast<unsigned int>(v);
+		m_count += c;
+		m_sum += double(c) * double(v);
+		if (c > peak)
+		{
+			peak = c;
+			m_modv = static_cast<unsigned int>(v);
+		}
+	}
+	if (!m_count)
+		return true;
+
+	for (size_t i = 0; i < pcts.size(); ++i)
+	{
+		double p = std::min(std::max(pcts[i], 0.0), 100.0);
+		unsigned long long k = (unsigned long long)
+			std::ceil(p / 100.0 * double(m_count));
+		k = std::min(std::max(k, 1ull), m_count);
+		unsigned long long acc = 0;
+		size_t v = start;
+		for (; v < bins - 1; ++v)
+		{
+			acc += m_counts[v];
+			if (acc >= k)
+				break;
+		}
+		m_values[i] = static_cast<unsigned int>(v);
+	}
+	return true;
+}
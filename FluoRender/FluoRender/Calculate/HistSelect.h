@@ -0,0 +1,155 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_HistSelect_h
+#define FL_HistSelect_h
+
+#include <vector>
+#include <cstddef>
+
+namespace flrd
+{
+	//exact order statistics of integer data from histograms
+	//8-bit values are counted directly
+	//16-bit values use two levels: a coarse pass on the high byte finds
+	//the bins holding the requested ranks, and a second pass counts
+	//the low bytes only within those bins
+	//both passes run over row slabs on multiple threads
+	//data that can't be kept until Compute, e.g. bricks read back one at
+	//a time, is counted right away into a full histogram instead
+	class HistSelect
+	{
+	public:
+		HistSelect();
+		~HistSelect();
+
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+		//zero voxels are excluded, as for background values
+		void SetIgnoreZero(bool val) { m_ignore_zero = val; }
+		//bytes: 1 or 2; mask is optional
+		//several regions, e.g. bricks, are combined into one distribution
+		void AddRegion(const void* data, int bytes,
+			size_t nx, size_t ny, size_t nz,
+			const unsigned char* mask = 0);
+		//limit the last added region to [x0, x1) x [y0, y1) x [z0, z1)
+		void SetWindow(size_t x0, size_t y0, size_t z0,
+			size_t x1, size_t y1, size_t z1);
+		void ClearRegions() { m_regions.clear(); }
+		//count values into the full histogram now, the data can be released
+		void Accumulate(const void* data, int bytes, size_t n,
+			const unsigned char* mask = 0);
+		//add a full histogram of 256 or 65536 bins
+		void AddCounts(const std::vector<unsigned long long>& hist);
+		void ClearCounts() { m_counts.clear(); }
+
+		//percentiles in [0, 100]
+		bool Compute(const std::vector<double>& pcts = std::vector<double>());
+
+		unsigned long long GetCount() { return m_count; }
+		double GetSum() { return m_sum; }
+		unsigned int GetMin() { return m_minv; }
+		unsigned int GetMax() { return m_maxv; }
+		//most frequent value
+		//exact with counted values; for 16-bit regions without them,
+		//it is the peak within the densest coarse bin
+		unsigned int GetMode() { return m_modv; }
+		//value with rank ceil(p * count), in the order of pcts
+		unsigned int GetPercentile(size_t i)
+		{
+			return i < m_values.size() ? m_values[i] : 0;
+		}
+
+	private:
+		struct Region
+		{
+			const void* data;
+			int bytes;
+			size_t nx, ny, nz;
+			const unsigned char* mask;
+			size_t x0, y0, z0;
+			size_t x1, y1, z1;
+		};
+
+		//per thread partial results of the coarse pass
+		struct Coarse
+		{
+			std::vector<unsigned long long> hist;
+			unsigned long long count = 0;
+			double sum = 0.0;
+			unsigned int minv = 0xffffffff;
+			unsigned int maxv = 0;
+		};
+
+		unsigned int m_thread_num = 0;
+		bool m_ignore_zero = false;
+		std::vector<Region> m_regions;
+		bool m_wide = false;//any 16-bit region
+		std::vector<unsigned long long> m_counts;//full histogram
+
+		//results
+		unsigned long long m_count = 0;
+		double m_sum = 0.0;
+		unsigned int m_minv = 0;
+		unsigned int m_maxv = 0;
+		unsigned int m_modv = 0;
+		std::vector<unsigned int> m_values;
+
+	private:
+		//statistics from m_counts, regions are counted into it first
+		bool ComputeCounts(const std::vector<double>& pcts);
+		//call func(value) for every counted voxel in rows [r0, r1) of a region
+		template <typename F>
+		void ScanRows(const Region& r, size_t r0, size_t r1, F&& func);
+	};
+
+	template <typename F>
+	void HistSelect::ScanRows(const Region& r, size_t r0, size_t r1, F&& func)
+	{
+		size_t wy = r.y1 - r.y0;
+		for (size_t row = r0; row < r1; ++row)
+		{
+			size_t k = r.z0 + row / wy;
+			size_t j = r.y0 + row % wy;
+			unsigned long long index =
+				(unsigned long long)k * r.nx * r.ny +
+				(unsigned long long)j * r.nx + r.x0;
+			for (size_t i = r.x0; i < r.x1; ++i, ++index)
+			{
+				if (r.mask && !r.mask[index])
+					continue;
+				unsigned int val = r.bytes == 1 ?
+					((const unsigned char*)r.data)[index] :
+					((const unsigned short*)r.data)[index];
+				if (m_ignore_zero && !val)
+					continue;
+				func(val);
+			}
+		}
+	}
+}
+
+#endif//FL_HistSelect_h
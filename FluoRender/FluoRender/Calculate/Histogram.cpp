@@ -150,6 +150,11 @@ void Histogram::Compute()
 	//sum histogram
 	m_histogram.resize(m_bins + 1, 0);
 	std::weak_ptr<flvr::Argument> arg_sh;
+	bool arg_new = true;
+	//voxels of empty bricks all go to the first bin
+	unsigned long long empty_num = 0;
+	if (!m_use_mask)
+		m_vd->GetTexture()->update_brick_stats();
 
 	for (size_t i = 0; i < brick_num; ++i)
 	{
@@ -157,6 +162,22 @@ void Histogram::Compute()
 		long nx, ny, nz;
 		if (!GetInfo(b, bits, nx, ny, nz))
 			continue;
+		if (m_use_mask)
+		{
+			//mask is up to date in memory and has nothing
+			if (!b->is_mask_valid() &&
+				b->is_comp_empty(flvr::CompType::Mask))
+			{
+				count++;
+				continue;
+			}
+		}
+		else if (b->is_empty())
+		{
+			empty_num += (unsigned long long)nx * ny * nz;
+			count++;
+			continue;
+		}
 		//get tex ids
 		GLint tid = m_vd->GetVR()->load_brick(b);
 		GLint mid = 0;
@@ -174,10 +195,13 @@ void Histogram::Compute()
 		kernel_prog->setConst(sizeof(float), (void*)(&minv));
 		kernel_prog->setConst(sizeof(float), (void*)(&maxv));
 		kernel_prog->setConst(sizeof(unsigned int), (void*)(&bin));
-		if (i == 0)
+		if (arg_new)
+		{
 			arg_sh = kernel_prog->setBufNew(
 				CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, "",
 				sizeof(unsigned int)*(bin + 1), (void*)(m_histogram.data()));
+			arg_new = false;
+		}
 		else
 			kernel_prog->bindArg(arg_sh);
 		if (m_use_mask)
@@ -197,6 +221,12 @@ void Histogram::Compute()
 		count++;
 	}
 
+	if (empty_num && !m_histogram.empty())
+	{
+		m_histogram[0] += static_cast<unsigned int>(empty_num);
+		m_histogram[m_bins] += static_cast<unsigned int>(empty_num);
+	}
+
 	kernel_prog->releaseAllArgs();
 
 	SetProgress(0, "");
@@ -26,6 +26,8 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <VolumeBaker.h>
+#include <Global.h>
+#include <BufferPool.h>
 #include <VolumeData.h>
 #include <Texture.h>
 #include <stdexcept>
@@ -95,7 +97,7 @@ void VolumeBaker::Bake(bool replace)
 
 	//output raw
 	unsigned long long total_size = (unsigned long long)m_size.get_size_xyz();
-	m_raw_result = (void*)(new unsigned char[total_size * (m_bits / 8)]);
+	m_raw_result = glbin_buffer_pool.Alloc(total_size * (m_bits / 8));
 	if (!m_raw_result)
 		return;
 
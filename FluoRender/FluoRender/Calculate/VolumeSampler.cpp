@@ -26,6 +26,8 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <VolumeSampler.h>
+#include <Global.h>
+#include <BufferPool.h>
 #include <VolumeData.h>
 #include <Vector.h>
 #include <Plane.h>
@@ -228,7 +230,7 @@ void VolumeSampler::Resize(SampDataType type, bool replace)
 	ly = m_crop_size.inty();
 	lz = m_crop_size.intz();
 	unsigned long long total_size = (unsigned long long)lx*(unsigned long long)ly*(unsigned long long)lz;
-	m_raw_result = (void*)(new unsigned char[total_size * (m_bits /8)]);
+	m_raw_result = glbin_buffer_pool.Alloc(total_size * (m_bits / 8));
 	if (!m_raw_result)
 		return;
 
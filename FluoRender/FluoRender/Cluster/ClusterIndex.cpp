@@ -0,0 +1,221 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <ClusterIndex.h>
+#include <Cell.h>
+#include <Parallel.h>
+#include <boost/qvm/vec_access.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace flrd;
+
+ClusterIndex::ClusterIndex()
+{
+}
+
+ClusterIndex::~ClusterIndex()
+{
+}
+
+void ClusterIndex::Clear()
+{
+	m_pts.clear();
+	m_x.clear();
+	m_y.clear();
+	m_z.clear();
+	m_int.clear();
+	m_cell_start.clear();
+	m_cell_pts.clear();
+	m_dim[0] = m_dim[1] = m_dim[2] = 0;
+}
+
+void ClusterIndex::Build(Cluster& data, double cell)
+{
+	Clear();
+	size_t n = data.size();
+	if (!n)
+		return;
+	m_pts.reserve(n);
+	m_x.reserve(n);
+	m_y.reserve(n);
+	m_z.reserve(n);
+	m_int.reserve(n);
+	using namespace boost::qvm;
+	for (auto& p : data)
+	{
+		m_pts.push_back(p);
+		m_x.push_back(A0(p->centerf));
+		m_y.push_back(A1(p->centerf));
+		m_z.push_back(A2(p->centerf));
+		m_int.push_back(p->intensity);
+	}
+	if (cell <= 0.0)
+		return;
+
+	//bounds
+	double mn[3] = { m_x[0], m_y[0], m_z[0] };
+	double mx[3] = { m_x[0], m_y[0], m_z[0] };
+	for (size_t i = 1; i < n; ++i)
+	{
+		double v[3] = { m_x[i], m_y[i], m_z[i] };
+		for (int a = 0; a < 3; ++a)
+		{
+			mn[a] = std::min(mn[a], v[a]);
+			mx[a] = std::max(mx[a], v[a]);
+		}
+	}
+	//keep the number of cells in proportion to the points
+	m_cell = cell;
+	size_t cells;
+	while (true)
+	{
+		cells = 1;
+		for (int a = 0; a < 3; ++a)
+		{
+			m_min[a] = mn[a];
+			m_dim[a] = size_t((mx[a] - mn[a]) / m_cell) + 1;
+			cells *= m_dim[a];
+		}
+		if (cells <= 4 * n + 64)
+			break;
+		m_cell *= 2.0;
+	}
+
+	//counting sort of the points by cell
+	std::vector<unsigned int> cid(n);
+	m_cell_start.assign(cells + 1, 0);
+	for (size_t i = 0; i < n; ++i)
+	{
+		size_t c = (CellCoord(m_z[i], 2) * m_dim[1] +
+			CellCoord(m_y[i], 1)) * m_dim[0] +
+			CellCoord(m_x[i], 0);
+		cid[i] = static_cast<unsigned int>(c);
+		m_cell_start[c + 1]++;
+	}
+	for (size_t c = 0; c < cells; ++c)
+		m_cell_start[c + 1] += m_cell_start[c];
+	m_cell_pts.resize(n);
+	std::vector<unsigned int> pos(m_cell_start.begin(), m_cell_start.end() - 1);
+	for (size_t i = 0; i < n; ++i)
+		m_cell_pts[pos[cid[i]]++] = static_cast<unsigned int>(i);
+}
+
+size_t ClusterIndex::CellCoord(double v, int axis) const
+{
+	double c = std::floor((v - m_min[axis]) / m_cell);
+	if (c < 0.0)
+		return 0;
+	size_t ci = size_t(c);
+	return std::min(ci, m_dim[axis] - 1);
+}
+
+float ClusterIndex::Dist(size_t i, size_t j, float w) const
+{
+	double dx = m_x[i] - m_x[j];
+	double dy = m_y[i] - m_y[j];
+	double dz = m_z[i] - m_z[j];
+	float int_diff = std::fabs(m_int[i] - m_int[j]);
+	return static_cast<float>(std::sqrt(dx * dx + dy * dy + dz * dz)) + w * int_diff;
+}
+
+void ClusterIndex::Query(size_t i, float eps, float w,
+	std::vector<unsigned int>& result) const
+{
+	result.clear();
+	if (i >= m_pts.size() || m_cell_start.empty())
+		return;
+	//the intensity term is never negative, so the spatial distance
+	//alone bounds the cells to search
+	double r = eps;
+	double v[3] = { m_x[i], m_y[i], m_z[i] };
+	size_t lo[3], hi[3];
+	for (int a = 0; a < 3; ++a)
+	{
+		lo[a] = CellCoord(v[a] - r, a);
+		hi[a] = CellCoord(v[a] + r, a);
+	}
+	for (size_t k = lo[2]; k <= hi[2]; ++k)
+	for (size_t j = lo[1]; j <= hi[1]; ++j)
+	{
+		size_t row = (k * m_dim[1] + j) * m_dim[0];
+		unsigned int b = m_cell_start[row + lo[0]];
+		unsigned int e = m_cell_start[row + hi[0] + 1];
+		for (unsigned int c = b; c < e; ++c)
+		{
+			unsigned int p = m_cell_pts[c];
+			if (Dist(i, p, w) < eps)
+				result.push_back(p);
+		}
+	}
+	std::sort(result.begin(), result.end());
+}
+
+void ClusterIndex::QueryAll(const std::vector<unsigned int>& items,
+	float eps, float w,
+	std::vector<unsigned int>& offset,
+	std::vector<unsigned int>& list) const
+{
+	size_t n = items.empty() ? m_pts.size() : items.size();
+	offset.assign(n + 1, 0);
+	list.clear();
+	if (!n)
+		return;
+	auto item = [&](size_t i)
+	{
+		return items.empty() ? i : size_t(items[i]);
+	};
+
+	//each thread keeps the lists of its own range,
+	//which are joined in order
+	unsigned int tn = GetThreadNum(m_thread_num);
+	std::vector<std::vector<unsigned int>> part(tn);
+	std::vector<size_t> part_begin(tn, 0);
+	ParallelFor(n, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		std::vector<unsigned int> result;
+		std::vector<unsigned int>& out = part[t];
+		part_begin[t] = i0;
+		for (size_t i = i0; i < i1; ++i)
+		{
+			Query(item(i), eps, w, result);
+			offset[i + 1] = static_cast<unsigned int>(result.size());
+			out.insert(out.end(), result.begin(), result.end());
+		}
+	}, tn);
+
+	for (size_t i = 0; i < n; ++i)
+		offset[i + 1] += offset[i];
+	list.resize(offset[n]);
+	for (unsigned int t = 0; t < tn; ++t)
+	{
+		if (part[t].empty())
+			continue;
+		std::copy(part[t].begin(), part[t].end(),
+			list.begin() + offset[part_begin[t]]);
+	}
+}
@@ -0,0 +1,94 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_ClusterIndex_h
+#define FL_ClusterIndex_h
+
+#include <ClusterMethod.h>
+#include <vector>
+#include <cstddef>
+
+namespace flrd
+{
+	//flat copy of the cluster points, one array per coordinate,
+	//with a uniform grid for range queries
+	//point indices follow the order of the cluster list
+	class ClusterIndex
+	{
+	public:
+		ClusterIndex();
+		~ClusterIndex();
+
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+
+		//copy the points; the grid cell size should be about
+		//the largest query radius, no grid is built if it is 0
+		void Build(Cluster& data, double cell = 0.0);
+		void Clear();
+
+		size_t size() const { return m_pts.size(); }
+		pClusterPoint& point(size_t i) { return m_pts[i]; }
+		double x(size_t i) const { return m_x[i]; }
+		double y(size_t i) const { return m_y[i]; }
+		double z(size_t i) const { return m_z[i]; }
+		float intensity(size_t i) const { return m_int[i]; }
+		const std::vector<double>& X() const { return m_x; }
+		const std::vector<double>& Y() const { return m_y; }
+		const std::vector<double>& Z() const { return m_z; }
+		const std::vector<float>& Intensity() const { return m_int; }
+
+		//same measure as Dist()
+		float Dist(size_t i, size_t j, float w) const;
+		//indices of the points with Dist(i, j, w) < eps, ascending
+		void Query(size_t i, float eps, float w,
+			std::vector<unsigned int>& result) const;
+		//neighbor lists of the points in items (all points if empty),
+		//computed in parallel and stored as offsets into list
+		void QueryAll(const std::vector<unsigned int>& items,
+			float eps, float w,
+			std::vector<unsigned int>& offset,
+			std::vector<unsigned int>& list) const;
+
+	private:
+		unsigned int m_thread_num = 0;
+		std::vector<pClusterPoint> m_pts;
+		std::vector<double> m_x, m_y, m_z;
+		std::vector<float> m_int;
+
+		//grid
+		double m_cell = 1.0;
+		double m_min[3] = { 0, 0, 0 };
+		size_t m_dim[3] = { 0, 0, 0 };
+		std::vector<unsigned int> m_cell_start;//size: cells + 1
+		std::vector<unsigned int> m_cell_pts;//point indices sorted by cell
+
+	private:
+		size_t CellCoord(double v, int axis) const;
+	};
+}
+
+#endif//FL_ClusterIndex_h
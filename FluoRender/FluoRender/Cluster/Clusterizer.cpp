@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Texture.h>
 #include <VolumeRenderer.h>
 #include <Cell.h>
+#include <algorithm>
 
 using namespace flrd;
 
@@ -47,7 +48,9 @@ Clusterizer::Clusterizer():
 	m_maxiter(0),
 	m_tol(0.0f),
 	m_size(0),
-	m_eps(0.0)
+	m_eps(0.0),
+	m_plus_plus(false),
+	m_batch(0)
 {
 	m_in_cells = std::make_unique<CelpList>();
 	m_out_cells = std::make_unique<CelpList>();
@@ -63,6 +66,8 @@ void Clusterizer::Compute()
 
 	m_in_cells->clear();
 	m_out_cells->clear();
+	m_titles.clear();
+	m_values.clear();
 
 	auto vd = glbin_current.vol_data.lock();
 	if (!vd)
@@ -99,6 +104,7 @@ void Clusterizer::Compute()
 	auto spc = vd->GetSpacing();
 
 	flrd::ClusterMethod* method = 0;
+	flrd::ClusterKmeans* method_kmeans = 0;
 	//switch method
 	switch (m_method)
 	{
@@ -121,9 +127,12 @@ void Clusterizer::Compute()
 		break;
 	case 2:
 	{
-		flrd::ClusterKmeans* method_kmeans = new flrd::ClusterKmeans();
+		method_kmeans = new flrd::ClusterKmeans();
 		method_kmeans->SetClnum(glbin_comp_def.m_cluster_clnum);
 		method_kmeans->SetMaxiter(glbin_comp_def.m_cluster_maxiter);
+		method_kmeans->SetPlusPlus(glbin_comp_def.m_cluster_plus_plus);
+		method_kmeans->SetMiniBatch(static_cast<size_t>(
+			std::max(glbin_comp_def.m_cluster_batch, 0)));
 		method = method_kmeans;
 	}
 		break;
@@ -265,6 +274,16 @@ void Clusterizer::Compute()
 		//m_view->RefreshGL(39);//refresh needs to be performed by caller
 	}
 
+	if (method_kmeans)
+	{
+		m_titles = L"Iterations\tConverged\tShift\tInertia\tTime\n";
+		m_values = std::to_wstring(method_kmeans->GetIterNum()) + L"\t" +
+			(method_kmeans->GetConverged() ? L"Yes" : L"No") + L"\t" +
+			std::to_wstring(method_kmeans->GetShift()) + L"\t" +
+			std::to_wstring(method_kmeans->GetInertia()) + L"\t" +
+			std::to_wstring(method_kmeans->GetTime()) + L" sec.\n";
+	}
+
 	delete method;
 
 	SetRange(0, 100);
@@ -30,6 +30,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Progress.h>
 #include <memory>
+#include <string>
 
 namespace flrd
 {
@@ -54,6 +55,14 @@ namespace flrd
 		int GetSize() { return m_size; }
 		void SetEps(double val) { m_eps = val; }
 		double GetEps() { return m_eps; }
+		//kmeans seeding and mini-batch size
+		void SetPlusPlus(bool val) { m_plus_plus = val; }
+		bool GetPlusPlus() { return m_plus_plus; }
+		void SetBatch(int val) { m_batch = val; }
+		int GetBatch() { return m_batch; }
+		//statistics of the last kmeans run
+		std::wstring GetTitles() { return m_titles; }
+		std::wstring GetValues() { return m_values; }
 		//in and out cell lists
 		CelpList& GetInCells();
 		CelpList& GetOutCells();
@@ -67,6 +76,9 @@ namespace flrd
 		float m_tol;
 		int m_size;
 		double m_eps;
+		bool m_plus_plus;
+		int m_batch;
+		std::wstring m_titles, m_values;
 		//in and out cell lists for tracking
 		std::unique_ptr<flrd::CelpList> m_in_cells;
 		std::unique_ptr<flrd::CelpList> m_out_cells;
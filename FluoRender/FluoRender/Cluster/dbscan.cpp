@@ -60,13 +60,20 @@ bool ClusterDbscan::Execute()
 	//	Dbscan();
 	//}
 
+	bool result = false;
 	if (m_result.size() > 0)
 	{
 		RemoveNoise();
-		return true;
+		result = true;
 	}
-	else
-		return false;
+
+	//copy states back to the points
+	for (size_t i = 0; i < m_index.size(); ++i)
+	{
+		m_index.point(i)->visited = m_visited[i] != 0;
+		m_index.point(i)->noise = m_noise[i] != 0;
+	}
+	return result;
 }
 
 float ClusterDbscan::GetProb()
@@ -82,110 +89,145 @@ void ClusterDbscan::ResetData()
 		(*iter)->visited = false;
 		(*iter)->noise = true;
 	}
+	m_visited.assign(m_visited.size(), 0);
+	m_noise.assign(m_noise.size(), 1);
+	m_label.assign(m_label.size(), -1);
 	m_result.clear();
 }
 
 void ClusterDbscan::Dbscan()
 {
-	size_t ticks = m_data.size() / 100;
+	m_index.Build(m_data, m_eps);
+	size_t n = m_index.size();
+	m_visited.assign(n, 0);
+	m_noise.assign(n, 1);
+	m_label.assign(n, -1);
+	m_stamp.assign(n, 0);
+
+	//all neighbor queries run in parallel before the sequential expansion
+	SetProgress(0, "Computing DBSCAN.");
+	m_index.QueryAll(std::vector<unsigned int>(),
+		m_eps, m_intw, m_nb_offset, m_nb_list);
+
+	size_t ticks = n / 100;
 	ticks = ticks ? ticks : 1;
-	size_t count = 0;
 	//an implementation of the DBSCAN algorithm
 	//see wikipedia.org
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	std::vector<unsigned int> cluster;
+	for (size_t i = 0; i < n; ++i)
 	{
-		pClusterPoint p = *iter;
-		if (p->visited)
+		if (i % ticks == 0)
+			SetProgress(static_cast<int>(i / ticks),
+				"Computing DBSCAN.");
+		if (m_visited[i])
 			continue;
-		p->visited = true;
-		Cluster neighbors = GetNeighbors(p, m_eps, m_intw);
-		if (neighbors.size() >= m_size)
+		m_visited[i] = 1;
+		if (m_nb_offset[i + 1] - m_nb_offset[i] >= m_size)
 		{
-			Cluster cluster;
-			ExpandCluster(p, neighbors, cluster);
-			m_result.push_back(cluster);
-		}
-		if (count % 100 == 0)
-		{
-			SetProgress(static_cast<int>(count / ticks),
-				"Computing DBSCAN.");
-			count++;
+			ExpandCluster(static_cast<unsigned int>(i), cluster);
+			AddCluster(cluster);
 		}
 	}
 }
 
-void ClusterDbscan::ExpandCluster(pClusterPoint& p, Cluster& neighbors, Cluster& cluster)
+void ClusterDbscan::ExpandCluster(unsigned int p, std::vector<unsigned int>& cluster)
 {
+	//points already in the list are stamped with the cluster number
+	unsigned int stamp = static_cast<unsigned int>(m_result.size()) + 1;
+	std::vector<unsigned int> neighbors(
+		m_nb_list.begin() + m_nb_offset[p],
+		m_nb_list.begin() + m_nb_offset[p + 1]);
+	for (auto q : neighbors)
+		m_stamp[q] = stamp;
+
+	cluster.clear();
 	cluster.push_back(p);
-	p->noise = false;
-	for (ClusterIter iter = neighbors.begin();
-		iter != neighbors.end(); ++iter)
+	m_noise[p] = 0;
+	for (size_t k = 0; k < neighbors.size(); ++k)
 	{
-		pClusterPoint p2 = *iter;
-		if (!p2->visited)
+		unsigned int p2 = neighbors[k];
+		if (!m_visited[p2])
 		{
-			p2->visited = true;
-			Cluster neighbors2 = GetNeighbors(p2, m_eps, m_intw);
-			if (neighbors2.size() >= m_size)
-				neighbors.join(neighbors2);
+			m_visited[p2] = 1;
+			unsigned int b = m_nb_offset[p2];
+			unsigned int e = m_nb_offset[p2 + 1];
+			if (e - b >= m_size)
+			{
+				for (unsigned int j = b; j < e; ++j)
+				{
+					unsigned int q = m_nb_list[j];
+					if (m_stamp[q] == stamp)
+						continue;
+					m_stamp[q] = stamp;
+					neighbors.push_back(q);
+				}
+			}
 		}
-		if (!m_result.find(p2))
+		//points of earlier clusters are not taken
+		if (m_label[p2] < 0)
 		{
 			cluster.push_back(p2);
-			p2->noise = false;
+			m_noise[p2] = 0;
 		}
 	}
 }
 
-Cluster ClusterDbscan::GetNeighbors(pClusterPoint &p, float eps, float intw)
+void ClusterDbscan::AddCluster(const std::vector<unsigned int>& cluster)
 {
-	Cluster neighbors;
-
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	int index = static_cast<int>(m_result.size());
+	Cluster result;
+	for (auto p : cluster)
 	{
-		if (Dist(*p, **iter, intw) < eps)
-			neighbors.push_back(*iter);
+		result.push_back(m_index.point(p));
+		m_label[p] = index;
 	}
-
-	return neighbors;
+	m_result.push_back(result);
 }
 
 void ClusterDbscan::RemoveNoise()
 {
+	std::vector<unsigned int> items;
+	for (size_t i = 0; i < m_noise.size(); ++i)
+		if (m_noise[i])
+			items.push_back(static_cast<unsigned int>(i));
+	if (items.empty())
+		return;
+	//neighbors of the noise points by position only
+	std::vector<unsigned int> offset, list;
+	m_index.QueryAll(items, 1.1f, 0.0f, offset, list);
+
 	//remove noise
 	unsigned int noise_num;
 	do
 	{
 		noise_num = 0;
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
+		for (size_t k = 0; k < items.size(); ++k)
 		{
 			//find a point that is not clustered
-			if (!(*iter)->noise)
+			unsigned int p = items[k];
+			if (!m_noise[p])
 				continue;
-			Cluster neighbors = GetNeighbors(*iter, 1.1f, 0.0f);
-			if (neighbors.size() &&
-				ClusterNoise(*iter, neighbors))
+			size_t num = offset[k + 1] - offset[k];
+			if (num &&
+				ClusterNoise(p, &list[offset[k]], num))
 				noise_num++;
 		}
 	} while (noise_num);
 }
 
-bool ClusterDbscan::ClusterNoise(pClusterPoint& p, Cluster& neighbors)
+bool ClusterDbscan::ClusterNoise(unsigned int p, const unsigned int* neighbors, size_t num)
 {
 	if (m_result.size() > 1)
 	{
 		std::vector<unsigned int> cluster_count;
 		cluster_count.resize(m_result.size(), 0);
 
-		for (ClusterIter iter = neighbors.begin();
-			iter != neighbors.end(); ++iter)
+		for (size_t i = 0; i < num; ++i)
 		{
-			if ((*iter)->noise)
+			unsigned int q = neighbors[i];
+			if (m_noise[q])
 				continue;
-			int index = m_result.find_(*iter);
+			int index = m_label[q];
 			if (index == -1)
 				continue;
 			cluster_count[index]++;
@@ -197,8 +239,9 @@ bool ClusterDbscan::ClusterNoise(pClusterPoint& p, Cluster& neighbors)
 		if (*result)
 		{
 			size_t index = std::distance(cluster_count.begin(), result);
-			m_result[index].push_back(p);
-			p->noise = false;
+			m_result[index].push_back(m_index.point(p));
+			m_label[p] = static_cast<int>(index);
+			m_noise[p] = 0;
 			return true;
 		}
 		else return false;
@@ -206,8 +249,9 @@ bool ClusterDbscan::ClusterNoise(pClusterPoint& p, Cluster& neighbors)
 	else
 	{
 		Cluster cluster;
-		cluster.push_back(p);
-		p->noise = false;
+		cluster.push_back(m_index.point(p));
+		m_noise[p] = 0;
+		m_label[p] = static_cast<int>(m_result.size());
 		m_result.push_back(cluster);
 		return true;
 	}
@@ -29,6 +29,8 @@ DEALINGS IN THE SOFTWARE.
 #define FL_Dbscan_h
 
 #include <ClusterMethod.h>
+#include <ClusterIndex.h>
+#include <vector>
 
 namespace flrd
 {
@@ -50,13 +52,24 @@ namespace flrd
 		float m_eps;
 		float m_intw;
 
+		//flat points with a grid sized by eps
+		ClusterIndex m_index;
+		//neighbor lists of all points
+		std::vector<unsigned int> m_nb_offset;
+		std::vector<unsigned int> m_nb_list;
+		//per point states, in the order of m_data
+		std::vector<char> m_visited;
+		std::vector<char> m_noise;
+		std::vector<int> m_label;//index in m_result, -1 if not clustered
+		std::vector<unsigned int> m_stamp;//marks points in the expanding list
+
 	private:
 		void Dbscan();
 		void ResetData();
-		void ExpandCluster(pClusterPoint& p, Cluster& neighbors, Cluster& cluster);
-		Cluster GetNeighbors(pClusterPoint &p, float eps, float intw);
+		void ExpandCluster(unsigned int p, std::vector<unsigned int>& cluster);
+		void AddCluster(const std::vector<unsigned int>& cluster);
 		void RemoveNoise();
-		bool ClusterNoise(pClusterPoint& p, Cluster& neighbors);
+		bool ClusterNoise(unsigned int p, const unsigned int* neighbors, size_t num);
 	};
 
 }
@@ -27,11 +27,12 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <exmax.h>
 #include <Cell.h>
+#include <Parallel.h>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <fstream>
 #include <boost/qvm/mat_operations.hpp>
-#include <boost/qvm/vec_operations.hpp>
-#include <boost/qvm/vec_mat_operations.hpp>
 #include <boost/qvm/mat_access.hpp>
 #include <boost/qvm/vec_access.hpp>
 
@@ -42,7 +43,11 @@ ClusterExmax::ClusterExmax() :
 	m_weak_result(false),
 	m_eps(1e-6f),
 	m_max_iter(300),
-	m_tol(0.9f)
+	m_tol(0.9f),
+	m_thread_num(0),
+	m_likelihood(0),
+	m_likelihood_prv(0),
+	m_bins(0)
 {
 
 }
@@ -58,11 +63,14 @@ bool ClusterExmax::Execute()
 		return false;
 
 	Initialize();
+	if (m_params.empty())
+		return false;
 
 	size_t counter = 0;
 	do {
 		m_params_prv = m_params;
 		m_likelihood_prv = m_likelihood;
+		Prepare();
 		Expectation();
 		Maximization();
 		//histograom test
@@ -95,299 +103,433 @@ bool ClusterExmax::Execute()
 
 float ClusterExmax::GetProb()
 {
-	if (m_mem_prob.empty())
+	size_t size = m_index.size();
+	size_t k = m_params.size();
+	if (!size || m_mem_prob.size() < k * size)
 		return 0.0f;
 
 	double sum = 0;
-	double max;
-	size_t size = m_mem_prob[0].size();
 	for (size_t i = 0; i < size; ++i)
 	{
-		max = 0;
-		for (size_t j = 0; j < m_clnum; ++j)
-		{
-			if (m_mem_prob[j][i] > max)
-				max = m_mem_prob[j][i];
-		}
+		double max = 0;
+		for (size_t j = 0; j < k; ++j)
+			max = std::max(max, Prob(j, i));
 		sum += max;
 	}
-	if (size)
-		return float(sum / size);
-	else
-		return 0.0f;
+	return float(sum / size);
 }
 
 void ClusterExmax::Initialize()
 {
+	m_index.SetThreadNum(m_thread_num);
+	m_index.Build(m_data);
+	m_params.clear();
+	m_likelihood = 0;
+
 	if (m_use_init_cluster)
 		Init2();
 	else
 		Init1();
 
 	//allocate membership probabilities
-	m_mem_prob.resize(m_clnum);
-	for (size_t i = 0; i < m_clnum; ++i)
-		m_mem_prob[i].resize(m_data.size(), 0);
+	m_mem_prob.assign(m_params.size() * m_index.size(), 0);
 	m_mem_prob_prv.clear();
-	m_count.resize(m_data.size(), 0);
+	m_count.assign(m_index.size(), 0);
 }
 
 void ClusterExmax::Init1()
 {
+	size_t n = m_index.size();
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	const float* w = m_index.Intensity().data();
+
 	//use same tau and covar
-	EmVec trace = { 0, 0, 0 };
-	EmVec mean = { 0, 0, 0 };
-	EmVec vec;
+	double mean[3] = { 0, 0, 0 };
 	double count = 0;
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	for (size_t i = 0; i < n; ++i)
 	{
-		mean += (*iter)->centerf * (*iter)->intensity;
-		count += (*iter)->intensity;
+		mean[0] += x[i] * w[i];
+		mean[1] += y[i] * w[i];
+		mean[2] += z[i] * w[i];
+		count += w[i];
 	}
-	mean /= count;
-
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	for (int c = 0; c < 3; ++c)
+		mean[c] /= count;
+	double trace[3] = { 0, 0, 0 };
+	for (size_t i = 0; i < n; ++i)
 	{
-		vec = (*iter)->centerf - mean;
-		EmVec temp = { 0, 0, 0 };
-		boost::qvm::A0(temp) = boost::qvm::A0(vec) * boost::qvm::A0(vec);
-		boost::qvm::A1(temp) = boost::qvm::A1(vec) * boost::qvm::A1(vec);
-		boost::qvm::A2(temp) = boost::qvm::A2(vec) * boost::qvm::A2(vec);
-		trace += temp * (*iter)->intensity;
+		double dx = x[i] - mean[0];
+		double dy = y[i] - mean[1];
+		double dz = z[i] - mean[2];
+		trace[0] += dx * dx * w[i];
+		trace[1] += dy * dy * w[i];
+		trace[2] += dz * dz * w[i];
 	}
-	trace /= count/*double(m_data.size() - 1)*/;
 	EmMat covar = boost::qvm::zero_mat<double, 3, 3>();
-	boost::qvm::A00(covar) = boost::qvm::A0(trace);
-	boost::qvm::A11(covar) = boost::qvm::A1(trace);
-	boost::qvm::A22(covar) = boost::qvm::A2(trace);
+	boost::qvm::A00(covar) = trace[0] / count;
+	boost::qvm::A11(covar) = trace[1] / count;
+	boost::qvm::A22(covar) = trace[2] / count;
 	double tau = 1.0 / m_clnum;
 
 	//use similar method as k-means for means
-	//search for maximum
-	pClusterPoint p = nullptr;
-	Cluster cluster;
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	//search for maximum, then the farthest from the last mean
+	std::vector<unsigned char> chosen(n, 0);
+	size_t p = 0;
+	for (size_t i = 1; i < n; ++i)
+		if (w[i] > w[p])
+			p = i;
+	for (size_t j = 0; j < m_clnum; ++j)
 	{
-		if (iter == m_data.begin())
-			p = *iter;
-		else
+		if (j)
 		{
-			if ((*iter)->intensity > p->intensity)
-				p = *iter;
+			const EmVec& m = m_params.back().mean;
+			double mx = boost::qvm::A0(m);
+			double my = boost::qvm::A1(m);
+			double mz = boost::qvm::A2(m);
+			p = n;
+			double d1 = -1;
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (chosen[i])
+					continue;
+				double dx = x[i] - mx;
+				double dy = y[i] - my;
+				double dz = z[i] - mz;
+				double d2 = dx * dx + dy * dy + dz * dz;
+				if (d2 > d1)
+				{
+					d1 = d2;
+					p = i;
+				}
+			}
+			if (p == n)
+				break;
 		}
-	}
-	if (p != nullptr)
-	{
 		Params params;
 		params.tau = tau;
-		params.mean = p->centerf;
+		params.mean = m_index.point(p)->centerf;
 		params.covar = covar;
 		m_params.push_back(params);
-		cluster.push_back(p);
-	}
-	//search for the rest
-	for (size_t i = 1; i < m_clnum; ++i)
-	{
-		p = nullptr;
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
-		{
-			if (cluster.find(*iter))
-				continue;
-			if (p == nullptr)
-				p = *iter;
-			else
-			{
-				EmVec pi_1 = m_params[i - 1].mean;
-				double d1 = boost::qvm::mag(p->centerf - pi_1);
-				double d2 = boost::qvm::mag((*iter)->centerf - pi_1);
-				if (d2 > d1)
-					p = *iter;
-			}
-		}
-		if (p != nullptr)
-		{
-			Params params;
-			params.tau = tau;
-			params.mean = p->centerf;
-			params.covar = covar;
-			m_params.push_back(params);
-			cluster.push_back(p);
-		}
+		chosen[p] = 1;
 	}
 }
 
 void ClusterExmax::Init2()
 {
+	size_t n = m_index.size();
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	const float* w = m_index.Intensity().data();
+	std::vector<unsigned int> cid(n);
+	for (size_t i = 0; i < n; ++i)
+		cid[i] = m_index.point(i)->cid;
+
 	//mixture coefficient
 	double tau = 1.0 / m_clnum;
-	for (size_t i = 0; i < m_clnum; ++i)
+	for (unsigned int j = 0; j < m_clnum; ++j)
 	{
-		EmVec trace = { 0, 0, 0 };
-		EmVec mean = { 0, 0, 0 };
-		EmVec vec;
-		double count = 0;
-
 		//center
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
+		double mean[3] = { 0, 0, 0 };
+		double count = 0;
+		for (size_t i = 0; i < n; ++i)
 		{
-			if ((*iter)->cid != i)
+			if (cid[i] != j)
 				continue;
-
-			mean += (*iter)->centerf * (*iter)->intensity;
-			count += (*iter)->intensity;
+			mean[0] += x[i] * w[i];
+			mean[1] += y[i] * w[i];
+			mean[2] += z[i] * w[i];
+			count += w[i];
 		}
-		mean /= count;
+		for (int c = 0; c < 3; ++c)
+			mean[c] /= count;
 
 		//covar
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
+		double trace[3] = { 0, 0, 0 };
+		for (size_t i = 0; i < n; ++i)
 		{
-			if ((*iter)->cid != i)
+			if (cid[i] != j)
 				continue;
-
-			vec = (*iter)->centerf - mean;
-			EmVec temp = { 0, 0, 0 };
-			boost::qvm::A0(temp) = boost::qvm::A0(vec) * boost::qvm::A0(vec);
-			boost::qvm::A1(temp) = boost::qvm::A1(vec) * boost::qvm::A1(vec);
-			boost::qvm::A2(temp) = boost::qvm::A2(vec) * boost::qvm::A2(vec);
-			trace += temp * (*iter)->intensity;
+			double dx = x[i] - mean[0];
+			double dy = y[i] - mean[1];
+			double dz = z[i] - mean[2];
+			trace[0] += dx * dx * w[i];
+			trace[1] += dy * dy * w[i];
+			trace[2] += dz * dz * w[i];
 		}
-		trace /= count/* - 1*/;
 		EmMat covar = boost::qvm::zero_mat<double, 3, 3>();
-		boost::qvm::A00(covar) = boost::qvm::A0(trace);
-		boost::qvm::A11(covar) = boost::qvm::A1(trace);
-		boost::qvm::A22(covar) = boost::qvm::A2(trace);
+		boost::qvm::A00(covar) = trace[0] / count;
+		boost::qvm::A11(covar) = trace[1] / count;
+		boost::qvm::A22(covar) = trace[2] / count;
 
 		//add to init values
 		Params params;
 		params.tau = tau;
-		params.mean = mean;
+		params.mean = EmVec{ mean[0], mean[1], mean[2] };
 		params.covar = covar;
 		m_params.push_back(params);
 	}
 }
 
-void ClusterExmax::Expectation()
+void ClusterExmax::Prepare()
 {
-	unsigned int i = 0;
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	using namespace boost::qvm;
+	size_t k = m_params_prv.size();
+	m_comps.resize(k);
+	for (size_t j = 0; j < k; ++j)
 	{
-		double sum = 0;
-		for (unsigned int j = 0; j < m_clnum; ++j)
-			sum += m_params_prv[j].tau *
-			Gaussian((*iter)->centerf,
-				m_params_prv[j].mean,
-				m_params_prv[j].covar) * (*iter)->intensity;
-		for (unsigned int j = 0; j < m_clnum; ++j)
+		EmMat& s = m_params_prv[j].covar;
+		Comp& c = m_comps[j];
+		if (determinant(s) == 0.0)
 		{
-			if (sum > 0.0)
-				m_mem_prob[j][i] = m_params_prv[j].tau *
-				Gaussian((*iter)->centerf,
-					m_params_prv[j].mean,
-					m_params_prv[j].covar) * (*iter)->intensity / sum;
-			else
-				m_mem_prob[j][i] = 1.0;
+			//perturb
+			A00(s) = A00(s) < 0.5 ? 0.5 : A00(s);
+			A11(s) = A11(s) < 0.5 ? 0.5 : A11(s);
+			A22(s) = A22(s) < 0.5 ? 0.5 : A22(s);
+		}
+		c.mean[0] = A0(m_params_prv[j].mean);
+		c.mean[1] = A1(m_params_prv[j].mean);
+		c.mean[2] = A2(m_params_prv[j].mean);
+		c.log_tau = std::log(m_params_prv[j].tau);
+
+		//s = l * lt
+		double l00 = std::sqrt(A00(s));
+		double l10 = A10(s) / l00;
+		double l20 = A20(s) / l00;
+		double l11 = std::sqrt(A11(s) - l10 * l10);
+		double l21 = (A21(s) - l20 * l10) / l11;
+		double l22 = std::sqrt(A22(s) - l20 * l20 - l21 * l21);
+		if (l00 > 0.0 && l11 > 0.0 && l22 > 0.0 &&
+			std::isfinite(l00 * l11 * l22))
+		{
+			//m = inverse of l, prec = mt * m
+			double m00 = 1.0 / l00;
+			double m11 = 1.0 / l11;
+			double m22 = 1.0 / l22;
+			double m10 = -l10 * m00 * m11;
+			double m21 = -l21 * m11 * m22;
+			double m20 = (l10 * l21 - l11 * l20) * m00 * m11 * m22;
+			c.prec[0] = m00 * m00 + m10 * m10 + m20 * m20;
+			c.prec[1] = m11 * m11 + m21 * m21;
+			c.prec[2] = m22 * m22;
+			c.prec[3] = m10 * m11 + m20 * m21;
+			c.prec[4] = m20 * m22;
+			c.prec[5] = m21 * m22;
+			c.log_det = 2.0 * std::log(l00 * l11 * l22);
+		}
+		else
+		{
+			//not positive definite
+			EmMat inv = inverse(s);
+			c.prec[0] = A00(inv);
+			c.prec[1] = A11(inv);
+			c.prec[2] = A22(inv);
+			c.prec[3] = A01(inv);
+			c.prec[4] = A02(inv);
+			c.prec[5] = A12(inv);
+			c.log_det = std::log(determinant(s));
 		}
-		i++;
 	}
 }
 
-double ClusterExmax::Gaussian(EmVec &p, EmVec &m, EmMat &s)
+void ClusterExmax::Expectation()
 {
-	using namespace boost::qvm;
-	double pi2_3 = 248.050213442399; //(2pi)^3
-	double det = determinant(s);
-	if (det == 0.0)
+	//0.5 * log((2pi)^3)
+	const double c = 2.75681559961402;
+	size_t n = m_index.size();
+	size_t k = m_comps.size();
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	const float* w = m_index.Intensity().data();
+	size_t nb = BlockNum();
+	std::vector<double> part(nb, 0.0);
+
+	ParallelFor(nb, [&](size_t b0, size_t b1, unsigned int)
 	{
-		//perturb
-		A00(s) = A00(s) < 0.5 ? 0.5 : A00(s);
-		A11(s) = A11(s) < 0.5 ? 0.5 : A11(s);
-		A22(s) = A22(s) < 0.5 ? 0.5 : A22(s);
-		det = determinant(s);
-	}
-	EmVec d = p - m;
-	return exp(-0.5 * dot(d, inverse(s) * d)) / sqrt(pi2_3 * det);
+		std::vector<double> lmax(s_block);
+		std::vector<double> lsum(s_block);
+		for (size_t b = b0; b < b1; ++b)
+		{
+			size_t i0 = b * s_block;
+			size_t i1 = std::min(n, i0 + s_block);
+			size_t bn = i1 - i0;
+			std::fill(lmax.begin(), lmax.begin() + bn,
+				-std::numeric_limits<double>::infinity());
+			double like = 0;
+
+			//log of tau * gaussian, for each comp over the block
+			for (size_t j = 0; j < k; ++j)
+			{
+				const Comp& cp = m_comps[j];
+				const double* pr = cp.prec;
+				double lc = cp.log_tau - 0.5 * cp.log_det;
+				double* lp = &m_mem_prob[j * n + i0];
+				double ql = 0;
+				double wl = 0;
+				for (size_t i = 0; i < bn; ++i)
+				{
+					double dx = x[i0 + i] - cp.mean[0];
+					double dy = y[i0 + i] - cp.mean[1];
+					double dz = z[i0 + i] - cp.mean[2];
+					double q = pr[0] * dx * dx + pr[1] * dy * dy + pr[2] * dz * dz +
+						2.0 * (pr[3] * dx * dy + pr[4] * dx * dz + pr[5] * dy * dz);
+					lp[i] = lc - 0.5 * q;
+					ql += q * w[i0 + i];
+					wl += w[i0 + i];
+				}
+				like += (lc - c) * wl - 0.5 * ql;
+				for (size_t i = 0; i < bn; ++i)
+					lmax[i] = lp[i] > lmax[i] ? lp[i] : lmax[i];
+			}
+			part[b] = like;
+
+			//normalize in the log domain
+			std::fill(lsum.begin(), lsum.begin() + bn, 0.0);
+			for (size_t j = 0; j < k; ++j)
+			{
+				double* lp = &m_mem_prob[j * n + i0];
+				for (size_t i = 0; i < bn; ++i)
+				{
+					lp[i] = std::exp(lp[i] - lmax[i]);
+					lsum[i] += lp[i];
+				}
+			}
+			for (size_t i = 0; i < bn; ++i)
+			{
+				bool valid = w[i0 + i] > 0.0f &&
+					std::isfinite(lmax[i]) && lsum[i] > 0.0;
+				lsum[i] = valid ? 1.0 / lsum[i] : 0.0;
+				lmax[i] = valid ? 0.0 : 1.0;
+			}
+			for (size_t j = 0; j < k; ++j)
+			{
+				double* lp = &m_mem_prob[j * n + i0];
+				for (size_t i = 0; i < bn; ++i)
+					lp[i] = lsum[i] != 0.0 ? lp[i] * lsum[i] : lmax[i];
+			}
+		}
+	}, GetThreadNum(m_thread_num));
+
+	m_likelihood = 0;
+	for (auto v : part)
+		m_likelihood += v;
 }
 
 void ClusterExmax::Maximization()
 {
-	//update params
-	for (unsigned int j = 0; j < m_clnum; ++j)
+	size_t n = m_index.size();
+	size_t k = m_params.size();
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	const float* w = m_index.Intensity().data();
+	size_t nb = BlockNum();
+	unsigned int tn = GetThreadNum(m_thread_num);
+
+	//weights and weighted positions
+	std::vector<double> part(nb * k * 4, 0.0);
+	ParallelFor(nb, [&](size_t b0, size_t b1, unsigned int)
 	{
-		double sum_t = 0;
-		unsigned int i = 0;
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
+		for (size_t b = b0; b < b1; ++b)
 		{
-			sum_t += m_mem_prob[j][i] * (*iter)->intensity;
-			i++;
+			size_t i0 = b * s_block;
+			size_t i1 = std::min(n, i0 + s_block);
+			for (size_t j = 0; j < k; ++j)
+			{
+				const double* r = &m_mem_prob[j * n];
+				double st = 0, sx = 0, sy = 0, sz = 0;
+				for (size_t i = i0; i < i1; ++i)
+				{
+					double rw = r[i] * w[i];
+					st += rw;
+					sx += x[i] * rw;
+					sy += y[i] * rw;
+					sz += z[i] * rw;
+				}
+				double* s = &part[(b * k + j) * 4];
+				s[0] = st; s[1] = sx; s[2] = sy; s[3] = sz;
+			}
 		}
-
+	}, tn);
+	std::vector<double> sum_t(k, 0.0);
+	std::vector<double> mean(k * 3, 0.0);
+	for (size_t b = 0; b < nb; ++b)
+	for (size_t j = 0; j < k; ++j)
+	{
+		const double* s = &part[(b * k + j) * 4];
+		sum_t[j] += s[0];
+		mean[j * 3] += s[1];
+		mean[j * 3 + 1] += s[2];
+		mean[j * 3 + 2] += s[3];
+	}
+	for (size_t j = 0; j < k; ++j)
+	{
 		//tau
-		m_params[j].tau = sum_t / m_data.size();
-
+		m_params[j].tau = sum_t[j] / n;
 		//mean
-		i = 0;
-		EmVec sum_p = { 0, 0, 0 };
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
+		for (int c = 0; c < 3; ++c)
+			mean[j * 3 + c] /= sum_t[j];
+		m_params[j].mean = EmVec{ mean[j * 3], mean[j * 3 + 1], mean[j * 3 + 2] };
+	}
+
+	//covar/sigma
+	part.assign(nb * k * 6, 0.0);
+	ParallelFor(nb, [&](size_t b0, size_t b1, unsigned int)
+	{
+		for (size_t b = b0; b < b1; ++b)
 		{
-			sum_p += (*iter)->centerf * (*iter)->intensity * m_mem_prob[j][i];
-			i++;
+			size_t i0 = b * s_block;
+			size_t i1 = std::min(n, i0 + s_block);
+			for (size_t j = 0; j < k; ++j)
+			{
+				const double* r = &m_mem_prob[j * n];
+				const double* m = &mean[j * 3];
+				double s00 = 0, s11 = 0, s22 = 0, s01 = 0, s02 = 0, s12 = 0;
+				for (size_t i = i0; i < i1; ++i)
+				{
+					double rw = r[i] * w[i];
+					double dx = x[i] - m[0];
+					double dy = y[i] - m[1];
+					double dz = z[i] - m[2];
+					s00 += dx * dx * rw;
+					s11 += dy * dy * rw;
+					s22 += dz * dz * rw;
+					s01 += dx * dy * rw;
+					s02 += dx * dz * rw;
+					s12 += dy * dz * rw;
+				}
+				double* s = &part[(b * k + j) * 6];
+				s[0] = s00; s[1] = s11; s[2] = s22;
+				s[3] = s01; s[4] = s02; s[5] = s12;
+			}
 		}
-		m_params[j].mean = sum_p / sum_t;
-
-		//covar/sigma
-		i = 0;
-		EmMat sum_s = boost::qvm::zero_mat<double, 3, 3>();
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
+	}, tn);
+	for (size_t j = 0; j < k; ++j)
+	{
+		double s[6] = { 0, 0, 0, 0, 0, 0 };
+		for (size_t b = 0; b < nb; ++b)
 		{
-			EmVec d = (*iter)->centerf - m_params[j].mean;
-			EmMat form;
-			using namespace boost::qvm;
-			A00(form) = A0(d) * A0(d);
-			A01(form) = A0(d) * A1(d);
-			A02(form) = A0(d) * A2(d);
-			A10(form) = A1(d) * A0(d);
-			A11(form) = A1(d) * A1(d);
-			A12(form) = A1(d) * A2(d);
-			A20(form) = A2(d) * A0(d);
-			A21(form) = A2(d) * A1(d);
-			A22(form) = A2(d) * A2(d);
-			sum_s += form * m_mem_prob[j][i] * (*iter)->intensity;
-			i++;
+			const double* p = &part[(b * k + j) * 6];
+			for (int c = 0; c < 6; ++c)
+				s[c] += p[c];
 		}
-		m_params[j].covar = sum_s / sum_t;
+		using namespace boost::qvm;
+		EmMat& covar = m_params[j].covar;
+		A00(covar) = s[0] / sum_t[j];
+		A11(covar) = s[1] / sum_t[j];
+		A22(covar) = s[2] / sum_t[j];
+		A01(covar) = A10(covar) = s[3] / sum_t[j];
+		A02(covar) = A20(covar) = s[4] / sum_t[j];
+		A12(covar) = A21(covar) = s[5] / sum_t[j];
 	}
 }
 
 bool ClusterExmax::Converge()
 {
-	//compute likelihood
-	double c = 2.75681559961402;
-	m_likelihood = 0;
-	double l;
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
-	{
-		for (unsigned int j = 0; j < m_clnum; ++j)
-		{
-			l = log(m_params_prv[j].tau);
-			l -= 0.5 * log(boost::qvm::determinant(m_params_prv[j].covar));
-			EmVec d = (*iter)->centerf - m_params_prv[j].mean;
-			l -= 0.5 * boost::qvm::dot(d, boost::qvm::inverse(m_params_prv[j].covar) * d);
-			l -= c;
-			m_likelihood += l * (*iter)->intensity;
-		}
-	}
-
+	//likelihood of the previous params is summed up in the e-step
 	if (fabs((m_likelihood - m_likelihood_prv)/ m_likelihood) > m_eps)
 		return false;
 	else
@@ -398,34 +540,22 @@ void ClusterExmax::GenResult()
 {
 	m_result.clear();
 	m_result.resize(m_clnum);
-	size_t i = 0;
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	size_t k = m_params.size();
+	if (!k)
+		return;
+	for (size_t i = 0; i < m_index.size(); ++i)
 	{
 		size_t index = 0;
-		bool changed = false;
-		double max_mem_prob;
-		for (size_t j = 0; j < m_clnum; ++j)
+		double max_mem_prob = Prob(0, i);
+		for (size_t j = 1; j < k; ++j)
 		{
-			if (j == 0)
+			if (Prob(j, i) > max_mem_prob)
 			{
 				index = j;
-				max_mem_prob = m_mem_prob[j][i];
-				changed = true;
-			}
-			else
-			{
-				if (m_mem_prob[j][i] > max_mem_prob)
-				{
-					index = j;
-					max_mem_prob = m_mem_prob[j][i];
-					changed = true;
-				}
+				max_mem_prob = Prob(j, i);
 			}
 		}
-		if (changed)
-			m_result[index].push_back(*iter);
-		i++;
+		m_result[index].push_back(m_index.point(i));
 	}
 }
 
@@ -435,6 +565,7 @@ void ClusterExmax::GenHistogram(size_t bins)
 		return;
 
 	m_bins = bins;
+	size_t k = m_params.size();
 	//allocate histogram space
 	m_histogram.clear();
 	double value = 1.0 / m_clnum;
@@ -448,19 +579,16 @@ void ClusterExmax::GenHistogram(size_t bins)
 		m_histogram.push_back(bin);
 	}
 	//fill in histogram
-	size_t i = 0;
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	for (size_t i = 0; i < m_index.size(); ++i)
 	{
 		double max_mem_prob = 0;
-		for (size_t j = 0; j < m_clnum; ++j)
+		for (size_t j = 0; j < k; ++j)
 		{
 			if (j == 0)
-				max_mem_prob = m_mem_prob[j][i];
-			else if (m_mem_prob[j][i] > max_mem_prob)
-				max_mem_prob = m_mem_prob[j][i];
+				max_mem_prob = Prob(j, i);
+			else if (Prob(j, i) > max_mem_prob)
+				max_mem_prob = Prob(j, i);
 		}
-		i++;
 		//
 		size_t index = size_t((max_mem_prob - 
 			1.0 / m_clnum) / inc);
@@ -490,24 +618,23 @@ void ClusterExmax::GenUncertainty(double delta, bool output)
 	}
 
 	//compute count
-	for (size_t i = 0; i < m_mem_prob[0].size(); ++i)
+	size_t n = m_index.size();
+	size_t k = m_params.size();
+	ParallelFor(n, [&](size_t i0, size_t i1, unsigned int)
 	{
-		double var = 0;
-		for (size_t j = 0; j < m_mem_prob.size(); ++j)
-			var += fabs(m_mem_prob[j][i] -
-				m_mem_prob_prv[j][i]);
-		//size_t count = size_t(var / delta);
-		//m_count[i] += count;
-		m_count[i] += var;
-	}
+		for (size_t j = 0; j < k; ++j)
+		{
+			const double* p = &m_mem_prob[j * n];
+			const double* q = &m_mem_prob_prv[j * n];
+			for (size_t i = i0; i < i1; ++i)
+				m_count[i] += fabs(p[i] - q[i]);
+		}
+	}, GetThreadNum(m_thread_num));
 	//allocate histogram space
 	m_histogram.clear();
 	//fill in histogram
 	for (size_t i = 0; i < m_count.size(); ++i)
 	{
-		//if (m_histogram.size() <= m_count[i])
-		//	m_histogram.resize(m_count[i] + 1);
-		//m_histogram[m_count[i]].count++;
 		size_t index = static_cast<size_t>(m_count[i] / delta);
 		if (m_histogram.size() <= index)
 		{
@@ -583,20 +710,20 @@ void ClusterExmax::GenerateNewColors2(void* label,
 		bool changed = false;
 		double max_mem_prob;
 		id = 0;
-		for (size_t j = 0; j < m_clnum; ++j)
+		for (size_t j = 0; j < m_params.size(); ++j)
 		{
 			if (j == 0)
 			{
 				index = j;
-				max_mem_prob = m_mem_prob[j][ii];
+				max_mem_prob = Prob(j, ii);
 				changed = true;
 			}
 			else
 			{
-				if (m_mem_prob[j][ii] > max_mem_prob)
+				if (Prob(j, ii) > max_mem_prob)
 				{
 					index = j;
-					max_mem_prob = m_mem_prob[j][ii];
+					max_mem_prob = Prob(j, ii);
 					changed = true;
 				}
 			}
@@ -29,6 +29,7 @@ DEALINGS IN THE SOFTWARE.
 #define FL_Exmax_h
 
 #include <ClusterMethod.h>
+#include <ClusterIndex.h>
 
 namespace flrd
 {
@@ -51,6 +52,9 @@ namespace flrd
 				m_tol = 0.7f;
 		}
 
+		void SetThreadNum(unsigned int val)
+		{ m_thread_num = val; }
+
 		bool Execute();
 		float GetProb();
 
@@ -71,6 +75,7 @@ namespace flrd
 		size_t m_max_iter;
 		//prob tolerance
 		float m_tol;
+		unsigned int m_thread_num;
 
 		//parameters to estimate
 		struct Params
@@ -82,12 +87,23 @@ namespace flrd
 		//all paramters to estimate
 		std::vector<Params> m_params;
 		std::vector<Params> m_params_prv;
+		//gaussian terms from the cholesky factor of each covariance
+		struct Comp
+		{
+			double mean[3];
+			double prec[6];//inverse covariance: 00, 11, 22, 01, 02, 12
+			double log_tau;
+			double log_det;
+		};
+		std::vector<Comp> m_comps;
 		//likelihood
 		double m_likelihood;
 		double m_likelihood_prv;
-		//membership probabilities
-		std::vector<std::vector<double>> m_mem_prob;//0-idx: comps; 1-idx: points
-		std::vector<std::vector<double>> m_mem_prob_prv;//for comparison
+		//point coordinates and intensities
+		ClusterIndex m_index;
+		//membership probabilities, one row of points per comp
+		std::vector<double> m_mem_prob;
+		std::vector<double> m_mem_prob_prv;//for comparison
 		std::vector<double> m_count;//count for changes
 
 		//histogram
@@ -103,13 +119,21 @@ namespace flrd
 		void Initialize();
 		void Init1();
 		void Init2();
+		void Prepare();
 		void Expectation();
-		double Gaussian(EmVec &p, EmVec &m, EmMat &s);
 		void Maximization();
 		bool Converge();
 		void GenResult();
 		void GenHistogram(size_t bins);
 		void GenUncertainty(double delta, bool output = false);
+
+		double& Prob(size_t j, size_t i)
+		{ return m_mem_prob[j * m_index.size() + i]; }
+		//sums are taken over fixed blocks of points and added in
+		//block order, so results do not depend on the thread number
+		size_t BlockNum()
+		{ return (m_index.size() + s_block - 1) / s_block; }
+		static const size_t s_block = 512;
 	};
 
 }
@@ -27,14 +27,29 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <kmeans.h>
 #include <Cell.h>
+#include <Parallel.h>
+#include <boost/qvm/vec_access.hpp>
 #include <algorithm>
+#include <chrono>
 
 using namespace flrd;
 
+//points per thread below which starting threads costs more than the work
+static const size_t s_min_points = 1 << 14;
+
 ClusterKmeans::ClusterKmeans() :
 	m_clnum(2),
 	m_eps(1e-3f),
-	m_max_iter(100)
+	m_max_iter(100),
+	m_plus_plus(false),
+	m_batch(0),
+	m_seed(0),
+	m_thread_num(0),
+	m_iter(0),
+	m_converged(false),
+	m_shift(0),
+	m_inertia(0),
+	m_time(0)
 {
 
 }
@@ -46,22 +61,56 @@ ClusterKmeans::~ClusterKmeans()
 
 bool ClusterKmeans::Execute()
 {
+	m_iter = 0;
+	m_converged = false;
+	m_shift = 0;
+	m_shift_hist.clear();
+	m_inertia = 0;
+	m_time = 0;
 	if (m_data.empty())
 		return false;
 
-	Initialize();
+	auto t0 = std::chrono::steady_clock::now();
+	m_index.SetThreadNum(m_thread_num);
+	m_index.Build(m_data);
+	m_assign.assign(m_index.size(), -1);
+
+	if (m_plus_plus)
+		InitializePlusPlus();
+	else
+		Initialize();
 
+	bool batch = m_batch && m_batch < m_index.size() && !m_means.empty();
+	std::mt19937 rng(m_seed);
+	std::vector<double> counts(m_means.size(), 0.0);
 	size_t counter = 0;
+	bool converged;
 	do {
 		m_means_prv = m_means;
-		Assign();
-		Update();
+		if (batch)
+			UpdateMiniBatch(rng, counts);
+		else
+		{
+			Assign();
+			Update();
+		}
 		counter++;
 		SetProgress(static_cast<int>(100 * counter / (m_max_iter ? m_max_iter : 1)),
 			"Computing K-Means.");
-	} while (!Converge() &&
+		converged = Converge();
+	} while (!converged &&
 		counter < m_max_iter);
 
+	//final assignment to the last means
+	if (batch)
+		Assign();
+	BuildResult();
+
+	m_iter = counter;
+	m_converged = converged;
+	m_time = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - t0).count();
+
 	if (counter == m_max_iter)
 		return false;
 	else
@@ -76,112 +125,272 @@ float ClusterKmeans::GetProb()
 void ClusterKmeans::Initialize()
 {
 	m_means.clear();
+	size_t n = m_index.size();
+	if (!m_clnum || !n)
+		return;
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
 	//search for maximum
-	pClusterPoint p = nullptr;
-	Cluster cluster;
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	size_t p = 0;
+	for (size_t i = 1; i < n; ++i)
+		if (m_index.intensity(i) > m_index.intensity(p))
+			p = i;
+	std::vector<char> chosen(n, 0);
+	m_means.push_back(EmVec{ x[p], y[p], z[p] });
+	chosen[p] = 1;
+	//search for the rest, each farthest from the last mean
+	for (size_t i = 1; i < m_clnum && i < n; ++i)
 	{
-		if (iter == m_data.begin())
-			p = *iter;
-		else
+		double mx = boost::qvm::A0(m_means[i - 1]);
+		double my = boost::qvm::A1(m_means[i - 1]);
+		double mz = boost::qvm::A2(m_means[i - 1]);
+		size_t q = n;
+		double qd = 0;
+		for (size_t j = 0; j < n; ++j)
 		{
-			if ((*iter)->intensity > p->intensity)
-				p = *iter;
+			if (chosen[j])
+				continue;
+			double dx = x[j] - mx;
+			double dy = y[j] - my;
+			double dz = z[j] - mz;
+			double d = dx * dx + dy * dy + dz * dz;
+			if (q == n || d > qd)
+			{
+				q = j;
+				qd = d;
+			}
 		}
+		if (q == n)
+			break;
+		m_means.push_back(EmVec{ x[q], y[q], z[q] });
+		chosen[q] = 1;
 	}
-	if (p != nullptr)
-	{
-		m_means.push_back(p->centerf);
-		cluster.push_back(p);
-	}
-	//search for the rest
-	for (size_t i = 1; i < m_clnum; ++i)
+}
+
+void ClusterKmeans::InitializePlusPlus()
+{
+	m_means.clear();
+	size_t n = m_index.size();
+	if (!m_clnum || !n)
+		return;
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	//start from the brightest point
+	size_t p = 0;
+	for (size_t i = 1; i < n; ++i)
+		if (m_index.intensity(i) > m_index.intensity(p))
+			p = i;
+	m_means.push_back(EmVec{ x[p], y[p], z[p] });
+
+	//squared distance to the nearest chosen mean
+	std::vector<double> dist(n, 0.0);
+	std::mt19937 rng(m_seed);
+	std::uniform_real_distribution<double> uni(0.0, 1.0);
+	unsigned int tn = ThreadNum(n);
+	std::vector<double> part(tn, 0.0);
+	for (size_t c = 1; c < m_clnum; ++c)
 	{
-		p = nullptr;
-		for (ClusterIter iter = m_data.begin();
-			iter != m_data.end(); ++iter)
+		double mx = boost::qvm::A0(m_means[c - 1]);
+		double my = boost::qvm::A1(m_means[c - 1]);
+		double mz = boost::qvm::A2(m_means[c - 1]);
+		bool first = c == 1;
+		std::fill(part.begin(), part.end(), 0.0);
+		ParallelFor(n, [&](size_t i0, size_t i1, unsigned int t)
 		{
-			if (cluster.find(*iter))
-				continue;
-			if (p == nullptr)
-				p = *iter;
-			else
+			double sum = 0;
+			for (size_t i = i0; i < i1; ++i)
 			{
-				double d1 = boost::qvm::mag(p->centerf - m_means[i - 1]);
-				double d2 = boost::qvm::mag((*iter)->centerf - m_means[i - 1]);
-				if (d2 > d1)
-					p = *iter;
+				double dx = x[i] - mx;
+				double dy = y[i] - my;
+				double dz = z[i] - mz;
+				double d = dx * dx + dy * dy + dz * dz;
+				dist[i] = first ? d : std::min(dist[i], d);
+				sum += dist[i] * m_index.intensity(i);
 			}
-		}
-		if (p != nullptr)
+			part[t] = sum;
+		}, tn);
+		double total = 0;
+		for (auto v : part)
+			total += v;
+		if (total <= 0.0)
+			break;
+
+		//pick a point with probability of its weighted distance
+		double r = uni(rng) * total;
+		double acc = 0;
+		size_t q = n;
+		for (size_t i = 0; i < n; ++i)
 		{
-			m_means.push_back(p->centerf);
-			cluster.push_back(p);
+			double w = dist[i] * m_index.intensity(i);
+			if (w <= 0.0)
+				continue;
+			acc += w;
+			q = i;
+			if (acc >= r)
+				break;
 		}
+		if (q == n)
+			break;
+		m_means.push_back(EmVec{ x[q], y[q], z[q] });
 	}
 }
 
-void ClusterKmeans::Assign()
+void ClusterKmeans::Nearest(size_t i0, size_t i1, int* index, double* dist)
 {
-	m_result.clear();
-	m_result.resize(m_clnum);
-	for (ClusterIter iter = m_data.begin();
-		iter != m_data.end(); ++iter)
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	size_t k = m_means.size();
+	//blocks stay in cache while all means are tested,
+	//the inner loops have no branches and vectorize
+	const size_t block = 1024;
+	for (size_t b = i0; b < i1; b += block)
 	{
-		size_t index = 0;
-		bool changed = false;
-		double mind;
-		for (size_t i = 0; i < m_clnum; ++i)
+		size_t e = std::min(b + block, i1);
+		int* bi = index + (b - i0);
+		double* bd = dist + (b - i0);
+		for (size_t c = 0; c < k; ++c)
 		{
-			double d = boost::qvm::mag((*iter)->centerf - m_means[i]);
-			if (i == 0)
+			double mx = boost::qvm::A0(m_means[c]);
+			double my = boost::qvm::A1(m_means[c]);
+			double mz = boost::qvm::A2(m_means[c]);
+			int ci = static_cast<int>(c);
+			for (size_t i = b; i < e; ++i)
 			{
-				index = i;
-				mind = d;
-				changed = true;
-			}
-			else
-			{
-				if (d < mind)
-				{
-					index = i;
-					mind = d;
-					changed = true;
-				}
+				double dx = x[i] - mx;
+				double dy = y[i] - my;
+				double dz = z[i] - mz;
+				double d = dx * dx + dy * dy + dz * dz;
+				bool closer = c == 0 || d < bd[i - b];
+				bd[i - b] = closer ? d : bd[i - b];
+				bi[i - b] = closer ? ci : bi[i - b];
 			}
 		}
-
-		if (changed)
-			m_result[index].push_back(*iter);
 	}
 }
 
+void ClusterKmeans::Assign()
+{
+	size_t n = m_index.size();
+	if (m_means.empty())
+		return;
+	std::vector<double> dist(n);
+	unsigned int tn = ThreadNum(n);
+	std::vector<double> part(tn, 0.0);
+	ParallelFor(n, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		Nearest(i0, i1, &m_assign[i0], &dist[i0]);
+		double sum = 0;
+		for (size_t i = i0; i < i1; ++i)
+			sum += dist[i] * m_index.intensity(i);
+		part[t] = sum;
+	}, tn);
+	m_inertia = 0;
+	for (auto v : part)
+		m_inertia += v;
+}
+
 void ClusterKmeans::Update()
 {
-	for (size_t i = 0; i < m_clnum; ++i)
+	size_t n = m_index.size();
+	size_t k = m_means.size();
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	//weighted sums per thread, added in thread order
+	unsigned int tn = ThreadNum(n);
+	std::vector<std::vector<double>> part(tn);
+	ParallelFor(n, [&](size_t i0, size_t i1, unsigned int t)
 	{
-		if (m_result[i].size() == 0)
-			continue;
-		EmVec sum = { 0, 0, 0 };
-		double count = 0;
-		for (ClusterIter iter = m_result[i].begin();
-			iter != m_result[i].end(); ++iter)
+		std::vector<double>& s = part[t];
+		s.assign(k * 4, 0.0);
+		for (size_t i = i0; i < i1; ++i)
 		{
-			sum += (*iter)->centerf * (*iter)->intensity;
-			count += (*iter)->intensity;
+			double* si = &s[size_t(m_assign[i]) * 4];
+			double w = m_index.intensity(i);
+			si[0] += x[i] * w;
+			si[1] += y[i] * w;
+			si[2] += z[i] * w;
+			si[3] += w;
 		}
-		m_means[i] = sum / count;
+	}, tn);
+	std::vector<double> sum(k * 4, 0.0);
+	for (auto& s : part)
+		for (size_t i = 0; i < s.size(); ++i)
+			sum[i] += s[i];
+	for (size_t i = 0; i < k; ++i)
+	{
+		double count = sum[i * 4 + 3];
+		if (count <= 0.0)
+			continue;
+		m_means[i] = EmVec{ sum[i * 4] / count,
+			sum[i * 4 + 1] / count, sum[i * 4 + 2] / count };
 	}
 }
 
+void ClusterKmeans::UpdateMiniBatch(std::mt19937& rng, std::vector<double>& counts)
+{
+	size_t n = m_index.size();
+	const double* x = m_index.X().data();
+	const double* y = m_index.Y().data();
+	const double* z = m_index.Z().data();
+	//sample a batch and find its nearest means in parallel
+	std::uniform_int_distribution<size_t> uni(0, n - 1);
+	std::vector<size_t> batch(m_batch);
+	for (auto& i : batch)
+		i = uni(rng);
+	std::sort(batch.begin(), batch.end());
+	std::vector<int> index(m_batch);
+	ParallelFor(m_batch, [&](size_t i0, size_t i1, unsigned int)
+	{
+		double dist;
+		for (size_t i = i0; i < i1; ++i)
+			Nearest(batch[i], batch[i] + 1, &index[i], &dist);
+	}, ThreadNum(m_batch));
+	//move each mean toward its points with a decreasing rate
+	for (size_t i = 0; i < m_batch; ++i)
+	{
+		size_t p = batch[i];
+		double w = m_index.intensity(p);
+		if (w <= 0.0)
+			continue;
+		int c = index[i];
+		counts[c] += w;
+		double eta = w / counts[c];
+		EmVec& m = m_means[c];
+		boost::qvm::A0(m) += eta * (x[p] - boost::qvm::A0(m));
+		boost::qvm::A1(m) += eta * (y[p] - boost::qvm::A1(m));
+		boost::qvm::A2(m) += eta * (z[p] - boost::qvm::A2(m));
+	}
+}
+
+unsigned int ClusterKmeans::ThreadNum(size_t n)
+{
+	size_t tn = n / s_min_points + 1;
+	return static_cast<unsigned int>(std::min(
+		size_t(GetThreadNum(m_thread_num)), tn));
+}
+
 bool ClusterKmeans::Converge()
 {
-	for (size_t i = 0; i < m_clnum; ++i)
+	m_shift = 0;
+	for (size_t i = 0; i < m_means.size(); ++i)
 	{
 		double d = boost::qvm::mag(m_means[i] - m_means_prv[i]);
-		if (d > m_eps)
-			return false;
+		m_shift = std::max(m_shift, d);
 	}
-	return true;
-}
\ No newline at end of file
+	m_shift_hist.push_back(m_shift);
+	return m_shift <= m_eps;
+}
+
+void ClusterKmeans::BuildResult()
+{
+	m_result.clear();
+	m_result.resize(m_clnum);
+	if (m_means.empty())
+		return;
+	for (size_t i = 0; i < m_index.size(); ++i)
+		m_result[m_assign[i]].push_back(m_index.point(i));
+}
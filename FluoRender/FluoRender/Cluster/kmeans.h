@@ -29,6 +29,9 @@ DEALINGS IN THE SOFTWARE.
 #define FL_Kmeans_h
 
 #include <ClusterMethod.h>
+#include <ClusterIndex.h>
+#include <vector>
+#include <random>
 
 namespace flrd
 {
@@ -42,9 +45,39 @@ namespace flrd
 		{ m_clnum = num; }
 		void SetMaxiter(size_t num)
 		{ m_max_iter = num; }
+		//k-means++ seeding instead of the brightest point
+		//followed by the farthest points
+		void SetPlusPlus(bool val)
+		{ m_plus_plus = val; }
+		//update from random subsets of this size, 0 for full passes
+		void SetMiniBatch(size_t num)
+		{ m_batch = num; }
+		//seed of the random choices
+		void SetSeed(unsigned int val)
+		{ m_seed = val; }
+		void SetThreadNum(unsigned int val)
+		{ m_thread_num = val; }
 		bool Execute();
 		float GetProb();
 
+		//statistics of the last run
+		size_t GetIterNum()
+		{ return m_iter; }
+		bool GetConverged()
+		{ return m_converged; }
+		//largest movement of a mean in the last iteration
+		double GetShift()
+		{ return m_shift; }
+		//largest movement of a mean in each iteration
+		std::vector<double>& GetShiftHistory()
+		{ return m_shift_hist; }
+		//intensity weighted sum of squared distances to the means
+		double GetInertia()
+		{ return m_inertia; }
+		//run time in seconds
+		double GetTime()
+		{ return m_time; }
+
 	private:
 		//cluster number
 		unsigned int m_clnum;
@@ -52,14 +85,38 @@ namespace flrd
 		float m_eps;
 		//maximum iteration number
 		size_t m_max_iter;
+		bool m_plus_plus;
+		size_t m_batch;
+		unsigned int m_seed;
+		unsigned int m_thread_num;
 		std::vector<EmVec> m_means;
 		std::vector<EmVec> m_means_prv;
 
+		//flat points
+		ClusterIndex m_index;
+		//mean of each point
+		std::vector<int> m_assign;
+
+		//statistics
+		size_t m_iter;
+		bool m_converged;
+		double m_shift;
+		std::vector<double> m_shift_hist;
+		double m_inertia;
+		double m_time;
+
 	private:
 		void Initialize();
+		void InitializePlusPlus();
 		void Assign();
 		void Update();
+		void UpdateMiniBatch(std::mt19937& rng, std::vector<double>& counts);
 		bool Converge();
+		void BuildResult();
+		//nearest means of points [i0, i1)
+		void Nearest(size_t i0, size_t i1, int* index, double* dist);
+		//threads for n points, small inputs run serially
+		unsigned int ThreadNum(size_t n);
 	};
 
 }
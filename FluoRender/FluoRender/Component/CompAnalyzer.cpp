@@ -38,6 +38,8 @@ DEALINGS IN THE SOFTWARE.
 #include <TextureBrick.h>
 #include <VolumeRenderer.h>
 #include <Ruler.h>
+#include <CompStats.h>
+#include <KdTree.h>
 #include <sstream>
 #include <iostream>
 #include <fstream>
@@ -47,6 +49,9 @@ DEALINGS IN THE SOFTWARE.
 
 using namespace flrd;
 
+//larger counts export nearest neighbor lists instead of the full matrix
+static const int s_dist_dense_max = 4096;
+
 ComponentAnalyzer::ComponentAnalyzer()
 	: Progress(),
 	m_use_sel(false),
@@ -127,47 +132,6 @@ int ComponentAnalyzer::GetBrickNum()
 	return m_bn;
 }
 
-int ComponentAnalyzer::GetColocalization(
-	size_t bid,
-	const fluo::Point& p,
-	std::vector<unsigned int> &sumi,
-	std::vector<double> &sumd)
-{
-	int num = 0;
-
-	for (auto it = m_vd_list.begin(); it != m_vd_list.end(); ++it)
-	{
-		auto vd = it->lock();
-
-		if (!vd)
-		{
-			sumi.push_back(0);
-			sumd.push_back(0.0);
-			continue;
-		}
-		flvr::Texture* tex = vd->GetTexture();
-		if (!tex)
-		{
-			sumi.push_back(0);
-			sumd.push_back(0.0);
-			continue;
-		}
-		flvr::TextureBrick* b = tex->get_brick(static_cast<unsigned int>(bid));
-		if (!b)
-		{
-			sumi.push_back(0);
-			sumd.push_back(0.0);
-			continue;
-		}
-		double value = b->get_data(p);
-		sumi.push_back(value > 0.0 ? 1 : 0);
-		sumd.push_back(value);
-		num++;
-	}
-
-	return num;
-}
-
 void ComponentAnalyzer::Analyze()
 {
 	auto vd = glbin_current.vol_data.lock();
@@ -343,106 +307,45 @@ void ComponentAnalyzer::Analyze()
 		prog += 80 * (0.2 + double(bi) / bn);
 		SetProgress(static_cast<int>(prog), "Analyzing components.");
 
-		unsigned int id = 0;
 		unsigned int brick_id = b->get_id();
-		double value;
-		double scale;
-		double ext;
-		int i, j, k;
-		//m_vd->GetResolution(nx, ny, nz);
-		unsigned long long for_size = res.intz() ?
-			((unsigned long long)res.get_size_xyz()) :
-			((unsigned long long)res.get_size_xy());
-		unsigned long long index;
 		CelpList comp_list_brick;
 		CelpListIter iter;
-		for (index = 0; index < for_size; ++index)
-		{
-			if (index % 10000 == 0)
-			{
-				prog += 320000.0 * (bi + 1) / for_size / bn;
-				SetProgress(static_cast<int>(prog),
-					"Analyzing components.");
-			}
-
-			value = 0.0;
-			if (use_sel)
-			{
-				if (data_mask && !data_mask[index])
-					continue;
-			}
-			if (data_label && !data_label[index])
-				continue;
 
-			if (data_label)
-				id = data_label[index];
-
-			if (bits == nrrdTypeUChar)
-			{
-				value = ((unsigned char*)data_data)[index] / 255.0;
-				scale = 255.0;
-			}
-			else if (bits == nrrdTypeUShort)
-			{
-				value = ((unsigned short*)data_data)[index] / 65535.0;
-				scale = 65535.0;
-			}
-
-			if (value <= 0.0)
-				continue;
-
-			k = static_cast<int>(index / (res.get_size_xy()));
-			j = static_cast<int>(index % (res.get_size_xy()));
-			i = j % res.intx();
-			j = j / res.intx();
-			auto p = fluo::Point(i, j, k);
-			auto res2 = fluo::Vector(
-				res.intx() ? res.intx() : 1,
-				res.inty() ? res.inty() : 1,
-				res.intz() ? res.intz() : 1);
-			ext = GetExt(data_label, index, id, res2, p);
-			//ext = 0.0;
-
-			//colocalization
-			std::vector<unsigned int> sumi;
-			std::vector<double> sumd;
-			if (m_colocal) GetColocalization(brick_id, p, sumi, sumd);
-
-			//find in list
-			iter = comp_list_brick.find(id);
-			if (iter == comp_list_brick.end())
+		//gather per-label statistics in parallel slabs
+		CompStatEngine stat;
+		stat.SetSize(res.intx() ? res.intx() : 1,
+			res.inty() ? res.inty() : 1,
+			res.intz() ? res.intz() : 1);
+		stat.SetOffset(b->get_off_size());
+		stat.SetBrickId(brick_id);
+		stat.SetSpacing(spc);
+		stat.SetData(data_data, bits == nrrdTypeUShort ? 2 : 1);
+		stat.SetMask(use_sel ? data_mask : 0);
+		stat.SetLabel(data_label);
+		if (m_colocal)
+		{
+			for (auto it = m_vd_list.begin(); it != m_vd_list.end(); ++it)
 			{
-				//not found
-				Cell* info = 0;
-				if (m_colocal)
+				auto vdi = it->lock();
+				flvr::Texture* tex = vdi ? vdi->GetTexture() : 0;
+				flvr::TextureBrick* cb = tex ?
+					tex->get_brick(static_cast<unsigned int>(brick_id)) : 0;
+				Nrrd* cn = cb ? cb->get_nrrd(flvr::CompType::Data).data : 0;
+				if (!cn)
 				{
-					info = new Cell(id, brick_id,
-						1, value, static_cast<unsigned int>(std::round(ext)),
-						p + b->get_off_size(),
-						spc,
-						sumi, sumd);
+					stat.AddCoVolume(0, 0, fluo::Vector(), fluo::Vector());
+					continue;
 				}
-				else
-					info = new Cell(id, brick_id,
-						1, value, static_cast<unsigned int>(std::round(ext)),
-						p + b->get_off_size(),
-						spc);
-					comp_list_brick.insert(std::pair<unsigned int, Celp>
-						(id, Celp(info)));
-			}
-			else
-			{
-				if (m_colocal)
-					iter->second->Inc(1, value, static_cast<unsigned int>(std::round(ext)),
-						p + b->get_off_size(),
-						spc,
-						sumi, sumd);
-				else
-					iter->second->Inc(1, value, static_cast<unsigned int>(std::round(ext)),
-						p + b->get_off_size(),
-						spc);
+				stat.AddCoVolume(cn->data, cb->nb(flvr::CompType::Data),
+					cb->get_stride(), cb->get_off_size());
 			}
 		}
+		stat.Compute();
+
+		prog += 80 * (0.4 / bn);
+		SetProgress(static_cast<int>(prog), "Analyzing components.");
+
+		stat.GetCelpList(comp_list_brick);
 
 		size_t count = 0;
 		size_t ticks = comp_list_brick.size();
@@ -1020,137 +923,6 @@ void ComponentAnalyzer::OutputCompListFile(const std::wstring &filename, int ver
 	ofs.close();
 }
 
-unsigned int ComponentAnalyzer::GetExt(unsigned int* data_label,
-	unsigned long long index,
-	unsigned int id,
-	const fluo::Vector& size,
-	const fluo::Point& p)
-{
-	if (!data_label)
-		return 0;
-	bool surface_vox, contact_vox;
-	unsigned long long indexn;
-	//determine the numbers
-	size_t i = p.intx();
-	size_t j = p.inty();
-	size_t k = p.intz();
-	if (i == 0 || i == size.intx() - 1 ||
-		j == 0 || j == size.inty() - 1 ||
-		k == 0 || k == size.intz() - 1)
-	{
-		//border voxel
-		surface_vox = true;
-		//determine contact
-		contact_vox = false;
-		if (i > 0)
-		{
-			indexn = index - 1;
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				contact_vox = true;
-		}
-		if (!contact_vox && i < size.intx() - 1)
-		{
-			indexn = index + 1;
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				contact_vox = true;
-		}
-		if (!contact_vox && j > 0)
-		{
-			indexn = index - size.intx();
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				contact_vox = true;
-		}
-		if (!contact_vox && j < size.inty() - 1)
-		{
-			indexn = index + size.intx();
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				contact_vox = true;
-		}
-		if (!contact_vox && k > 0)
-		{
-			indexn = index - size.get_size_xy();
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				contact_vox = true;
-		}
-		if (!contact_vox && k < size.intz() - 1)
-		{
-			indexn = index + size.get_size_xy();
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				contact_vox = true;
-		}
-	}
-	else
-	{
-		surface_vox = false;
-		contact_vox = false;
-		//i-1
-		indexn = index - 1;
-		if (data_label[indexn] == 0)
-			surface_vox = true;
-		if (data_label[indexn] &&
-			data_label[indexn] != id)
-			surface_vox = contact_vox = true;
-		//i+1
-		if (!surface_vox || !contact_vox)
-		{
-			indexn = index + 1;
-			if (data_label[indexn] == 0)
-				surface_vox = true;
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				surface_vox = contact_vox = true;
-		}
-		//j-1
-		if (!surface_vox || !contact_vox)
-		{
-			indexn = index - size.intx();
-			if (data_label[indexn] == 0)
-				surface_vox = true;
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				surface_vox = contact_vox = true;
-		}
-		//j+1
-		if (!surface_vox || !contact_vox)
-		{
-			indexn = index + size.intx();
-			if (data_label[indexn] == 0)
-				surface_vox = true;
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				surface_vox = contact_vox = true;
-		}
-		//k-1
-		if (!surface_vox || !contact_vox)
-		{
-			indexn = index - size.get_size_xy();
-			if (data_label[indexn] == 0)
-				surface_vox = true;
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				surface_vox = contact_vox = true;
-		}
-		//k+1
-		if (!surface_vox || !contact_vox)
-		{
-			indexn = index + size.get_size_xy();
-			if (data_label[indexn] == 0)
-				surface_vox = true;
-			if (data_label[indexn] &&
-				data_label[indexn] != id)
-				surface_vox = contact_vox = true;
-		}
-	}
-
-	return surface_vox ? 1 : 0;
-}
-
 bool ComponentAnalyzer::OutputAnnotData()
 {
 	if (!m_compgroup)
@@ -1603,20 +1375,11 @@ void ComponentAnalyzer::OutputDistance(std::ostream& stream)
 
 	//result
 	std::string str;
-	std::vector<std::vector<double>> rm;//result matrix
 	std::vector<std::string> nl;//name list
 	std::vector<int> gn;//group number
-	rm.reserve(num);
 	nl.reserve(num);
 	if (gsize > 1)
 		gn.reserve(num);
-	for (size_t i = 0; i < num; ++i)
-	{
-		rm.push_back(std::vector<double>());
-		rm[i].reserve(num);
-		for (size_t j = 0; j < num; ++j)
-			rm[i].push_back(0);
-	}
 
 	//compute
 	double sx, sy, sz;
@@ -1685,103 +1448,91 @@ void ComponentAnalyzer::OutputDistance(std::ostream& stream)
 			num2++;
 		}
 	}
-	double dist = 0;
-	for (int i = 0; i < num2; ++i)
-	{
-		for (int j = i; j < num2; ++j)
-		{
-			dist = (pos[i] - pos[j]).length();
-			rm[i][j] = dist;
-			rm[j][i] = dist;
-		}
-	}
+	if (!num2)
+		return;
 
 	bool bdist = m_use_dist_neighbor &&
 		m_dist_neighbor_num > 0 &&
 		m_dist_neighbor_num < num2 - 1;
+	int knum = m_dist_neighbor_num;
+	//the full matrix is only written for small counts
+	if (!bdist && num2 > s_dist_dense_max)
+	{
+		bdist = true;
+		knum = std::max(knum, 1);
+	}
 
 	std::vector<double> in_group;//distances with in a group
 	std::vector<double> out_group;//distance between groups
-	in_group.reserve(num2 * num2 / 2);
-	out_group.reserve(num2 * num2 / 2);
-	std::vector<std::vector<int>> im;//index matrix
 	if (bdist)
 	{
-		//sort with indices
-		im.reserve(num2);
+		//nearest neighbors from a spatial index, itself included
+		KdTree tree;
+		tree.Build(pos);
+		size_t dnum = static_cast<size_t>(knum) + 1;
+		std::vector<unsigned int> im;//index lists
+		std::vector<double> rm;//distance lists
+		tree.KnnAll(dnum, im, rm);
+		dnum = im.size() / num2;
 		for (size_t i = 0; i < num2; ++i)
 		{
-			im.push_back(std::vector<int>());
-			im[i].reserve(num2);
-			for (size_t j = 0; j < num2; ++j)
-				im[i].push_back(static_cast<int>(j));
-		}
-		//copy rm
-		std::vector<std::vector<double>> rm2 = rm;
-		//sort
-		for (size_t i = 0; i < num2; ++i)
-		{
-			std::sort(im[i].begin(), im[i].end(),
-				[&](int ii, int jj) {return rm2[i][ii] < rm2[i][jj]; });
-		}
-		//fill rm
-		for (size_t i = 0; i < num2; ++i)
-			for (size_t j = 0; j < num2; ++j)
+			stream << nl[i] << "\t";
+			for (size_t j = 1; j < dnum; ++j)
 			{
-				rm[i][j] = rm2[i][im[i][j]];
-				if (gsize > 1 && j > 0 &&
-					j <= m_dist_neighbor_num)
+				stream << rm[i * dnum + j];
+				if (j < dnum - 1)
+					stream << "\t";
+				if (gsize > 1)
 				{
-					if (gn[i] == gn[im[i][j]])
-						in_group.push_back(rm[i][j]);
+					if (gn[i] == gn[im[i * dnum + j]])
+						in_group.push_back(rm[i * dnum + j]);
 					else
-						out_group.push_back(rm[i][j]);
+						out_group.push_back(rm[i * dnum + j]);
 				}
 			}
-	}
-	else
-	{
-		if (gsize > 1)
-		{
-			for (int i = 0; i < num2; ++i)
-				for (int j = i + 1; j < num2; ++j)
-				{
-					if (gn[i] == gn[j])
-						in_group.push_back(rm[i][j]);
-					else
-						out_group.push_back(rm[i][j]);
-				}
+			stream << "\n";
 		}
-	}
-
-	size_t dnum = bdist ? (m_dist_neighbor_num + 1) : num2;
-	for (size_t i = 0; i < num2; ++i)
-	{
-		stream << nl[i] << "\t";
-		for (size_t j = bdist ? 1 : 0; j < dnum; ++j)
+		//index lists
+		stream << "\n";
+		for (size_t i = 0; i < num2; ++i)
 		{
-			stream << rm[i][j];
-			if (j < dnum - 1)
-				stream << "\t";
+			stream << nl[i] << "\t";
+			for (size_t j = 1; j < dnum; ++j)
+			{
+				stream << im[i * dnum + j] + 1;
+				if (j < dnum - 1)
+					stream << "\t";
+			}
+			stream << "\n";
 		}
-		stream << "\n";
 	}
-	//index matrix
-	if (bdist)
+	else
 	{
-		stream << "\n";
+		//rows are computed as they are written
 		for (size_t i = 0; i < num2; ++i)
 		{
 			stream << nl[i] << "\t";
-			for (size_t j = bdist ? 1 : 0; j < dnum; ++j)
+			for (size_t j = 0; j < num2; ++j)
 			{
-				stream << im[i][j] + 1;
-				if (j < dnum - 1)
+				stream << (pos[i] - pos[j]).length();
+				if (j < num2 - 1)
 					stream << "\t";
 			}
 			stream << "\n";
 		}
+		if (gsize > 1)
+		{
+			for (int i = 0; i < num2; ++i)
+				for (int j = i + 1; j < num2; ++j)
+				{
+					if (gn[i] == gn[j])
+						in_group.push_back((pos[i] - pos[j]).length());
+					else
+						out_group.push_back((pos[i] - pos[j]).length());
+				}
+		}
 	}
+
 	//output in_group and out_group distances
 	if (gsize > 1)
 	{
@@ -2105,6 +1856,20 @@ CompGroup* ComponentAnalyzer::FindCompGroup(const std::shared_ptr<VolumeData>& v
 	return 0;
 }
 
+void ComponentAnalyzer::SetCelpList(const std::shared_ptr<VolumeData>& vd, const CelpList& list)
+{
+	CompGroup* compgroup = FindCompGroup(vd);
+	if (!compgroup)
+		compgroup = AddCompGroup(vd);
+	if (!compgroup)
+		return;
+	m_compgroup = compgroup;
+	m_compgroup->Clear();
+	m_compgroup->celps = list;
+	m_compgroup->dirty = false;
+	m_analyzed = true;
+}
+
 CompGroup* ComponentAnalyzer::AddCompGroup(const std::shared_ptr<VolumeData>& vd)
 {
 	if (!vd)
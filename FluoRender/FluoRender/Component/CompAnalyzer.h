@@ -157,6 +157,8 @@ namespace flrd
 		bool GetSelectedCelp(CelpList& cl, bool links = false);
 		bool GetAllCelp(CelpList& cl, bool links = false);
 		bool GetCelpFromIds(CelpList& cl, const std::vector<unsigned long long>& ids, bool links = false);
+		//results computed elsewhere, e.g. out of core
+		void SetCelpList(const std::shared_ptr<VolumeData>& vd, const CelpList& list);
 
 		//update progress
 		CompAnalyzerFunc m_sig_progress;
@@ -197,20 +199,10 @@ namespace flrd
 		double m_size;
 
 	private:
-		unsigned int GetExt(unsigned int* data_label,
-			unsigned long long index,
-			unsigned int id,
-			const fluo::Vector& size,
-			const fluo::Point& p);
-
 		bool GetColor(unsigned int id,
 			int brick_id,
 			VolumeData* vd,
 			fluo::Color &color);
-		int GetColocalization(size_t bid,
-			const fluo::Point& p,
-			std::vector<unsigned int> &sumi,
-			std::vector<double> &sumd);
 
 		//replace id to make color consistent
 		void ReplaceId(unsigned int base_id, Celp &info);
@@ -47,6 +47,10 @@ DEALINGS IN THE SOFTWARE.
 #include <TreeFileFactory.h>
 #include <Plane.h>
 #include <Count.h>
+#include <Watershed.h>
+#include <CompStream.h>
+#include <CompAnalyzer.h>
+#include <base_vol_reader.h>
 #include <compatibility.h>
 #include <algorithm>
 #ifdef _DEBUG
@@ -126,6 +130,12 @@ void ComponentGenerator::GenerateComp(bool command)
 	if (!vd)
 		return;
 
+	if (m_out_core)
+	{
+		GenerateOutOfCore(command);
+		return;
+	}
+
 	m_busy = true;
 	//int clean_iter = m_clean_iter;
 	//int clean_size = m_clean_size_vl;
@@ -192,6 +202,12 @@ void ComponentGenerator::GenerateComp(bool command)
 		FillBorders();
 	}
 
+	if (m_watershed)
+	{
+		SetRange(90, 100);
+		SplitWatershed();
+	}
+
 	m_tps.push_back(std::chrono::high_resolution_clock::now());
 	std::chrono::duration<double> time_span =
 		std::chrono::duration_cast<std::chrono::duration<double>>(
@@ -223,6 +239,75 @@ void ComponentGenerator::GenerateComp(bool command)
 	m_busy = false;
 }
 
+void ComponentGenerator::GenerateOutOfCore(bool command)
+{
+	if (m_busy)
+		return;
+
+	auto vd = m_vd.lock();
+	if (!vd)
+		return;
+
+	m_busy = true;
+	m_titles.clear();
+	m_values.clear();
+	m_tps.clear();
+	m_tps.push_back(std::chrono::high_resolution_clock::now());
+	SetProgress(0, "Generating components out of core.");
+
+	//labels are written to a scratch file next to the label file
+	//the user's label file is left alone until the labels are saved
+	std::wstring filename;
+	if (auto reader = vd->GetReader())
+		filename = reader->GetCurLabelName(vd->GetCurTime(), vd->GetCurChannel());
+	if (filename.empty())
+		filename = vd->GetPath();
+	filename = filename.substr(0, filename.find_last_of(L'.')) + L"_ooc.lbl";
+
+	ComponentStream stream;
+	stream.SetProgressFunc(GetProgressFunc());
+	stream.SetRange(GetMin(), GetMax());
+	stream.SetThresh(m_thresh * m_tfactor);
+	stream.SetWorkingSet(size_t(std::max(m_out_core_mem, 64)) << 20);
+	stream.SetCompact(glbin_settings.m_label_compact);
+	stream.SetFile(filename);
+	std::wstring error;
+	if (!stream.SetVolumeData(vd))
+		error = L"Volume data cannot be read by blocks.";
+	else if (!stream.Compute())
+		error = L"Label file cannot be written: " + filename;
+	else if (vd->LoadLabelSrc(stream.GetLabelSrc()))
+	{
+		//labels stay on disk, bricks are read as they are drawn
+		glbin_comp_analyzer.SetCelpList(vd, stream.GetCelpList());
+	}
+	else
+		error = L"Label file cannot be loaded: " + filename;
+
+	if (!error.empty())
+	{
+		m_titles = L"Error\n";
+		m_values = error + L"\n";
+	}
+	else
+	{
+		m_tps.push_back(std::chrono::high_resolution_clock::now());
+		std::chrono::duration<double> time_span =
+			std::chrono::duration_cast<std::chrono::duration<double>>(
+				m_tps.back() - m_tps.front());
+		m_titles = L"Components\tTotal time\n";
+		m_values = std::to_wstring(stream.GetCompNum()) + L"\t" +
+			std::to_wstring(time_span.count()) + L" sec.\n";
+	}
+
+	if (command && m_record_cmd)
+		AddCmd("generate");
+
+	SetRange(0, 100);
+	SetProgress(0, "");
+	m_busy = false;
+}
+
 void ComponentGenerator::Fixate(bool command)
 {
 	auto vd = m_vd.lock();
@@ -288,6 +373,28 @@ void ComponentGenerator::Clean(bool command)
 	m_busy = false;
 }
 
+void ComponentGenerator::Split(bool command)
+{
+	if (m_busy)
+		return;
+
+	auto vd = m_vd.lock();
+	if (!vd || !vd->GetLabel(false))
+		return;
+
+	m_busy = true;
+
+	SetProgress(0, "Splitting components.");
+	SplitWatershed();
+
+	if (command && m_record_cmd)
+		AddCmd("watershed");
+
+	SetRange(0, 100);
+	SetProgress(0, "");
+	m_busy = false;
+}
+
 void ComponentGenerator::ApplyRecord()
 {
 	//generate components using records
@@ -364,6 +471,14 @@ void ComponentGenerator::ShuffleID()
 	size_t brick_num = vd->GetTexture()->get_brick_list_size();
 	size_t count = 0;
 	std::vector<flvr::TextureBrick*> *bricks = vd->GetTexture()->get_bricks();
+	if (!m_use_sel)
+	{
+		//labels of empty bricks are kept in memory
+		//drop the ones in gpu so they are not stale
+		vd->GetTexture()->valid_all_mask();
+		vd->GetVR()->clear_tex_label();
+		vd->GetTexture()->update_brick_stats();
+	}
 	for (size_t i = 0; i < brick_num; ++i)
 	{
 		if (prework)
@@ -380,7 +495,14 @@ void ComponentGenerator::ShuffleID()
 				continue;
 		}
 		else
+		{
 			b->valid_mask();
+			//all ids are zero for empty data
+			//the kernel compares the unscaled value against 1e-4
+			if (b->stat_valid() && b->get_max() < 1e-4 &&
+				b->is_comp_empty(flvr::CompType::Label))
+				continue;
+		}
 
 		int bits = b->nb(flvr::CompType::Data) * 8;
 		auto res = b->get_size();
@@ -630,6 +752,14 @@ void ComponentGenerator::Grow()
 	size_t count = 0;
 
 	std::vector<flvr::TextureBrick*> *bricks = vd->GetTexture()->get_bricks();
+	bool skip_empty = !m_use_sel && !m_fixate;
+	//the kernel stops where the scaled value is below the threshold,
+	//less the falloff range
+	double grow_lo = m_thresh * m_tfactor;
+	if (m_diff && m_falloff > 0.0)
+		grow_lo -= std::sqrt(m_falloff) * 2.12;
+	if (skip_empty)
+		vd->GetTexture()->update_brick_stats();
 	for (size_t i = 0; i < brick_num; ++i)
 	{
 		if (prework)
@@ -638,6 +768,12 @@ void ComponentGenerator::Grow()
 		flvr::TextureBrick* b = (*bricks)[i];
 		if (m_use_sel && !b->is_mask_valid())
 			continue;
+		//no voxels above the threshold to grow into
+		if (skip_empty && b->stat_valid() && b->get_max() * scale < grow_lo)
+		{
+			count += m_iter > 0 ? m_iter : 0;
+			continue;
+		}
 		int bits = b->nb(flvr::CompType::Data) * 8;
 		auto res = b->get_size();
 		int nx = res.intx();
@@ -1716,6 +1852,54 @@ void ComponentGenerator::FillBorders()
 	glbin_kernel_factory.clear(kernel_prog);
 }
 
+void ComponentGenerator::SplitWatershed()
+{
+	auto vd = m_vd.lock();
+	if (!vd || vd->isBrxml())
+		return;
+
+	if (prework)
+		prework("");
+
+	SetProgress(0, "Splitting components.");
+
+	Nrrd* nrrd_data = vd->GetVolume(false);
+	Nrrd* nrrd_label = vd->GetLabel(true);
+	if (!nrrd_data || !nrrd_data->data ||
+		!nrrd_label || !nrrd_label->data)
+		return;
+	unsigned char* data_mask = 0;
+	if (m_use_sel)
+	{
+		Nrrd* nrrd_mask = vd->GetMask(true);
+		if (nrrd_mask)
+			data_mask = (unsigned char*)(nrrd_mask->data);
+	}
+
+	auto res = vd->GetResolution();
+	auto spc = vd->GetSpacing();
+	flrd::Watershed ws;
+	ws.SetSize(res.intx(), res.inty(), res.intz());
+	ws.SetSpacing(spc.x(), spc.y(), spc.z());
+	ws.SetData(nrrd_data->data, vd->GetBits(), vd->GetScalarScale());
+	ws.SetMask(data_mask);
+	ws.SetLabel((unsigned int*)(nrrd_label->data));
+	ws.SetMarkerType(m_ws_marker);
+	ws.SetH(m_ws_h);
+	ws.SetDistWeight(m_ws_dist_weight);
+	ws.SetMemLimit(size_t(std::max(m_ws_mem, 64)) << 20);
+	ws.Compute();
+	m_ws_skip_num = ws.GetSkipNum();
+
+	//label changed on cpu
+	vd->GetVR()->clear_tex_current();
+
+	SetProgress(100, "Splitting components.");
+
+	if (postwork)
+		postwork(__FUNCTION__);
+}
+
 void ComponentGenerator::AddEntry()
 {
 	//parameters
@@ -2126,7 +2310,8 @@ void ComponentGenerator::LoadCmd(const std::wstring& filename)
 		fconfig->Read("type", &str, std::string(""));
 		if (str == "generate" ||
 			str == "clean" ||
-			str == "fixate")
+			str == "fixate" ||
+			str == "watershed")
 			params.push_back(str);
 		else
 			continue;
@@ -2183,6 +2368,18 @@ void ComponentGenerator::LoadCmd(const std::wstring& filename)
 		{
 			params.push_back("fix_size"); params.push_back(std::to_string(lval));
 		}
+		if (fconfig->Read("use_watershed", &lval))
+		{
+			params.push_back("use_watershed"); params.push_back(std::to_string(lval));
+		}
+		if (fconfig->Read("ws_marker", &lval))
+		{
+			params.push_back("ws_marker"); params.push_back(std::to_string(lval));
+		}
+		if (fconfig->Read("ws_mem", &lval))
+		{
+			params.push_back("ws_mem"); params.push_back(std::to_string(lval));
+		}
 		double dval;
 		if (fconfig->Read("thresh", &dval))
 		{
@@ -2208,6 +2405,14 @@ void ComponentGenerator::LoadCmd(const std::wstring& filename)
 		{
 			params.push_back("varth"); params.push_back(std::to_string(dval));
 		}
+		if (fconfig->Read("ws_h", &dval))
+		{
+			params.push_back("ws_h"); params.push_back(std::to_string(dval));
+		}
+		if (fconfig->Read("ws_dist_weight", &dval))
+		{
+			params.push_back("ws_dist_weight"); params.push_back(std::to_string(dval));
+		}
 
 		m_command.push_back(params);
 		cmd_count++;
@@ -2241,7 +2446,8 @@ void ComponentGenerator::SaveCmd(const std::wstring& filename)
 			continue;
 		if ((*it)[0] == "generate" ||
 			(*it)[0] == "clean" ||
-			(*it)[0] == "fixate")
+			(*it)[0] == "fixate" ||
+			(*it)[0] == "watershed")
 		{
 			str = "/cmd" + std::to_string(cmd_count++);
 			fconfig->SetPath(str);
@@ -2263,7 +2469,10 @@ void ComponentGenerator::SaveCmd(const std::wstring& filename)
 				*it2 == "clean_iter" ||
 				*it2 == "clean_size_vl" ||
 				*it2 == "fix_size" ||
-				*it2 == "grow_fixed")
+				*it2 == "grow_fixed" ||
+				*it2 == "use_watershed" ||
+				*it2 == "ws_marker" ||
+				*it2 == "ws_mem")
 			{
 				str = (*it2);
 				++it2;
@@ -2275,7 +2484,9 @@ void ComponentGenerator::SaveCmd(const std::wstring& filename)
 				*it2 == "dist_thresh" ||
 				*it2 == "falloff" ||
 				*it2 == "density_thresh" ||
-				*it2 == "varth")
+				*it2 == "varth" ||
+				*it2 == "ws_h" ||
+				*it2 == "ws_dist_weight")
 			{
 				str = (*it2);
 				++it2;
@@ -2297,7 +2508,8 @@ void ComponentGenerator::AddCmd(const std::string& type)
 		if (!params.empty())
 		{
 			if ((params[0] == "generate" ||
-				params[0] == "fixate") &&
+				params[0] == "fixate" ||
+				params[0] == "watershed") &&
 				params[0] == type)
 			{
 				//replace
@@ -2329,6 +2541,13 @@ void ComponentGenerator::AddCmd(const std::string& type)
 		params.push_back("clean_iter"); params.push_back(std::to_string(m_clean_iter));
 		params.push_back("clean_size_vl"); params.push_back(std::to_string(m_clean_size_vl));
 		params.push_back("grow_fixed"); params.push_back(std::to_string(m_grow_fixed));
+		params.push_back("use_watershed"); params.push_back(std::to_string(m_watershed));
+		params.push_back("ws_marker"); params.push_back(std::to_string(m_ws_marker));
+		params.push_back("ws_h"); params.push_back(std::to_string(m_ws_h));
+		params.push_back("ws_dist_weight"); params.push_back(std::to_string(m_ws_dist_weight));
+		params.push_back("ws_mem"); params.push_back(std::to_string(m_ws_mem));
+		params.push_back("out_core"); params.push_back(std::to_string(m_out_core));
+		params.push_back("out_core_mem"); params.push_back(std::to_string(m_out_core_mem));
 	}
 	else if (type == "clean")
 	{
@@ -2341,6 +2560,14 @@ void ComponentGenerator::AddCmd(const std::string& type)
 		params.push_back("fixate");
 		params.push_back("fix_size"); params.push_back(std::to_string(m_fix_size));
 	}
+	else if (type == "watershed")
+	{
+		params.push_back("watershed");
+		params.push_back("ws_marker"); params.push_back(std::to_string(m_ws_marker));
+		params.push_back("ws_h"); params.push_back(std::to_string(m_ws_h));
+		params.push_back("ws_dist_weight"); params.push_back(std::to_string(m_ws_dist_weight));
+		params.push_back("ws_mem"); params.push_back(std::to_string(m_ws_mem));
+	}
 	m_command.push_back(params);
 
 	//record
@@ -2420,6 +2647,20 @@ void ComponentGenerator::PlayCmd(double tfactor)
 					m_clean_size_vl = STOI(*(++it2));
 				else if (*it2 == "grow_fixed")
 					m_grow_fixed = STOI(*(++it2));
+				else if (*it2 == "use_watershed")
+					m_watershed = STOI(*(++it2));
+				else if (*it2 == "ws_marker")
+					m_ws_marker = STOI(*(++it2));
+				else if (*it2 == "ws_h")
+					m_ws_h = STOD(*(++it2));
+				else if (*it2 == "ws_dist_weight")
+					m_ws_dist_weight = STOD(*(++it2));
+				else if (*it2 == "ws_mem")
+					m_ws_mem = STOI(*(++it2));
+				else if (*it2 == "out_core")
+					m_out_core = STOI(*(++it2));
+				else if (*it2 == "out_core_mem")
+					m_out_core_mem = STOI(*(++it2));
 			}
 			GenerateComp(false);
 		}
@@ -2449,6 +2690,22 @@ void ComponentGenerator::PlayCmd(double tfactor)
 			Fixate(false);
 			//return;
 		}
+		else if ((*it)[0] == "watershed")
+		{
+			for (auto it2 = it->begin();
+				it2 != it->end(); ++it2)
+			{
+				if (*it2 == "ws_marker")
+					m_ws_marker = STOI(*(++it2));
+				else if (*it2 == "ws_h")
+					m_ws_h = STOD(*(++it2));
+				else if (*it2 == "ws_dist_weight")
+					m_ws_dist_weight = STOD(*(++it2));
+				else if (*it2 == "ws_mem")
+					m_ws_mem = STOI(*(++it2));
+			}
+			Split(false);
+		}
 	}
 	//Update();
 }
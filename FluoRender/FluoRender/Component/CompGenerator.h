@@ -111,12 +111,37 @@ namespace flrd
 		//fill border
 		void SetFillBorder(double val) { m_fill_border = val; }
 		double GetFillBorder() { return m_fill_border; }
+		//watershed
+		void SetWatershed(bool val) { m_watershed = val; }
+		bool GetWatershed() { return m_watershed; }
+		void SetWsMarker(int val) { m_ws_marker = val; }
+		int GetWsMarker() { return m_ws_marker; }
+		void SetWsH(double val) { m_ws_h = val; }
+		double GetWsH() { return m_ws_h; }
+		void SetWsDistWeight(double val) { m_ws_dist_weight = val; }
+		double GetWsDistWeight() { return m_ws_dist_weight; }
+		//memory for the blocks being split, in mb
+		void SetWsMem(int val) { m_ws_mem = val; }
+		int GetWsMem() { return m_ws_mem; }
+		//components left unsplit by the last split for the memory limit
+		size_t GetWsSkipNum() { return m_ws_skip_num; }
+		//out of core, working set in mb
+		//only bricked (brkxml) volumes are streamed from file
+		//other volumes are resident already and are read from memory
+		void SetOutOfCore(bool val) { m_out_core = val; }
+		bool GetOutOfCore() { return m_out_core; }
+		void SetOutOfCoreMem(int val) { m_out_core_mem = val; }
+		int GetOutOfCoreMem() { return m_out_core_mem; }
 
 		//high-level functions
 		void Compute();
 		void GenerateComp(bool command = true);
+		//threshold components streamed by blocks, labels go to file
+		//then are reloaded to the volume, errors go to the output
+		void GenerateOutOfCore(bool command = true);
 		void Fixate(bool command = true);
 		void Clean(bool command = true);
+		void Split(bool command = true);
 		//learning functions
 		void ApplyRecord();
 
@@ -131,6 +156,7 @@ namespace flrd
 		void CleanNoise();
 		void ClearBorders();
 		void FillBorders();
+		void SplitWatershed();
 
 		//learning functions
 		void AddEntry();
@@ -204,6 +230,16 @@ namespace flrd
 		int m_clean_size_vl = 5;
 		//fill borders
 		double m_fill_border = 0.1;
+		//watershed
+		bool m_watershed = false;
+		int m_ws_marker = 0;//0-distance field; 1-intensity
+		double m_ws_h = 2.0;//marker dynamic: voxels for distance, normalized for intensity
+		double m_ws_dist_weight = 0.0;//0: flood on inverted intensity only
+		int m_ws_mem = 2048;//working memory of split blocks in mb
+		size_t m_ws_skip_num = 0;
+		//out of core
+		bool m_out_core = false;
+		int m_out_core_mem = 1024;//working set in mb
 
 		//record
 		bool m_record_cmd = false;
@@ -0,0 +1,363 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <CompStats.h>
+#include <Parallel.h>
+#include <BPoint.h>
+#include <limits>
+
+using namespace flrd;
+
+size_t CompStatEngine::StatArrays::add(unsigned int lid, size_t co_num)
+{
+	size_t i = id.size();
+	id.push_back(lid);
+	size_ui.push_back(0);
+	ext_ui.push_back(0);
+	size_d.push_back(0.0);
+	ext_d.push_back(0.0);
+	int2.push_back(0.0);
+	vmin.push_back(std::numeric_limits<double>::max());
+	vmax.push_back(-std::numeric_limits<double>::max());
+	for (int c = 0; c < 3; ++c)
+	{
+		m1[c].push_back(0.0);
+		bmin[c].push_back(std::numeric_limits<int>::max());
+		bmax[c].push_back(std::numeric_limits<int>::min());
+	}
+	for (int c = 0; c < 6; ++c)
+	{
+		m2[c].push_back(0.0);
+		ext_idx[c].push_back(0);
+	}
+	co_i.resize(co_i.size() + co_num, 0);
+	co_d.resize(co_d.size() + co_num, 0.0);
+	return i;
+}
+
+void CompStatEngine::StatArrays::merge(size_t dst, StatArrays& src, size_t si,
+	size_t co_num, size_t nx, size_t nxy)
+{
+	//src comes after dst in raster order
+	size_ui[dst] += src.size_ui[si];
+	ext_ui[dst] += src.ext_ui[si];
+	size_d[dst] += src.size_d[si];
+	ext_d[dst] += src.ext_d[si];
+	int2[dst] += src.int2[si];
+	vmin[dst] = std::min(vmin[dst], src.vmin[si]);
+	vmax[dst] = std::max(vmax[dst], src.vmax[si]);
+	for (int c = 0; c < 3; ++c)
+	{
+		m1[c][dst] += src.m1[c][si];
+		bmin[c][dst] = std::min(bmin[c][dst], src.bmin[c][si]);
+		bmax[c][dst] = std::max(bmax[c][dst], src.bmax[c][si]);
+	}
+	for (int c = 0; c < 6; ++c)
+		m2[c][dst] += src.m2[c][si];
+	//extreme points, earlier voxels win ties
+	auto coord = [nx, nxy](size_t index, int axis)
+	{
+		switch (axis)
+		{
+		case 0: return index % nxy % nx;
+		case 1: return index % nxy / nx;
+		default: return index / nxy;
+		}
+	};
+	for (int c = 0; c < 3; ++c)
+	{
+		size_t& a0 = ext_idx[c * 2][dst];
+		size_t b0 = src.ext_idx[c * 2][si];
+		if (coord(b0, c) < coord(a0, c))
+			a0 = b0;
+		size_t& a1 = ext_idx[c * 2 + 1][dst];
+		size_t b1 = src.ext_idx[c * 2 + 1][si];
+		if (coord(b1, c) > coord(a1, c))
+			a1 = b1;
+	}
+	for (size_t c = 0; c < co_num; ++c)
+	{
+		co_i[dst * co_num + c] += src.co_i[si * co_num + c];
+		co_d[dst * co_num + c] += src.co_d[si * co_num + c];
+	}
+}
+
+CompStatEngine::CompStatEngine()
+{
+}
+
+CompStatEngine::~CompStatEngine()
+{
+}
+
+void CompStatEngine::AddCoVolume(void* data, int bytes,
+	const fluo::Vector& stride, const fluo::Vector& off)
+{
+	CoVolume co;
+	co.data = data;
+	co.bytes = bytes;
+	co.sx = size_t(stride.intx());
+	co.sy = size_t(stride.inty());
+	co.ox = size_t(off.intx());
+	co.oy = size_t(off.inty());
+	co.oz = size_t(off.intz());
+	m_co.push_back(co);
+}
+
+void CompStatEngine::ScanRows(size_t r0, size_t r1, StatArrays& st, LabelIndexMap& map)
+{
+	size_t nxy = m_nx * m_ny;
+	size_t co_num = m_co.size();
+	double ox = m_off.x();
+	double oy = m_off.y();
+	double oz = m_off.z();
+	unsigned int last_id = 0;
+	size_t l = 0;
+
+	for (size_t r = r0; r < r1; ++r)
+	{
+		size_t k = r / m_ny;
+		size_t j = r % m_ny;
+		size_t index = r * m_nx;
+		for (size_t i = 0; i < m_nx; ++i, ++index)
+		{
+			if (m_mask && !m_mask[index])
+				continue;
+			unsigned int id = m_label[index];
+			if (!id)
+				continue;
+			double value = m_bytes == 1 ?
+				((unsigned char*)m_data)[index] / 255.0 :
+				((unsigned short*)m_data)[index] / 65535.0;
+			if (value <= 0.0)
+				continue;
+
+			//labels come in runs, skip the lookup
+			if (id != last_id)
+			{
+				bool inserted;
+				l = map.insert(id, static_cast<unsigned int>(st.id.size()), inserted);
+				if (inserted)
+					st.add(id, co_num);
+				last_id = id;
+			}
+
+			//surface voxel
+			unsigned int ext = 1;
+			if (i > 0 && i < m_nx - 1 &&
+				j > 0 && j < m_ny - 1 &&
+				k > 0 && k < m_nz - 1)
+			{
+				ext = (m_label[index - 1] != id ||
+					m_label[index + 1] != id ||
+					m_label[index - m_nx] != id ||
+					m_label[index + m_nx] != id ||
+					m_label[index - nxy] != id ||
+					m_label[index + nxy] != id) ? 1 : 0;
+			}
+
+			st.size_ui[l]++;
+			st.size_d[l] += value;
+			st.ext_ui[l] += ext;
+			st.ext_d[l] += ext * value;
+			st.int2[l] += value * value;
+			if (value < st.vmin[l]) st.vmin[l] = value;
+			if (value > st.vmax[l]) st.vmax[l] = value;
+
+			double x = ox + i;
+			double y = oy + j;
+			double z = oz + k;
+			st.m1[0][l] += x;
+			st.m1[1][l] += y;
+			st.m1[2][l] += z;
+			st.m2[0][l] += x * x;
+			st.m2[1][l] += x * y;
+			st.m2[2][l] += x * z;
+			st.m2[3][l] += y * y;
+			st.m2[4][l] += y * z;
+			st.m2[5][l] += z * z;
+
+			int c[3] = { int(i), int(j), int(k) };
+			if (st.size_ui[l] == 1)
+			{
+				for (int a = 0; a < 3; ++a)
+				{
+					st.bmin[a][l] = st.bmax[a][l] = c[a];
+					st.ext_idx[a * 2][l] = st.ext_idx[a * 2 + 1][l] = index;
+				}
+			}
+			else
+			{
+				for (int a = 0; a < 3; ++a)
+				{
+					if (c[a] < st.bmin[a][l])
+					{
+						st.bmin[a][l] = c[a];
+						st.ext_idx[a * 2][l] = index;
+					}
+					if (c[a] > st.bmax[a][l])
+					{
+						st.bmax[a][l] = c[a];
+						st.ext_idx[a * 2 + 1][l] = index;
+					}
+				}
+			}
+
+			for (size_t ci = 0; ci < co_num; ++ci)
+			{
+				double cv = GetCoValue(m_co[ci], i, j, k);
+				st.co_i[l * co_num + ci] += cv > 0.0 ? 1 : 0;
+				st.co_d[l * co_num + ci] += cv;
+			}
+		}
+	}
+}
+
+bool CompStatEngine::Compute()
+{
+	m_stats = StatArrays();
+	if (!m_data || !m_label ||
+		!m_nx || !m_ny || !m_nz)
+		return false;
+
+	size_t rows = m_ny * m_nz;
+	unsigned int tn = GetThreadNum(m_thread_num);
+	if (tn > rows)
+		tn = static_cast<unsigned int>(rows);
+	std::vector<StatArrays> local(tn);
+	std::vector<LabelIndexMap> maps(tn);
+
+	ParallelFor(rows,
+		[&](size_t r0, size_t r1, unsigned int t)
+		{
+			ScanRows(r0, r1, local[t], maps[t]);
+		}, tn);
+
+	//reduce in slab order
+	size_t co_num = m_co.size();
+	size_t nxy = m_nx * m_ny;
+	size_t total = 0;
+	for (auto& it : local)
+		total += it.id.size();
+	LabelIndexMap gmap(total);
+	for (unsigned int t = 0; t < tn; ++t)
+	{
+		StatArrays& st = local[t];
+		for (size_t si = 0; si < st.id.size(); ++si)
+		{
+			bool inserted;
+			size_t gi = gmap.insert(st.id[si],
+				static_cast<unsigned int>(m_stats.id.size()), inserted);
+			if (inserted)
+			{
+				m_stats.add(st.id[si], co_num);
+				//take extents from the first slab
+				for (int a = 0; a < 6; ++a)
+					m_stats.ext_idx[a][gi] = st.ext_idx[a][si];
+				for (int a = 0; a < 3; ++a)
+				{
+					m_stats.bmin[a][gi] = st.bmin[a][si];
+					m_stats.bmax[a][gi] = st.bmax[a][si];
+				}
+			}
+			m_stats.merge(gi, st, si, co_num, m_nx, nxy);
+		}
+		st = StatArrays();
+	}
+
+	return true;
+}
+
+void CompStatEngine::GetCelpList(CelpList& list, unsigned int size_limit)
+{
+	size_t num = m_stats.id.size();
+	size_t co_num = m_co.size();
+	std::vector<Celp> cells(num);
+	double sx = m_spc.x();
+	double sy = m_spc.y();
+	double sz = m_spc.z();
+	double ox = m_off.x();
+	double oy = m_off.y();
+	double oz = m_off.z();
+
+	ParallelFor(num,
+		[&](size_t b, size_t e, unsigned int)
+		{
+			for (size_t i = b; i < e; ++i)
+			{
+				const StatArrays& st = m_stats;
+				if (st.size_ui[i] < size_limit)
+					continue;
+				Celp cell = std::make_shared<Cell>(st.id[i], m_bid);
+				fluo::Point pos(st.m1[0][i], st.m1[1][i], st.m1[2][i]);
+				fluo::BBox box(
+					fluo::Point(st.bmin[0][i] + ox, st.bmin[1][i] + oy, st.bmin[2][i] + oz),
+					fluo::Point(st.bmax[0][i] + ox, st.bmax[1][i] + oy, st.bmax[2][i] + oz));
+				cell->SetStats(st.size_ui[i], st.size_d[i],
+					st.ext_ui[i], st.ext_d[i],
+					st.int2[i], st.vmin[i], st.vmax[i],
+					pos, box);
+				//shape from scaled coords
+				fluo::Point psum(st.m1[0][i] * sx, st.m1[1][i] * sy, st.m1[2][i] * sz);
+				double cov[6] = {
+					st.m2[0][i] * sx * sx,
+					st.m2[1][i] * sx * sy,
+					st.m2[2][i] * sx * sz,
+					st.m2[3][i] * sy * sy,
+					st.m2[4][i] * sy * sz,
+					st.m2[5][i] * sz * sz };
+				fluo::Point ep[6];
+				for (int a = 0; a < 6; ++a)
+				{
+					ep[a] = GetPoint(st.ext_idx[a][i]);
+					ep[a].scale(m_spc);
+				}
+				fluo::BPoint bpoint(ep[0], ep[1], ep[2], ep[3], ep[4], ep[5]);
+				cell->GetPca().SetSums(static_cast<int>(st.size_ui[i]),
+					psum, cov, bpoint);
+				if (co_num)
+				{
+					std::vector<unsigned int> sumi(
+						st.co_i.begin() + i * co_num,
+						st.co_i.begin() + (i + 1) * co_num);
+					std::vector<double> sumd(
+						st.co_d.begin() + i * co_num,
+						st.co_d.begin() + (i + 1) * co_num);
+					cell->SetCoSize(sumi, sumd);
+				}
+				cells[i] = cell;
+			}
+		}, m_thread_num);
+
+	list.reserve(list.size() + num);
+	for (size_t i = 0; i < num; ++i)
+	{
+		if (cells[i])
+			list.insert(std::pair<unsigned long long, Celp>
+				(m_stats.id[i], cells[i]));
+	}
+}
@@ -0,0 +1,261 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_CompStats_h
+#define FL_CompStats_h
+
+#include <Cell.h>
+#include <Vector.h>
+#include <vector>
+
+namespace flrd
+{
+	//open addressing map from sparse label ids to dense indices
+	class LabelIndexMap
+	{
+	public:
+		LabelIndexMap(size_t capacity = 1024)
+		{
+			reset(capacity);
+		}
+
+		void reset(size_t capacity)
+		{
+			size_t cap = 16;
+			while (cap < capacity * 2)
+				cap <<= 1;
+			m_keys.assign(cap, 0);
+			m_vals.assign(cap, 0);
+			m_mask = cap - 1;
+			m_num = 0;
+		}
+
+		size_t size() const { return m_num; }
+
+		//returns index of key, or invalid
+		unsigned int find(unsigned int key) const
+		{
+			size_t h = hash(key);
+			for (;;)
+			{
+				unsigned int k = m_keys[h];
+				if (k == key)
+					return m_vals[h];
+				if (k == 0)
+					return invalid;
+				h = (h + 1) & m_mask;
+			}
+		}
+
+		//key must not be 0
+		//inserts val if key is new, returns stored index
+		unsigned int insert(unsigned int key, unsigned int val, bool& inserted)
+		{
+			if ((m_num + 1) * 2 > m_keys.size())
+				grow();
+			size_t h = hash(key);
+			for (;;)
+			{
+				unsigned int k = m_keys[h];
+				if (k == key)
+				{
+					inserted = false;
+					return m_vals[h];
+				}
+				if (k == 0)
+				{
+					m_keys[h] = key;
+					m_vals[h] = val;
+					m_num++;
+					inserted = true;
+					return val;
+				}
+				h = (h + 1) & m_mask;
+			}
+		}
+
+		static const unsigned int invalid = 0xffffffff;
+
+	private:
+		std::vector<unsigned int> m_keys;
+		std::vector<unsigned int> m_vals;
+		size_t m_mask;
+		size_t m_num;
+
+		size_t hash(unsigned int key) const
+		{
+			unsigned long long h = key * 0x9E3779B97F4A7C15ull;
+			return size_t(h >> 32) & m_mask;
+		}
+
+		void grow()
+		{
+			std::vector<unsigned int> keys, vals;
+			keys.swap(m_keys);
+			vals.swap(m_vals);
+			size_t cap = keys.size() * 2;
+			m_keys.assign(cap, 0);
+			m_vals.assign(cap, 0);
+			m_mask = cap - 1;
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				if (!keys[i])
+					continue;
+				size_t h = hash(keys[i]);
+				while (m_keys[h])
+					h = (h + 1) & m_mask;
+				m_keys[h] = keys[i];
+				m_vals[h] = vals[i];
+			}
+		}
+	};
+
+	//per-label statistics of one brick, gathered on the cpu
+	//rows of the brick are split into contiguous slabs, one per thread
+	//each thread accumulates into flat arrays indexed by a local label map
+	//and the slabs are reduced in order, so results match a serial scan
+	class CompStatEngine
+	{
+	public:
+		CompStatEngine();
+		~CompStatEngine();
+
+		void SetSize(size_t nx, size_t ny, size_t nz)
+		{
+			m_nx = nx; m_ny = ny; m_nz = nz;
+		}
+		//offset of the brick in the volume
+		void SetOffset(const fluo::Vector& off) { m_off = off; }
+		void SetBrickId(unsigned int bid) { m_bid = bid; }
+		void SetSpacing(const fluo::Vector& spc) { m_spc = spc; }
+		//bytes: 1 or 2
+		void SetData(void* data, int bytes) { m_data = data; m_bytes = bytes; }
+		void SetMask(unsigned char* mask) { m_mask = mask; }
+		void SetLabel(unsigned int* label) { m_label = label; }
+		//colocalization channels, addressed with the volume coordinates
+		//of this brick; data can be null for a missing channel
+		void AddCoVolume(void* data, int bytes,
+			const fluo::Vector& stride, const fluo::Vector& off);
+		void ClearCoVolumes() { m_co.clear(); }
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+
+		bool Compute();
+
+		size_t GetCompNum() { return m_stats.id.size(); }
+		//create cells in list, keyed by id
+		void GetCelpList(CelpList& list, unsigned int size_limit = 0);
+
+	private:
+		struct CoVolume
+		{
+			void* data;
+			int bytes;
+			size_t sx, sy;
+			size_t ox, oy, oz;
+		};
+
+		//structure of arrays for a set of labels
+		struct StatArrays
+		{
+			std::vector<unsigned int> id;
+			std::vector<unsigned int> size_ui;
+			std::vector<unsigned int> ext_ui;
+			std::vector<double> size_d;
+			std::vector<double> ext_d;
+			std::vector<double> int2;
+			std::vector<double> vmin;
+			std::vector<double> vmax;
+			//first and second moments of voxel coords
+			std::vector<double> m1[3];
+			std::vector<double> m2[6];//xx, xy, xz, yy, yz, zz
+			//bounding box
+			std::vector<int> bmin[3];
+			std::vector<int> bmax[3];
+			//first voxels reaching the extents along each axis
+			std::vector<size_t> ext_idx[6];//xmin, xmax, ymin, ymax, zmin, zmax
+			//colocalization, co_num entries per label
+			std::vector<unsigned int> co_i;
+			std::vector<double> co_d;
+
+			size_t add(unsigned int lid, size_t co_num);
+			void merge(size_t dst, StatArrays& src, size_t si,
+				size_t co_num, size_t nx, size_t nxy);
+		};
+
+		size_t m_nx = 0;
+		size_t m_ny = 0;
+		size_t m_nz = 0;
+		fluo::Vector m_off;
+		unsigned int m_bid = 0;
+		fluo::Vector m_spc = fluo::Vector(1.0);
+		void* m_data = nullptr;
+		int m_bytes = 1;
+		unsigned char* m_mask = nullptr;
+		unsigned int* m_label = nullptr;
+		std::vector<CoVolume> m_co;
+		unsigned int m_thread_num = 0;
+
+		StatArrays m_stats;
+
+	private:
+		void ScanRows(size_t r0, size_t r1, StatArrays& st, LabelIndexMap& map);
+		double GetCoValue(const CoVolume& co, size_t i, size_t j, size_t k);
+		fluo::Point GetPoint(size_t index);
+	};
+
+	inline double CompStatEngine::GetCoValue(const CoVolume& co, size_t i, size_t j, size_t k)
+	{
+		if (!co.data)
+			return 0.0;
+		unsigned long long offset =
+			(unsigned long long)(co.oz + k) * co.sx * co.sy +
+			(unsigned long long)(co.oy + j) * co.sx +
+			(unsigned long long)(co.ox + i);
+		switch (co.bytes)
+		{
+		case 1:
+			return ((unsigned char*)co.data)[offset] / 255.0;
+		case 2:
+			return ((unsigned short*)co.data)[offset] / 65535.0;
+		case 4:
+			return ((unsigned int*)co.data)[offset] / 4294967295.0;
+		}
+		return 0.0;
+	}
+
+	inline fluo::Point CompStatEngine::GetPoint(size_t index)
+	{
+		size_t nxy = m_nx * m_ny;
+		size_t k = index / nxy;
+		size_t j = index % nxy;
+		size_t i = j % m_nx;
+		j /= m_nx;
+		return fluo::Point(double(i), double(j), double(k)) + m_off;
+	}
+}
+
+#endif//FL_CompStats_h
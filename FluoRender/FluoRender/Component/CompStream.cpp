@@ -0,0 +1,688 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <CompStream.h>
+#include <CompStats.h>
+#include <VolumeData.h>
+#include <brkxml_reader.h>
+#include <Parallel.h>
+#include <compatibility.h>
+#include <filesystem>
+#include <sstream>
+#include <mutex>
+#include <atomic>
+#include <numeric>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace flrd;
+
+namespace
+{
+	//two pass labeling of a block, 6-connected
+	//returns the number of labels, ids are 1..n in raster order
+	template <typename T>
+	unsigned int LabelBlock(const T* data, unsigned int thr,
+		size_t nx, size_t ny, size_t nz,
+		unsigned int* label, std::vector<unsigned int>& parent)
+	{
+		parent.assign(1, 0);
+		auto find = [&parent](unsigned int a)
+		{
+			while (parent[a] != a)
+			{
+				parent[a] = parent[parent[a]];
+				a = parent[a];
+			}
+			return a;
+		};
+		auto unite = [&parent, &find](unsigned int a, unsigned int b)
+		{
+			a = find(a);
+			b = find(b);
+			if (a < b)
+				parent[b] = a;
+			else if (b < a)
+				parent[a] = b;
+			return std::min(a, b);
+		};
+
+		size_t nxy = nx * ny;
+		size_t index = 0;
+		for (size_t k = 0; k < nz; ++k)
+		for (size_t j = 0; j < ny; ++j)
+		for (size_t i = 0; i < nx; ++i, ++index)
+		{
+			if (data[index] <= thr)
+			{
+				label[index] = 0;
+				continue;
+			}
+			unsigned int l = 0;
+			if (i && label[index - 1])
+				l = label[index - 1];
+			if (j && label[index - nx])
+				l = l ? unite(l, label[index - nx]) : label[index - nx];
+			if (k && label[index - nxy])
+				l = l ? unite(l, label[index - nxy]) : label[index - nxy];
+			if (!l)
+			{
+				l = static_cast<unsigned int>(parent.size());
+				parent.push_back(l);
+			}
+			label[index] = l;
+		}
+
+		//roots are the smallest ids of their sets, so they come first
+		unsigned int num = 0;
+		std::vector<unsigned int> dense(parent.size(), 0);
+		for (size_t i = 1; i < parent.size(); ++i)
+		{
+			unsigned int r = find(static_cast<unsigned int>(i));
+			dense[i] = r == i ? ++num : dense[r];
+		}
+		size_t n = nxy * nz;
+		for (size_t i = 0; i < n; ++i)
+			label[i] = dense[label[i]];
+		return num;
+	}
+
+	//border planes in order x0, x1, y0, y1, z0, z1
+	size_t GetFaceSize(const int size[3])
+	{
+		return 2 * (size_t(size[1]) * size[2] +
+			size_t(size[0]) * size[2] +
+			size_t(size[0]) * size[1]);
+	}
+
+	size_t GetFaceOffset(const int size[3], int axis, bool high)
+	{
+		size_t fx = size_t(size[1]) * size[2];
+		size_t fy = size_t(size[0]) * size[2];
+		size_t fz = size_t(size[0]) * size[1];
+		size_t off = 0;
+		size_t len = fx;
+		if (axis > 0)
+		{
+			off += 2 * fx;
+			len = fy;
+		}
+		if (axis > 1)
+		{
+			off += 2 * fy;
+			len = fz;
+		}
+		return high ? off + len : off;
+	}
+
+	void GetFaces(const unsigned int* label, const int size[3], unsigned int* faces)
+	{
+		size_t nx = size[0], ny = size[1], nz = size[2];
+		size_t nxy = nx * ny;
+		unsigned int* f = faces;
+		for (size_t k = 0; k < nz; ++k)
+		for (size_t j = 0; j < ny; ++j)
+			*f++ = label[k * nxy + j * nx];
+		for (size_t k = 0; k < nz; ++k)
+		for (size_t j = 0; j < ny; ++j)
+			*f++ = label[k * nxy + j * nx + nx - 1];
+		for (size_t k = 0; k < nz; ++k)
+		for (size_t i = 0; i < nx; ++i)
+			*f++ = label[k * nxy + i];
+		for (size_t k = 0; k < nz; ++k)
+		for (size_t i = 0; i < nx; ++i)
+			*f++ = label[k * nxy + (ny - 1) * nx + i];
+		memcpy(f, label, nxy * sizeof(unsigned int));
+		f += nxy;
+		memcpy(f, label + (nz - 1) * nxy, nxy * sizeof(unsigned int));
+	}
+
+	bool ReadAt(FILE* fp, size_t off, void* dst, size_t bytes)
+	{
+		if (FSEEK64(fp, off, SEEK_SET))
+			return false;
+		return fread(dst, 1, bytes, fp) == bytes;
+	}
+
+	bool WriteAt(FILE* fp, size_t off, const void* src, size_t bytes)
+	{
+		if (FSEEK64(fp, off, SEEK_SET))
+			return false;
+		return fwrite(src, 1, bytes, fp) == bytes;
+	}
+}
+
+ComponentStream::ComponentStream() :
+	Progress(),
+	m_size{ 0, 0, 0 },
+	m_bytes(1),
+	m_spc(1.0),
+	m_thresh(0.5),
+	m_scale(1.0),
+	m_working_set(size_t(1) << 30),
+	m_thread_num(0),
+	m_compact(true),
+	m_data_off(0),
+	m_label_bytes(0),
+	m_bsize{ 0, 0, 0 },
+	m_bnum{ 0, 0, 0 },
+	m_comp_num(0)
+{
+}
+
+ComponentStream::~ComponentStream()
+{
+}
+
+bool ComponentStream::SetVolumeData(const std::shared_ptr<VolumeData>& vd)
+{
+	if (!vd)
+		return false;
+	m_spc = vd->GetSpacing();
+	m_scale = vd->GetScalarScale();
+
+	//bricked data are read from the finest level
+	auto breader = std::dynamic_pointer_cast<BRKXMLReader>(vd->GetReader());
+	if (breader)
+	{
+		int nx, ny, nz, bytes;
+		if (!breader->GetLevelSize(0, nx, ny, nz, bytes))
+			return false;
+		int t = breader->GetCurTime();
+		int c = vd->GetCurChannel();
+		SetSource([breader, t, c](const int org[3], const int size[3], void* dst)
+			{
+				return breader->ReadRegion(t, c, 0, org, size, dst);
+			}, nx, ny, nz, bytes);
+		return true;
+	}
+
+	Nrrd* nrrd = vd->GetVolume(false);
+	if (!nrrd || !nrrd->data || nrrd->dim != 3)
+		return false;
+	int bytes = nrrd->type == nrrdTypeUChar ? 1 :
+		(nrrd->type == nrrdTypeUShort ? 2 : 0);
+	if (!bytes)
+		return false;
+	int nx = static_cast<int>(nrrd->axis[0].size);
+	int ny = static_cast<int>(nrrd->axis[1].size);
+	int nz = static_cast<int>(nrrd->axis[2].size);
+	const char* data = static_cast<const char*>(nrrd->data);
+	SetSource([vd, data, nx, ny, bytes](const int org[3], const int size[3], void* dst)
+		{
+			size_t len = size_t(size[0]) * bytes;
+			char* d = static_cast<char*>(dst);
+			for (int k = 0; k < size[2]; ++k)
+			for (int j = 0; j < size[1]; ++j)
+			{
+				size_t si = ((size_t(org[2] + k) * ny + org[1] + j) * nx + org[0]) * bytes;
+				memcpy(d, data + si, len);
+				d += len;
+			}
+			return true;
+		}, nx, ny, nz, bytes);
+	return true;
+}
+
+void ComponentStream::SetSource(const CompStreamSrc& src,
+	int nx, int ny, int nz, int bytes)
+{
+	m_src = src;
+	m_size[0] = nx;
+	m_size[1] = ny;
+	m_size[2] = nz;
+	m_bytes = bytes;
+}
+
+bool ComponentStream::Compute()
+{
+	m_comp_num = 0;
+	m_label_bytes = 0;
+	m_celps.clear();
+	if (!m_src || m_filename.empty() ||
+		m_size[0] <= 0 || m_size[1] <= 0 || m_size[2] <= 0 ||
+		(m_bytes != 1 && m_bytes != 2))
+		return false;
+
+	SetBlocks();
+	size_t bn = size_t(m_bnum[0]) * m_bnum[1] * m_bnum[2];
+	m_vox_off.assign(bn + 1, 0);
+	m_face_off.assign(bn + 1, 0);
+	for (size_t bi = 0; bi < bn; ++bi)
+	{
+		int org[3], size[3];
+		GetBlock(bi, org, size);
+		m_vox_off[bi + 1] = m_vox_off[bi] + size_t(size[0]) * size[1] * size[2];
+		m_face_off[bi + 1] = m_face_off[bi] + GetFaceSize(size);
+	}
+
+	//scratch files for block labels and border planes
+	std::wstring blk_name = m_filename + L".blk";
+	std::wstring bdr_name = m_filename + L".bdr";
+	FILE* fp_blk = 0;
+	FILE* fp_bdr = 0;
+	auto cleanup = [&]()
+	{
+		if (fp_blk)
+			fclose(fp_blk);
+		if (fp_bdr)
+			fclose(fp_bdr);
+		fp_blk = fp_bdr = 0;
+		std::error_code ec;
+		std::filesystem::remove(std::filesystem::path(blk_name), ec);
+		std::filesystem::remove(std::filesystem::path(bdr_name), ec);
+		m_vox_off.clear();
+		m_face_off.clear();
+		m_base.clear();
+		std::vector<unsigned int>().swap(m_parent);
+	};
+	if (!WFOPEN(&fp_blk, blk_name, L"w+b") ||
+		!WFOPEN(&fp_bdr, bdr_name, L"w+b"))
+	{
+		cleanup();
+		return false;
+	}
+
+	//label blocks
+	SetProgress(0, "Labeling blocks.");
+	unsigned int tn = GetThreadNum(m_thread_num);
+	unsigned int thr = GetThreshInt();
+	std::vector<unsigned int> count(bn, 0);
+	std::vector<CelpList> block_celps(bn);
+	std::mutex io_mutex;
+	std::atomic<bool> valid(true);
+	std::atomic<size_t> done(0);
+	ParallelForDynamic(bn, [&](size_t bi, unsigned int tid)
+		{
+			if (!valid)
+				return;
+			int org[3], size[3];
+			GetBlock(bi, org, size);
+			size_t n = m_vox_off[bi + 1] - m_vox_off[bi];
+			std::vector<unsigned char> data(n * m_bytes);
+			if (!m_src(org, size, data.data()))
+			{
+				valid = false;
+				return;
+			}
+			std::vector<unsigned int> label(n);
+			std::vector<unsigned int> parent;
+			unsigned int num = m_bytes == 2 ?
+				LabelBlock(reinterpret_cast<const unsigned short*>(data.data()), thr,
+					size[0], size[1], size[2], label.data(), parent) :
+				LabelBlock(data.data(), thr,
+					size[0], size[1], size[2], label.data(), parent);
+			std::vector<unsigned int>().swap(parent);
+			count[bi] = num;
+
+			//empty blocks leave holes of zeros in the scratch files
+			if (num)
+			{
+				CompStatEngine stat;
+				stat.SetSize(size[0], size[1], size[2]);
+				stat.SetOffset(fluo::Vector(org[0], org[1], org[2]));
+				stat.SetSpacing(m_spc);
+				stat.SetData(data.data(), m_bytes);
+				stat.SetLabel(label.data());
+				stat.SetThreadNum(1);
+				if (stat.Compute())
+					stat.GetCelpList(block_celps[bi]);
+
+				std::vector<unsigned int> faces(m_face_off[bi + 1] - m_face_off[bi]);
+				GetFaces(label.data(), size, faces.data());
+				std::lock_guard<std::mutex> lock(io_mutex);
+				if (!WriteAt(fp_blk, m_vox_off[bi] * sizeof(unsigned int),
+					label.data(), n * sizeof(unsigned int)) ||
+					!WriteAt(fp_bdr, m_face_off[bi] * sizeof(unsigned int),
+					faces.data(), faces.size() * sizeof(unsigned int)))
+					valid = false;
+			}
+
+			size_t d = ++done;
+			if (tid == 0)
+				SetProgress(static_cast<int>(50 * d / bn), "Labeling blocks.");
+		}, 1, tn);
+	if (!valid)
+	{
+		cleanup();
+		return false;
+	}
+
+	//global ids, block by block
+	m_base.assign(bn, 0);
+	size_t total = 0;
+	for (size_t bi = 0; bi < bn; ++bi)
+	{
+		m_base[bi] = static_cast<unsigned int>(total);
+		total += count[bi];
+	}
+	if (total >= 0xffffffff)
+	{
+		cleanup();
+		return false;
+	}
+	m_parent.resize(total + 1);
+	std::iota(m_parent.begin(), m_parent.end(), 0);
+
+	//merge ids across block borders
+	SetProgress(50, "Merging block borders.");
+	std::vector<unsigned int> face0, face1;
+	for (int k = 0; k < m_bnum[2]; ++k)
+	for (int j = 0; j < m_bnum[1]; ++j)
+	for (int i = 0; i < m_bnum[0]; ++i)
+	{
+		size_t bi = GetBlockIndex(i, j, k);
+		if (!count[bi])
+			continue;
+		int org[3], size[3];
+		GetBlock(bi, org, size);
+		for (int a = 0; a < 3; ++a)
+		{
+			int nb[3] = { i, j, k };
+			nb[a]++;
+			if (nb[a] >= m_bnum[a])
+				continue;
+			size_t bj = GetBlockIndex(nb[0], nb[1], nb[2]);
+			if (!count[bj])
+				continue;
+			int org2[3], size2[3];
+			GetBlock(bj, org2, size2);
+			size_t off0 = GetFaceOffset(size, a, true);
+			size_t off1 = GetFaceOffset(size2, a, false);
+			size_t len = GetFaceOffset(size, a, true) - GetFaceOffset(size, a, false);
+			face0.resize(len);
+			face1.resize(len);
+			if (!ReadAt(fp_bdr, (m_face_off[bi] + off0) * sizeof(unsigned int),
+				face0.data(), len * sizeof(unsigned int)) ||
+				!ReadAt(fp_bdr, (m_face_off[bj] + off1) * sizeof(unsigned int),
+				face1.data(), len * sizeof(unsigned int)))
+			{
+				cleanup();
+				return false;
+			}
+			for (size_t p = 0; p < len; ++p)
+			{
+				if (face0[p] && face1[p])
+					Unite(m_base[bi] + face0[p], m_base[bj] + face1[p]);
+			}
+		}
+	}
+	std::vector<unsigned int>().swap(face0);
+	std::vector<unsigned int>().swap(face1);
+
+	//final ids in order of first appearance
+	std::vector<unsigned int> fid(total + 1, 0);
+	unsigned int num = 0;
+	for (size_t p = 1; p <= total; ++p)
+	{
+		unsigned int r = Find(static_cast<unsigned int>(p));
+		fid[p] = r == p ? ++num : fid[r];
+	}
+	std::vector<unsigned int>().swap(m_parent);
+	m_comp_num = num;
+
+	//merge stats
+	SetProgress(55, "Merging components.");
+	for (size_t bi = 0; bi < bn; ++bi)
+	{
+		for (auto& it : block_celps[bi])
+		{
+			Celp& celp = it.second;
+			unsigned int id = fid[m_base[bi] + celp->Id()];
+			auto cit = m_celps.find(id);
+			if (cit == m_celps.end())
+			{
+				celp->SetId(id);
+				celp->SetBrickId(0);
+				m_celps.insert(std::pair<unsigned long long, Celp>(id, celp));
+			}
+			else
+				cit->second->Inc(celp);
+		}
+		block_celps[bi].clear();
+	}
+	m_celps.min = std::numeric_limits<unsigned int>::max();
+	m_celps.max = 0;
+	m_celps.sx = m_spc.x();
+	m_celps.sy = m_spc.y();
+	m_celps.sz = m_spc.z();
+	for (auto& it : m_celps)
+	{
+		unsigned int size = static_cast<unsigned int>(std::round(it.second->GetSizeD()));
+		m_celps.min = std::min(m_celps.min, size);
+		m_celps.max = std::max(m_celps.max, size);
+	}
+
+	//write final labels
+	SetProgress(60, "Writing labels.");
+	int bytes = m_compact && num <= 0xffff ? 2 : 4;
+	FILE* fp_out = 0;
+	if (!WFOPEN(&fp_out, m_filename, L"wb"))
+	{
+		cleanup();
+		return false;
+	}
+	std::string header = GetHeader(bytes);
+	size_t data_off = header.size();
+	size_t data_size = size_t(m_size[0]) * m_size[1] * m_size[2] * bytes;
+	//empty blocks are skipped, extend the file with zeros
+	char zero = 0;
+	valid = WriteAt(fp_out, 0, header.data(), header.size()) &&
+		WriteAt(fp_out, data_off + data_size - 1, &zero, 1);
+	done = 0;
+	ParallelForDynamic(bn, [&](size_t bi, unsigned int tid)
+		{
+			if (!valid || !count[bi])
+				return;
+			int org[3], size[3];
+			GetBlock(bi, org, size);
+			size_t n = m_vox_off[bi + 1] - m_vox_off[bi];
+			std::vector<unsigned int> label(n);
+			{
+				std::lock_guard<std::mutex> lock(io_mutex);
+				if (!ReadAt(fp_blk, m_vox_off[bi] * sizeof(unsigned int),
+					label.data(), n * sizeof(unsigned int)))
+				{
+					valid = false;
+					return;
+				}
+			}
+			unsigned int base = m_base[bi];
+			std::vector<unsigned short> label16;
+			const char* src;
+			if (bytes == 2)
+			{
+				label16.resize(n);
+				for (size_t i = 0; i < n; ++i)
+					label16[i] = label[i] ? static_cast<unsigned short>(fid[base + label[i]]) : 0;
+				src = reinterpret_cast<const char*>(label16.data());
+			}
+			else
+			{
+				for (size_t i = 0; i < n; ++i)
+					label[i] = label[i] ? fid[base + label[i]] : 0;
+				src = reinterpret_cast<const char*>(label.data());
+			}
+			size_t len = size_t(size[0]) * bytes;
+			std::lock_guard<std::mutex> lock(io_mutex);
+			for (int k = 0; k < size[2] && valid; ++k)
+			for (int j = 0; j < size[1]; ++j)
+			{
+				size_t off = ((size_t(org[2] + k) * m_size[1] + org[1] + j) *
+					m_size[0] + org[0]) * bytes;
+				if (!WriteAt(fp_out, data_off + off, src, len))
+				{
+					valid = false;
+					break;
+				}
+				src += len;
+			}
+			size_t d = ++done;
+			if (tid == 0)
+				SetProgress(static_cast<int>(60 + 40 * d / bn), "Writing labels.");
+		}, 1, tn);
+	fclose(fp_out);
+	cleanup();
+	if (!valid)
+	{
+		std::error_code ec;
+		std::filesystem::remove(std::filesystem::path(m_filename), ec);
+		m_comp_num = 0;
+		m_celps.clear();
+		return false;
+	}
+	m_data_off = data_off;
+	m_label_bytes = bytes;
+	return true;
+}
+
+CompStreamSrc ComponentStream::GetLabelSrc()
+{
+	if (!m_label_bytes)
+		return nullptr;
+	std::wstring filename = m_filename;
+	size_t data_off = m_data_off;
+	int bytes = m_label_bytes;
+	size_t nx = m_size[0];
+	size_t ny = m_size[1];
+	return [=](const int org[3], const int size[3], void* dst)
+	{
+		FILE* fp = 0;
+		if (!WFOPEN(&fp, filename, L"rb"))
+			return false;
+		unsigned int* out = static_cast<unsigned int*>(dst);
+		size_t len = size_t(size[0]);
+		std::vector<unsigned short> row16(bytes == 2 ? len : 0);
+		bool valid = true;
+		for (int k = 0; k < size[2] && valid; ++k)
+		for (int j = 0; j < size[1]; ++j)
+		{
+			size_t off = ((size_t(org[2] + k) * ny + org[1] + j) *
+				nx + org[0]) * bytes;
+			if (bytes == 2)
+			{
+				valid = ReadAt(fp, data_off + off, row16.data(), len * 2);
+				for (size_t i = 0; valid && i < len; ++i)
+					out[i] = row16[i];
+			}
+			else
+				valid = ReadAt(fp, data_off + off, out, len * 4);
+			if (!valid)
+				break;
+			out += len;
+		}
+		fclose(fp);
+		return valid;
+	};
+}
+
+void ComponentStream::SetBlocks()
+{
+	//data, labels and local equivalences of each block in flight
+	unsigned int tn = GetThreadNum(m_thread_num);
+	size_t cost = m_bytes + 2 * sizeof(unsigned int);
+	size_t vox = m_working_set / (cost * tn);
+	int edge = static_cast<int>(std::cbrt(static_cast<double>(vox)));
+	edge = std::max(edge, 32);
+	for (int a = 0; a < 3; ++a)
+	{
+		m_bsize[a] = std::min(edge, m_size[a]);
+		m_bnum[a] = (m_size[a] + m_bsize[a] - 1) / m_bsize[a];
+	}
+}
+
+void ComponentStream::GetBlock(size_t bi, int org[3], int size[3])
+{
+	int idx[3];
+	idx[0] = static_cast<int>(bi % m_bnum[0]);
+	idx[1] = static_cast<int>((bi / m_bnum[0]) % m_bnum[1]);
+	idx[2] = static_cast<int>(bi / (size_t(m_bnum[0]) * m_bnum[1]));
+	for (int a = 0; a < 3; ++a)
+	{
+		org[a] = idx[a] * m_bsize[a];
+		size[a] = std::min(m_bsize[a], m_size[a] - org[a]);
+	}
+}
+
+unsigned int ComponentStream::Find(unsigned int id)
+{
+	while (m_parent[id] != id)
+	{
+		m_parent[id] = m_parent[m_parent[id]];
+		id = m_parent[id];
+	}
+	return id;
+}
+
+void ComponentStream::Unite(unsigned int a, unsigned int b)
+{
+	//the smaller id stays the root
+	a = Find(a);
+	b = Find(b);
+	if (a < b)
+		m_parent[b] = a;
+	else if (b < a)
+		m_parent[a] = b;
+}
+
+unsigned int ComponentStream::GetThreshInt()
+{
+	double maxv = m_bytes == 2 ? 65535.0 : 255.0;
+	double scale = m_scale > 0.0 ? m_scale : 1.0;
+	double thr = m_thresh * maxv / scale;
+	if (thr <= 0.0)
+		return 0;
+	if (thr >= maxv)
+		return static_cast<unsigned int>(maxv);
+	return static_cast<unsigned int>(std::floor(thr));
+}
+
+std::string ComponentStream::GetHeader(int bytes)
+{
+	std::ostringstream oss;
+	oss << "NRRD0004\n";
+	oss << "# Complete NRRD file format specification at:\n";
+	oss << "# http://teem.sourceforge.net/nrrd/format.html\n";
+	oss << "type: " << (bytes == 2 ? "unsigned short" : "unsigned int") << "\n";
+	oss << "dimension: 3\n";
+	oss << "sizes: " << m_size[0] << " " << m_size[1] << " " << m_size[2] << "\n";
+	oss << "spacings: " << m_spc.x() << " " << m_spc.y() << " " << m_spc.z() << "\n";
+	oss << "endian: little\n";
+	oss << "encoding: raw\n";
+	//narrow labels carry their id table, ids are already dense
+	if (bytes == 2)
+	{
+		oss << "label_ids:=";
+		for (size_t i = 1; i <= m_comp_num; ++i)
+			oss << (i > 1 ? " " : "") << i;
+		oss << "\n";
+	}
+	oss << "\n";
+	return oss.str();
+}
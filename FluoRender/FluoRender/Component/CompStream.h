@@ -0,0 +1,127 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_CompStream_h
+#define FL_CompStream_h
+
+#include <Progress.h>
+#include <Cell.h>
+#include <Vector.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+class VolumeData;
+namespace flrd
+{
+	//reads a box of voxels into dst, x fastest
+	typedef std::function<bool(const int org[3], const int size[3], void* dst)> CompStreamSrc;
+
+	//connected components of volumes that do not fit in memory
+	//blocks are read one at a time from the reader or the resident data,
+	//labeled locally and their border planes are kept in a scratch file
+	//equivalences across block borders are merged with a union-find on
+	//block ids, then the final labels are written block by block
+	//peak memory is set by the working set and the number of components
+	class ComponentStream : public Progress
+	{
+	public:
+		ComponentStream();
+		~ComponentStream();
+
+		//set source from the current frame and channel of a volume
+		bool SetVolumeData(const std::shared_ptr<VolumeData>& vd);
+		//or a custom source, bytes per voxel 1 or 2
+		void SetSource(const CompStreamSrc& src,
+			int nx, int ny, int nz, int bytes);
+		void SetSpacing(const fluo::Vector& spc) { m_spc = spc; }
+		//normalized threshold, scale is the scalar scale of the data
+		void SetThresh(double val) { m_thresh = val; }
+		void SetScale(double val) { m_scale = val; }
+		//bytes for the blocks in flight
+		void SetWorkingSet(size_t bytes) { m_working_set = bytes; }
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+		//label file to write, scratch files are created next to it
+		void SetFile(const std::wstring& filename) { m_filename = filename; }
+		//store dense ids in 16 bits in the file when possible
+		//the label source widens them to 32 bits
+		void SetCompact(bool val) { m_compact = val; }
+
+		bool Compute();
+
+		size_t GetCompNum() { return m_comp_num; }
+		//reads boxes of the written labels as 32-bit ids
+		CompStreamSrc GetLabelSrc();
+		//stats of the final components, brick id 0
+		CelpList& GetCelpList() { return m_celps; }
+
+	private:
+		CompStreamSrc m_src;
+		int m_size[3];
+		int m_bytes;
+		fluo::Vector m_spc;
+		double m_thresh;
+		double m_scale;
+		size_t m_working_set;
+		unsigned int m_thread_num;
+		std::wstring m_filename;
+		bool m_compact;
+		size_t m_data_off;//header size of the label file
+		int m_label_bytes;//bytes per label in the file
+
+		//block grid
+		int m_bsize[3];
+		int m_bnum[3];
+		std::vector<size_t> m_vox_off;//offset of each block in the scratch labels
+		std::vector<size_t> m_face_off;//offset of each block in the scratch faces
+		std::vector<unsigned int> m_base;//first global id of each block
+
+		//global union-find, parent of each block id
+		std::vector<unsigned int> m_parent;
+
+		size_t m_comp_num;
+		CelpList m_celps;
+
+	private:
+		void SetBlocks();
+		size_t GetBlockIndex(int i, int j, int k)
+		{
+			return (size_t(k) * m_bnum[1] + j) * m_bnum[0] + i;
+		}
+		void GetBlock(size_t bi, int org[3], int size[3]);
+		unsigned int Find(unsigned int id);
+		void Unite(unsigned int a, unsigned int b);
+		//voxels above threshold as integer value
+		unsigned int GetThreshInt();
+		//nrrd header of the label file
+		std::string GetHeader(int bytes);
+	};
+}
+
+#endif//FL_CompStream_h
@@ -0,0 +1,234 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <KdTree.h>
+#include <Parallel.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace flrd;
+
+//ranges at or below are scanned linearly
+static const size_t s_leaf_size = 8;
+
+KdTree::KdTree()
+{
+}
+
+KdTree::~KdTree()
+{
+}
+
+void KdTree::Build(const std::vector<fluo::Point>& pts)
+{
+	size_t n = pts.size();
+	m_pts.resize(n * 3);
+	m_idx.resize(n);
+	m_axis.assign(n, 0);
+	for (size_t i = 0; i < n; ++i)
+	{
+		m_pts[i * 3] = pts[i].x();
+		m_pts[i * 3 + 1] = pts[i].y();
+		m_pts[i * 3 + 2] = pts[i].z();
+		m_idx[i] = static_cast<unsigned int>(i);
+	}
+	Split(0, n);
+}
+
+void KdTree::Split(size_t lo, size_t hi)
+{
+	if (hi - lo <= s_leaf_size)
+		return;
+	//split along the widest extent
+	double bmin[3], bmax[3];
+	for (int a = 0; a < 3; ++a)
+	{
+		bmin[a] = m_pts[size_t(m_idx[lo]) * 3 + a];
+		bmax[a] = bmin[a];
+	}
+	for (size_t i = lo + 1; i < hi; ++i)
+	{
+		const double* q = &m_pts[size_t(m_idx[i]) * 3];
+		for (int a = 0; a < 3; ++a)
+		{
+			bmin[a] = std::min(bmin[a], q[a]);
+			bmax[a] = std::max(bmax[a], q[a]);
+		}
+	}
+	int axis = 0;
+	for (int a = 1; a < 3; ++a)
+		if (bmax[a] - bmin[a] > bmax[axis] - bmin[axis])
+			axis = a;
+	size_t mid = (lo + hi) / 2;
+	std::nth_element(m_idx.begin() + lo, m_idx.begin() + mid,
+		m_idx.begin() + hi, [&](unsigned int i, unsigned int j)
+	{
+		return m_pts[size_t(i) * 3 + axis] < m_pts[size_t(j) * 3 + axis];
+	});
+	m_axis[mid] = static_cast<unsigned char>(axis);
+	Split(lo, mid);
+	Split(mid + 1, hi);
+}
+
+void KdTree::SearchKnn(const double* p, size_t k,
+	size_t lo, size_t hi, std::vector<Item>& heap) const
+{
+	auto add = [&](unsigned int i)
+	{
+		Item it{ Dist2(p, i), i };
+		if (heap.size() < k)
+		{
+			heap.push_back(it);
+			std::push_heap(heap.begin(), heap.end());
+		}
+		else if (it < heap.front())
+		{
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = it;
+			std::push_heap(heap.begin(), heap.end());
+		}
+	};
+	if (hi - lo <= s_leaf_size)
+	{
+		for (size_t i = lo; i < hi; ++i)
+			add(m_idx[i]);
+		return;
+	}
+	size_t mid = (lo + hi) / 2;
+	unsigned int mi = m_idx[mid];
+	int axis = m_axis[mid];
+	double d = p[axis] - m_pts[size_t(mi) * 3 + axis];
+	add(mi);
+	//near side first
+	if (d < 0.0)
+		SearchKnn(p, k, lo, mid, heap);
+	else
+		SearchKnn(p, k, mid + 1, hi, heap);
+	//far side only if the plane is within reach
+	if (heap.size() < k || d * d <= heap.front().d2)
+	{
+		if (d < 0.0)
+			SearchKnn(p, k, mid + 1, hi, heap);
+		else
+			SearchKnn(p, k, lo, mid, heap);
+	}
+}
+
+void KdTree::SearchRadius(const double* p, double r2,
+	size_t lo, size_t hi, std::vector<Item>& list) const
+{
+	if (hi - lo <= s_leaf_size)
+	{
+		for (size_t i = lo; i < hi; ++i)
+		{
+			double d2 = Dist2(p, m_idx[i]);
+			if (d2 <= r2)
+				list.push_back(Item{ d2, m_idx[i] });
+		}
+		return;
+	}
+	size_t mid = (lo + hi) / 2;
+	unsigned int mi = m_idx[mid];
+	int axis = m_axis[mid];
+	double d = p[axis] - m_pts[size_t(mi) * 3 + axis];
+	double d2 = Dist2(p, mi);
+	if (d2 <= r2)
+		list.push_back(Item{ d2, mi });
+	if (d <= 0.0 || d * d <= r2)
+		SearchRadius(p, r2, lo, mid, list);
+	if (d >= 0.0 || d * d <= r2)
+		SearchRadius(p, r2, mid + 1, hi, list);
+}
+
+void KdTree::Knn(const fluo::Point& p, size_t k,
+	std::vector<unsigned int>& idx,
+	std::vector<double>& dist) const
+{
+	idx.clear();
+	dist.clear();
+	k = std::min(k, m_idx.size());
+	if (!k)
+		return;
+	double q[3] = { p.x(), p.y(), p.z() };
+	std::vector<Item> heap;
+	heap.reserve(k);
+	SearchKnn(q, k, 0, m_idx.size(), heap);
+	std::sort_heap(heap.begin(), heap.end());
+	idx.reserve(k);
+	dist.reserve(k);
+	for (auto& it : heap)
+	{
+		idx.push_back(it.i);
+		dist.push_back(std::sqrt(it.d2));
+	}
+}
+
+void KdTree::Radius(const fluo::Point& p, double r,
+	std::vector<unsigned int>& idx,
+	std::vector<double>& dist) const
+{
+	idx.clear();
+	dist.clear();
+	if (m_idx.empty() || r < 0.0)
+		return;
+	double q[3] = { p.x(), p.y(), p.z() };
+	std::vector<Item> list;
+	SearchRadius(q, r * r, 0, m_idx.size(), list);
+	std::sort(list.begin(), list.end());
+	idx.reserve(list.size());
+	dist.reserve(list.size());
+	for (auto& it : list)
+	{
+		idx.push_back(it.i);
+		dist.push_back(std::sqrt(it.d2));
+	}
+}
+
+void KdTree::KnnAll(size_t k,
+	std::vector<unsigned int>& idx,
+	std::vector<double>& dist) const
+{
+	size_t n = m_idx.size();
+	k = std::min(k, n);
+	idx.assign(n * k, 0);
+	dist.assign(n * k, 0.0);
+	if (!k)
+		return;
+	std::vector<std::vector<Item>> heaps(GetThreadNum(m_thread_num));
+	ParallelForDynamic(n, [&](size_t i, unsigned int t)
+	{
+		std::vector<Item>& heap = heaps[t];
+		heap.clear();
+		SearchKnn(&m_pts[i * 3], k, 0, n, heap);
+		std::sort_heap(heap.begin(), heap.end());
+		for (size_t j = 0; j < k; ++j)
+		{
+			idx[i * k + j] = heap[j].i;
+			dist[i * k + j] = std::sqrt(heap[j].d2);
+		}
+	}, 64, m_thread_num);
+}
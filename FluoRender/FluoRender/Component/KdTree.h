@@ -0,0 +1,97 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_KdTree_h
+#define FL_KdTree_h
+
+#include <Point.h>
+#include <vector>
+#include <cstddef>
+
+namespace flrd
+{
+	//static k-d tree over 3d points
+	//stored as a permutation of the input, split at the median
+	//results are sorted by distance, ties by index
+	class KdTree
+	{
+	public:
+		KdTree();
+		~KdTree();
+
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+
+		void Build(const std::vector<fluo::Point>& pts);
+		size_t GetSize() { return m_idx.size(); }
+
+		//k nearest points to p
+		void Knn(const fluo::Point& p, size_t k,
+			std::vector<unsigned int>& idx,
+			std::vector<double>& dist) const;
+		//all points within distance r to p
+		void Radius(const fluo::Point& p, double r,
+			std::vector<unsigned int>& idx,
+			std::vector<double>& dist) const;
+		//k nearest points for every input point, including itself
+		//results are k per point, row by row
+		void KnnAll(size_t k,
+			std::vector<unsigned int>& idx,
+			std::vector<double>& dist) const;
+
+	private:
+		std::vector<double> m_pts;//xyz
+		std::vector<unsigned int> m_idx;//permutation
+		std::vector<unsigned char> m_axis;//split axis at median
+		unsigned int m_thread_num = 0;
+
+		struct Item
+		{
+			double d2;
+			unsigned int i;
+			bool operator<(const Item& o) const
+			{
+				return d2 < o.d2 || (d2 == o.d2 && i < o.i);
+			}
+		};
+
+		void Split(size_t lo, size_t hi);
+		void SearchKnn(const double* p, size_t k,
+			size_t lo, size_t hi, std::vector<Item>& heap) const;
+		void SearchRadius(const double* p, double r2,
+			size_t lo, size_t hi, std::vector<Item>& list) const;
+		double Dist2(const double* p, unsigned int i) const
+		{
+			const double* q = &m_pts[size_t(i) * 3];
+			double x = p[0] - q[0];
+			double y = p[1] - q[1];
+			double z = p[2] - q[2];
+			return x * x + y * y + z * z;
+		}
+	};
+}
+
+#endif//FL_KdTree_h
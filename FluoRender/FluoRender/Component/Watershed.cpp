@@ -0,0 +1,500 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <Watershed.h>
+#include <Parallel.h>
+#include <unordered_map>
+#include <queue>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace flrd;
+
+Watershed::Watershed()
+{
+}
+
+Watershed::~Watershed()
+{
+}
+
+bool Watershed::Compute()
+{
+	m_comp_num = 0;
+	m_split_num = 0;
+	m_skip_num = 0;
+	m_mem_used = 0;
+	if (!m_data || !m_label ||
+		!m_nx || !m_ny || !m_nz)
+		return false;
+
+	std::vector<CompBox> comps;
+	CollectComps(comps);
+	m_comp_num = comps.size();
+	if (comps.empty())
+		return true;
+
+	//ids in use
+	m_used_ids.clear();
+	unsigned int max_id = 0;
+	for (auto& it : comps)
+	{
+		m_used_ids.insert(it.id);
+		max_id = std::max(max_id, it.id);
+	}
+	m_next_id = max_id + 1;
+	if (m_next_id == 0)
+		m_next_id = 1;
+
+	//large components first for better load balance
+	std::sort(comps.begin(), comps.end(),
+		[](const CompBox& a, const CompBox& b)
+		{
+			if (a.count != b.count)
+				return a.count > b.count;
+			return a.id < b.id;
+		});
+
+	ParallelForDynamic(comps.size(),
+		[&](size_t i, unsigned int)
+		{
+			size_t bytes = BlockBytes(comps[i]);
+			if (!AcquireMem(bytes))
+			{
+				m_skip_num++;
+				return;
+			}
+			SplitComp(comps[i]);
+			ReleaseMem(bytes);
+		}, 1, m_thread_num);
+
+	return true;
+}
+
+void Watershed::CollectComps(std::vector<CompBox>& comps)
+{
+	unsigned int tn = GetThreadNum(m_thread_num);
+	std::vector<std::unordered_map<unsigned int, CompBox>> local(tn);
+	size_t nxy = m_nx * m_ny;
+
+	//scan z slabs in memory order
+	ParallelFor(m_nz,
+		[&](size_t zb, size_t ze, unsigned int t)
+		{
+			auto& boxes = local[t];
+			for (size_t k = zb; k < ze; ++k)
+			for (size_t j = 0; j < m_ny; ++j)
+			{
+				size_t index = nxy * k + m_nx * j;
+				for (size_t i = 0; i < m_nx; ++i, ++index)
+				{
+					unsigned int id = m_label[index];
+					if (!id)
+						continue;
+					if (m_mask && !m_mask[index])
+						continue;
+					auto it = boxes.find(id);
+					if (it == boxes.end())
+					{
+						boxes.insert(std::pair<unsigned int, CompBox>(id,
+							CompBox{ id, 1, i, j, k, i, j, k }));
+						continue;
+					}
+					CompBox& b = it->second;
+					b.count++;
+					b.x0 = std::min(b.x0, i); b.x1 = std::max(b.x1, i);
+					b.y0 = std::min(b.y0, j); b.y1 = std::max(b.y1, j);
+					b.z0 = std::min(b.z0, k); b.z1 = std::max(b.z1, k);
+				}
+			}
+		}, tn);
+
+	//reduce in thread order
+	std::unordered_map<unsigned int, CompBox> all;
+	for (auto& boxes : local)
+	for (auto& it : boxes)
+	{
+		auto it2 = all.find(it.first);
+		if (it2 == all.end())
+		{
+			all.insert(it);
+			continue;
+		}
+		CompBox& a = it2->second;
+		const CompBox& b = it.second;
+		a.count += b.count;
+		a.x0 = std::min(a.x0, b.x0); a.x1 = std::max(a.x1, b.x1);
+		a.y0 = std::min(a.y0, b.y0); a.y1 = std::max(a.y1, b.y1);
+		a.z0 = std::min(a.z0, b.z0); a.z1 = std::max(a.z1, b.z1);
+	}
+	comps.reserve(all.size());
+	for (auto& it : all)
+		comps.push_back(it.second);
+}
+
+size_t Watershed::BlockBytes(const CompBox& comp)
+{
+	size_t ln = (comp.x1 - comp.x0 + 3) *
+		(comp.y1 - comp.y0 + 3) * (comp.z1 - comp.z0 + 3);
+	//inside flags, intensity, reconstruction and the queue for it,
+	//distance field if used, flooding queue of the component voxels
+	bool use_dist = m_marker == MK_DIST || m_dist_weight > 0.0;
+	size_t per_voxel = 1 + 4 + 4 + sizeof(size_t) + (use_dist ? 4 : 0);
+	return ln * per_voxel + comp.count * 3 * sizeof(size_t);
+}
+
+bool Watershed::AcquireMem(size_t bytes)
+{
+	if (!m_mem_limit)
+		return true;
+	if (bytes > m_mem_limit)
+		return false;
+	std::unique_lock<std::mutex> lock(m_mem_mutex);
+	m_mem_cv.wait(lock, [&]() { return m_mem_used + bytes <= m_mem_limit; });
+	m_mem_used += bytes;
+	return true;
+}
+
+void Watershed::ReleaseMem(size_t bytes)
+{
+	if (!m_mem_limit)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mem_mutex);
+		m_mem_used -= bytes;
+	}
+	m_mem_cv.notify_all();
+}
+
+unsigned int Watershed::NewId()
+{
+	std::lock_guard<std::mutex> lock(m_id_mutex);
+	for (;;)
+	{
+		unsigned int id = m_next_id++;
+		if (m_next_id == 0)
+			m_next_id = 1;
+		if (id && m_used_ids.find(id) == m_used_ids.end())
+		{
+			m_used_ids.insert(id);
+			m_split_num++;
+			return id;
+		}
+	}
+}
+
+void Watershed::Edt1D(float* f, size_t n, size_t stride, float sp,
+	std::vector<float>& d, std::vector<int>& v, std::vector<float>& z)
+{
+	//lower envelope of parabolas (felzenszwalb and huttenlocher)
+	const float inf = std::numeric_limits<float>::max();
+	if (d.size() < n) d.resize(n);
+	if (v.size() < n) v.resize(n);
+	if (z.size() < n + 1) z.resize(n + 1);
+	int k = 0;
+	v[0] = 0;
+	z[0] = -inf;
+	z[1] = inf;
+	for (size_t q = 1; q < n; ++q)
+	{
+		double fq = f[q * stride];
+		double xq = q * sp;
+		double xv = v[k] * sp;
+		double s = ((fq + xq * xq) - (f[v[k] * stride] + xv * xv)) / (2.0 * (xq - xv));
+		while (s <= z[k])
+		{
+			k--;
+			xv = v[k] * sp;
+			s = ((fq + xq * xq) - (f[v[k] * stride] + xv * xv)) / (2.0 * (xq - xv));
+		}
+		k++;
+		v[k] = static_cast<int>(q);
+		z[k] = float(s);
+		z[k + 1] = inf;
+	}
+	k = 0;
+	for (size_t q = 0; q < n; ++q)
+	{
+		float xq = q * sp;
+		while (z[k + 1] < xq)
+			k++;
+		float dx = xq - v[k] * sp;
+		d[q] = dx * dx + f[v[k] * stride];
+	}
+	for (size_t q = 0; q < n; ++q)
+		f[q * stride] = d[q];
+}
+
+void Watershed::SplitComp(const CompBox& comp)
+{
+	if (comp.count < 2)
+		return;
+
+	//local block with a one-voxel empty border
+	//the marker relief is read from dist or fval, buffers are released
+	//as soon as a stage is done to keep the block small
+	long long lx = (long long)(comp.x1 - comp.x0) + 3;
+	long long ly = (long long)(comp.y1 - comp.y0) + 3;
+	long long lz = (long long)(comp.z1 - comp.z0) + 3;
+	long long lxy = lx * ly;
+	size_t ln = size_t(lxy * lz);
+	size_t nxy = m_nx * m_ny;
+
+	std::vector<unsigned char> inside(ln, 0);
+	std::vector<float> fval(ln, 0.0f);
+	for (size_t k = comp.z0; k <= comp.z1; ++k)
+	for (size_t j = comp.y0; j <= comp.y1; ++j)
+	{
+		size_t gi = nxy * k + m_nx * j + comp.x0;
+		size_t li = size_t(lxy * (k - comp.z0 + 1) + lx * (j - comp.y0 + 1) + 1);
+		for (size_t i = comp.x0; i <= comp.x1; ++i, ++gi, ++li)
+		{
+			if (m_label[gi] != comp.id)
+				continue;
+			if (m_mask && !m_mask[gi])
+				continue;
+			inside[li] = 1;
+			fval[li] = GetValue(gi);
+		}
+	}
+
+	//distance field
+	bool use_dist = m_marker == MK_DIST || m_dist_weight > 0.0;
+	std::vector<float> dist;
+	float dmax = 0.0f;
+	if (use_dist)
+	{
+		const float big = 1e20f;
+		dist.resize(ln);
+		for (size_t i = 0; i < ln; ++i)
+			dist[i] = inside[i] ? big : 0.0f;
+		double minsp = std::min(m_sx, std::min(m_sy, m_sz));
+		if (minsp <= 0.0)
+			minsp = 1.0;
+		float spx = float(m_sx > 0.0 ? m_sx / minsp : 1.0);
+		float spy = float(m_sy > 0.0 ? m_sy / minsp : 1.0);
+		float spz = float(m_sz > 0.0 ? m_sz / minsp : 1.0);
+		std::vector<float> d, z;
+		std::vector<int> v;
+		for (long long k = 0; k < lz; ++k)
+		for (long long j = 0; j < ly; ++j)
+			Edt1D(&dist[size_t(lxy * k + lx * j)], size_t(lx), 1, spx, d, v, z);
+		for (long long k = 0; k < lz; ++k)
+		for (long long i = 0; i < lx; ++i)
+			Edt1D(&dist[size_t(lxy * k + i)], size_t(ly), size_t(lx), spy, d, v, z);
+		for (long long j = 0; j < ly; ++j)
+		for (long long i = 0; i < lx; ++i)
+			Edt1D(&dist[size_t(lx * j + i)], size_t(lz), size_t(lxy), spz, d, v, z);
+		for (size_t i = 0; i < ln; ++i)
+		{
+			dist[i] = std::sqrt(dist[i]);
+			dmax = std::max(dmax, dist[i]);
+		}
+	}
+
+	//marker relief, only read inside
+	const std::vector<float>& g = m_marker == MK_DIST ? dist : fval;
+
+	//neighbors
+	long long nb26[26];
+	int nbn = 0;
+	for (int dz = -1; dz <= 1; ++dz)
+	for (int dy = -1; dy <= 1; ++dy)
+	for (int dx = -1; dx <= 1; ++dx)
+	{
+		if (!dx && !dy && !dz)
+			continue;
+		nb26[nbn++] = lxy * dz + lx * dy + dx;
+	}
+	//nb26 is sorted, first 13 precede the center in raster order
+	long long nb6[6] = { -lxy, -lx, -1, 1, lx, lxy };
+
+	//h-maxima: reconstruction by dilation of g-h under g
+	//outside is below everything
+	float h = float(std::max(m_h, 1e-4));
+	std::vector<float> rec(ln, -1e30f);
+	for (size_t i = 0; i < ln; ++i)
+		if (inside[i])
+			rec[i] = g[i] - h;
+	for (size_t p = 0; p < ln; ++p)
+	{
+		if (!inside[p])
+			continue;
+		float m = rec[p];
+		for (int n = 0; n < 13; ++n)
+			m = std::max(m, rec[p + nb26[n]]);
+		rec[p] = std::min(m, g[p]);
+	}
+	std::deque<size_t> fifo;
+	for (size_t p = ln; p-- > 0;)
+	{
+		if (!inside[p])
+			continue;
+		float m = rec[p];
+		for (int n = 13; n < 26; ++n)
+			m = std::max(m, rec[p + nb26[n]]);
+		rec[p] = std::min(m, g[p]);
+		for (int n = 13; n < 26; ++n)
+		{
+			size_t q = p + nb26[n];
+			if (inside[q] && rec[q] < rec[p] && rec[q] < g[q])
+			{
+				fifo.push_back(p);
+				break;
+			}
+		}
+	}
+	while (!fifo.empty())
+	{
+		size_t p = fifo.front();
+		fifo.pop_front();
+		for (int n = 0; n < 26; ++n)
+		{
+			size_t q = p + nb26[n];
+			if (inside[q] && rec[q] < rec[p] && rec[q] != g[q])
+			{
+				rec[q] = std::min(rec[p], g[q]);
+				fifo.push_back(q);
+			}
+		}
+	}
+
+	//flag dome tops in inside and release the reconstruction
+	float eps = h * 1e-3f;
+	for (size_t p = 0; p < ln; ++p)
+		if (inside[p] && g[p] - rec[p] >= h - eps)
+			inside[p] = 2;
+	std::vector<float>().swap(rec);
+	std::deque<size_t>().swap(fifo);
+
+	//label dome tops as markers
+	std::vector<unsigned int> mk(ln, 0);
+	std::vector<size_t> mk_size(1, 0);
+	unsigned int mk_num = 0;
+	for (size_t p = 0; p < ln; ++p)
+	{
+		if (inside[p] != 2 || mk[p])
+			continue;
+		mk_num++;
+		size_t size = 0;
+		mk[p] = mk_num;
+		fifo.push_back(p);
+		while (!fifo.empty())
+		{
+			size_t c = fifo.front();
+			fifo.pop_front();
+			size++;
+			for (int n = 0; n < 26; ++n)
+			{
+				size_t q = c + nb26[n];
+				if (inside[q] == 2 && !mk[q])
+				{
+					mk[q] = mk_num;
+					fifo.push_back(q);
+				}
+			}
+		}
+		mk_size.push_back(size);
+	}
+	if (mk_num < 2)
+		return;
+
+	//flooding relief, in place of the intensity
+	float w = float(std::min(std::max(m_dist_weight, 0.0), 1.0));
+	std::vector<float>& prio = fval;
+	for (size_t i = 0; i < ln; ++i)
+	{
+		if (!inside[i])
+			continue;
+		float pv = 1.0f - fval[i];
+		if (use_dist && w > 0.0f && dmax > 0.0f)
+			pv = (1.0f - w) * pv + w * (1.0f - dist[i] / dmax);
+		prio[i] = pv;
+	}
+	std::vector<float>().swap(dist);
+
+	//priority flood, ties are resolved in insertion order
+	struct FloodItem
+	{
+		float p;
+		unsigned long long order;
+		size_t index;
+		bool operator>(const FloodItem& o) const
+		{
+			if (p != o.p)
+				return p > o.p;
+			return order > o.order;
+		}
+	};
+	std::priority_queue<FloodItem, std::vector<FloodItem>,
+		std::greater<FloodItem>> pq;
+	unsigned long long order = 0;
+	for (size_t p = 0; p < ln; ++p)
+		if (mk[p])
+			pq.push(FloodItem{ prio[p], order++, p });
+	while (!pq.empty())
+	{
+		FloodItem item = pq.top();
+		pq.pop();
+		for (int n = 0; n < 6; ++n)
+		{
+			size_t q = item.index + nb6[n];
+			if (!inside[q] || mk[q])
+				continue;
+			mk[q] = mk[item.index];
+			pq.push(FloodItem{ std::max(prio[q], item.p), order++, q });
+		}
+	}
+
+	//the largest basin keeps the original id
+	std::vector<unsigned int> rank(mk_num);
+	for (unsigned int i = 0; i < mk_num; ++i)
+		rank[i] = i + 1;
+	std::stable_sort(rank.begin(), rank.end(),
+		[&](unsigned int a, unsigned int b)
+		{
+			return mk_size[a] > mk_size[b];
+		});
+	std::vector<unsigned int> ids(mk_num + 1, comp.id);
+	for (unsigned int i = 1; i < mk_num; ++i)
+		ids[rank[i]] = NewId();
+
+	//write back, voxels of this component are not touched by other threads
+	for (size_t k = comp.z0; k <= comp.z1; ++k)
+	for (size_t j = comp.y0; j <= comp.y1; ++j)
+	{
+		size_t gi = nxy * k + m_nx * j + comp.x0;
+		size_t li = size_t(lxy * (k - comp.z0 + 1) + lx * (j - comp.y0 + 1) + 1);
+		for (size_t i = comp.x0; i <= comp.x1; ++i, ++gi, ++li)
+		{
+			if (inside[li] && mk[li])
+				m_label[gi] = ids[mk[li]];
+		}
+	}
+}
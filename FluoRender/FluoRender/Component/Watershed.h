@@ -0,0 +1,166 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_Watershed_h
+#define FL_Watershed_h
+
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+namespace flrd
+{
+	//marker-controlled watershed for splitting touching components
+	//each existing label is flooded separately, so components are
+	//processed in parallel and a split never crosses a label border
+	//each component works on a block of its bounding box, and blocks
+	//in flight share a memory limit; components whose block alone
+	//exceeds the limit are left unsplit
+	class Watershed
+	{
+	public:
+		enum MarkerType
+		{
+			MK_DIST = 0,//h-maxima of the distance field
+			MK_INTENSITY = 1//h-maxima of the intensity
+		};
+
+		Watershed();
+		~Watershed();
+
+		void SetSize(size_t nx, size_t ny, size_t nz)
+		{
+			m_nx = nx; m_ny = ny; m_nz = nz;
+		}
+		void SetSpacing(double sx, double sy, double sz)
+		{
+			m_sx = sx; m_sy = sy; m_sz = sz;
+		}
+		//8- or 16-bit intensity, scale is the scalar scale of 16-bit data
+		void SetData(void* data, int bits, double scale)
+		{
+			m_data = data; m_bits = bits; m_scale = scale;
+		}
+		//optional, only masked voxels are flooded
+		void SetMask(unsigned char* mask) { m_mask = mask; }
+		void SetLabel(unsigned int* label) { m_label = label; }
+
+		void SetMarkerType(int val) { m_marker = val; }
+		int GetMarkerType() { return m_marker; }
+		//dynamic of a marker, in voxels for distance markers,
+		//normalized intensity for intensity markers
+		void SetH(double val) { m_h = val; }
+		double GetH() { return m_h; }
+		//blend of the inverted distance into the flooding relief
+		//0: inverted intensity only
+		void SetDistWeight(double val) { m_dist_weight = val; }
+		double GetDistWeight() { return m_dist_weight; }
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+		//bytes for all blocks in flight, 0 for no limit
+		void SetMemLimit(size_t val) { m_mem_limit = val; }
+		size_t GetMemLimit() { return m_mem_limit; }
+
+		//split the label volume in place
+		//returns false if input is incomplete
+		bool Compute();
+
+		size_t GetCompNum() { return m_comp_num; }
+		size_t GetSplitNum() { return m_split_num; }
+		//components too large for the memory limit
+		size_t GetSkipNum() { return m_skip_num; }
+
+	private:
+		size_t m_nx = 0;
+		size_t m_ny = 0;
+		size_t m_nz = 0;
+		double m_sx = 1.0;
+		double m_sy = 1.0;
+		double m_sz = 1.0;
+		void* m_data = nullptr;
+		int m_bits = 8;
+		double m_scale = 1.0;
+		unsigned char* m_mask = nullptr;
+		unsigned int* m_label = nullptr;
+
+		int m_marker = MK_DIST;
+		double m_h = 2.0;
+		double m_dist_weight = 0.0;
+		unsigned int m_thread_num = 0;
+		size_t m_mem_limit = 0;
+
+		//results
+		size_t m_comp_num = 0;
+		size_t m_split_num = 0;
+		std::atomic<size_t> m_skip_num{ 0 };
+
+		//memory of blocks in flight
+		std::mutex m_mem_mutex;
+		std::condition_variable m_mem_cv;
+		size_t m_mem_used = 0;
+
+		//unique id generation
+		std::mutex m_id_mutex;
+		std::unordered_set<unsigned int> m_used_ids;
+		unsigned int m_next_id = 1;
+
+		struct CompBox
+		{
+			unsigned int id;
+			size_t count;
+			size_t x0, y0, z0;
+			size_t x1, y1, z1;
+		};
+
+	private:
+		void CollectComps(std::vector<CompBox>& comps);
+		void SplitComp(const CompBox& comp);
+		//upper bound of the working memory of a block
+		size_t BlockBytes(const CompBox& comp);
+		//wait until the block fits, false if it never will
+		bool AcquireMem(size_t bytes);
+		void ReleaseMem(size_t bytes);
+		unsigned int NewId();
+
+		float GetValue(size_t index);
+		//squared euclidean distance along one axis of a strided line
+		static void Edt1D(float* f, size_t n, size_t stride, float sp,
+			std::vector<float>& d, std::vector<int>& v, std::vector<float>& z);
+	};
+
+	inline float Watershed::GetValue(size_t index)
+	{
+		if (m_bits == 8)
+			return ((unsigned char*)m_data)[index] / 255.0f;
+		float val = float(((unsigned short*)m_data)[index] * m_scale / 65535.0);
+		return val > 1.0f ? 1.0f : val;
+	}
+}
+
+#endif//FL_Watershed_h
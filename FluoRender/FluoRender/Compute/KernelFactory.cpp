@@ -68,6 +68,15 @@ namespace flvr
 		}
 	}
 
+	size_t KernelFactory::get_buf_size()
+	{
+		size_t size = 0;
+		for (auto& prog : programs_)
+			if (prog)
+				size += prog->get_buf_size();
+		return size;
+	}
+
 	KernelProgram* KernelFactory::program(std::string s, int bits, float max_int)
 	{
 		//change string according to bits
@@ -45,6 +45,8 @@ namespace flvr
 		KernelProgram* program(std::string s, int bits, float max_int);
 		void clear();
 		void clear(KernelProgram* prog);
+		//bytes of buffers of all programs
+		size_t get_buf_size();
 
 	protected:
 		std::vector<std::shared_ptr<KernelProgram>> programs_;
@@ -1173,6 +1173,17 @@ namespace flvr
 		arg_map_.erase(kernel_idx); // weak_ptrs dropped
 	}
 
+	size_t KernelProgram::get_buf_size()
+	{
+		size_t size = 0;
+		for (auto& arg : arg_list_)
+		{
+			if (arg && arg->valid_ && !arg->tex_ && !arg->vbo_)
+				size += arg->size_;
+		}
+		return size;
+	}
+
 	void KernelProgram::releaseArg(const std::weak_ptr<Argument>& arg)
 	{
 		auto shared_arg = arg.lock();
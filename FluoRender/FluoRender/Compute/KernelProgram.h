@@ -249,6 +249,9 @@ namespace flvr
 		void releaseAllArgs();
 		void releaseKernelArgs(int kernel_idx);
 		void releaseArg(const std::weak_ptr<Argument>&);
+		//bytes of buffers created by the program
+		//buffers shared with gl objects are not counted
+		size_t get_buf_size();
 
 		//initialization
 		static void init_kernels_supported();
@@ -35,6 +35,7 @@ ColocalDefault::ColocalDefault()
 {
 	m_use_mask = false;
 	m_method = 2;
+	m_single_pass = true;
 	m_int_weighted = false;
 	m_get_ratio = false;
 	m_physical_size = false;
@@ -60,6 +61,7 @@ void ColocalDefault::Read()
 
 	f->Read("use mask", &m_use_mask, false);
 	f->Read("method", &m_method, 2);
+	f->Read("single pass", &m_single_pass, true);
 	f->Read("int weighted", &m_int_weighted, false);
 	f->Read("get ratio", &m_get_ratio, false);
 	f->Read("physical size", &m_physical_size, false);
@@ -79,6 +81,7 @@ void ColocalDefault::Save()
 
 	f->Write("use mask", m_use_mask);
 	f->Write("method", m_method);
+	f->Write("single pass", m_single_pass);
 	f->Write("int weighted", m_int_weighted);
 	f->Write("get ratio", m_get_ratio);
 	f->Write("physical size", m_physical_size);
@@ -55,7 +55,8 @@ public:
 	//default values
 	bool m_use_mask;
 	//method
-	int m_method;//0:dot product; 1:min value; 2:threshold
+	int m_method;//0:dot product; 1:min value; 2:threshold; 3:pearson; 4:manders
+	bool m_single_pass;//all channels together from memory
 	//format
 	bool m_int_weighted;
 	bool m_get_ratio;
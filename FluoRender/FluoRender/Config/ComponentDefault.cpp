@@ -68,6 +68,13 @@ ComponentDefault::ComponentDefault()
 	m_clean_iter = 5;
 	m_clean_size_vl = 5;
 	m_fill_border = 0.1;
+	m_watershed = false;
+	m_ws_marker = 0;
+	m_ws_h = 2.0;
+	m_ws_dist_weight = 0.0;
+	m_ws_mem = 2048;
+	m_out_core = false;
+	m_out_core_mem = 1024;
 
 	//noise removal
 	m_nr_thresh = 0.5;
@@ -84,6 +91,8 @@ ComponentDefault::ComponentDefault()
 	m_cluster_tol = 0.9f;
 	m_cluster_size = 60;
 	m_cluster_eps = 2.5;
+	m_cluster_plus_plus = false;
+	m_cluster_batch = 0;
 
 	//selection
 	m_use_min = false;
@@ -171,6 +180,13 @@ void ComponentDefault::Read(const std::string& gst_file)
 	f->Read("clean_size_vl", &m_clean_size_vl);
 	f->Read("grow_fixed", &m_grow_fixed);
 	f->Read("fill_border", &m_fill_border);
+	f->Read("watershed", &m_watershed);
+	f->Read("ws_marker", &m_ws_marker);
+	f->Read("ws_h", &m_ws_h);
+	f->Read("ws_dist_weight", &m_ws_dist_weight);
+	f->Read("ws_mem", &m_ws_mem);
+	f->Read("out_core", &m_out_core);
+	f->Read("out_core_mem", &m_out_core_mem);
 
 	//noise removal
 	f->Read("nr thresh", &m_nr_thresh);
@@ -188,6 +204,8 @@ void ComponentDefault::Read(const std::string& gst_file)
 	f->Read("cluster_tol", &m_cluster_tol);
 	f->Read("cluster_size", &m_cluster_size);
 	f->Read("cluster_eps", &m_cluster_eps);
+	f->Read("cluster_plus_plus", &m_cluster_plus_plus);
+	f->Read("cluster_batch", &m_cluster_batch);
 
 	//selection
 	f->Read("use_min", &m_use_min);
@@ -242,6 +260,13 @@ void ComponentDefault::Save(const std::string& gst_file)
 	f->Write("clean_size_vl", m_clean_size_vl);
 	f->Write("grow_fixed", m_grow_fixed);
 	f->Write("fill_border", m_fill_border);
+	f->Write("watershed", m_watershed);
+	f->Write("ws_marker", m_ws_marker);
+	f->Write("ws_h", m_ws_h);
+	f->Write("ws_dist_weight", m_ws_dist_weight);
+	f->Write("ws_mem", m_ws_mem);
+	f->Write("out_core", m_out_core);
+	f->Write("out_core_mem", m_out_core_mem);
 
 	//noise removal
 	f->Write("nr thresh", m_nr_thresh);
@@ -259,6 +284,8 @@ void ComponentDefault::Save(const std::string& gst_file)
 	f->Write("cluster_tol", m_cluster_tol);
 	f->Write("cluster_size", m_cluster_size);
 	f->Write("cluster_eps", m_cluster_eps);
+	f->Write("cluster_plus_plus", m_cluster_plus_plus);
+	f->Write("cluster_batch", m_cluster_batch);
 
 	//selection
 	f->Write("use_min", m_use_min);
@@ -313,6 +340,13 @@ void ComponentDefault::Set(flrd::ComponentGenerator* cg)
 	m_clean_iter = cg->GetCleanIter();
 	m_clean_size_vl = cg->GetCleanSize();
 	m_fill_border = cg->GetFillBorder();
+	m_watershed = cg->GetWatershed();
+	m_ws_marker = cg->GetWsMarker();
+	m_ws_h = cg->GetWsH();
+	m_ws_dist_weight = cg->GetWsDistWeight();
+	m_ws_mem = cg->GetWsMem();
+	m_out_core = cg->GetOutOfCore();
+	m_out_core_mem = cg->GetOutOfCoreMem();
 }
 
 void ComponentDefault::Apply(flrd::ComponentGenerator* cg)
@@ -346,6 +380,13 @@ void ComponentDefault::Apply(flrd::ComponentGenerator* cg)
 	cg->SetCleanIter(m_clean_iter);
 	cg->SetCleanSize(m_clean_size_vl);
 	cg->SetFillBorder(m_fill_border);
+	cg->SetWatershed(m_watershed);
+	cg->SetWsMarker(m_ws_marker);
+	cg->SetWsH(m_ws_h);
+	cg->SetWsDistWeight(m_ws_dist_weight);
+	cg->SetWsMem(m_ws_mem);
+	cg->SetOutOfCore(m_out_core);
+	cg->SetOutOfCoreMem(m_out_core_mem);
 }
 
 void ComponentDefault::Set(flrd::Clusterizer* cl)
@@ -359,6 +400,8 @@ void ComponentDefault::Set(flrd::Clusterizer* cl)
 	m_cluster_tol = cl->GetTol();
 	m_cluster_size = cl->GetSize();
 	m_cluster_eps = cl->GetEps();
+	m_cluster_plus_plus = cl->GetPlusPlus();
+	m_cluster_batch = cl->GetBatch();
 }
 
 void ComponentDefault::Apply(flrd::Clusterizer* cl)
@@ -372,6 +415,8 @@ void ComponentDefault::Apply(flrd::Clusterizer* cl)
 	cl->SetTol(m_cluster_tol);
 	cl->SetSize(m_cluster_size);
 	cl->SetEps(m_cluster_eps);
+	cl->SetPlusPlus(m_cluster_plus_plus);
+	cl->SetBatch(m_cluster_batch);
 }
 
 void ComponentDefault::Set(flrd::ComponentSelector* cs)
@@ -91,6 +91,15 @@ public:
 	int m_clean_size_vl;
 	//fill borders
 	double m_fill_border;
+	//watershed
+	bool m_watershed;
+	int m_ws_marker;
+	double m_ws_h;
+	double m_ws_dist_weight;
+	int m_ws_mem;
+	//out of core, saves memory for brkxml volumes only
+	bool m_out_core;
+	int m_out_core_mem;
 
 	//noise removal settings
 	double m_nr_thresh;
@@ -108,6 +117,8 @@ public:
 	float m_cluster_tol;
 	int m_cluster_size;
 	double m_cluster_eps;
+	bool m_cluster_plus_plus;//kmeans++ seeding
+	int m_cluster_batch;//kmeans mini-batch size, 0 for full passes
 
 	//selection
 	bool m_use_min;
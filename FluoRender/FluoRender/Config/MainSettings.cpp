@@ -66,6 +66,7 @@ MainSettings::MainSettings()
 	m_ser_num = 0;
 	m_skip_brick = false;
 	m_load_mask = true;
+	m_label_compact = false;
 	m_save_crop = false;
 	m_save_filter = 0;
 	m_vrp_embed = false;
@@ -76,9 +77,16 @@ MainSettings::MainSettings()
 	m_mov_bitrate = 20.0;
 	m_mov_filename = L"output.mp4";
 	m_mpg_cache_size = -1;
+	m_mesh_cache = false;
 	m_fp_convert = false;
 	m_fp_min = 0;
 	m_fp_max = 1;
+	m_bit_reduce = 0;
+	m_bit_reduce_lo = 0.1;
+	m_bit_reduce_hi = 99.9;
+	m_bit_reduce_gamma = 1.0;
+	m_bit_reduce_min = 0;
+	m_bit_reduce_max = 0;
 	m_prg_size = 1e8;
 
 	m_script_break = true;
@@ -157,6 +165,13 @@ MainSettings::MainSettings()
 	m_invalidate_tex = false;
 	m_detail_level_offset = 0;
 	m_inf_loop = false;
+	m_buffer_pool_size = 2048.0;
+	m_buffer_pool_huge = true;
+	m_frame_cache_size = 1024.0;
+	m_mem_log_interval = 0.0;
+	m_mip_mode = 1;
+	m_mip_size = 500.0;
+	m_mip_pixel = 2.0;
 
 	m_bg_type = 0;
 	m_kx = 100;
@@ -191,6 +206,7 @@ MainSettings::MainSettings()
 	m_try_split = false;
 	m_contact_factor = 0.6;
 	m_similarity = 0.5;
+	m_track_ahead = 4;
 
 	m_jvm_path = L"";
 	m_ij_path = L"";
@@ -273,6 +289,7 @@ void MainSettings::Read(const std::string& filename)
 		fconfig->Read("ser num", &m_ser_num, 0);
 		fconfig->Read("skip brick", &m_skip_brick, false);
 		fconfig->Read("load mask", &m_load_mask, true);
+		fconfig->Read("label compact", &m_label_compact, false);
 		fconfig->Read("save crop", &m_save_crop, false);
 		fconfig->Read("save filter", &m_save_filter, 0);
 		fconfig->Read("vrp embed", &m_vrp_embed, false);
@@ -283,9 +300,16 @@ void MainSettings::Read(const std::string& filename)
 		fconfig->Read("mov bitrate", &m_mov_bitrate, 20.0);
 		fconfig->Read("mov filename", &m_mov_filename, std::wstring(L"output.mp4"));
 		fconfig->Read("mpg cache size", &m_mpg_cache_size, -1);
+		fconfig->Read("mesh cache", &m_mesh_cache, false);
 		fconfig->Read("fp convert", &m_fp_convert, false);
 		fconfig->Read("fp min", &m_fp_min, 0.0);
 		fconfig->Read("fp max", &m_fp_max, 1.0);
+		fconfig->Read("bit reduce", &m_bit_reduce, 0);
+		fconfig->Read("bit reduce lo", &m_bit_reduce_lo, 0.1);
+		fconfig->Read("bit reduce hi", &m_bit_reduce_hi, 99.9);
+		fconfig->Read("bit reduce gamma", &m_bit_reduce_gamma, 1.0);
+		fconfig->Read("bit reduce min", &m_bit_reduce_min, 0.0);
+		fconfig->Read("bit reduce max", &m_bit_reduce_max, 0.0);
 		fconfig->Read("prg size", &m_prg_size, 1e8);
 	}
 	//script
@@ -432,6 +456,17 @@ void MainSettings::Read(const std::string& filename)
 		//detail level offset
 		fconfig->Read("detail level offset", &m_detail_level_offset, 0);
 		fconfig->Read("inf loop", &m_inf_loop, false);
+		//volume buffer pool
+		fconfig->Read("buffer pool size", &m_buffer_pool_size, 2048.0);
+		fconfig->Read("buffer pool huge", &m_buffer_pool_huge, true);
+		//compressed frame cache
+		fconfig->Read("frame cache size", &m_frame_cache_size, 1024.0);
+		//memory log
+		fconfig->Read("mem log interval", &m_mem_log_interval, 0.0);
+		//coarse levels
+		fconfig->Read("mip mode", &m_mip_mode, 1);
+		fconfig->Read("mip size", &m_mip_size, 500.0);
+		fconfig->Read("mip pixel", &m_mip_pixel, 2.0);
 	}
 	//background removal paramters
 	if (fconfig->Exists("/bg remove"))
@@ -483,6 +518,7 @@ void MainSettings::Read(const std::string& filename)
 		fconfig->Read("try_split", &m_try_split, false);
 		fconfig->Read("contact_factor", &m_contact_factor, 0.6);
 		fconfig->Read("similarity", &m_similarity, 0.5);
+		fconfig->Read("track_ahead", &m_track_ahead, 4);
 	}
 	// java
 	if (fconfig->Exists("/java"))
@@ -557,6 +593,7 @@ void MainSettings::Save()
 	fconfig->Write("ser num", m_ser_num);
 	fconfig->Write("skip brick", m_skip_brick);
 	fconfig->Write("load mask", m_load_mask);
+	fconfig->Write("label compact", m_label_compact);
 	fconfig->Write("save crop", m_save_crop);
 	fconfig->Write("save filter", m_save_filter);
 	fconfig->Write("vrp embed", m_vrp_embed);
@@ -567,9 +604,16 @@ void MainSettings::Save()
 	fconfig->Write("mov bitrate", m_mov_bitrate);
 	fconfig->Write("mov filename", m_mov_filename);
 	fconfig->Write("mpg cache size", m_mpg_cache_size);
+	fconfig->Write("mesh cache", m_mesh_cache);
 	fconfig->Write("fp convert", m_fp_convert);
 	fconfig->Write("fp min", m_fp_min);
 	fconfig->Write("fp max", m_fp_max);
+	fconfig->Write("bit reduce", m_bit_reduce);
+	fconfig->Write("bit reduce lo", m_bit_reduce_lo);
+	fconfig->Write("bit reduce hi", m_bit_reduce_hi);
+	fconfig->Write("bit reduce gamma", m_bit_reduce_gamma);
+	fconfig->Write("bit reduce min", m_bit_reduce_min);
+	fconfig->Write("bit reduce max", m_bit_reduce_max);
 	fconfig->Write("prg size", m_prg_size);
 
 	//script
@@ -694,6 +738,17 @@ void MainSettings::Save()
 	//detail level offset
 	fconfig->Write("detail level offset", m_detail_level_offset);
 	fconfig->Write("inf loop", m_inf_loop);
+	//volume buffer pool
+	fconfig->Write("buffer pool size", m_buffer_pool_size);
+	fconfig->Write("buffer pool huge", m_buffer_pool_huge);
+	//compressed frame cache
+	fconfig->Write("frame cache size", m_frame_cache_size);
+	//memory log
+	fconfig->Write("mem log interval", m_mem_log_interval);
+	//coarse levels
+	fconfig->Write("mip mode", m_mip_mode);
+	fconfig->Write("mip size", m_mip_size);
+	fconfig->Write("mip pixel", m_mip_pixel);
 
 	//background removal paramters
 	fconfig->SetPath("/bg remove");
@@ -737,6 +792,7 @@ void MainSettings::Save()
 	fconfig->Write("try_split", m_try_split);
 	fconfig->Write("contact_factor", m_contact_factor);
 	fconfig->Write("similarity", m_similarity);
+	fconfig->Write("track_ahead", m_track_ahead);
 
 	// java
 	fconfig->SetPath("/java");
@@ -113,6 +113,7 @@ public:
 	int m_ser_num;			//series number
 	bool m_skip_brick;		//brick skipping
 	bool m_load_mask;		//load volume mask
+	bool m_label_compact;	//label files with dense ids in 8 or 16 bits, labels in memory stay 32 bits
 	bool m_save_crop;		//save crop
 	int m_save_filter;		//filter
 	bool m_vrp_embed;		//embed files in project
@@ -123,9 +124,16 @@ public:
 	double m_mov_bitrate;	//bitrate for mov export (Mbits)
 	std::wstring m_mov_filename;//file name for mov export
 	int m_mpg_cache_size;	//mpeg cache size
+	bool m_mesh_cache;		//save binary copies next to obj files for faster loading
 	bool m_fp_convert;		//convert floating point to int
 	double m_fp_min;		//min value of the floating point number
 	double m_fp_max;		//max value of the floating point number
+	int m_bit_reduce;		//map 16-bit data to 8 bits when reading//0:off; 1:min/max; 2:percentile; 3:gamma; 4:drop low bits
+	double m_bit_reduce_lo;	//low percentile
+	double m_bit_reduce_hi;	//high percentile
+	double m_bit_reduce_gamma;//gamma of the mapping
+	double m_bit_reduce_min;//fixed range, empty for automatic
+	double m_bit_reduce_max;
 	double m_prg_size;		//min data size to show progress in reader
 
 	bool m_run_script;		//script
@@ -212,6 +220,13 @@ public:
 	bool m_invalidate_tex;	//invalidate texture in every loop
 	int m_detail_level_offset;//an offset value to current level of detail (for multiresolution data only)
 	bool m_inf_loop;		//keep the render loop going
+	double m_buffer_pool_size;//idle volume buffers kept for reuse in MB, 0 to disable
+	bool m_buffer_pool_huge;//advise huge pages for volume buffers
+	double m_frame_cache_size;//compressed frames of time sequences kept in MB, 0 to disable
+	double m_mem_log_interval;//seconds between lines of the memory log, 0 to disable
+	int m_mip_mode;			//coarse levels of resident volumes for interaction//0:off; 1:mean; 2:max
+	double m_mip_size;		//data size in MB above which coarse levels are built
+	double m_mip_pixel;		//largest voxel size on screen in pixels when drawing a coarse level
 
 	int m_bg_type;			//background parameters: 0-mean; 1-minmax; 2-median
 	int m_kx, m_ky;			//windows size
@@ -245,6 +260,7 @@ public:
 	bool m_try_split;
 	double m_contact_factor;
 	double m_similarity;
+	int m_track_ahead;		//frames initialized ahead on worker threads, 0 to disable
 
 	std::wstring m_jvm_path;	// java settings strings.
 	std::wstring m_ij_path;
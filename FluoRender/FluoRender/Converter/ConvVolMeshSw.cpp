@@ -32,14 +32,43 @@ DEALINGS IN THE SOFTWARE.
 #include <Texture.h>
 #include <VolumeRenderer.h>
 #include <MCTable.h>
+#include <Parallel.h>
 #include <Utils.h>
 #include <compatibility.h>
 #include <glm.h>
 #include <nrrd.h>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
 
 using namespace flrd;
 
+namespace
+{
+	const unsigned int NO_VERT = 0xffffffff;
+
+	//cube edge to lattice edge: axis (0:x, 1:y, 2:z), corner offset in x and y,
+	//and corner layer (0:lower, 1:upper) for x and y edges
+	const int edge_lattice[12][4] =
+	{
+		{0, 0, 0, 0}, {1, 1, 0, 0}, {0, 0, 1, 0}, {1, 0, 0, 0},
+		{0, 0, 0, 1}, {1, 1, 0, 1}, {0, 0, 1, 1}, {1, 0, 0, 1},
+		{2, 0, 0, 0}, {2, 1, 0, 0}, {2, 1, 1, 0}, {2, 0, 1, 0}
+	};
+
+	//results of one z slab
+	struct McSlab
+	{
+		std::vector<float> verts;
+		std::vector<unsigned int> tris;
+		//x and y edge vertices on the first and last corner layers
+		//keyed by (corner index * 2 + axis), in key order
+		std::vector<std::pair<uint64_t, unsigned int>> bottom;
+		std::vector<std::pair<uint64_t, unsigned int>> top;
+	};
+}
+
 ConvVolMeshSw::ConvVolMeshSw() :
 	m_area(0),
 	BaseConvVolMesh()
@@ -57,42 +86,15 @@ void ConvVolMeshSw::Convert()
 		return;
 	m_mesh = std::make_shared<MeshData>();
 	std::wstring name = vd->GetName();
-	m_mesh->SetName(name + L"_MESH");
-	GLMmodel* model = new GLMmodel;
-	if (!model)
-	{
-		SetProgress(0, "FluoRender failed to allocate memory for mesh.");
-		return;
-	}
-	model->pathname = 0;
-	model->mtllibname = 0;
-	model->numvertices = 0;
-	model->vertices = 0;
-	model->numnormals = 0;
-	model->normals = 0;
-	model->numtexcoords = 0;
-	model->texcoords = 0;
-	model->numfacetnorms = 0;
-	model->facetnorms = 0;
-	model->numlines = 0;
-	model->lines = 0;
-	model->numtriangles = 0;
-	model->triangles = 0;
-	model->nummaterials = 0;
-	model->materials = 0;
-	model->numgroups = 0;
-	model->groups = 0;
-	model->position[0] = 0.0f;
-	model->position[1] = 0.0f;
-	model->position[2] = 0.0f;
-	model->hastexture = false;
+	m_mesh->SetName(name + L"_Mesh");
 
 	m_spacing = vd->GetSpacing();
 
 	SetProgress(0, "FluoRender is converting volume to mesh. Please wait.");
 	SetRange(0, 100);
 	//start converting
-	if (!Compute((void*)model))
+	MeshOps mesh;
+	if (!Compute(mesh))
 	{
 		SetProgress(0, "");
 		return;
@@ -103,8 +105,10 @@ void ConvVolMeshSw::Convert()
 
 	//m_info = std::to_string(m_area);
 
-	auto md_name = vd->GetName() + L"_Mesh";
-	m_mesh->Load(model, md_name, L"");
+	SetProgress(90, "FluoRender is converting volume to mesh. Please wait.");
+	SetMesh(mesh, false);
+	//shared edges already give shared vertices
+	m_merged = true;
 
 	SetProgress(0, "");
 }
@@ -116,10 +120,23 @@ void ConvVolMeshSw::Update(bool create_mesh)
 
 void ConvVolMeshSw::MergeVertices(bool avg_normals)
 {
-	GLMmodel* model = m_mesh->GetMesh();
+	GLMmodel* model = m_mesh ? m_mesh->GetMesh() : nullptr;
 	if (!model)
 		return;
 	SetRange(0, 100);
+	if (m_merged)
+	{
+		//vertices are shared, only normals are needed
+		if (avg_normals)
+		{
+			SetProgress(0, "FluoRender is generating normals. Please wait.");
+			MeshOps mesh;
+			if (GetMesh(mesh))
+				SetMesh(mesh, true);
+		}
+		SetProgress(0, "");
+		return;
+	}
 	SetProgress(0, "FluoRender is welding vertices. Please wait.");
 	glmWeld(model, static_cast<GLfloat>(0.001 * m_spacing.minComponent()));
 	if (avg_normals)
@@ -127,27 +144,144 @@ void ConvVolMeshSw::MergeVertices(bool avg_normals)
 		SetProgress(50, "FluoRender is generating normals. Please wait.");
 		glmVertexNormals(model, 89.0f);
 	}
+	m_merged = true;
+	SetProgress(0, "");
+}
+
+void ConvVolMeshSw::Simplify(bool avg_normals)
+{
+	if (!m_mesh)
+		return;
+	MeshOps mesh;
+	if (!GetMesh(mesh))
+		return;
+	double ratio = std::clamp(m_simplify, 0.0, 1.0);
+	size_t target = static_cast<size_t>(
+		std::round(mesh.GetTriangleNum() * (1.0 - ratio)));
+	if (target >= mesh.GetTriangleNum())
+		return;
+
+	SetRange(0, 100);
+	SetProgress(0, "FluoRender is simplifying mesh. Please wait.");
+	mesh.Simplify(target);
+	SetProgress(80, "FluoRender is simplifying mesh. Please wait.");
+	SetMesh(mesh, avg_normals);
 	SetProgress(0, "");
 }
 
-bool ConvVolMeshSw::Compute(void* m)
+void ConvVolMeshSw::Smooth(bool avg_normals)
+{
+	if (!m_mesh)
+		return;
+	MeshOps mesh;
+	if (!GetMesh(mesh))
+		return;
+
+	//taubin smoothing: strength is the shrinking step lambda,
+	//the inflating step mu keeps the pass band at 0.1
+	//scale sets the number of iterations
+	float lambda = static_cast<float>(std::clamp(m_smooth_strength, 0.0, 0.9));
+	if (lambda <= 0.0f)
+		return;
+	float mu = 1.0f / (0.1f - 1.0f / lambda);
+	int iter = std::max(1, static_cast<int>(std::round(m_smooth_scale * 10.0)));
+
+	SetRange(0, 100);
+	SetProgress(0, "FluoRender is smoothing mesh. Please wait.");
+	mesh.Smooth(lambda, mu, iter);
+	SetProgress(80, "FluoRender is smoothing mesh. Please wait.");
+	SetMesh(mesh, avg_normals);
+	SetProgress(0, "");
+}
+
+bool ConvVolMeshSw::GetMesh(MeshOps& mesh)
+{
+	GLMmodel* model = m_mesh ? m_mesh->GetMesh() : nullptr;
+	if (!model || !model->vertices || !model->triangles)
+		return false;
+	std::vector<float>& verts = mesh.Vertices();
+	std::vector<unsigned int>& tris = mesh.Triangles();
+	verts.assign(model->vertices + 3,
+		model->vertices + 3 * (model->numvertices + 1));
+	tris.resize(size_t(model->numtriangles) * 3);
+	for (GLuint i = 0; i < model->numtriangles; ++i)
+	for (int j = 0; j < 3; ++j)
+		tris[i * 3 + j] = model->triangles[i].vindices[j] - 1;
+	return !tris.empty();
+}
+
+void ConvVolMeshSw::SetMesh(MeshOps& mesh, bool avg_normals)
+{
+	if (!m_mesh)
+		return;
+	if (avg_normals)
+		mesh.ComputeNormals();
+
+	GLMmodel* model = (GLMmodel*)calloc(1, sizeof(GLMmodel));
+	if (!model)
+	{
+		SetProgress(0, "FluoRender failed to allocate memory for mesh.");
+		return;
+	}
+	//add default group
+	model->scale[0] = 1.0f;
+	model->scale[1] = 1.0f;
+	model->scale[2] = 1.0f;
+	GLMgroup* group = (GLMgroup*)calloc(1, sizeof(GLMgroup));
+	group->name = STRDUP("default");
+	model->groups = group;
+	model->numgroups = 1;
+
+	//glm indices start from 1
+	size_t vn = mesh.GetVertexNum();
+	size_t tn = mesh.GetTriangleNum();
+	const std::vector<float>& verts = mesh.Vertices();
+	const std::vector<unsigned int>& tris = mesh.Triangles();
+	const std::vector<float>& norms = mesh.Normals();
+	bool has_norms = norms.size() == verts.size() && vn;
+	model->numvertices = static_cast<GLuint>(vn);
+	model->vertices = (GLfloat*)malloc(sizeof(GLfloat) * 3 * (vn + 1));
+	std::copy(verts.begin(), verts.end(), model->vertices + 3);
+	if (has_norms)
+	{
+		model->numnormals = static_cast<GLuint>(vn);
+		model->normals = (GLfloat*)malloc(sizeof(GLfloat) * 3 * (vn + 1));
+		std::copy(norms.begin(), norms.end(), model->normals + 3);
+	}
+	model->numtriangles = static_cast<GLuint>(tn);
+	model->triangles = (GLMtriangle*)calloc(tn ? tn : 1, sizeof(GLMtriangle));
+	group->numtriangles = static_cast<GLuint>(tn);
+	group->triangles = (GLuint*)malloc(sizeof(GLuint) * (tn ? tn : 1));
+	for (size_t i = 0; i < tn; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			GLuint v = tris[i * 3 + j] + 1;
+			model->triangles[i].vindices[j] = v;
+			if (has_norms)
+				model->triangles[i].nindices[j] = v;
+		}
+		group->triangles[i] = static_cast<GLuint>(i);
+	}
+
+	//the mesh data takes the new model
+	m_mesh->Load(model, m_mesh->GetName(), m_mesh->GetPath());
+}
+
+bool ConvVolMeshSw::Compute(MeshOps& mesh)
 {
 	auto vd = m_volume.lock();
 	if (!vd)
 		return false;
 	if (!m_mesh)
 		return false;
-	GLMmodel* model = static_cast<GLMmodel*>(m);
-	if (!model)
-		return false;
 
-	VolumeData* vol_data = vd.get();
-	Nrrd* nrrd_data = nullptr;
+	Nrrd* nrrd_data = vd->GetVolume(false);
+	Nrrd* nrrd_mask = nullptr;
 	if (m_use_mask)
-		nrrd_data = vd->GetMask(true);
-	else
-		nrrd_data = vd->GetVolume(false);
-	if (!nrrd_data)
+		nrrd_mask = vd->GetMask(true);
+	if (!nrrd_data || !nrrd_data->data ||
+		(m_use_mask && (!nrrd_mask || !nrrd_mask->data)))
 	{
 		SetProgress(0, "FluoRender failed to get volume data.");
 		return false;
@@ -160,210 +294,258 @@ bool ConvVolMeshSw::Compute(void* m)
 	if (m_downsample_z <= 0)
 		m_downsample_z = 1;
 
-	//triangle list
-	std::vector<MCTriangle> tri_list;
-
-	//add default group
-	GLMgroup* group = new GLMgroup;
-	group->name = STRDUP("default");
-	group->material = 0;
-	group->numtriangles = 0;
-	group->triangles = 0;
-	group->next = 0;
-	model->groups = group;
-	model->numgroups = 1;
-
 	//get volume info
-	int nx = int(nrrd_data->axis[0].size);
-	int ny = int(nrrd_data->axis[1].size);
-	int nz = int(nrrd_data->axis[2].size);
-
-	int v1, v2, range;
-	v1 = GetMin();
-	v2 = GetMax();
-	range = GetRange();
-	SetRange(v1, v1 + range / 2);
+	long long nx = (long long)(nrrd_data->axis[0].size);
+	long long ny = (long long)(nrrd_data->axis[1].size);
+	long long nz = (long long)(nrrd_data->axis[2].size);
+	const unsigned char* data8 = nrrd_data->type == nrrdTypeUChar ?
+		(const unsigned char*)nrrd_data->data : nullptr;
+	const unsigned short* data16 = nrrd_data->type == nrrdTypeUShort ?
+		(const unsigned short*)nrrd_data->data : nullptr;
+	if (!data8 && !data16)
+		return false;
+	const unsigned char* mask = nrrd_mask ?
+		(const unsigned char*)nrrd_mask->data : nullptr;
+	float scale = static_cast<float>(vd->GetScalarScale());
+	float iso = static_cast<float>(m_iso);
+	bool use_transfer = m_use_transfer;
+
+	//value at a voxel, 0 outside the volume or the mask
+	auto sample = [&](long long x, long long y, long long z) -> float
+	{
+		if (x < 0 || y < 0 || z < 0 || x >= nx || y >= ny || z >= nz)
+			return 0.0f;
+		uint64_t index = (uint64_t)nx * ny * z + (uint64_t)nx * y + x;
+		if (mask && !mask[index])
+			return 0.0f;
+		if (use_transfer)
+			return static_cast<float>(vd->GetTransferedValue(fluo::Point(x, y, z)));
+		if (data8)
+			return data8[index] / 255.0f;
+		return data16[index] * scale / 65535.0f;
+	};
 
 	//marching cubes
-	//parse the volume data
-	//it has a 1 voxel border, in case the values touch the border
-	int i, j, k;
-	for (k = -1; k < nz + m_downsample_z; k += m_downsample_z)
+	//cube origins are at -1 + a * ds, so the surface is closed at the border
+	//a corner takes the max of the samples at its position and one step back
+	long long ds = m_downsample;
+	long long dz = m_downsample_z;
+	size_t cx = size_t((nx + 2 * ds) / ds);
+	size_t cy = size_t((ny + 2 * ds) / ds);
+	size_t cz = size_t((nz + 2 * dz) / dz);
+	size_t w = cx + 1;//corners in a row
+	size_t h = cy + 1;
+	size_t plane = w * h;
+	size_t sw = cx + 2;//samples in a row
+	size_t sh = cy + 2;
+	double spcx = m_spacing.x(), spcy = m_spacing.y(), spcz = m_spacing.z();
+
+	unsigned int tn = GetThreadNum();
+	if (tn > cz)
+		tn = static_cast<unsigned int>(cz);
+	std::vector<McSlab> slabs(tn);
+
+	ParallelFor(cz, [&](size_t c0, size_t c1, unsigned int t)
 	{
-		SetProgress(100 * (k + 1) / (nz + m_downsample_z + 1),
-			"FluoRender is converting volume to mesh. Please wait.");
-		for (j = -1; j < ny + m_downsample; j += m_downsample)
-		for (i = -1; i < nx + m_downsample; i += m_downsample)
+		McSlab& slab = slabs[t];
+		std::vector<float> s_lo(sw * sh), s_hi(sw * sh);
+		std::vector<float> v_lo(plane), v_hi(plane);
+		std::vector<unsigned int> ex_lo(plane, NO_VERT), ey_lo(plane, NO_VERT);
+		std::vector<unsigned int> ex_hi(plane, NO_VERT), ey_hi(plane, NO_VERT);
+		std::vector<unsigned int> ez(plane, NO_VERT);
+
+		auto fill_samples = [&](size_t layer, std::vector<float>& s)
 		{
-			//current cube is (i, j, k)
-			//27 neighbors
-			double neighbors[3][3][3];
-			int ii, jj, kk;
-			for (ii = 0; ii < 3; ii++)
-				for (jj = 0; jj < 3; jj++)
-					for (kk = 0; kk < 3; kk++)
-						neighbors[ii][jj][kk] =
-						GetValue(vol_data, i + (ii - 1) * m_downsample,
-							j + (jj - 1) * m_downsample, k + (kk - 1) * m_downsample_z);
-			//8 vertices
-			double verts[8];
-			verts[0] = GetMaxNeighbor(neighbors, 0, 0, 0);
-			verts[1] = GetMaxNeighbor(neighbors, 1, 0, 0);
-			verts[2] = GetMaxNeighbor(neighbors, 1, 1, 0);
-			verts[3] = GetMaxNeighbor(neighbors, 0, 1, 0);
-			verts[4] = GetMaxNeighbor(neighbors, 0, 0, 1);
-			verts[5] = GetMaxNeighbor(neighbors, 1, 0, 1);
-			verts[6] = GetMaxNeighbor(neighbors, 1, 1, 1);
-			verts[7] = GetMaxNeighbor(neighbors, 0, 1, 1);
-
-			//calculate cube index
-			int cubeindex = 0;
-			for (int n = 0; n < 8; n++)
-				if (verts[n] <= m_iso)
-					cubeindex |= (1 << n);
-
-			//check if it's completely inside or outside
-			if (!edgeTable[cubeindex])
-				continue;
-
-			//get intersection vertices on edge
-			fluo::Vector intverts[12];
-			if (edgeTable[cubeindex] & 1) intverts[0] = Intersect(verts, 0, 1, i, j, k);
-			if (edgeTable[cubeindex] & 2) intverts[1] = Intersect(verts, 1, 2, i, j, k);
-			if (edgeTable[cubeindex] & 4) intverts[2] = Intersect(verts, 2, 3, i, j, k);
-			if (edgeTable[cubeindex] & 8) intverts[3] = Intersect(verts, 3, 0, i, j, k);
-			if (edgeTable[cubeindex] & 16) intverts[4] = Intersect(verts, 4, 5, i, j, k);
-			if (edgeTable[cubeindex] & 32) intverts[5] = Intersect(verts, 5, 6, i, j, k);
-			if (edgeTable[cubeindex] & 64) intverts[6] = Intersect(verts, 6, 7, i, j, k);
-			if (edgeTable[cubeindex] & 128) intverts[7] = Intersect(verts, 7, 4, i, j, k);
-			if (edgeTable[cubeindex] & 256) intverts[8] = Intersect(verts, 0, 4, i, j, k);
-			if (edgeTable[cubeindex] & 512) intverts[9] = Intersect(verts, 1, 5, i, j, k);
-			if (edgeTable[cubeindex] & 1024) intverts[10] = Intersect(verts, 2, 6, i, j, k);
-			if (edgeTable[cubeindex] & 2048) intverts[11] = Intersect(verts, 3, 7, i, j, k);
-
-			//build triangles
-			for (int n = 0; triTable[cubeindex][n] != -1; n += 3)
+			long long z = -1 + ((long long)layer - 1) * dz;
+			for (size_t j = 0; j < sh; ++j)
 			{
-				MCTriangle tri;
-				tri.p[0] = intverts[triTable[cubeindex][n + 2]];
-				tri.p[1] = intverts[triTable[cubeindex][n + 1]];
-				tri.p[2] = intverts[triTable[cubeindex][n]];
-				tri_list.push_back(tri);
+				long long y = -1 + ((long long)j - 1) * ds;
+				for (size_t i = 0; i < sw; ++i)
+					s[j * sw + i] = sample(-1 + ((long long)i - 1) * ds, y, z);
 			}
-		}
-	}
+		};
+		auto fill_corners = [&](const std::vector<float>& s0,
+			const std::vector<float>& s1, std::vector<float>& v)
+		{
+			for (size_t j = 0; j < h; ++j)
+			for (size_t i = 0; i < w; ++i)
+			{
+				size_t k = j * sw + i;
+				float m = std::max(std::max(s0[k], s0[k + 1]),
+					std::max(s0[k + sw], s0[k + sw + 1]));
+				m = std::max(m, std::max(std::max(s1[k], s1[k + 1]),
+					std::max(s1[k + sw], s1[k + sw + 1])));
+				v[j * w + i] = m;
+			}
+		};
+		auto record = [&](const std::vector<unsigned int>& ex,
+			const std::vector<unsigned int>& ey,
+			std::vector<std::pair<uint64_t, unsigned int>>& list)
+		{
+			list.clear();
+			for (size_t k = 0; k < plane; ++k)
+			{
+				if (ex[k] != NO_VERT)
+					list.emplace_back(uint64_t(k) * 2, ex[k]);
+				if (ey[k] != NO_VERT)
+					list.emplace_back(uint64_t(k) * 2 + 1, ey[k]);
+			}
+		};
 
-	SetRange(v1 + range / 2, v2);
-
-	int numtriangles = int(tri_list.size());
-	model->numvertices = numtriangles*3;
-	model->numtriangles = numtriangles;
-	model->vertices = (GLfloat*)malloc(sizeof(GLfloat) *
-		3 * (model->numvertices + 1));
-	model->triangles = (GLMtriangle*)malloc(sizeof(GLMtriangle) *
-		model->numtriangles);
-	group->triangles = (GLuint*)malloc(sizeof(GLuint) * numtriangles);
-
-	GLfloat* vertices = model->vertices;
-	int numvertices = 1;
-	numtriangles = 0;
-	size_t tri_list_size = tri_list.size();
-	for (size_t n = 0; n < tri_list_size; ++n)
-	{
-		SetProgress(static_cast<int>(100 * n / tri_list_size),
-			"FluoRender is converting volume to mesh. Please wait.");
-
-		MCTriangle tri = tri_list[n];
-
-		//copy data
-		//vertex 1
-		vertices[3*numvertices + 0] = GLfloat(tri.p[0].x());
-		vertices[3*numvertices + 1] = GLfloat(tri.p[0].y());
-		vertices[3*numvertices + 2] = GLfloat(tri.p[0].z());
-		//triangle
-		model->triangles[numtriangles].vindices[0] = numvertices;
-		numvertices++;
-		//vertex 2
-		vertices[3*numvertices + 0] = GLfloat(tri.p[1].x());
-		vertices[3*numvertices + 1] = GLfloat(tri.p[1].y());
-		vertices[3*numvertices + 2] = GLfloat(tri.p[1].z());
-		//triangle
-		model->triangles[numtriangles].vindices[1] = numvertices;
-		numvertices++;
-		//vertex 3
-		vertices[3*numvertices + 0] = GLfloat(tri.p[2].x());
-		vertices[3*numvertices + 1] = GLfloat(tri.p[2].y());
-		vertices[3*numvertices + 2] = GLfloat(tri.p[2].z());
-		//triangle
-		model->triangles[numtriangles].vindices[2] = numvertices;
-		numvertices++;
-
-		//group
-		group->triangles[group->numtriangles++] = (GLint)numtriangles;
-		numtriangles++;
-	}
-	
-	SetRange(v1, v2);
+		fill_samples(c0, s_lo);
+		fill_samples(c0 + 1, s_hi);
+		fill_corners(s_lo, s_hi, v_lo);
 
-	return true;
-}
+		for (size_t c = c0; c < c1; ++c)
+		{
+			//corners of the upper layer
+			std::swap(s_lo, s_hi);
+			fill_samples(c + 2, s_hi);
+			fill_corners(s_lo, s_hi, v_hi);
+			double z0 = -1.0 + double(c) * dz;
+
+			//vertex on a lattice edge, interpolated from the lower corner
+			auto get_vert = [&](int e, size_t a, size_t b) -> unsigned int
+			{
+				const int* el = edge_lattice[e];
+				a += el[1];
+				b += el[2];
+				size_t k = b * w + a;
+				unsigned int* slot;
+				float v0, v1;
+				double dx = 0.0, dy = 0.0, dzz = 0.0;
+				double zz = z0;
+				if (el[0] == 2)
+				{
+					slot = &ez[k];
+					v0 = v_lo[k];
+					v1 = v_hi[k];
+					dzz = double(dz);
+				}
+				else
+				{
+					const std::vector<float>& v = el[3] ? v_hi : v_lo;
+					if (el[3])
+						zz += dz;
+					v0 = v[k];
+					if (el[0] == 0)
+					{
+						slot = el[3] ? &ex_hi[k] : &ex_lo[k];
+						v1 = v[k + 1];
+						dx = double(ds);
+					}
+					else
+					{
+						slot = el[3] ? &ey_hi[k] : &ey_lo[k];
+						v1 = v[k + w];
+						dy = double(ds);
+					}
+				}
+				if (*slot != NO_VERT)
+					return *slot;
+				double f = v0 != v1 ? (double(iso) - v0) / (double(v1) - v0) : 0.0;
+				double x = -1.0 + double(a) * ds + f * dx;
+				double y = -1.0 + double(b) * ds + f * dy;
+				double z = zz + f * dzz;
+				*slot = static_cast<unsigned int>(slab.verts.size() / 3);
+				slab.verts.push_back(static_cast<float>(x * spcx));
+				slab.verts.push_back(static_cast<float>(y * spcy));
+				slab.verts.push_back(static_cast<float>(z * spcz));
+				return *slot;
+			};
+
+			for (size_t b = 0; b < cy; ++b)
+			for (size_t a = 0; a < cx; ++a)
+			{
+				size_t k = b * w + a;
+				float verts[8] =
+				{
+					v_lo[k], v_lo[k + 1], v_lo[k + w + 1], v_lo[k + w],
+					v_hi[k], v_hi[k + 1], v_hi[k + w + 1], v_hi[k + w]
+				};
+
+				//calculate cube index
+				int cubeindex = 0;
+				for (int n = 0; n < 8; n++)
+					if (verts[n] <= iso)
+						cubeindex |= (1 << n);
+
+				//check if it's completely inside or outside
+				int edges = edgeTable[cubeindex];
+				if (!edges)
+					continue;
+
+				//get intersection vertices on edge
+				unsigned int intverts[12];
+				for (int e = 0; e < 12; ++e)
+					if (edges & (1 << e))
+						intverts[e] = get_vert(e, a, b);
+
+				//build triangles
+				for (int n = 0; triTable[cubeindex][n] != -1; n += 3)
+				{
+					slab.tris.push_back(intverts[triTable[cubeindex][n + 2]]);
+					slab.tris.push_back(intverts[triTable[cubeindex][n + 1]]);
+					slab.tris.push_back(intverts[triTable[cubeindex][n]]);
+				}
+			}
 
-double ConvVolMeshSw::GetValue(VolumeData* vd, int x, int y, int z)
-{
-	if (!vd)
-		return 0.0;
-	if (m_use_mask)
+			if (c == c0)
+				record(ex_lo, ey_lo, slab.bottom);
+			if (c + 1 == c1)
+				record(ex_hi, ey_hi, slab.top);
+			std::swap(v_lo, v_hi);
+			std::swap(ex_lo, ex_hi);
+			std::swap(ey_lo, ey_hi);
+			std::fill(ex_hi.begin(), ex_hi.end(), NO_VERT);
+			std::fill(ey_hi.begin(), ey_hi.end(), NO_VERT);
+			std::fill(ez.begin(), ez.end(), NO_VERT);
+		}
+	}, tn);
+
+	SetProgress(70, "FluoRender is converting volume to mesh. Please wait.");
+
+	//join slabs, vertices on a seam are taken from the slab below
+	std::vector<size_t> offset(tn + 1, 0);
+	for (unsigned int t = 0; t < tn; ++t)
+		offset[t + 1] = offset[t] + slabs[t].verts.size() / 3;
+	size_t tri_num = 0;
+	for (auto& s : slabs)
+		tri_num += s.tris.size();
+	std::vector<float>& verts = mesh.Vertices();
+	std::vector<unsigned int>& tris = mesh.Triangles();
+	verts.clear();
+	verts.reserve(offset[tn] * 3);
+	tris.clear();
+	tris.reserve(tri_num);
+	std::vector<unsigned int> remap;
+	for (unsigned int t = 0; t < tn; ++t)
 	{
-		double v = vd->GetMaskValue(fluo::Point(x, y, z));
-		if (v > 0.0)
+		McSlab& s = slabs[t];
+		size_t vn = s.verts.size() / 3;
+		remap.resize(vn);
+		for (size_t i = 0; i < vn; ++i)
+			remap[i] = static_cast<unsigned int>(offset[t] + i);
+		if (t > 0)
 		{
-			if (m_use_transfer)
-				return vd->GetTransferedValue(fluo::Point(x, y, z));
-			else
-				return vd->GetOriginalValue(fluo::Point(x, y, z));
+			auto& below = slabs[t - 1].top;
+			auto it = below.begin();
+			for (auto& p : s.bottom)
+			{
+				while (it != below.end() && it->first < p.first)
+					++it;
+				if (it != below.end() && it->first == p.first)
+					remap[p.second] = static_cast<unsigned int>(offset[t - 1] + it->second);
+			}
 		}
+		verts.insert(verts.end(), s.verts.begin(), s.verts.end());
+		for (auto i : s.tris)
+			tris.push_back(remap[i]);
+		std::vector<float>().swap(s.verts);
+		std::vector<unsigned int>().swap(s.tris);
 	}
-	else
-	{
-		if (m_use_transfer)
-			return vd->GetTransferedValue(fluo::Point(x, y, z));
-		else
-			return vd->GetOriginalValue(fluo::Point(x, y, z));
-	}
-	return 0.0;
-}
+	//drop seam duplicates
+	mesh.Compact();
 
-double ConvVolMeshSw::GetMaxNeighbor(double neighbors[3][3][3],
-	int xx, int yy, int zz)
-{
-	double v1 = neighbors[xx][yy][zz];
-	double v2 = neighbors[xx+1][yy][zz];
-	double v3 = neighbors[xx][yy+1][zz];
-	double v4 = neighbors[xx+1][yy+1][zz];
-	double v5 = neighbors[xx][yy][zz+1];
-	double v6 = neighbors[xx+1][yy][zz+1];
-	double v7 = neighbors[xx][yy+1][zz+1];
-	double v8 = neighbors[xx+1][yy+1][zz+1];
-
-	return std::max(v1, std::max(v2, std::max(v3, std::max(v4, std::max(v5, std::max(v6, std::max(v7, v8)))))));
-}
-
-fluo::Vector ConvVolMeshSw::Intersect(double verts[8], int v1, int v2,
-	int x, int y, int z)
-{
-	double val1 = verts[v1];
-	double val2 = verts[v2];
-	fluo::Vector p1(cubeTable[v1][0], cubeTable[v1][1], cubeTable[v1][2]);
-	fluo::Vector p2(cubeTable[v2][0], cubeTable[v2][1], cubeTable[v2][2]);
-
-	fluo::Vector p;
-	if (val1 != val2)
-		p = p1 + (p2 - p1) * (m_iso - val1) / (val2 - val1);
-	else
-		p = p1;
-
-	p = fluo::Vector(x, y, z) * m_spacing +
-		p * m_spacing * fluo::Vector(m_downsample, m_downsample, m_downsample_z);
-
-	return p;
+	return true;
 }
@@ -30,6 +30,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <BaseConvVolMesh.h>
 #include <Vector.h>
+#include <MeshOps.h>
 
 namespace flrd
 {
@@ -46,28 +47,24 @@ namespace flrd
 		virtual void MergeVertices(bool avg_normals) override;
 
 		//simplify and smooth
-		virtual void Simplify(bool avg_normals) override {}
-		virtual void Smooth(bool avg_normals) override {}
+		virtual void Simplify(bool avg_normals) override;
+		virtual void Smooth(bool avg_normals) override;
 
 		double GetArea() { return m_area; }
 
 	private:
-		typedef struct
-		{
-			fluo::Vector p[3];
-		} MCTriangle;
 		float m_area;
 	
 	private:
 		//properties from volume data
 		fluo::Vector m_spacing = fluo::Vector(1.0);
 
-		bool Compute(void* model);
-		double GetValue(VolumeData* vd, int x, int y, int z);
-		double GetMaxNeighbor(double neighbors[3][3][3],
-			int xx, int yy, int zz);
-		fluo::Vector Intersect(double verts[8], int v1, int v2,
-			int x, int y, int z);
+		//marching cubes over z slabs, one per thread
+		//vertices on shared edges are created once
+		bool Compute(MeshOps& mesh);
+		//copy between the indexed mesh and the mesh data
+		bool GetMesh(MeshOps& mesh);
+		void SetMesh(MeshOps& mesh, bool avg_normals);
 	};
 
 }
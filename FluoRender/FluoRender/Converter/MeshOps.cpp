@@ -0,0 +1,534 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <MeshOps.h>
+#include <Parallel.h>
+#include <algorithm>
+#include <queue>
+#include <cmath>
+#include <cstdint>
+
+using namespace flrd;
+
+namespace
+{
+	//symmetric 4x4 error quadric
+	//a2, ab, ac, ad, b2, bc, bd, c2, cd, d2
+	struct Quadric
+	{
+		double q[10] = {};
+
+		void add_plane(double a, double b, double c, double d, double w)
+		{
+			q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+			q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+			q[7] += w * c * c; q[8] += w * c * d;
+			q[9] += w * d * d;
+		}
+		void add(const Quadric& o)
+		{
+			for (int i = 0; i < 10; ++i)
+				q[i] += o.q[i];
+		}
+		double error(double x, double y, double z) const
+		{
+			return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x +
+				q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y +
+				q[7] * z * z + 2 * q[8] * z + q[9];
+		}
+		//minimizer, false if singular
+		bool optimal(double& x, double& y, double& z) const
+		{
+			double a = q[0], b = q[1], c = q[2];
+			double d = q[4], e = q[5], f = q[7];
+			double det = a * (d * f - e * e) - b * (b * f - e * c) + c * (b * e - d * c);
+			if (std::fabs(det) < 1e-12)
+				return false;
+			double r0 = -q[3], r1 = -q[6], r2 = -q[8];
+			x = (r0 * (d * f - e * e) - b * (r1 * f - e * r2) + c * (r1 * e - d * r2)) / det;
+			y = (a * (r1 * f - e * r2) - r0 * (b * f - e * c) + c * (b * r2 - r1 * c)) / det;
+			z = (a * (d * r2 - r1 * e) - b * (b * r2 - r1 * c) + r0 * (b * e - d * c)) / det;
+			return true;
+		}
+	};
+
+	struct Collapse
+	{
+		double cost;
+		unsigned int v1, v2;
+		unsigned int ver1, ver2;
+		float p[3];
+		bool operator<(const Collapse& o) const
+		{
+			return cost > o.cost;//min heap
+		}
+	};
+
+	inline void cross(const float* a, const float* b, const float* c, double* n)
+	{
+		double u[3] = { double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2] };
+		double v[3] = { double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2] };
+		n[0] = u[1] * v[2] - u[2] * v[1];
+		n[1] = u[2] * v[0] - u[0] * v[2];
+		n[2] = u[0] * v[1] - u[1] * v[0];
+	}
+}
+
+MeshOps::MeshOps()
+{
+}
+
+MeshOps::~MeshOps()
+{
+}
+
+void MeshOps::BuildNeighbors(std::vector<unsigned int>& offset,
+	std::vector<unsigned int>& list)
+{
+	size_t vn = GetVertexNum();
+	size_t tn = GetTriangleNum();
+	std::vector<uint64_t> edges;
+	edges.reserve(tn * 6);
+	for (size_t t = 0; t < tn; ++t)
+	for (int e = 0; e < 3; ++e)
+	{
+		uint64_t a = m_tris[t * 3 + e];
+		uint64_t b = m_tris[t * 3 + (e + 1) % 3];
+		if (a == b)
+			continue;
+		edges.push_back((a << 32) | b);
+		edges.push_back((b << 32) | a);
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	offset.assign(vn + 1, 0);
+	for (auto e : edges)
+		offset[(e >> 32) + 1]++;
+	for (size_t i = 0; i < vn; ++i)
+		offset[i + 1] += offset[i];
+	list.resize(edges.size());
+	for (size_t i = 0; i < edges.size(); ++i)
+		list[i] = static_cast<unsigned int>(edges[i] & 0xffffffff);
+}
+
+void MeshOps::BuildVertexTris(std::vector<unsigned int>& offset,
+	std::vector<unsigned int>& list)
+{
+	size_t vn = GetVertexNum();
+	size_t tn = GetTriangleNum();
+	offset.assign(vn + 1, 0);
+	for (size_t i = 0; i < tn * 3; ++i)
+		offset[m_tris[i] + 1]++;
+	for (size_t i = 0; i < vn; ++i)
+		offset[i + 1] += offset[i];
+	list.resize(tn * 3);
+	std::vector<unsigned int> pos(offset.begin(), offset.end() - 1);
+	for (size_t i = 0; i < tn * 3; ++i)
+		list[pos[m_tris[i]]++] = static_cast<unsigned int>(i / 3);
+}
+
+void MeshOps::Compact()
+{
+	size_t vn = GetVertexNum();
+	std::vector<unsigned int> remap(vn, 0xffffffff);
+	std::vector<float> verts;
+	verts.reserve(m_verts.size());
+	for (auto& i : m_tris)
+	{
+		if (remap[i] == 0xffffffff)
+		{
+			remap[i] = static_cast<unsigned int>(verts.size() / 3);
+			verts.push_back(m_verts[i * 3]);
+			verts.push_back(m_verts[i * 3 + 1]);
+			verts.push_back(m_verts[i * 3 + 2]);
+		}
+		i = remap[i];
+	}
+	m_verts.swap(verts);
+	m_norms.clear();
+}
+
+void MeshOps::Simplify(size_t target)
+{
+	size_t vn = GetVertexNum();
+	size_t tn = GetTriangleNum();
+	if (tn <= target || vn < 4)
+		return;
+
+	//face quadrics
+	std::vector<Quadric> quad(vn);
+	std::vector<unsigned int> vt_off, vt_list;
+	BuildVertexTris(vt_off, vt_list);
+	for (size_t t = 0; t < tn; ++t)
+	{
+		const unsigned int* f = &m_tris[t * 3];
+		double n[3];
+		cross(&m_verts[f[0] * 3], &m_verts[f[1] * 3], &m_verts[f[2] * 3], n);
+		double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (len <= 0.0)
+			continue;
+		double area = len * 0.5;
+		n[0] /= len; n[1] /= len; n[2] /= len;
+		const float* p = &m_verts[f[0] * 3];
+		double d = -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]);
+		for (int i = 0; i < 3; ++i)
+			quad[f[i]].add_plane(n[0], n[1], n[2], d, area);
+	}
+	//boundary edges are held in place by perpendicular planes
+	std::vector<unsigned int> nb_off, nb_list;
+	BuildNeighbors(nb_off, nb_list);
+	for (size_t t = 0; t < tn; ++t)
+	for (int e = 0; e < 3; ++e)
+	{
+		unsigned int a = m_tris[t * 3 + e];
+		unsigned int b = m_tris[t * 3 + (e + 1) % 3];
+		int count = 0;
+		for (unsigned int i = vt_off[a]; i < vt_off[a + 1]; ++i)
+		{
+			const unsigned int* f = &m_tris[vt_list[i] * 3];
+			if (f[0] == b || f[1] == b || f[2] == b)
+				count++;
+		}
+		if (count != 1)
+			continue;
+		const unsigned int* f = &m_tris[t * 3];
+		double n[3];
+		cross(&m_verts[f[0] * 3], &m_verts[f[1] * 3], &m_verts[f[2] * 3], n);
+		const float* pa = &m_verts[a * 3];
+		const float* pb = &m_verts[b * 3];
+		double ev[3] = { double(pb[0]) - pa[0], double(pb[1]) - pa[1], double(pb[2]) - pa[2] };
+		double pn[3] = {
+			ev[1] * n[2] - ev[2] * n[1],
+			ev[2] * n[0] - ev[0] * n[2],
+			ev[0] * n[1] - ev[1] * n[0] };
+		double len = std::sqrt(pn[0] * pn[0] + pn[1] * pn[1] + pn[2] * pn[2]);
+		if (len <= 0.0)
+			continue;
+		pn[0] /= len; pn[1] /= len; pn[2] /= len;
+		double d = -(pn[0] * pa[0] + pn[1] * pa[1] + pn[2] * pa[2]);
+		double w = (ev[0] * ev[0] + ev[1] * ev[1] + ev[2] * ev[2]) * 1000.0;
+		quad[a].add_plane(pn[0], pn[1], pn[2], d, w);
+		quad[b].add_plane(pn[0], pn[1], pn[2], d, w);
+	}
+
+	//per vertex triangle lists, updated as vertices merge
+	std::vector<std::vector<unsigned int>> vf(vn);
+	for (size_t v = 0; v < vn; ++v)
+		vf[v].assign(vt_list.begin() + vt_off[v], vt_list.begin() + vt_off[v + 1]);
+	vt_list.clear();
+	std::vector<char> tri_alive(tn, 1);
+	std::vector<char> vert_alive(vn, 1);
+	std::vector<unsigned int> ver(vn, 0);
+	size_t live = tn;
+
+	auto make = [&](unsigned int v1, unsigned int v2, Collapse& c)
+	{
+		Quadric q = quad[v1];
+		q.add(quad[v2]);
+		const float* p1 = &m_verts[v1 * 3];
+		const float* p2 = &m_verts[v2 * 3];
+		double mx = (double(p1[0]) + p2[0]) * 0.5;
+		double my = (double(p1[1]) + p2[1]) * 0.5;
+		double mz = (double(p1[2]) + p2[2]) * 0.5;
+		double el2 = (double(p2[0]) - p1[0]) * (double(p2[0]) - p1[0]) +
+			(double(p2[1]) - p1[1]) * (double(p2[1]) - p1[1]) +
+			(double(p2[2]) - p1[2]) * (double(p2[2]) - p1[2]);
+		double x, y, z;
+		bool opt = q.optimal(x, y, z);
+		//keep the new vertex near the edge
+		if (opt && (x - mx) * (x - mx) + (y - my) * (y - my) + (z - mz) * (z - mz) > el2)
+			opt = false;
+		if (opt)
+		{
+			c.cost = q.error(x, y, z);
+		}
+		else
+		{
+			double cand[3][3] = {
+				{ mx, my, mz },
+				{ p1[0], p1[1], p1[2] },
+				{ p2[0], p2[1], p2[2] } };
+			c.cost = -1.0;
+			for (int i = 0; i < 3; ++i)
+			{
+				double e = q.error(cand[i][0], cand[i][1], cand[i][2]);
+				if (c.cost < 0.0 || e < c.cost)
+				{
+					c.cost = e;
+					x = cand[i][0]; y = cand[i][1]; z = cand[i][2];
+				}
+			}
+		}
+		c.cost = std::max(c.cost, 0.0);
+		c.v1 = v1; c.v2 = v2;
+		c.ver1 = ver[v1]; c.ver2 = ver[v2];
+		c.p[0] = float(x); c.p[1] = float(y); c.p[2] = float(z);
+	};
+
+	std::priority_queue<Collapse> heap;
+	for (size_t v = 0; v < vn; ++v)
+	for (unsigned int i = nb_off[v]; i < nb_off[v + 1]; ++i)
+	{
+		unsigned int w = nb_list[i];
+		if (w <= v)
+			continue;
+		Collapse c;
+		make(static_cast<unsigned int>(v), w, c);
+		heap.push(c);
+	}
+	nb_off.clear();
+	nb_list.clear();
+
+	std::vector<unsigned int> ring1, ring2;
+	auto ring = [&](unsigned int v, std::vector<unsigned int>& r)
+	{
+		r.clear();
+		for (auto f : vf[v])
+		{
+			if (!tri_alive[f])
+				continue;
+			for (int i = 0; i < 3; ++i)
+			{
+				unsigned int w = m_tris[f * 3 + i];
+				if (w != v)
+					r.push_back(w);
+			}
+		}
+		std::sort(r.begin(), r.end());
+		r.erase(std::unique(r.begin(), r.end()), r.end());
+	};
+
+	while (live > target && !heap.empty())
+	{
+		Collapse c = heap.top();
+		heap.pop();
+		unsigned int v1 = c.v1, v2 = c.v2;
+		if (!vert_alive[v1] || !vert_alive[v2] ||
+			ver[v1] != c.ver1 || ver[v2] != c.ver2)
+			continue;
+
+		//link condition
+		ring(v1, ring1);
+		ring(v2, ring2);
+		if (!std::binary_search(ring1.begin(), ring1.end(), v2))
+			continue;
+		size_t common = 0;
+		for (auto w : ring1)
+			if (std::binary_search(ring2.begin(), ring2.end(), w))
+				common++;
+		size_t shared = 0;
+		for (auto f : vf[v1])
+		{
+			if (!tri_alive[f])
+				continue;
+			const unsigned int* t = &m_tris[f * 3];
+			if (t[0] == v2 || t[1] == v2 || t[2] == v2)
+				shared++;
+		}
+		if (common != shared)
+			continue;
+
+		//reject flipped or degenerate faces
+		bool flip = false;
+		for (int s = 0; s < 2 && !flip; ++s)
+		{
+			unsigned int v = s ? v2 : v1;
+			unsigned int o = s ? v1 : v2;
+			for (auto f : vf[v])
+			{
+				if (!tri_alive[f])
+					continue;
+				const unsigned int* t = &m_tris[f * 3];
+				if (t[0] == o || t[1] == o || t[2] == o)
+					continue;
+				const float* p[3];
+				float np[3][3];
+				for (int i = 0; i < 3; ++i)
+				{
+					p[i] = &m_verts[t[i] * 3];
+					if (t[i] == v)
+					{
+						np[i][0] = c.p[0]; np[i][1] = c.p[1]; np[i][2] = c.p[2];
+					}
+					else
+					{
+						np[i][0] = p[i][0]; np[i][1] = p[i][1]; np[i][2] = p[i][2];
+					}
+				}
+				double n0[3], n1[3];
+				cross(p[0], p[1], p[2], n0);
+				cross(np[0], np[1], np[2], n1);
+				double d = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+				double l0 = n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2];
+				double l1 = n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2];
+				if (l1 <= 1e-12 * l0 || d <= 0.2 * std::sqrt(l0 * l1))
+				{
+					flip = true;
+					break;
+				}
+			}
+		}
+		if (flip)
+			continue;
+
+		//collapse v2 into v1
+		m_verts[v1 * 3] = c.p[0];
+		m_verts[v1 * 3 + 1] = c.p[1];
+		m_verts[v1 * 3 + 2] = c.p[2];
+		quad[v1].add(quad[v2]);
+		vert_alive[v2] = 0;
+		ver[v1]++;
+		for (auto f : vf[v2])
+		{
+			if (!tri_alive[f])
+				continue;
+			unsigned int* t = &m_tris[f * 3];
+			if (t[0] == v1 || t[1] == v1 || t[2] == v1)
+			{
+				tri_alive[f] = 0;
+				live--;
+				continue;
+			}
+			for (int i = 0; i < 3; ++i)
+				if (t[i] == v2)
+					t[i] = v1;
+			vf[v1].push_back(f);
+		}
+		std::vector<unsigned int>().swap(vf[v2]);
+		auto& l = vf[v1];
+		l.erase(std::remove_if(l.begin(), l.end(),
+			[&](unsigned int f) { return !tri_alive[f]; }), l.end());
+		std::sort(l.begin(), l.end());
+		l.erase(std::unique(l.begin(), l.end()), l.end());
+
+		ring(v1, ring1);
+		for (auto w : ring1)
+		{
+			Collapse nc;
+			make(std::min(v1, w), std::max(v1, w), nc);
+			heap.push(nc);
+		}
+	}
+
+	//keep live triangles
+	std::vector<unsigned int> tris;
+	tris.reserve(live * 3);
+	for (size_t t = 0; t < tn; ++t)
+	{
+		if (!tri_alive[t])
+			continue;
+		tris.push_back(m_tris[t * 3]);
+		tris.push_back(m_tris[t * 3 + 1]);
+		tris.push_back(m_tris[t * 3 + 2]);
+	}
+	m_tris.swap(tris);
+	Compact();
+}
+
+void MeshOps::Smooth(float lambda, float mu, int iter)
+{
+	size_t vn = GetVertexNum();
+	if (!vn || iter <= 0)
+		return;
+	std::vector<unsigned int> offset, list;
+	BuildNeighbors(offset, list);
+	std::vector<float> temp(m_verts.size());
+
+	auto step = [&](float w)
+	{
+		ParallelFor(vn, [&](size_t v0, size_t v1, unsigned int t)
+		{
+			for (size_t v = v0; v < v1; ++v)
+			{
+				unsigned int b = offset[v], e = offset[v + 1];
+				const float* p = &m_verts[v * 3];
+				float* q = &temp[v * 3];
+				if (b == e)
+				{
+					q[0] = p[0]; q[1] = p[1]; q[2] = p[2];
+					continue;
+				}
+				double s[3] = { 0.0, 0.0, 0.0 };
+				for (unsigned int i = b; i < e; ++i)
+				{
+					const float* n = &m_verts[list[i] * 3];
+					s[0] += n[0]; s[1] += n[1]; s[2] += n[2];
+				}
+				double inv = 1.0 / (e - b);
+				for (int i = 0; i < 3; ++i)
+					q[i] = float(p[i] + w * (s[i] * inv - p[i]));
+			}
+		}, m_thread_num);
+		m_verts.swap(temp);
+	};
+
+	for (int i = 0; i < iter; ++i)
+	{
+		step(lambda);
+		step(mu);
+	}
+	m_norms.clear();
+}
+
+void MeshOps::ComputeNormals()
+{
+	size_t vn = GetVertexNum();
+	size_t tn = GetTriangleNum();
+	m_norms.assign(vn * 3, 0.0f);
+	if (!vn || !tn)
+		return;
+	std::vector<double> fn(tn * 3);
+	ParallelFor(tn, [&](size_t t0, size_t t1, unsigned int t)
+	{
+		for (size_t i = t0; i < t1; ++i)
+		{
+			const unsigned int* f = &m_tris[i * 3];
+			cross(&m_verts[f[0] * 3], &m_verts[f[1] * 3], &m_verts[f[2] * 3], &fn[i * 3]);
+		}
+	}, m_thread_num);
+	std::vector<unsigned int> offset, list;
+	BuildVertexTris(offset, list);
+	ParallelFor(vn, [&](size_t v0, size_t v1, unsigned int t)
+	{
+		for (size_t v = v0; v < v1; ++v)
+		{
+			double n[3] = { 0.0, 0.0, 0.0 };
+			for (unsigned int i = offset[v]; i < offset[v + 1]; ++i)
+			{
+				const double* f = &fn[list[i] * 3];
+				n[0] += f[0]; n[1] += f[1]; n[2] += f[2];
+			}
+			double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (len > 0.0)
+			{
+				m_norms[v * 3] = float(n[0] / len);
+				m_norms[v * 3 + 1] = float(n[1] / len);
+				m_norms[v * 3 + 2] = float(n[2] / len);
+			}
+		}
+	}, m_thread_num);
+}
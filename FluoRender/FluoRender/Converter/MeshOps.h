@@ -0,0 +1,78 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_MeshOps_h
+#define FL_MeshOps_h
+
+#include <vector>
+#include <cstddef>
+
+namespace flrd
+{
+	//operations on a triangle mesh with shared vertices
+	//indices are 0-based, three per triangle
+	class MeshOps
+	{
+	public:
+		MeshOps();
+		~MeshOps();
+
+		std::vector<float>& Vertices() { return m_verts; }
+		std::vector<unsigned int>& Triangles() { return m_tris; }
+		std::vector<float>& Normals() { return m_norms; }
+		size_t GetVertexNum() { return m_verts.size() / 3; }
+		size_t GetTriangleNum() { return m_tris.size() / 3; }
+
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+
+		//quadric error edge collapse until the triangle number
+		//drops to target, collapses that flip a face
+		//or make the surface non-manifold are skipped
+		void Simplify(size_t target);
+		//taubin lambda/mu smoothing with uniform weights
+		//lambda > 0 shrinks, mu < -lambda inflates
+		void Smooth(float lambda, float mu, int iter);
+		//area weighted vertex normals
+		void ComputeNormals();
+		//remove vertices not used by any triangle
+		void Compact();
+
+	private:
+		std::vector<float> m_verts;
+		std::vector<unsigned int> m_tris;
+		std::vector<float> m_norms;
+		unsigned int m_thread_num = 0;
+
+		//vertex to vertex or vertex to triangle lists
+		void BuildNeighbors(std::vector<unsigned int>& offset,
+			std::vector<unsigned int>& list);
+		void BuildVertexTris(std::vector<unsigned int>& offset,
+			std::vector<unsigned int>& list);
+	};
+}
+
+#endif//FL_MeshOps_h
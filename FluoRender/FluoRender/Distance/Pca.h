@@ -87,6 +87,22 @@ namespace flrd
 			sp.scale(scale);
 			AddPoint(sp);
 		}
+		//set incremental sums accumulated elsewhere
+		//cov: xx, xy, xz, yy, yz, zz
+		void SetSums(int num, const fluo::Point& sum,
+			const double* cov, const fluo::BPoint& bpoint)
+		{
+			m_mode = 0;
+			m_num = num;
+			m_mean = sum;
+			m_cov[0][0] = cov[0];
+			m_cov[0][1] = cov[1];
+			m_cov[0][2] = cov[2];
+			m_cov[1][1] = cov[3];
+			m_cov[1][2] = cov[4];
+			m_cov[2][2] = cov[5];
+			m_bpoint = bpoint;
+		}
 		void SetPoints(std::vector<fluo::Point> &points)
 		{
 			m_points.assign(points.begin(), points.end());
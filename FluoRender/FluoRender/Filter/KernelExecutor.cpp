@@ -303,7 +303,10 @@ bool KernelExecutor::ExecuteKernel(VolumeData* vd, VolumeData* vd_r)
 
 	//clear gpu texture because the kernel updates the data in main memory after read back
 	if (vd == vd_r)
+	{
 		vd->GetVR()->clear_tex_current();
+		vd->GetTexture()->invalid_brick_stats();
+	}
 
 	return kernel_exe;
 }
@@ -61,9 +61,15 @@ ColocalizationDlg::ColocalizationDlg(MainFrame* frame) :
 		wxDefaultPosition, wxDefaultSize);
 	m_logical_and_rdb = new wxRadioButton(this, wxID_ANY, "Threshold + Logical AND",
 		wxDefaultPosition, wxDefaultSize);
+	m_pearson_rdb = new wxRadioButton(this, wxID_ANY, "Pearson",
+		wxDefaultPosition, wxDefaultSize);
+	m_manders_rdb = new wxRadioButton(this, wxID_ANY, "Manders",
+		wxDefaultPosition, wxDefaultSize);
 	m_product_rdb->Bind(wxEVT_RADIOBUTTON, &ColocalizationDlg::OnMethodRdb, this);
 	m_min_value_rdb->Bind(wxEVT_RADIOBUTTON, &ColocalizationDlg::OnMethodRdb, this);
 	m_logical_and_rdb->Bind(wxEVT_RADIOBUTTON, &ColocalizationDlg::OnMethodRdb, this);
+	m_pearson_rdb->Bind(wxEVT_RADIOBUTTON, &ColocalizationDlg::OnMethodRdb, this);
+	m_manders_rdb->Bind(wxEVT_RADIOBUTTON, &ColocalizationDlg::OnMethodRdb, this);
 	sizer1_1->Add(10, 10);
 	sizer1_1->Add(st, 0, wxALIGN_CENTER);
 	sizer1_1->Add(10, 10);
@@ -72,6 +78,10 @@ ColocalizationDlg::ColocalizationDlg(MainFrame* frame) :
 	sizer1_1->Add(m_min_value_rdb, 0, wxALIGN_CENTER);
 	sizer1_1->Add(10, 10);
 	sizer1_1->Add(m_product_rdb, 0, wxALIGN_CENTER);
+	sizer1_1->Add(10, 10);
+	sizer1_1->Add(m_pearson_rdb, 0, wxALIGN_CENTER);
+	sizer1_1->Add(10, 10);
+	sizer1_1->Add(m_manders_rdb, 0, wxALIGN_CENTER);
 	wxBoxSizer* sizer1_2 = new wxBoxSizer(wxHORIZONTAL);
 	st = new wxStaticText(this, 0, "Output Format:",
 		wxDefaultPosition, wxDefaultSize);
@@ -172,6 +182,8 @@ void ColocalizationDlg::FluoUpdate(const fluo::ValueCollection& vc)
 		m_product_rdb->SetValue(glbin_colocal_def.m_method == 0);
 		m_min_value_rdb->SetValue(glbin_colocal_def.m_method == 1);
 		m_logical_and_rdb->SetValue(glbin_colocal_def.m_method == 2);
+		m_pearson_rdb->SetValue(glbin_colocal_def.m_method == 3);
+		m_manders_rdb->SetValue(glbin_colocal_def.m_method == 4);
 	}
 
 	if (update_all || FOUND_VALUE(gstIntWeighted))
@@ -360,6 +372,10 @@ void ColocalizationDlg::OnMethodRdb(wxCommandEvent& event)
 		glbin_colocal_def.m_method = 1;
 	else if (m_logical_and_rdb->GetValue())
 		glbin_colocal_def.m_method = 2;
+	else if (m_pearson_rdb->GetValue())
+		glbin_colocal_def.m_method = 3;
+	else if (m_manders_rdb->GetValue())
+		glbin_colocal_def.m_method = 4;
 
 	FluoUpdate({ gstColocalAutoUpdate });
 }
@@ -58,6 +58,8 @@ private:
 	wxRadioButton* m_product_rdb;
 	wxRadioButton* m_min_value_rdb;
 	wxRadioButton* m_logical_and_rdb;
+	wxRadioButton* m_pearson_rdb;
+	wxRadioButton* m_manders_rdb;
 	//format
 	wxToggleButton* m_int_weight_btn;
 	wxToggleButton* m_ratio_btn;
@@ -402,6 +402,82 @@ wxWindow* ComponentDlg::CreateCompGenPage(wxWindow *parent)
 	sizer20->Add(m_max_dist_text, 0, wxALIGN_CENTER);
 	sizer20->Add(2, 2);
 
+	//watershed
+	wxBoxSizer* sizer23 = new wxBoxSizer(wxHORIZONTAL);
+	m_ws_check = new wxCheckBox(page, wxID_ANY, "Split after Generating",
+		wxDefaultPosition, wxDefaultSize, wxALIGN_LEFT);
+	m_ws_btn = new wxButton(page, wxID_ANY, "Split",
+		wxDefaultPosition, FromDIP(wxSize(75, -1)), wxALIGN_LEFT);
+	m_ws_check->Bind(wxEVT_CHECKBOX, &ComponentDlg::OnWsCheck, this);
+	m_ws_btn->Bind(wxEVT_BUTTON, &ComponentDlg::OnWsBtn, this);
+	sizer23->Add(2, 2);
+	sizer23->Add(m_ws_check, 0, wxALIGN_CENTER);
+	sizer23->AddStretchSpacer(1);
+	sizer23->Add(m_ws_btn, 0, wxALIGN_CENTER);
+	sizer23->Add(2, 2);
+
+	wxBoxSizer* sizer24 = new wxBoxSizer(wxHORIZONTAL);
+	st = new wxStaticText(page, 0, "Seeds from:",
+		wxDefaultPosition, FromDIP(wxSize(100, 23)));
+	m_ws_marker_dist_rb = new wxRadioButton(page, ID_WsMarkerDistRb,
+		"Distance", wxDefaultPosition, wxDefaultSize, wxRB_GROUP);
+	m_ws_marker_int_rb = new wxRadioButton(page, ID_WsMarkerIntRb,
+		"Intensity", wxDefaultPosition, wxDefaultSize);
+	m_ws_marker_dist_rb->Bind(wxEVT_RADIOBUTTON, &ComponentDlg::OnWsMarkerRb, this);
+	m_ws_marker_int_rb->Bind(wxEVT_RADIOBUTTON, &ComponentDlg::OnWsMarkerRb, this);
+	sizer24->Add(2, 2);
+	sizer24->Add(st, 0, wxALIGN_CENTER);
+	sizer24->Add(m_ws_marker_dist_rb, 0, wxALIGN_CENTER);
+	sizer24->Add(10, 10);
+	sizer24->Add(m_ws_marker_int_rb, 0, wxALIGN_CENTER);
+
+	wxBoxSizer* sizer25 = new wxBoxSizer(wxHORIZONTAL);
+	st = new wxStaticText(page, 0, "Seed Height:",
+		wxDefaultPosition, FromDIP(wxSize(100, 23)));
+	m_ws_h_sldr = new wxSingleSlider(page, wxID_ANY, 200, 1, 1000,
+		wxDefaultPosition, wxDefaultSize, wxSL_HORIZONTAL);
+	m_ws_h_text = new wxTextCtrl(page, wxID_ANY, "2.00",
+		wxDefaultPosition, FromDIP(wxSize(60, 20)), wxTE_RIGHT, vald_fp3);
+	m_ws_h_sldr->Bind(wxEVT_SCROLL_CHANGED, &ComponentDlg::OnWsHSldr, this);
+	m_ws_h_text->Bind(wxEVT_TEXT, &ComponentDlg::OnWsHText, this);
+	sizer25->Add(2, 2);
+	sizer25->Add(st, 0, wxALIGN_CENTER);
+	sizer25->Add(m_ws_h_sldr, 1, wxEXPAND);
+	sizer25->Add(m_ws_h_text, 0, wxALIGN_CENTER);
+	sizer25->Add(2, 2);
+
+	wxBoxSizer* sizer26 = new wxBoxSizer(wxHORIZONTAL);
+	st = new wxStaticText(page, 0, "Shape Weight:",
+		wxDefaultPosition, FromDIP(wxSize(100, 23)));
+	m_ws_dist_weight_sldr = new wxSingleSlider(page, wxID_ANY, 0, 0, 100,
+		wxDefaultPosition, wxDefaultSize, wxSL_HORIZONTAL);
+	m_ws_dist_weight_text = new wxTextCtrl(page, wxID_ANY, "0.00",
+		wxDefaultPosition, FromDIP(wxSize(60, 20)), wxTE_RIGHT, vald_fp3);
+	m_ws_dist_weight_sldr->Bind(wxEVT_SCROLL_CHANGED, &ComponentDlg::OnWsDistWeightSldr, this);
+	m_ws_dist_weight_text->Bind(wxEVT_TEXT, &ComponentDlg::OnWsDistWeightText, this);
+	sizer26->Add(2, 2);
+	sizer26->Add(st, 0, wxALIGN_CENTER);
+	sizer26->Add(m_ws_dist_weight_sldr, 1, wxEXPAND);
+	sizer26->Add(m_ws_dist_weight_text, 0, wxALIGN_CENTER);
+	sizer26->Add(2, 2);
+
+	//out of core
+	wxBoxSizer* sizer27 = new wxBoxSizer(wxHORIZONTAL);
+	m_out_core_check = new wxCheckBox(page, wxID_ANY, "Out of Core",
+		wxDefaultPosition, wxDefaultSize, wxALIGN_LEFT);
+	st = new wxStaticText(page, 0, "Memory (MB):",
+		wxDefaultPosition, wxDefaultSize);
+	m_out_core_mem_text = new wxTextCtrl(page, wxID_ANY, "1024",
+		wxDefaultPosition, FromDIP(wxSize(60, 20)), wxTE_RIGHT, vald_int);
+	m_out_core_check->Bind(wxEVT_CHECKBOX, &ComponentDlg::OnOutCoreCheck, this);
+	m_out_core_mem_text->Bind(wxEVT_TEXT, &ComponentDlg::OnOutCoreMemText, this);
+	sizer27->Add(2, 2);
+	sizer27->Add(m_out_core_check, 0, wxALIGN_CENTER);
+	sizer27->AddStretchSpacer(1);
+	sizer27->Add(st, 0, wxALIGN_CENTER);
+	sizer27->Add(m_out_core_mem_text, 0, wxALIGN_CENTER);
+	sizer27->Add(2, 2);
+
 	//command record
 	wxBoxSizer* sizer21 = new wxBoxSizer(wxHORIZONTAL);
 	st = new wxStaticText(page, 0, "Actions:",
@@ -455,6 +531,8 @@ wxWindow* ComponentDlg::CreateCompGenPage(wxWindow *parent)
 	group1->Add(5, 5);
 	group1->Add(sizer5, 0, wxEXPAND);
 	group1->Add(5, 5);
+	group1->Add(sizer27, 0, wxEXPAND);
+	group1->Add(5, 5);
 
 	wxStaticBoxSizer *group2 = new wxStaticBoxSizer(
 		wxVERTICAL, page, "Noise Reduction");
@@ -492,6 +570,17 @@ wxWindow* ComponentDlg::CreateCompGenPage(wxWindow *parent)
 	group3->Add(sizer20, 0, wxEXPAND);
 	group3->Add(5, 5);
 
+	wxStaticBoxSizer *group5 = new wxStaticBoxSizer(
+		wxVERTICAL, page, "Split Touching Components");
+	group5->Add(sizer23, 0, wxEXPAND);
+	group5->Add(5, 5);
+	group5->Add(sizer24, 0, wxEXPAND);
+	group5->Add(5, 5);
+	group5->Add(sizer25, 0, wxEXPAND);
+	group5->Add(5, 5);
+	group5->Add(sizer26, 0, wxEXPAND);
+	group5->Add(5, 5);
+
 	wxStaticBoxSizer *group4 = new wxStaticBoxSizer(
 		wxVERTICAL, page, "Action Recording and Playback");
 	group4->Add(sizer21, 0, wxEXPAND);
@@ -509,6 +598,8 @@ wxWindow* ComponentDlg::CreateCompGenPage(wxWindow *parent)
 	sizerv->Add(10, 10);
 	sizerv->Add(group3, 0, wxEXPAND);
 	sizerv->Add(10, 10);
+	sizerv->Add(group5, 0, wxEXPAND);
+	sizerv->Add(10, 10);
 	sizerv->Add(group4, 0, wxEXPAND);
 	sizerv->Add(10, 10);
 
@@ -1078,7 +1169,7 @@ void ComponentDlg::FluoUpdate(const fluo::ValueCollection& vc)
 			if (glbin_comp_generator.GetUseSel())
 			{
 				auto vd = glbin_comp_generator.GetVolumeData();
-				if (!vd->GetLabel(false))
+				if (!vd->HasLabel())
 					return;
 			}
 			else
@@ -1236,6 +1327,41 @@ void ComponentDlg::FluoUpdate(const fluo::ValueCollection& vc)
 		m_clean_limit_sldr->ChangeValue(ival);
 		m_clean_limit_text->ChangeValue(wxString::Format("%d", ival));
 	}
+	//watershed
+	if (update_all || FOUND_VALUE(gstWatershedEnable))
+	{
+		bval = glbin_comp_generator.GetWatershed();
+		m_ws_check->SetValue(bval);
+	}
+	if (update_all || FOUND_VALUE(gstWsMarker))
+	{
+		ival = glbin_comp_generator.GetWsMarker();
+		m_ws_marker_dist_rb->SetValue(ival == 0);
+		m_ws_marker_int_rb->SetValue(ival == 1);
+	}
+	if (update_all || FOUND_VALUE(gstWsH))
+	{
+		dval = glbin_comp_generator.GetWsH();
+		m_ws_h_sldr->ChangeValue(std::round(dval * 100.0));
+		m_ws_h_text->ChangeValue(wxString::Format("%.2f", dval));
+	}
+	if (update_all || FOUND_VALUE(gstWsDistWeight))
+	{
+		dval = glbin_comp_generator.GetWsDistWeight();
+		m_ws_dist_weight_sldr->ChangeValue(std::round(dval * 100.0));
+		m_ws_dist_weight_text->ChangeValue(wxString::Format("%.2f", dval));
+	}
+	//out of core
+	if (update_all || FOUND_VALUE(gstCompOutCore))
+	{
+		bval = glbin_comp_generator.GetOutOfCore();
+		m_out_core_check->SetValue(bval);
+	}
+	if (update_all || FOUND_VALUE(gstCompOutCoreMem))
+	{
+		ival = glbin_comp_generator.GetOutOfCoreMem();
+		m_out_core_mem_text->ChangeValue(wxString::Format("%d", ival));
+	}
 	//record
 	if (update_all || FOUND_VALUE(gstRecordCmd))
 	{
@@ -1589,6 +1715,18 @@ void ComponentDlg::SetCleanLimit(int val)
 	FluoUpdate({ gstCleanSize, gstCompAutoUpdate, gstRecordCmd });
 }
 
+void ComponentDlg::SetWsH(double val)
+{
+	glbin_comp_generator.SetWsH(val);
+	FluoUpdate({ gstWsH, gstCompAutoUpdate, gstRecordCmd });
+}
+
+void ComponentDlg::SetWsDistWeight(double val)
+{
+	glbin_comp_generator.SetWsDistWeight(val);
+	FluoUpdate({ gstWsDistWeight, gstCompAutoUpdate, gstRecordCmd });
+}
+
 //comp generate page
 void ComponentDlg::OnIterSldr(wxScrollEvent& event)
 {
@@ -1946,6 +2084,83 @@ void ComponentDlg::OnCleanLimitText(wxCommandEvent& event)
 	SetCleanLimit(val);
 }
 
+//watershed
+void ComponentDlg::OnWsCheck(wxCommandEvent& event)
+{
+	bool bval = m_ws_check->GetValue();
+	glbin_comp_generator.SetWatershed(bval);
+	FluoUpdate({ gstWatershedEnable, gstCompAutoUpdate, gstRecordCmd });
+}
+
+void ComponentDlg::OnWsBtn(wxCommandEvent& event)
+{
+	bool bval = m_use_sel_gen_chk->GetValue();
+	glbin_comp_generator.SetUseSel(bval);
+	glbin_comp_generator.Split();
+	FluoRefresh(3, { gstNull });
+}
+
+void ComponentDlg::OnWsMarkerRb(wxCommandEvent& event)
+{
+	int id = event.GetId();
+	glbin_comp_generator.SetWsMarker(id == ID_WsMarkerIntRb ? 1 : 0);
+	FluoUpdate({ gstWsMarker, gstCompAutoUpdate, gstRecordCmd });
+}
+
+void ComponentDlg::OnWsHSldr(wxScrollEvent& event)
+{
+	double val = m_ws_h_sldr->GetValue() / 100.0;
+	wxString str = wxString::Format("%.2f", val);
+	if (str != m_ws_h_text->GetValue())
+	{
+		m_ws_h_text->ChangeValue(str);
+		SetWsH(val);
+	}
+}
+
+void ComponentDlg::OnWsHText(wxCommandEvent& event)
+{
+	double val = 0.0;
+	m_ws_h_text->GetValue().ToDouble(&val);
+	m_ws_h_sldr->ChangeValue(std::round(val * 100.0));
+	SetWsH(val);
+}
+
+void ComponentDlg::OnWsDistWeightSldr(wxScrollEvent& event)
+{
+	double val = m_ws_dist_weight_sldr->GetValue() / 100.0;
+	wxString str = wxString::Format("%.2f", val);
+	if (str != m_ws_dist_weight_text->GetValue())
+	{
+		m_ws_dist_weight_text->ChangeValue(str);
+		SetWsDistWeight(val);
+	}
+}
+
+void ComponentDlg::OnWsDistWeightText(wxCommandEvent& event)
+{
+	double val = 0.0;
+	m_ws_dist_weight_text->GetValue().ToDouble(&val);
+	m_ws_dist_weight_sldr->ChangeValue(std::round(val * 100.0));
+	SetWsDistWeight(val);
+}
+
+//out of core
+void ComponentDlg::OnOutCoreCheck(wxCommandEvent& event)
+{
+	bool bval = m_out_core_check->GetValue();
+	glbin_comp_generator.SetOutOfCore(bval);
+	FluoUpdate({ gstCompOutCore, gstCompAutoUpdate, gstRecordCmd });
+}
+
+void ComponentDlg::OnOutCoreMemText(wxCommandEvent& event)
+{
+	long val = 1024;
+	m_out_core_mem_text->GetValue().ToLong(&val);
+	glbin_comp_generator.SetOutOfCoreMem(static_cast<int>(val));
+	FluoUpdate({ gstCompOutCoreMem, gstRecordCmd });
+}
+
 //record
 void ComponentDlg::OnRecordCmd(wxCommandEvent& event)
 {
@@ -2435,6 +2650,13 @@ void ComponentDlg::OnGenerate(wxCommandEvent& event)
 void ComponentDlg::OnCluster(wxCommandEvent& event)
 {
 	glbin_clusterizer.Compute();
+	wxString str1 = glbin_clusterizer.GetTitles();
+	wxString str2 = glbin_clusterizer.GetValues();
+	if (!str1.IsEmpty())
+	{
+		DeleteGridRows();
+		OutputAnalysis(str1, str2);
+	}
 	FluoRefresh(3, { gstNull });
 }
 
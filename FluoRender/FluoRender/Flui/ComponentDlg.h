@@ -46,6 +46,12 @@ public:
 		ID_ClusterMethodKmeansRd
 	};
 	enum
+	{
+		//watershed markers
+		ID_WsMarkerDistRb = 0,
+		ID_WsMarkerIntRb
+	};
+	enum
 	{
 		//output
 		ID_OutputMultiRb = 0,
@@ -104,6 +110,8 @@ public:
 	void SetFixSize(int val);
 	void SetCleanIter(int val);
 	void SetCleanLimit(int val);
+	void SetWsH(double val);
+	void SetWsDistWeight(double val);
 
 private:
 	int m_max_lines;
@@ -166,6 +174,18 @@ private:
 	wxTextCtrl* m_clean_iter_text;
 	wxSingleSlider* m_clean_limit_sldr;
 	wxTextCtrl* m_clean_limit_text;
+	//watershed
+	wxCheckBox* m_ws_check;
+	wxButton* m_ws_btn;
+	wxRadioButton* m_ws_marker_dist_rb;
+	wxRadioButton* m_ws_marker_int_rb;
+	wxSingleSlider* m_ws_h_sldr;
+	wxTextCtrl* m_ws_h_text;
+	wxSingleSlider* m_ws_dist_weight_sldr;
+	wxTextCtrl* m_ws_dist_weight_text;
+	//out of core
+	wxCheckBox* m_out_core_check;
+	wxTextCtrl* m_out_core_mem_text;
 	//record
 	wxTextCtrl* m_cmd_count_text;
 	wxToggleButton* m_record_cmd_btn;
@@ -334,6 +354,17 @@ private:
 	void OnCleanIterText(wxCommandEvent& event);
 	void OnCleanLimitSldr(wxScrollEvent& event);
 	void OnCleanLimitText(wxCommandEvent& event);
+	//watershed
+	void OnWsCheck(wxCommandEvent& event);
+	void OnWsBtn(wxCommandEvent& event);
+	void OnWsMarkerRb(wxCommandEvent& event);
+	void OnWsHSldr(wxScrollEvent& event);
+	void OnWsHText(wxCommandEvent& event);
+	void OnWsDistWeightSldr(wxScrollEvent& event);
+	void OnWsDistWeightText(wxCommandEvent& event);
+	//out of core
+	void OnOutCoreCheck(wxCommandEvent& event);
+	void OnOutCoreMemText(wxCommandEvent& event);
 	//record
 	void OnRecordCmd(wxCommandEvent& event);
 	void OnPlayCmd(wxCommandEvent& event);
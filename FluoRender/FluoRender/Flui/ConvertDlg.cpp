@@ -688,7 +688,7 @@ void ConvertDlg::MeshColor()
 	auto md = glbin_conv_vol_mesh->GetMeshData();
 	if (!md)
 		return;
-	if (vd->GetLabel(false))
+	if (vd->HasLabel())
 	{
 		glbin_color_mesh.SetUseSel(true);
 		glbin_color_mesh.SetUseComp(true);
@@ -102,7 +102,10 @@ bool DnDFile::OnDropFiles(wxCoord x, wxCoord y, const wxArrayString &filenames)
 			{
 				glbin_data_manager.LoadVolumes(std_filenames, false);
 			}
-			else if (suffix == L".obj")
+			else if (suffix == L".obj" ||
+				suffix == L".ply" ||
+				suffix == L".stl" ||
+				suffix == L".fmsh")
 			{
 				glbin_data_manager.LoadMeshFiles(std_filenames);
 			}
@@ -555,7 +555,10 @@ void ListPanel::SaveSelection()
 			break;
 		ModalDlg fopendlg(
 			m_frame, "Save Mesh Data", "", "",
-			"OBJ file (*.obj)|*.obj",
+			"OBJ file (*.obj)|*.obj|"\
+			"PLY file (*.ply)|*.ply|"\
+			"STL file (*.stl)|*.stl|"\
+			"FluoRender mesh (*.fmsh)|*.fmsh",
 			wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
 
 		int rval = fopendlg.ShowModal();
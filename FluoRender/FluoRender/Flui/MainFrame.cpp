@@ -2499,7 +2499,7 @@ void MainFrame::OpenMesh()
 {
 	ModalDlg fopendlg(
 		this, "Choose the mesh data file",
-		"", "", "*.obj", wxFD_OPEN | wxFD_MULTIPLE);
+		"", "", "*.obj;*.ply;*.stl;*.fmsh", wxFD_OPEN | wxFD_MULTIPLE);
 
 	int rval = fopendlg.ShowModal();
 	if (rval == wxID_OK)
@@ -2962,6 +2962,23 @@ wxWindow* MainFrame::CreateExtraControlVolume(wxWindow* parent)
 		wxCommandEventHandler(MainFrame::OnCh3Check), NULL, panel);
 	ch3->SetValue(glbin_settings.m_skip_brick);
 
+	//16-bit to 8-bit mapping
+	wxBoxSizer* sizer3 = new wxBoxSizer(wxHORIZONTAL);
+	wxStaticText* st3 = new wxStaticText(panel, 0,
+		"Map 16-bit data to 8 bits:");
+	wxComboBox* combo3 = new wxComboBox(panel, ID_BIT_REDUCE,
+		"", wxDefaultPosition, parent->FromDIP(wxSize(120, 20)), 0, NULL, wxCB_READONLY);
+	combo3->Connect(combo3->GetId(), wxEVT_COMMAND_COMBOBOX_SELECTED,
+		wxCommandEventHandler(MainFrame::OnBitReduceCmb), NULL, panel);
+	std::vector<std::string> br_list = {
+		"Off", "Min/max", "Percentiles", "Gamma", "Drop low bits" };
+	for (size_t i = 0; i < br_list.size(); ++i)
+		combo3->Append(br_list[i]);
+	combo3->SetSelection(glbin_settings.m_bit_reduce);
+	sizer3->Add(st3, 0, wxALIGN_CENTER);
+	sizer3->Add(5, 5);
+	sizer3->Add(combo3, 0, wxALIGN_CENTER);
+
 	//time sequence identifier
 	wxBoxSizer* sizer2 = new wxBoxSizer(wxHORIZONTAL);
 	wxTextCtrl* txt1 = new wxTextCtrl(panel, ID_TSEQ_ID,
@@ -2982,6 +2999,8 @@ wxWindow* MainFrame::CreateExtraControlVolume(wxWindow* parent)
 	group1->Add(10, 10);
 	group1->Add(ch3);
 	group1->Add(10, 10);
+	group1->Add(sizer3);
+	group1->Add(10, 10);
 	group1->Add(sizer2);
 	group1->Add(10, 10);
 
@@ -3016,11 +3035,30 @@ wxWindow* MainFrame::CreateExtraControlVolumeForImport(wxWindow* parent)
 		wxCommandEventHandler(MainFrame::OnCh3Check), NULL, panel);
 	ch3->SetValue(glbin_settings.m_skip_brick);
 
+	//16-bit to 8-bit mapping
+	wxBoxSizer* sizer3 = new wxBoxSizer(wxHORIZONTAL);
+	wxStaticText* st3 = new wxStaticText(panel, 0,
+		"Map 16-bit data to 8 bits:");
+	wxComboBox* combo3 = new wxComboBox(panel, ID_BIT_REDUCE,
+		"", wxDefaultPosition, parent->FromDIP(wxSize(120, 20)), 0, NULL, wxCB_READONLY);
+	combo3->Connect(combo3->GetId(), wxEVT_COMMAND_COMBOBOX_SELECTED,
+		wxCommandEventHandler(MainFrame::OnBitReduceCmb), NULL, panel);
+	std::vector<std::string> br_list = {
+		"Off", "Min/max", "Percentiles", "Gamma", "Drop low bits" };
+	for (size_t i = 0; i < br_list.size(); ++i)
+		combo3->Append(br_list[i]);
+	combo3->SetSelection(glbin_settings.m_bit_reduce);
+	sizer3->Add(st3, 0, wxALIGN_CENTER);
+	sizer3->Add(5, 5);
+	sizer3->Add(combo3, 0, wxALIGN_CENTER);
+
 	group1->Add(10, 10);
 	group1->Add(ch2);
 	group1->Add(10, 10);
 	group1->Add(ch3);
 	group1->Add(10, 10);
+	group1->Add(sizer3);
+	group1->Add(10, 10);
 
 	panel->SetSizerAndFit(group1);
 	panel->Layout();
@@ -3122,6 +3160,13 @@ void MainFrame::OnCh3Check(wxCommandEvent& event)
 		glbin_settings.m_skip_brick = ch3->GetValue();
 }
 
+void MainFrame::OnBitReduceCmb(wxCommandEvent& event)
+{
+	wxComboBox* combo3 = (wxComboBox*)event.GetEventObject();
+	if (combo3)
+		glbin_settings.m_bit_reduce = combo3->GetSelection();
+}
+
 void MainFrame::OnChEmbedCheck(wxCommandEvent& event)
 {
 	wxCheckBox* ch_embed = (wxCheckBox*)event.GetEventObject();
@@ -225,6 +225,7 @@ class MainFrame : public wxFrame
 		ID_SER_NUM,
 		ID_COMPRESS,
 		ID_SKIP_BRICKS,
+		ID_BIT_REDUCE,
 		ID_TSEQ_ID,
 		ID_EMBED_FILES,
 		ID_LZW_COMP
@@ -451,6 +452,7 @@ private:
 	void OnTxt2Change(wxCommandEvent& event);
 	void OnCh2Check(wxCommandEvent& event);
 	void OnCh3Check(wxCommandEvent& event);
+	void OnBitReduceCmb(wxCommandEvent& event);
 	void OnChEmbedCheck(wxCommandEvent& event);
 	void OnChSaveCmpCheck(wxCommandEvent& event);
 	void OnSysColorChanged(wxSysColourChangedEvent& event);
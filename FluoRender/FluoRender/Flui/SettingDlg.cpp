@@ -38,6 +38,7 @@ DEALINGS IN THE SOFTWARE.
 #include <KernelProgram.h>
 #include <Texture.h>
 #include <TextRenderer.h>
+#include <MemRegistry.h>
 #include <wxSingleSlider.h>
 #include <ModalDlg.h>
 #include <wx/valnum.h>
@@ -634,6 +635,44 @@ wxWindow* SettingDlg::CreatePerformancePage(wxWindow *parent)
 	group3->Add(sizer3_2, 0, wxEXPAND);
 	group3->Add(10, 5);
 
+	//memory usage
+	wxStaticBoxSizer *group4 = new wxStaticBoxSizer(
+		wxVERTICAL, page, "Memory Usage");
+	m_mem_info_text = new wxTextCtrl(page, wxID_ANY, "",
+		wxDefaultPosition, FromDIP(wxSize(-1, 200)),
+		wxTE_READONLY | wxTE_MULTILINE | wxHSCROLL);
+	m_mem_info_text->SetFont(wxFont(wxFontInfo().Family(wxFONTFAMILY_TELETYPE)));
+	wxBoxSizer* sizer4_1 = new wxBoxSizer(wxHORIZONTAL);
+	m_mem_log_text = new wxTextCtrl(page, wxID_ANY, "0",
+		wxDefaultPosition, FromDIP(wxSize(40, -1)), wxTE_RIGHT, vald_int);
+	m_mem_log_text->Bind(wxEVT_TEXT, &SettingDlg::OnMemLogEdit, this);
+	m_mem_refresh_btn = new wxButton(page, wxID_ANY, "Refresh");
+	m_mem_refresh_btn->Bind(wxEVT_BUTTON, &SettingDlg::OnMemRefreshBtn, this);
+	m_mem_reset_btn = new wxButton(page, wxID_ANY, "Reset Peaks");
+	m_mem_reset_btn->Bind(wxEVT_BUTTON, &SettingDlg::OnMemResetBtn, this);
+	sizer4_1->Add(new wxStaticText(page, 0, "Log Interval:"),
+		0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+	sizer4_1->Add(m_mem_log_text, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
+	sizer4_1->Add(new wxStaticText(page, 0, "s"),
+		0, wxALIGN_CENTER_VERTICAL);
+	sizer4_1->AddStretchSpacer();
+	sizer4_1->Add(m_mem_refresh_btn, 0, wxALIGN_CENTER);
+	sizer4_1->Add(m_mem_reset_btn, 0, wxALIGN_CENTER);
+	wxBoxSizer* sizer4_2 = new wxBoxSizer(wxHORIZONTAL);
+	st = new wxStaticText(page, 0,
+		"Memory used by volumes, caches, textures and OpenCL buffers. "\
+		"When the log interval is not 0, the usage is appended to "\
+		"memory_log.csv in the settings folder.");
+	st->Wrap(FromDIP(450));
+	sizer4_2->Add(st, 1, wxEXPAND);
+	group4->Add(10, 5);
+	group4->Add(m_mem_info_text, 0, wxEXPAND);
+	group4->Add(10, 5);
+	group4->Add(sizer4_1, 0, wxEXPAND);
+	group4->Add(10, 5);
+	group4->Add(sizer4_2, 0, wxEXPAND);
+	group4->Add(10, 5);
+
 	wxBoxSizer *sizerV = new wxBoxSizer(wxVERTICAL);
 	sizerV->Add(10, 10);
 	sizerV->Add(group1, 0, wxEXPAND);
@@ -641,6 +680,8 @@ wxWindow* SettingDlg::CreatePerformancePage(wxWindow *parent)
 	sizerV->Add(group2, 0, wxEXPAND);
 	sizerV->Add(10, 10);
 	sizerV->Add(group3, 0, wxEXPAND);
+	sizerV->Add(10, 10);
+	sizerV->Add(group4, 0, wxEXPAND);
 
 	page->SetSizer(sizerV);
 	page->SetAutoLayout(true);
@@ -1212,7 +1253,10 @@ void SettingDlg::FluoUpdate(const fluo::ValueCollection& vc)
 		m_response_time_sldr->ChangeValue(std::round(glbin_settings.m_up_time / 10.0));
 		m_detail_level_offset_text->ChangeValue(wxString::Format("%d", -glbin_settings.m_detail_level_offset));
 		m_detail_level_offset_sldr->ChangeValue(-glbin_settings.m_detail_level_offset);
+		m_mem_log_text->ChangeValue(wxString::Format("%d", (int)glbin_settings.m_mem_log_interval));
 	}
+	if (update_all)
+		UpdateMemInfo();
 
 	//automate page
 	if (update_all || FOUND_VALUE(gstAutomate))
@@ -1808,6 +1852,33 @@ void SettingDlg::OnResponseTimeEdit(wxCommandEvent& event)
 	glbin_settings.m_up_time = val;
 }
 
+void SettingDlg::UpdateMemInfo()
+{
+	glbin_data_manager.ReportMemory();
+	m_mem_info_text->ChangeValue(glbin_mem_registry.GetText(true));
+}
+
+void SettingDlg::OnMemRefreshBtn(wxCommandEvent& event)
+{
+	UpdateMemInfo();
+}
+
+void SettingDlg::OnMemResetBtn(wxCommandEvent& event)
+{
+	glbin_mem_registry.ResetPeak();
+	UpdateMemInfo();
+}
+
+void SettingDlg::OnMemLogEdit(wxCommandEvent& event)
+{
+	wxString str = m_mem_log_text->GetValue();
+	double val;
+	str.ToDouble(&val);
+	if (val < 0.0)
+		return;
+	glbin_settings.m_mem_log_interval = val;
+}
+
 void SettingDlg::OnDetailLevelOffsetChange(wxScrollEvent& event)
 {
 	int ival = m_detail_level_offset_sldr->GetValue();
@@ -110,6 +110,11 @@ private:
 	wxTextCtrl* m_response_time_text;
 	wxSingleSlider* m_detail_level_offset_sldr;
 	wxTextCtrl* m_detail_level_offset_text;
+	//memory usage
+	wxTextCtrl* m_mem_info_text;
+	wxButton* m_mem_refresh_btn;
+	wxButton* m_mem_reset_btn;
+	wxTextCtrl* m_mem_log_text;
 	//font
 	wxComboBox* m_font_cmb;
 	wxComboBox* m_font_size_cmb;
@@ -220,6 +225,11 @@ private:
 	void OnBlockSizeEdit(wxCommandEvent& event);
 	void OnResponseTimeChange(wxScrollEvent& event);
 	void OnResponseTimeEdit(wxCommandEvent& event);
+	//memory usage
+	void UpdateMemInfo();
+	void OnMemRefreshBtn(wxCommandEvent& event);
+	void OnMemResetBtn(wxCommandEvent& event);
+	void OnMemLogEdit(wxCommandEvent& event);
 	void OnDetailLevelOffsetChange(wxScrollEvent& event);
 	void OnDetailLevelOffsetEdit(wxCommandEvent& event);
 	//font
@@ -1106,7 +1106,10 @@ void TrackDlg::DeleteSelection(int type)
 
 void TrackDlg::WriteInfo(const std::wstring& str)
 {
-	(*m_stat_text) << str;
+	//track files are written on a background thread
+	CallAfter([this, str] {
+		(*m_stat_text) << str;
+	});
 }
 
 void TrackDlg::OnClearTrace(wxCommandEvent& event)
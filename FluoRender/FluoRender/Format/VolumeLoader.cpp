@@ -248,6 +248,19 @@ void VolumeLoader::RemoveBrickVD(VolumeData *vd)
 	}
 }
 
+unsigned long long VolumeLoader::GetUsedMemory(VolumeData *vd)
+{
+	unsigned long long size = 0;
+	for (auto& elem : m_loaded)
+	{
+		if (vd && elem.second.vd != vd)
+			continue;
+		if (elem.second.brick->isLoaded())
+			size += elem.second.datasize;
+	}
+	return size;
+}
+
 bool VolumeLoader::sort_data_dsc(const VolumeLoaderData b1, const VolumeLoaderData b2)
 {
 	return b2.brick->get_d() > b1.brick->get_d();
@@ -62,6 +62,8 @@ public:
 	void CleanupLoadedBrick();
 	void RemoveAllLoadedBrick();
 	void RemoveBrickVD(VolumeData *vd);
+	//bytes of loaded bricks, only those of vd if given
+	unsigned long long GetUsedMemory(VolumeData *vd = 0);
 
 	static bool sort_data_dsc(const VolumeLoaderData b1, const VolumeLoaderData b2);
 	static bool sort_data_asc(const VolumeLoaderData b1, const VolumeLoaderData b2);
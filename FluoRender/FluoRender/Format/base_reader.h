@@ -62,6 +62,9 @@ DEALINGS IN THE SOFTWARE.
 #define READER_DCM_TYPE	15
 //mesh types
 #define READER_OBJ_TYPE	50
+#define READER_PLY_TYPE	51
+#define READER_STL_TYPE	52
+#define READER_FMSH_TYPE	53
 
 class BaseReader : public Progress
 {
@@ -27,7 +27,12 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <base_vol_reader.h>
+#include <Global.h>
+#include <FrameCache.h>
+#include <BufferPool.h>
 #include <compatibility.h>
+#include <algorithm>
+#include <cstring>
 
 BaseVolReader::BaseVolReader() :
 	BaseReader()
@@ -35,6 +40,123 @@ BaseVolReader::BaseVolReader() :
 
 }
 
+BaseVolReader::~BaseVolReader()
+{
+	//cached frames are keyed on the reader
+	glbin_frame_cache.Erase(this);
+}
+
+void BaseVolReader::SetBitReduce(int mode)
+{
+	if (mode == m_bit_reduce)
+		return;
+	m_bit_reduce = mode;
+	ResetBitReduce();
+}
+
+void BaseVolReader::SetBitReducePercentile(double lo, double hi)
+{
+	m_br_lo = lo;
+	m_br_hi = hi;
+	ResetBitReduce();
+}
+
+void BaseVolReader::SetBitReduceGamma(double gamma)
+{
+	m_br_gamma = gamma;
+	ResetBitReduce();
+}
+
+void BaseVolReader::SetBitReduceRange(double min_val, double max_val)
+{
+	m_br_min = min_val;
+	m_br_max = max_val;
+	ResetBitReduce();
+}
+
+BitReducer& BaseVolReader::GetBitReducer(int c)
+{
+	auto it = m_bit_reducers.find(c);
+	if (it != m_bit_reducers.end())
+		return it->second;
+	BitReducer& br = m_bit_reducers[c];
+	br.SetMode(m_bit_reduce);
+	br.SetPercentile(m_br_lo, m_br_hi);
+	br.SetGamma(m_br_gamma);
+	br.SetRange(m_br_min, m_br_max);
+	return br;
+}
+
+void BaseVolReader::ResetBitReduce()
+{
+	m_bit_reducers.clear();
+	//frames in the cache were read with the old mapping
+	glbin_frame_cache.Erase(this);
+}
+
+bool BaseVolReader::ReduceBits(Nrrd* nrrd, int c)
+{
+	if (m_bit_reduce == BitReducer::Disabled ||
+		!nrrd || !nrrd->data || nrrd->type != nrrdTypeUShort)
+		return false;
+	size_t n = nrrdElementNumber(nrrd);
+	uint16_t* val16 = static_cast<uint16_t*>(nrrd->data);
+	//the first frame of a channel sets an automatic range
+	BitReducer& br = GetBitReducer(c);
+	if (!br.GetReady() && br.NeedSamples())
+		br.AddSamples(val16, n);
+	//8-bit values go to the front of the same buffer
+	//a chunk only overwrites values already mapped
+	const size_t chunk = size_t(1) << 20;
+	std::vector<uint8_t> buf(std::min(n, chunk));
+	uint8_t* val8 = reinterpret_cast<uint8_t*>(val16);
+	for (size_t i = 0; i < n; i += chunk)
+	{
+		size_t num = std::min(chunk, n - i);
+		br.Map(val16 + i, buf.data(), num);
+		std::memcpy(val8 + i, buf.data(), num);
+	}
+	nrrd->data = glbin_buffer_pool.Shrink(val8, n);
+	nrrd->type = nrrdTypeUChar;
+	return true;
+}
+
+uint8_t* BaseVolReader::ReduceSlices(int c, size_t slice_size, size_t nz,
+	const std::function<bool(size_t z, uint16_t* dst)>& read_slice)
+{
+	if (m_bit_reduce == BitReducer::Disabled || !slice_size || !nz)
+		return 0;
+	uint16_t* val16 = glbin_buffer_pool.Alloc<uint16_t>(slice_size);
+	if (!val16)
+		return 0;
+	uint8_t* val8 = glbin_buffer_pool.Alloc<uint8_t>(slice_size * nz);
+	if (!val8)
+	{
+		glbin_buffer_pool.Free(val16, slice_size * sizeof(uint16_t));
+		return 0;
+	}
+	//like tiff, every few slices of the first frame are read for the range
+	BitReducer& br = GetBitReducer(c);
+	if (!br.GetReady() && br.NeedSamples())
+	{
+		size_t step = std::max(nz / 16, size_t(1));
+		for (size_t z = 0; z < nz; z += step)
+			if (read_slice(z, val16))
+				br.AddSamples(val16, slice_size);
+		br.Finish();
+	}
+	for (size_t z = 0; z < nz; ++z)
+	{
+		uint8_t* dst = val8 + z * slice_size;
+		if (read_slice(z, val16))
+			br.Map(val16, dst, slice_size);
+		else
+			std::memset(dst, 0, slice_size);
+	}
+	glbin_buffer_pool.Free(val16, slice_size * sizeof(uint16_t));
+	return val8;
+}
+
 void BaseVolReader::AnalyzeNamePattern(const std::wstring &path_name)
 {
 	m_name_patterns.clear();
@@ -34,7 +34,10 @@ DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <deque>
 #include <set>
+#include <map>
 #include <cstdint>
+#include <functional>
+#include <bit_reducer.h>
 
 namespace fluo
 {
@@ -44,7 +47,7 @@ class BaseVolReader : public BaseReader
 {
 public:
 	BaseVolReader();
-	virtual ~BaseVolReader() {};
+	virtual ~BaseVolReader();
 
 	//set reader flag to read a 3D stack as a file sequence, each file being a slice
 	//in UI, it is set in the open file dialog as "read a sequence as z slices..."
@@ -135,6 +138,16 @@ public:
 	void GetFpRange(double& min_val, double& max_val) { min_val = m_fp_min; max_val = m_fp_max; }
 	void SetFpRange(double min_val, double max_val) { m_fp_min = min_val; m_fp_max = max_val; }
 
+	//map 16-bit data to 8 bits, see BitReducer::Mode
+	//tiff pages and the slices of other stack readers are mapped while decoding
+	//readers that get a frame whole map it in place
+	void SetBitReduce(int mode);
+	int GetBitReduce() { return m_bit_reduce; }
+	void SetBitReducePercentile(double lo, double hi);
+	void SetBitReduceGamma(double gamma);
+	//an empty range is found from the first frame read of each channel
+	void SetBitReduceRange(double min_val, double max_val);
+
 protected:
 	//resizing
 	int m_resize_type;		//0: no resizing; 1: padding; 2: resampling
@@ -145,6 +158,25 @@ protected:
 	double m_fp_min;
 	double m_fp_max;
 
+	//bit reduction
+	int m_bit_reduce = 0;
+	double m_br_lo = 0.1;
+	double m_br_hi = 99.9;
+	double m_br_gamma = 1.0;
+	double m_br_min = 0.0;
+	double m_br_max = 0.0;
+	std::map<int, BitReducer> m_bit_reducers;//per channel, kept for all time points
+	BitReducer& GetBitReducer(int c);
+	void ResetBitReduce();
+	//replace 16-bit data of a frame read whole with 8 bits, in place
+	//true if mapped, the reader then resets its value range
+	bool ReduceBits(Nrrd* nrrd, int c);
+	//read a 16-bit frame slice by slice to 8 bits, 0 if not reducing
+	//read_slice decodes slice z to a buffer of slice_size values
+	//an automatic range is sampled from a few slices first
+	uint8_t* ReduceSlices(int c, size_t slice_size, size_t nz,
+		const std::function<bool(size_t z, uint16_t* dst)>& read_slice);
+
 	//sequence type
 	bool m_slice_seq = false;
 	bool m_chann_seq = false;
@@ -0,0 +1,163 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <bit_reducer.h>
+#include <Parallel.h>
+#include <algorithm>
+#include <cmath>
+
+//threads are not worth it for small pages
+static unsigned int ThreadNum(size_t n)
+{
+	size_t tn = n / (1 << 18) + 1;
+	return static_cast<unsigned int>(std::min(size_t(flrd::GetThreadNum()), tn));
+}
+
+BitReducer::BitReducer() :
+	m_mode(Disabled),
+	m_lo(0.1),
+	m_hi(99.9),
+	m_gamma(1.0),
+	m_min(0.0),
+	m_max(0.0),
+	m_ready(false)
+{
+}
+
+BitReducer::~BitReducer()
+{
+}
+
+bool BitReducer::NeedSamples()
+{
+	return m_max <= m_min;
+}
+
+void BitReducer::AddSamples(const uint16_t* data, size_t n)
+{
+	if (!data || !n)
+		return;
+	if (m_hist.empty())
+		m_hist.assign(65536, 0);
+	unsigned int tn = ThreadNum(n);
+	std::vector<std::vector<uint64_t>> hists(tn);
+	flrd::ParallelFor(n, [&](size_t b, size_t e, unsigned int t)
+	{
+		std::vector<uint64_t>& h = hists[t];
+		h.assign(65536, 0);
+		for (size_t i = b; i < e; ++i)
+			h[data[i]]++;
+	}, tn);
+	for (auto& h : hists)
+	{
+		if (h.empty())
+			continue;
+		for (size_t i = 0; i < 65536; ++i)
+			m_hist[i] += h[i];
+	}
+}
+
+void BitReducer::Finish()
+{
+	if (NeedSamples())
+	{
+		size_t lo = 0, hi = 65535;
+		uint64_t total = 0;
+		for (auto i : m_hist)
+			total += i;
+		if (total)
+		{
+			uint64_t lo_count = 1, hi_count = total;
+			if (m_mode == Percentile)
+			{
+				lo_count = std::max(uint64_t(1),
+					uint64_t(std::ceil(total * std::clamp(m_lo, 0.0, 100.0) / 100.0)));
+				hi_count = std::max(uint64_t(1),
+					uint64_t(std::ceil(total * std::clamp(m_hi, 0.0, 100.0) / 100.0)));
+			}
+			uint64_t sum = 0;
+			bool lo_found = false;
+			for (size_t i = 0; i < 65536; ++i)
+			{
+				sum += m_hist[i];
+				if (!lo_found && sum >= lo_count)
+				{
+					lo = i;
+					lo_found = true;
+				}
+				if (sum >= hi_count)
+				{
+					hi = i;
+					break;
+				}
+			}
+		}
+		m_min = double(lo);
+		m_max = double(std::max(hi, lo + 1));
+	}
+	m_hist.clear();
+	m_hist.shrink_to_fit();
+
+	m_table.resize(65536);
+	if (m_mode == Shift)
+	{
+		//bits used by the max value
+		int bits = 0;
+		for (unsigned int v = static_cast<unsigned int>(m_max); v; v >>= 1)
+			bits++;
+		int shift = std::max(bits - 8, 0);
+		for (size_t i = 0; i < 65536; ++i)
+			m_table[i] = static_cast<uint8_t>(std::min(i >> shift, size_t(255)));
+	}
+	else
+	{
+		double range = m_max - m_min;
+		double inv_gamma = m_mode == Gamma && m_gamma > 0.0 ? 1.0 / m_gamma : 1.0;
+		for (size_t i = 0; i < 65536; ++i)
+		{
+			double t = std::clamp((double(i) - m_min) / range, 0.0, 1.0);
+			if (inv_gamma != 1.0)
+				t = std::pow(t, inv_gamma);
+			m_table[i] = static_cast<uint8_t>(std::round(t * 255.0));
+		}
+	}
+	m_ready = true;
+}
+
+void BitReducer::Map(const uint16_t* src, uint8_t* dst, size_t n)
+{
+	if (!src || !dst || !n)
+		return;
+	if (!m_ready)
+		Finish();
+	const uint8_t* table = m_table.data();
+	flrd::ParallelFor(n, [&](size_t b, size_t e, unsigned int)
+	{
+		for (size_t i = b; i < e; ++i)
+			dst[i] = table[src[i]];
+	}, ThreadNum(n));
+}
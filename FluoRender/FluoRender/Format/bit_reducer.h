@@ -0,0 +1,84 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef _BIT_REDUCER_H_
+#define _BIT_REDUCER_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//maps 16-bit intensities to 8 bits through a lookup table
+//a reader feeds decoded pages to it, so no 16-bit copy of the volume is kept
+class BitReducer
+{
+public:
+	enum Mode
+	{
+		Disabled = 0,
+		MinMax,		//linear between min and max values
+		Percentile,	//linear between low and high percentiles
+		Gamma,		//min/max with a gamma curve
+		Shift		//drop low bits beyond the used precision
+	};
+
+	BitReducer();
+	~BitReducer();
+
+	void SetMode(int mode) { m_mode = mode; m_ready = false; }
+	int GetMode() { return m_mode; }
+	//percentiles in [0, 100]
+	void SetPercentile(double lo, double hi) { m_lo = lo; m_hi = hi; m_ready = false; }
+	void SetGamma(double gamma) { m_gamma = gamma; m_ready = false; }
+	//fixed value range, an empty range is found from the data
+	void SetRange(double min_val, double max_val) { m_min = min_val; m_max = max_val; m_ready = false; }
+	void GetRange(double& min_val, double& max_val) { min_val = m_min; max_val = m_max; }
+
+	//the table is built and kept for later frames
+	bool GetReady() { return m_ready; }
+	//a fixed range needs no samples
+	bool NeedSamples();
+	//accumulate samples for an automatic range
+	void AddSamples(const uint16_t* data, size_t n);
+	//find the range and build the table
+	void Finish();
+	//convert n values, in parallel
+	void Map(const uint16_t* src, uint8_t* dst, size_t n);
+
+private:
+	int m_mode;
+	double m_lo;
+	double m_hi;
+	double m_gamma;
+	double m_min;
+	double m_max;
+	bool m_ready;
+	std::vector<uint64_t> m_hist;
+	std::vector<uint8_t> m_table;
+};
+
+#endif//_BIT_REDUCER_H_
@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <locale>
 #include <algorithm>
+#include <cstring>
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -968,6 +969,69 @@ int BRKXMLReader::GetFileType(int lv)
 	return m_pyramid[lv].file_type;
 }
 
+bool BRKXMLReader::GetLevelSize(int lv, int& nx, int& ny, int& nz, int& bytes)
+{
+	if (lv < 0 || lv >= m_level_num || lv >= (int)m_pyramid.size())
+		return false;
+	LevelInfo& level = m_pyramid[lv];
+	nx = level.imageW;
+	ny = level.imageH;
+	nz = level.imageD;
+	bytes = level.bit_depth / 8;
+	return true;
+}
+
+bool BRKXMLReader::ReadRegion(int t, int c, int lv,
+	const int org[3], const int size[3], void* dst)
+{
+	if (!dst || lv < 0 || lv >= m_level_num || lv >= (int)m_pyramid.size())
+		return false;
+	LevelInfo& level = m_pyramid[lv];
+	if (t < 0 || t >= (int)level.filename.size() ||
+		c < 0 || c >= (int)level.filename[t].size())
+		return false;
+	size_t bytes = level.bit_depth / 8;
+	if (bytes != 1 && bytes != 2)
+		return false;
+
+	size_t sx = size[0];
+	size_t sy = size[1];
+	std::vector<char> buf;
+	for (auto b : level.bricks)
+	{
+		//overlap of the brick and the box
+		int x0 = std::max(org[0], b->x_start);
+		int y0 = std::max(org[1], b->y_start);
+		int z0 = std::max(org[2], b->z_start);
+		int x1 = std::min(org[0] + size[0], b->x_start + b->x_size);
+		int y1 = std::min(org[1] + size[1], b->y_start + b->y_size);
+		int z1 = std::min(org[2] + size[2], b->z_start + b->z_size);
+		if (x0 >= x1 || y0 >= y1 || z0 >= z1)
+			continue;
+		if (b->id < 0 || b->id >= (int)level.filename[t][c].size())
+			return false;
+
+		size_t bx = b->x_size;
+		size_t by = b->y_size;
+		buf.resize(bx * by * b->z_size * bytes);
+		if (!flvr::TextureBrick::read_brick(buf.data(), buf.size(),
+			level.filename[t][c][b->id]))
+			return false;
+
+		size_t len = size_t(x1 - x0) * bytes;
+		for (int z = z0; z < z1; ++z)
+		for (int y = y0; y < y1; ++y)
+		{
+			size_t si = ((size_t(z - b->z_start) * by + (y - b->y_start)) * bx +
+				(x0 - b->x_start)) * bytes;
+			size_t di = ((size_t(z - org[2]) * sy + (y - org[1])) * sx +
+				(x0 - org[0])) * bytes;
+			memcpy(static_cast<char*>(dst) + di, buf.data() + si, len);
+		}
+	}
+	return true;
+}
+
 void BRKXMLReader::OutputInfo()
 {
 	std::ofstream ofs;
@@ -89,6 +89,12 @@ public:
 	int GetFileType(int lv = -1);
 
 	int GetLevelNum() {return m_level_num;}
+	//size and bytes per voxel of a level
+	bool GetLevelSize(int lv, int& nx, int& ny, int& nz, int& bytes);
+	//copy a box of a level from the bricks covering it
+	//dst holds size[0]*size[1]*size[2] voxels
+	bool ReadRegion(int t, int c, int lv,
+		const int org[3], const int size[3], void* dst);
 	void SetLevel(int lv);
 	int GetCopyableLevel() {return m_copy_lv;}
 
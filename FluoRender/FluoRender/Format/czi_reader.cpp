@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <czi_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 #include <XmlUtils.h>
@@ -196,11 +197,11 @@ Nrrd* CZIReader::Convert(int t, int c, bool get_max)
 		switch (m_datatype)
 		{
 		case 1://8-bit
-			val = new (std::nothrow) unsigned char[mem_size];
+			val = glbin_buffer_pool.Alloc<unsigned char>(mem_size);
 			show_progress = mem_size > glbin_settings.m_prg_size;
 			break;
 		case 2://16-bit
-			val = new (std::nothrow) unsigned short[mem_size];
+			val = glbin_buffer_pool.Alloc<unsigned short>(mem_size);
 			show_progress = mem_size * 2 > glbin_settings.m_prg_size;
 			break;
 		}
@@ -234,6 +235,13 @@ Nrrd* CZIReader::Convert(int t, int c, bool get_max)
 
 	fclose(pfile);
 	m_cur_time = t;
+	//16-bit frames are mapped to 8 bits if set
+	if (ReduceBits(data, c))
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 }
 
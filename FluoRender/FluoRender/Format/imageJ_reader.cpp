@@ -297,6 +297,13 @@ Nrrd* ImageJReader::Convert(int t, int c, bool get_max)
 	
 	data = ReadFromImageJ(t, c, get_max);
 	m_cur_time = t;
+	//16-bit frames are mapped to 8 bits if set
+	if (ReduceBits(data, c))
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 }
 
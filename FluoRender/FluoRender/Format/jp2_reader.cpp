@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <jp2_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 #include <openjpeg.h>
@@ -303,7 +304,7 @@ Nrrd* JP2Reader::ReadJp2(const std::vector<SliceInfo>& filelist, int c, bool get
 	Nrrd* nrrdout = nrrdNew();
 
 	unsigned long long total_size = m_size.get_size_xyz();
-	void* val = (void*)(new unsigned char[total_size]);
+	void* val = (void*)(glbin_buffer_pool.Alloc<unsigned char>(total_size));
 	if (!val)
 		return nullptr;
 
@@ -318,7 +319,7 @@ Nrrd* JP2Reader::ReadJp2(const std::vector<SliceInfo>& filelist, int c, bool get
 			continue;
 		if (!ReadSingleJp2(static_cast<void*>(val_ptr), slice_info.slice, c))
 		{
-			delete[] static_cast<unsigned char*>(val);
+			glbin_buffer_pool.Free(val, total_size);
 			return nullptr;
 		}
 		if (show_progress)
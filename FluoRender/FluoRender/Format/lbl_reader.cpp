@@ -26,6 +26,9 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <lbl_reader.h>
+#include <Global.h>
+#include <BufferPool.h>
+#include <LabelCompact.h>
 #include <compatibility.h>
 #include <sstream>
 #include <inttypes.h>
@@ -99,17 +102,36 @@ Nrrd* LBLReader::Convert(int t, int c, bool get_max)
 	rewind(lbl_file);
 	if (output->dim != 3 ||
 		(output->type != nrrdTypeInt &&
-		output->type != nrrdTypeUInt))
+		output->type != nrrdTypeUInt &&
+		output->type != nrrdTypeUShort &&
+		output->type != nrrdTypeUChar))
 	{
 		nrrdNuke(output);
 		fclose(lbl_file);
 		return 0;
 	}
-	int slice_num = int(output->axis[2].size);
-	int x_size = int(output->axis[0].size);
-	int y_size = int(output->axis[1].size);
-	int data_size = slice_num * x_size * y_size;
-	output->data = new unsigned int[data_size];
+	//narrow labels have dense ids and a table of the original ids
+	bool narrow = output->type == nrrdTypeUShort ||
+		output->type == nrrdTypeUChar;
+	flrd::LabelCompact compact;
+	if (narrow)
+	{
+		char* ids = nrrdKeyValueGet(output, "label_ids");
+		bool valid = ids && compact.SetTableString(ids);
+		free(ids);
+		if (!valid)
+		{
+			nrrdNuke(output);
+			fclose(lbl_file);
+			return 0;
+		}
+	}
+	size_t slice_num = output->axis[2].size;
+	size_t x_size = output->axis[0].size;
+	size_t y_size = output->axis[1].size;
+	size_t data_size = slice_num * x_size * y_size;
+	size_t elem = nrrdElementSize(output);
+	output->data = glbin_buffer_pool.Alloc(data_size * elem);
 
 	if (nrrdRead(output, lbl_file, NULL))
 	{
@@ -117,8 +139,21 @@ Nrrd* LBLReader::Convert(int t, int c, bool get_max)
 		fclose(lbl_file);
 		return 0;
 	}
-
 	fclose(lbl_file);
+
+	if (narrow)
+	{
+		//working labels are always 32 bits
+		unsigned int* data = glbin_buffer_pool.Alloc<unsigned int>(data_size);
+		if (elem == 1)
+			compact.Expand(static_cast<unsigned char*>(output->data), data, data_size);
+		else
+			compact.Expand(static_cast<unsigned short*>(output->data), data, data_size);
+		glbin_buffer_pool.Free(output->data, data_size * elem);
+		output->data = data;
+		output->type = nrrdTypeUInt;
+		nrrdKeyValueClear(output);
+	}
 	return output;
 }
 
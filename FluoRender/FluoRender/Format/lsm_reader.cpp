@@ -27,8 +27,10 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <lsm_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
+#include <algorithm>
 
 LSMReader::LSMReader():
 	BaseVolReader()
@@ -668,78 +670,89 @@ Nrrd* LSMReader::Convert(int t, int c, bool get_max)
 		ChannelInfo *cinfo = &m_lsm_info[t][c];
 		size_t blk_num = cinfo->size();
 		unsigned long long mem_size = m_size.get_size_xyz();
+		size_t xy = m_size.get_size_xy();
+		size_t bytes = m_datatype == 1 ? xy : xy * 2;
 		void* val = 0;
 		switch (m_datatype)
 		{
 		case 1://8-bit
-			val = new (std::nothrow) unsigned char[mem_size];
 			show_progress = mem_size > glbin_settings.m_prg_size;
 			break;
 		case 2://16-bit
 		case 3:
-			val = new (std::nothrow) unsigned short[mem_size];
 			show_progress = mem_size * 2 > glbin_settings.m_prg_size;
 			break;
 		}
 
-		for (size_t i = 0; i < blk_num; i++)
+		//decode block i to a slice at dst
+		auto read_slice = [&](size_t i, tidata_t dst)
 		{
+			if (i >= blk_num)
+				return false;
 			if (m_l4gb ?
-				FSEEK64(pfile, ((uint64_t((*cinfo)[i].offset_high)) << 32) + (*cinfo)[i].offset, SEEK_SET) == 0 :
-				FSEEK64(pfile, (*cinfo)[i].offset, SEEK_SET) == 0)
-			{
-				size_t val_pos = 0;
-				switch (m_datatype)
-				{
-				case 1:
-					val_pos = m_size.get_size_xy() * i;
-					break;
-				case 2:
-				case 3:
-					val_pos = m_size.get_size_xy() * i * 2;
-					break;
-				}
+				FSEEK64(pfile, ((uint64_t((*cinfo)[i].offset_high)) << 32) + (*cinfo)[i].offset, SEEK_SET) != 0 :
+				FSEEK64(pfile, (*cinfo)[i].offset, SEEK_SET) != 0)
+				return false;
 
-				if (m_compression == 1)
-				{
-					fread(tidata_t(val) + val_pos, sizeof(uint8_t), (*cinfo)[i].size, pfile);
-				}
-				else if (m_compression == 5)
+			if (m_compression == 1)
+			{
+				fread(dst, sizeof(uint8_t), std::min(size_t((*cinfo)[i].size), bytes), pfile);
+			}
+			else if (m_compression == 5)
+			{
+				unsigned char* tif = new (std::nothrow) unsigned char[(*cinfo)[i].size];
+				fread(tif, sizeof(unsigned char), (*cinfo)[i].size, pfile);
+				LZWDecode(tif, dst, (*cinfo)[i].size);
+				for (size_t j = 0; j < m_size.inty(); j++)
 				{
-					unsigned char* tif = new (std::nothrow) unsigned char[(*cinfo)[i].size];
-					fread(tif, sizeof(unsigned char), (*cinfo)[i].size, pfile);
-					LZWDecode(tif, tidata_t(val) + val_pos, (*cinfo)[i].size);
-					for (size_t j = 0; j < m_size.inty(); j++)
+					switch (m_datatype)
 					{
-						switch (m_datatype)
-						{
-						case 1:
-							DecodeAcc8(tidata_t(val) + val_pos + j * m_size.intx(), m_size.intx(), 1);
-							break;
-						case 2:
-						case 3:
-							DecodeAcc16(tidata_t(val) + val_pos + j * m_size.intx() * 2, m_size.intx(), 1);
-							break;
-						}
+					case 1:
+						DecodeAcc8(dst + j * m_size.intx(), m_size.intx(), 1);
+						break;
+					case 2:
+					case 3:
+						DecodeAcc16(dst + j * m_size.intx() * 2, m_size.intx(), 1);
+						break;
 					}
-					delete[]tif;
 				}
+				delete[]tif;
+			}
+
+			if (show_progress && m_time_num == 1)
+				SetProgress(static_cast<int>(std::round(100.0 * (i + 1) / blk_num)), "NOT_SET");
+			return true;
+		};
 
-				if (show_progress && m_time_num == 1)
-					SetProgress(static_cast<int>(std::round(100.0 * (i + 1) / blk_num)), "NOT_SET");
+		//16-bit slices are mapped to 8 bits as they are decoded
+		bool reduce = false;
+		if (m_datatype == 2 || m_datatype == 3)
+		{
+			val = ReduceSlices(c, xy, m_size.intz(),
+				[&](size_t z, uint16_t* dst) { return read_slice(z, tidata_t(dst)); });
+			reduce = val != 0;
+		}
+		if (!val)
+		{
+			switch (m_datatype)
+			{
+			case 1:
+				val = glbin_buffer_pool.Alloc<unsigned char>(mem_size);
+				break;
+			case 2:
+			case 3:
+				val = glbin_buffer_pool.Alloc<unsigned short>(mem_size);
+				break;
 			}
+			for (size_t i = 0; i < blk_num; i++)
+				read_slice(i, tidata_t(val) + bytes * i);
 		}
 		//create nrrd
 		data = nrrdNew();
-		switch (m_datatype)
-		{
-		case 1:
+		if (reduce || m_datatype == 1)
 			nrrdWrap_va(data, val, nrrdTypeUChar, 3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
-			break;
-		case 2:
+		else
 			nrrdWrap_va(data, val, nrrdTypeUShort, 3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
-			break;
-		}
 		nrrdAxisInfoSet_va(data, nrrdAxisInfoSpacing, m_spacing.x(), m_spacing.y(), m_spacing.z());
 		auto max_size = m_spacing * m_size;
 		nrrdAxisInfoSet_va(data, nrrdAxisInfoMax, max_size.x(), max_size.y(), max_size.z());
@@ -749,6 +762,13 @@ Nrrd* LSMReader::Convert(int t, int c, bool get_max)
 
 	fclose(pfile);
 	m_cur_time = t;
+	//16-bit frames are mapped to 8 bits if set
+	if (data && data->type == nrrdTypeUChar && m_datatype != 1)
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 }
 
@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <mpg_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 extern "C"
@@ -375,7 +376,9 @@ Nrrd* MPGReader::get_nrrd(AVFrame* frame, int c)
 {
 	//extract channel
 	unsigned long long total_size = m_size.get_size_xy();
-	uint8_t* val = new unsigned char[total_size];
+	uint8_t* val = glbin_buffer_pool.Alloc<uint8_t>(total_size);
+	if (!val)
+		return 0;
 	unsigned long long index;
 	for (index = 0; index < total_size; ++index)
 		val[index] = *(frame->data[0] + index * 3 + c);
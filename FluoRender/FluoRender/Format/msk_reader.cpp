@@ -26,6 +26,8 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <msk_reader.h>
+#include <Global.h>
+#include <BufferPool.h>
 #include <compatibility.h>
 #include <sstream>
 #include <inttypes.h>
@@ -102,7 +104,7 @@ Nrrd* MSKReader::Convert(int t, int c, bool get_max)
 	int x_size = int(output->axis[0].size);
 	int y_size = int(output->axis[1].size);
 	unsigned long long data_size = (unsigned long long)slice_num * x_size * y_size;
-	output->data = new unsigned char[data_size];
+	output->data = glbin_buffer_pool.Alloc<unsigned char>(data_size);
 	if (!output->data)
 	{
 		nrrdNuke(output);
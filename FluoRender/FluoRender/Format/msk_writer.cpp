@@ -26,6 +26,8 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <msk_writer.h>
+#include <LabelCompact.h>
+#include <memory>
 #include <sstream>
 #include <inttypes.h>
 
@@ -33,6 +35,7 @@ MSKWriter::MSKWriter()
 {
 	m_data = 0;
 	m_use_spacings = false;
+	m_compact = false;
 	m_time = 0;
 	m_channel = 0;
 }
@@ -86,9 +89,51 @@ void MSKWriter::Save(const std::wstring& filename, int mode)
 	str.assign(filename.length(), 0);
 	for (int i=0; i<(int)filename.length(); i++)
 		str[i] = (char)filename[i];
+	if (mode == 1 && m_compact &&
+		m_data->data && m_data->dim == 3 &&
+		(m_data->type == nrrdTypeUInt || m_data->type == nrrdTypeInt) &&
+		SaveCompact(str))
+		return;
 	nrrdSave(str.c_str(), m_data, NULL);
 }
 
+bool MSKWriter::SaveCompact(const std::string& filename)
+{
+	size_t n = nrrdElementNumber(m_data);
+	const unsigned int* src = static_cast<const unsigned int*>(m_data->data);
+	flrd::LabelCompact compact;
+	if (!compact.Build(src, n))
+		return false;
+
+	//dense ids in the narrowest type, original ids in the header
+	size_t elem = compact.GetElemSize();
+	std::unique_ptr<unsigned char[]> buf(new (std::nothrow) unsigned char[n * elem]);
+	if (!buf)
+		return false;
+	int type;
+	if (elem == 1)
+	{
+		compact.Compact(src, buf.get(), n);
+		type = nrrdTypeUChar;
+	}
+	else
+	{
+		compact.Compact(src, reinterpret_cast<unsigned short*>(buf.get()), n);
+		type = nrrdTypeUShort;
+	}
+
+	Nrrd* nrrd = nrrdNew();
+	nrrdWrap_va(nrrd, buf.get(), type, 3,
+		m_data->axis[0].size,
+		m_data->axis[1].size,
+		m_data->axis[2].size);
+	nrrdAxisInfoCopy(nrrd, m_data, NULL, NRRD_AXIS_INFO_SIZE_BIT);
+	nrrdKeyValueAdd(nrrd, "label_ids", compact.GetTableString().c_str());
+	int err = nrrdSave(filename.c_str(), nrrd, NULL);
+	nrrdNix(nrrd);
+	return !err;
+}
+
 void MSKWriter::SetTC(int t, int c)
 {
 	m_time = t;
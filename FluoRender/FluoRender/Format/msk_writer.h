@@ -40,6 +40,9 @@ public:
 	void SetData(Nrrd* data);
 	void SetSpacing(const fluo::Vector& spc);
 	void SetCompression(bool value);
+	//store labels with dense ids in 8 or 16 bits when possible
+	//only the file is narrow, the reader expands it to 32 bits
+	void SetCompact(bool value) { m_compact = value; }
 	void Save(const std::wstring& filename, int mode);//mode: 0-normal mask; 1-label mask
 
 	void SetTC(int t, int c);
@@ -48,9 +51,12 @@ private:
 	Nrrd* m_data;
 	fluo::Vector m_spc;
 	bool m_use_spacings;
+	bool m_compact;
 
 	int m_time;
 	int m_channel;
+
+	bool SaveCompact(const std::string& filename);
 };
 
 #endif//_MSK_WRITER_H_
@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <nd2_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 #if defined(_WIN32) || defined(__APPLE__)
@@ -172,7 +173,7 @@ Nrrd* ND2Reader::Convert(int t, int c, bool get_max)
 		case 8:
 		{
 			unsigned long long mem_size = m_size.get_size_xyz();
-			unsigned char *val = new (std::nothrow) unsigned char[mem_size];
+			unsigned char *val = glbin_buffer_pool.Alloc<unsigned char>(mem_size);
 			ReadChannel(h, t, c, val);
 			//create nrrd
 			data = nrrdNew();
@@ -187,7 +188,7 @@ Nrrd* ND2Reader::Convert(int t, int c, bool get_max)
 		case 16:
 		{
 			unsigned long long mem_size = m_size.get_size_xyz();
-			unsigned short *val = new (std::nothrow) unsigned short[mem_size];
+			unsigned short *val = glbin_buffer_pool.Alloc<unsigned short>(mem_size);
 			ReadChannel(h, t, c, val);
 			//create nrrd
 			data = nrrdNew();
@@ -205,6 +206,13 @@ Nrrd* ND2Reader::Convert(int t, int c, bool get_max)
 	Lim_FileClose(h);
 	m_cur_time = t;
 
+	//16-bit frames are mapped to 8 bits if set
+	if (ReduceBits(data, c))
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 #else
 	return nullptr;
@@ -26,6 +26,9 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <nrrd_reader.h>
+#include <Global.h>
+#include <BufferPool.h>
+#include <LabelCompact.h>
 #include <compatibility.h>
 #include <algorithm>
 #include <sstream>
@@ -235,7 +238,7 @@ Nrrd* NRRDReader::Convert(int t, int c, bool get_max)
 	else if (output->type == nrrdTypeInt ||
 		output->type == nrrdTypeUInt)
 		data_size *= 4;
-	output->data = new unsigned char[data_size];
+	output->data = glbin_buffer_pool.Alloc<unsigned char>(data_size);
 
 	if (nrrdRead(output, nrrd_file, NULL))
 	{
@@ -244,6 +247,31 @@ Nrrd* NRRDReader::Convert(int t, int c, bool get_max)
 		return 0;
 	}
 
+	//compact labels opened as volumes get their original ids back
+	if (output->type == nrrdTypeUChar ||
+		output->type == nrrdTypeUShort)
+	{
+		char* ids = nrrdKeyValueGet(output, "label_ids");
+		flrd::LabelCompact compact;
+		if (ids && compact.SetTableString(ids))
+		{
+			size_t elem = nrrdElementSize(output);
+			unsigned int* data = glbin_buffer_pool.Alloc<unsigned int>(nsize);
+			if (data)
+			{
+				if (elem == 1)
+					compact.Expand(static_cast<unsigned char*>(output->data), data, nsize);
+				else
+					compact.Expand(static_cast<unsigned short*>(output->data), data, nsize);
+				glbin_buffer_pool.Free(output->data, data_size);
+				output->data = data;
+				output->type = nrrdTypeUInt;
+				nrrdKeyValueClear(output);
+			}
+		}
+		free(ids);
+	}
+
 	m_max_value = 0.0;
 	// turn signed into unsigned
 	if (output->type == nrrdTypeChar)
@@ -352,6 +380,13 @@ Nrrd* NRRDReader::Convert(int t, int c, bool get_max)
 
 	m_cur_time = t;
 	fclose(nrrd_file);
+	//16-bit frames are mapped to 8 bits if set
+	if (ReduceBits(output, c))
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return output;
 }
 
@@ -26,8 +26,11 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <obj_reader.h>
+#include <Global.h>
+#include <MainSettings.h>
 #include <glm.h>
 #include <compatibility.h>
+#include <filesystem>
 
 ObjReader::ObjReader():
 	BaseMeshReader()
@@ -43,8 +46,52 @@ GLMmodel* ObjReader::Convert(int t)
 	m_data_name = GET_STEM(str_name);
 	m_cur_time = t;
 	std::string str_fn = ws2s(str_name);
+
+	//a binary copy next to the obj file is used when it matches
+	//the size and modification time of the obj file
+	unsigned long long src_size = 0;
+	long long src_time = 0;
+	bool cache = glbin_settings.m_mesh_cache &&
+		GetFileStamp(str_name, src_size, src_time);
+	std::string cache_fn = str_fn + ".fmsh";
+	if (cache)
+	{
+		unsigned long long size = 0;
+		long long time = 0;
+		GLMmodel* model = glmReadBIN(cache_fn.c_str(), &size, &time);
+		if (model && size == src_size && time == src_time)
+		{
+			//the model stands for the obj file
+			free(model->pathname);
+			model->pathname = STRDUP(str_fn.c_str());
+			return model;
+		}
+		if (model)
+			glmDelete(model);
+	}
+
 	bool no_fail = true;
-	return glmReadOBJ(str_fn.c_str(), &no_fail);
+	GLMmodel* model = glmReadOBJ(str_fn.c_str(), &no_fail);
+	//models with material files are not cached,
+	//as the materials may change separately
+	if (model && cache && no_fail && !model->mtllibname)
+		glmWriteBIN(model, cache_fn.c_str(), src_size, src_time);
+	return model;
+}
+
+bool ObjReader::GetFileStamp(const std::wstring& filename,
+	unsigned long long& size, long long& time)
+{
+	std::error_code ec;
+	std::filesystem::path path(filename);
+	size = std::filesystem::file_size(path, ec);
+	if (ec)
+		return false;
+	auto ftime = std::filesystem::last_write_time(path, ec);
+	if (ec)
+		return false;
+	time = static_cast<long long>(ftime.time_since_epoch().count());
+	return true;
 }
 
 void ObjReader::SetBatch(bool batch)
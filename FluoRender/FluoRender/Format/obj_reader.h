@@ -41,6 +41,11 @@ public:
 	virtual GLMmodel* Convert(int t);
 
 	virtual void SetBatch(bool batch);
+
+private:
+	//size and modification time to validate the binary cache
+	bool GetFileStamp(const std::wstring& filename,
+		unsigned long long& size, long long& time);
 };
 
 #endif//_OBJ_READER_H_
\ No newline at end of file
@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <oib_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 #include <pole.h>
@@ -664,69 +665,93 @@ Nrrd *OIBReader::Convert(int t, int c, bool get_max)
 		{
 			//allocate memory for nrrd
 			unsigned long long mem_size = (unsigned long long)m_size.get_size_xyz();
-			unsigned short *val = new (std::nothrow) unsigned short[mem_size];
 			bool show_progress = mem_size > glbin_settings.m_prg_size;
 
-			//enumerate
+			//enumerate directories and the slice streams they hold
+			ChannelInfo *cinfo = &m_oib_info[t].dataset[c];
+			std::vector<std::pair<std::string, size_t>> dirs;
 			std::list<std::string> entries = pStg.entries();
-			size_t i = 0;
-			size_t num = entries.size();
 			for (std::list<std::string>::iterator it = entries.begin();
-				it != entries.end(); ++it, ++i)
+				it != entries.end(); ++it)
 			{
 				if (pStg.isDirectory(*it))
+					dirs.push_back(std::make_pair(*it,
+						std::min(pStg.GetAllStreams(*it).size(), cinfo->size())));
+			}
+			size_t slice_num = static_cast<size_t>(m_size.intz());
+			std::vector<bool> done(slice_num, false);
+			//read stream num to slice pos of val, a later directory comes first
+			auto read_slice = [&](size_t num, unsigned short* val, int pos) -> bool
+			{
+				if (num >= slice_num)
+					return false;
+				for (auto it = dirs.rbegin(); it != dirs.rend() && !done[num]; ++it)
 				{
-					std::list<std::string> streams = pStg.GetAllStreams(*it);
-					size_t num = 0;
-					ChannelInfo *cinfo = &m_oib_info[t].dataset[c];
-					for (std::list<std::string>::iterator its = streams.begin();
-						its != streams.end(); ++its)
-					{
-						if (num >= cinfo->size())
-							break;
-						//fix the stream name
-						std::string str_name = ws2s((*cinfo)[num].stream_name);
-						std::string name = (*it) + std::string("/") + str_name;
+					if (num >= it->second)
+						continue;
+					//fix the stream name
+					std::string str_name = ws2s((*cinfo)[num].stream_name);
+					std::string name = it->first + std::string("/") + str_name;
 
-						POLE::Stream pStm(&pStg, name);
+					POLE::Stream pStm(&pStg, name);
 
-						//open
-						if (!pStm.eof() && !pStm.fail())
+					//open
+					if (!pStm.eof() && !pStm.fail())
+					{
+						//get stream size
+						size_t sz = pStm.size();
+						//allocate 
+						pbyData = new unsigned char[sz];
+						//read
+						if (pStm.read(pbyData, sz))
 						{
-							//get stream size
-							size_t sz = pStm.size();
-							//allocate 
-							pbyData = new unsigned char[sz];
-							if (!pbyData)
-								return NULL;
-							//read
-							if (pStm.read(pbyData, sz))
-							{
-								//copy tiff to val
-								ReadTiff(pbyData, val, static_cast<int>(num));
-
-								//increase
-								sl_num++;
-							}
+							//copy tiff to val
+							ReadTiff(pbyData, val, pos);
+							done[num] = true;
 						}
-
 						//release
-						if (pbyData)
-							delete[] pbyData;
-						num++;
+						delete[] pbyData;
+						pbyData = 0;
 					}
 				}
 
 				if (show_progress && m_time_num == 1)
-					SetProgress(static_cast<int>(std::round(100.0 * (i + 1) / num)), "NOT_SET");
+					SetProgress(static_cast<int>(std::round(100.0 * (num + 1) / slice_num)), "NOT_SET");
+				return done[num];
+			};
+
+			//16-bit slices are mapped to 8 bits as they are read
+			unsigned char* val8 = ReduceSlices(c, m_size.get_size_xy(), slice_num,
+				[&](size_t z, uint16_t* dst)
+				{
+					//the sample pass reads a slice again when mapping
+					done[z] = false;
+					return read_slice(z, dst, 0);
+				});
+			unsigned short* val = 0;
+			if (!val8)
+			{
+				val = glbin_buffer_pool.Alloc<unsigned short>(mem_size);
+				if (val)
+					for (size_t i = 0; i < slice_num; i++)
+						read_slice(i, val, static_cast<int>(i));
 			}
+			sl_num = static_cast<int>(std::count(done.begin(), done.end(), true));
 
 			//create nrrd
-			if (val && sl_num == m_size.intz())
+			if (val8 && sl_num == m_size.intz())
+			{
+				data = nrrdNew();
+				nrrdWrap_va(data, val8, nrrdTypeUChar, 3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
+			}
+			else if (val && sl_num == m_size.intz())
 			{
 				//ok
 				data = nrrdNew();
 				nrrdWrap_va(data, val, nrrdTypeUShort, 3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
+			}
+			if (data)
+			{
 				nrrdAxisInfoSet_va(data, nrrdAxisInfoSpacing, m_spacing.x(), m_spacing.y(), m_spacing.z());
 				auto max_size = m_spacing * m_size;
 				nrrdAxisInfoSet_va(data, nrrdAxisInfoMax, max_size.x(), max_size.y(), max_size.z());
@@ -737,7 +762,9 @@ Nrrd *OIBReader::Convert(int t, int c, bool get_max)
 			{
 				//something is wrong
 				if (val)
-					delete[]val;
+					glbin_buffer_pool.Free(val, mem_size * sizeof(unsigned short));
+				if (val8)
+					glbin_buffer_pool.Free(val8, mem_size);
 			}
 			//release
 			pStg.close();
@@ -748,6 +775,13 @@ Nrrd *OIBReader::Convert(int t, int c, bool get_max)
 		m_scalar_scale = 65535.0 / m_max_value;
 
 	m_cur_time = t;
+	//16-bit frames are mapped to 8 bits if set
+	if (data && data->type == nrrdTypeUChar)
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 }
 
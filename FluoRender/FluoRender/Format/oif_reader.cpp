@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <oif_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 #include <algorithm>
@@ -566,14 +567,17 @@ Nrrd* OIFReader::Convert(int t, int c, bool get_max)
 	{
 		//allocate memory for nrrd
 		unsigned long long mem_size = m_size.get_size_xyz();
-		unsigned short *val = new (std::nothrow) unsigned short[mem_size];
 		bool show_progress = mem_size > glbin_settings.m_prg_size;
 
 		//read the channel
 		ChannelInfo *cinfo = &m_oif_info[t].dataset[c];
 		size_t num = cinfo->size();
-		for (size_t i = 0; i < num; i++)
+		std::vector<bool> done(num, false);
+		//read file i to slice pos of val
+		auto read_slice = [&](size_t i, unsigned short* val, int pos) -> bool
 		{
+			if (i >= num)
+				return false;
 			char *pbyData = 0;
 			std::wstring file_name = (*cinfo)[i];
 
@@ -594,10 +598,8 @@ Nrrd* OIFReader::Convert(int t, int c, bool get_max)
 				is.close();
 
 				//read
-				ReadTiff(pbyData, val, static_cast<int>(i));
-
-				//increase
-				sl_num++;
+				ReadTiff(pbyData, val, pos);
+				done[i] = true;
 			}
 
 			if (pbyData)
@@ -605,14 +607,36 @@ Nrrd* OIFReader::Convert(int t, int c, bool get_max)
 
 			if (show_progress && m_time_num == 1)
 				SetProgress(static_cast<int>(std::round(100.0 * (i + 1) / num)), "NOT_SET");
+			return done[i];
+		};
+
+		//16-bit slices are mapped to 8 bits as they are read
+		unsigned char* val8 = ReduceSlices(c, m_size.get_size_xy(), m_size.intz(),
+			[&](size_t z, uint16_t* dst) { return read_slice(z, dst, 0); });
+		unsigned short* val = 0;
+		if (!val8)
+		{
+			val = glbin_buffer_pool.Alloc<unsigned short>(mem_size);
+			if (val)
+				for (size_t i = 0; i < num; i++)
+					read_slice(i, val, static_cast<int>(i));
 		}
+		sl_num = static_cast<int>(std::count(done.begin(), done.end(), true));
 
 		//create nrrd
-		if (val && sl_num == m_size.intz())
+		if (val8 && sl_num == m_size.intz())
+		{
+			data = nrrdNew();
+			nrrdWrap_va(data, val8, nrrdTypeUChar, 3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
+		}
+		else if (val && sl_num == m_size.intz())
 		{
 			//ok
 			data = nrrdNew();
 			nrrdWrap_va(data, val, nrrdTypeUShort, 3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
+		}
+		if (data)
+		{
 			nrrdAxisInfoSet_va(data, nrrdAxisInfoSpacing, m_spacing.x(), m_spacing.y(), m_spacing.z());
 			auto max_size = m_spacing * m_size;
 			nrrdAxisInfoSet_va(data, nrrdAxisInfoMax, max_size.x(), max_size.y(), max_size.z());
@@ -623,7 +647,9 @@ Nrrd* OIFReader::Convert(int t, int c, bool get_max)
 		{
 			//something is wrong
 			if (val)
-				delete[]val;
+				glbin_buffer_pool.Free(val, mem_size * sizeof(unsigned short));
+			if (val8)
+				glbin_buffer_pool.Free(val8, mem_size);
 		}
 	}
 
@@ -631,6 +657,13 @@ Nrrd* OIFReader::Convert(int t, int c, bool get_max)
 		m_scalar_scale = 65535.0 / m_max_value;
 
 	m_cur_time = t;
+	//16-bit frames are mapped to 8 bits if set
+	if (data && data->type == nrrdTypeUChar)
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 }
 
@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <png_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 #include <png.h>
@@ -315,6 +316,13 @@ Nrrd* PNGReader::Convert(int t, int c, bool get_max)
 	m_data_name = GET_STEM(chan_info.slices[0].slice);
 	data = ReadPng(chan_info.slices, c, get_max);
 	m_cur_time = t;
+	//16-bit frames are mapped to 8 bits if set
+	if (data && data->type == nrrdTypeUChar && m_bits == 16)
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 }
 
@@ -327,32 +335,66 @@ Nrrd* PNGReader::ReadPng(const std::vector<SliceInfo>& filelist, int c, bool get
 	bool eight_bit = m_bits == 8;
 
 	unsigned long long total_size = m_size.get_size_xyz();
-	void* val = eight_bit ? (void*)(new unsigned char[total_size]) :
-		(void*)(new unsigned short[total_size]);
-	if (!val)
-		return nullptr;
-
 	bool show_progress = total_size > glbin_settings.m_prg_size;
 
-	uint8_t* val_ptr = static_cast<uint8_t*>(val);
+	//files holding a slice, in order
+	std::vector<size_t> slices;
 	size_t for_size = filelist.size();
 	for (size_t i = 0; i < for_size; i++)
+		if (!filelist[i].slice.empty())
+			slices.push_back(i);
+	bool failed = false;
+	auto read_slice = [&](size_t z, void* dst)
 	{
-		const SliceInfo& slice_info = filelist[i];
-		if (slice_info.slice.empty())
-			continue;
-		if (!ReadSinglePng(static_cast<void*>(val_ptr), slice_info.slice, c))
+		if (z >= slices.size())
+			return false;
+		size_t i = slices[z];
+		if (!ReadSinglePng(dst, filelist[i].slice, c))
 		{
-			delete[] static_cast<unsigned char*>(val);
-			return nullptr;
+			failed = true;
+			return false;
 		}
 		if (show_progress)
 			SetProgress(static_cast<int>(std::round(100.0 * (i + 1) / for_size)), "NOT_SET");
-		val_ptr += m_size.get_size_xy() * (m_bits / 8);
+		return true;
+	};
+
+	//16-bit slices are mapped to 8 bits as they are read
+	void* val = 0;
+	bool reduce = false;
+	if (m_bits == 16)
+	{
+		val = ReduceSlices(c, m_size.get_size_xy(), m_size.intz(),
+			[&](size_t z, uint16_t* dst) { return read_slice(z, dst); });
+		reduce = val != 0;
+		if (reduce && failed)
+		{
+			glbin_buffer_pool.Free(val, total_size);
+			return nullptr;
+		}
+	}
+	if (!val)
+	{
+		val = eight_bit ?
+			(void*)(glbin_buffer_pool.Alloc<unsigned char>(total_size)) :
+			(void*)(glbin_buffer_pool.Alloc<unsigned short>(total_size));
+		if (!val)
+			return nullptr;
+
+		uint8_t* val_ptr = static_cast<uint8_t*>(val);
+		for (size_t z = 0; z < slices.size(); z++)
+		{
+			if (!read_slice(z, val_ptr))
+			{
+				glbin_buffer_pool.Free(val, total_size * (eight_bit ? 1 : 2));
+				return nullptr;
+			}
+			val_ptr += m_size.get_size_xy() * (m_bits / 8);
+		}
 	}
 
 	//write to nrrd
-	if (eight_bit)
+	if (eight_bit || reduce)
 		nrrdWrap_va(nrrdout, (uint8_t*)val, nrrdTypeUChar,
 			3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
 	else
@@ -366,7 +408,7 @@ Nrrd* PNGReader::ReadPng(const std::vector<SliceInfo>& filelist, int c, bool get
 	nrrdAxisInfoSet_va(nrrdout, nrrdAxisInfoSize, (size_t)m_size.intx(),
 		(size_t)m_size.inty(), (size_t)m_size.intz());
 
-	if (!eight_bit)
+	if (!eight_bit && !reduce)
 	{
 		if (get_max)
 		{
@@ -26,11 +26,14 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 DEALINGS IN THE SOFTWARE.
 */
 #include <pvxml_reader.h>
+#include <Global.h>
+#include <BufferPool.h>
 #include <Utils.h>
 #include <compatibility.h>
 #include <XmlUtils.h>
 #include <fstream>
 #include <iostream>
+#include <cstring>
 
 PVXMLReader::PVXMLReader() :
 	BaseVolReader()
@@ -861,8 +864,9 @@ Nrrd* PVXMLReader::Convert(int t, int c, bool get_max)
 	{
 		//allocate memory for nrrd
 		unsigned long long mem_size = (unsigned long long)m_size.get_size_xyz();
-		unsigned short* val = new (std::nothrow) unsigned short[mem_size]();
+		unsigned short* val = glbin_buffer_pool.Alloc<unsigned short>(mem_size);
 		if (!val) return 0;
+		std::memset(val, 0, mem_size * sizeof(unsigned short));
 
 		TimeDataInfo* time_data_info = &(m_pvxml_info[t]);
 
@@ -915,6 +919,13 @@ Nrrd* PVXMLReader::Convert(int t, int c, bool get_max)
 		m_valid_spc = false;
 		m_spacing = fluo::Vector(1.0);
 	}
+	//16-bit frames are mapped to 8 bits if set
+	if (ReduceBits(data, c))
+	{
+		m_min_value = 0.0;
+		m_max_value = 255.0;
+		m_scalar_scale = 1.0;
+	}
 	return data;
 }
 
@@ -27,6 +27,8 @@ DEALINGS IN THE SOFTWARE.
 */
 #include <tif_reader.h>
 #include <Global.h>
+#include <BufferPool.h>
+#include <FrameCache.h>
 #include <MainSettings.h>
 #include <compatibility.h>
 #include <sstream>
@@ -1182,6 +1184,8 @@ int TIFReader::LoadBatch(int index)
 	int result = -1;
 	if (index >= 0 && index < (int)m_batch_list.size())
 	{
+		//cached frames belong to the previous file
+		glbin_frame_cache.Erase(this);
 		m_path_name = m_batch_list[index];
 		Preprocess();
 		result = index;
@@ -1612,10 +1616,17 @@ void TIFReader::CloseTiff()
 }
 
 Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
-	int c, bool get_max)
+	int c, bool get_max, bool scan)
 {
 	if (filelist.empty())
 		return 0;
+	//sampled pages set the range before the first frame is mapped
+	if (!scan && m_bit_reduce != BitReducer::Disabled)
+	{
+		BitReducer& br = GetBitReducer(c);
+		if (!br.GetReady() && br.NeedSamples())
+			ReadTiff(filelist, c, false, true);
+	}
 	std::wstring filename;
 	if (isHyperstack_ && !isHsTimeSeq_)
 		filename = m_path_name;
@@ -1707,19 +1718,34 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 
 	if (sequence && !isHyperstack_) CloseTiff();
 
+	//16-bit pages are decoded to a page buffer and mapped to 8 bits
+	bool reduce = bits == 16 && m_bit_reduce != BitReducer::Disabled;
+	if (scan && !reduce)
+	{
+		GetBitReducer(c).Finish();
+		if (!sequence || isHyperstack_) CloseTiff();
+		return 0;
+	}
+	BitReducer* reducer = reduce ? &GetBitReducer(c) : 0;
+
 	Nrrd *nrrdout = nrrdNew();
 
 	//allocate memory
 	void *val = 0;
 	bool eight_bit = bits == 8;
+	bool out8 = eight_bit || reduce;
 
 	unsigned long long total_size = m_size.get_size_xyz();
-	val = eight_bit ? (void*)(new unsigned char[total_size]) :
-		(void*)(new unsigned short[total_size]);
-	if (!val)
-		return NULL;
+	if (!scan)
+	{
+		val = out8 ?
+			(void*)(glbin_buffer_pool.Alloc<unsigned char>(total_size)) :
+			(void*)(glbin_buffer_pool.Alloc<unsigned short>(total_size));
+		if (!val)
+			return NULL;
+	}
 
-	bool show_progress = total_size > glbin_settings.m_prg_size;
+	bool show_progress = !scan && total_size > glbin_settings.m_prg_size;
 
 	int min_value = 0;
 	int max_value = 0;
@@ -1762,11 +1788,46 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 			strip_size = height * width * samples * (bits / 8);
 	}
 
+	//16-bit values are written at val16 + (valindex - base16)
+	uint16_t* val16 = (uint16_t*)val;
+	uint64_t base16 = 0;
+	uint64_t page16_size = 0;
+	//every scan_step page is sampled for the range
+	uint64_t scan_step = scan ? std::max(numPages / 16, uint64_t(1)) : 1;
+	if (reduce)
+	{
+		//whole strips are decoded in a hyperstack
+		page16_size = pagepixels + (isHyperstack_ ? strip_size / 2 : 0);
+		val16 = glbin_buffer_pool.Alloc<uint16_t>(page16_size);
+		if (!val16)
+		{
+			glbin_buffer_pool.Free(val, total_size);
+			nrrdNix(nrrdout);
+			return NULL;
+		}
+	}
+	auto reduce_page = [&]()
+	{
+		if (!reduce)
+			return;
+		if (scan)
+			reducer->AddSamples(val16, pagepixels);
+		else
+			reducer->Map(val16, (uint8_t*)val + base16, pagepixels);
+	};
+
 	if (isHyperstack_)
 	{
 		uint64_t pageindex = filelist[0].pagenumber + c;
 		for (int i = 0; i < numPages; ++i)
 		{
+			if (i % scan_step)
+			{
+				pageindex += m_chan_num;
+				continue;
+			}
+			if (reduce)
+				base16 = pagepixels * i;
 			if (!imagej_raw_)
 				TurnToPage(pageindex);
 			if (!imagej_raw_)
@@ -1786,8 +1847,9 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 					(uint8_t*)val + valindex, strip_size);
 				else
 					GetTiffStrip(pageindex, strip,
-					(uint16_t*)val + valindex, strip_size);
+					val16 + (valindex - base16), strip_size);
 			}
+			reduce_page();
 			pageindex += m_chan_num;
 			//if (!imagej_raw_)
 			//	InvalidatePageInfo();
@@ -1838,6 +1900,18 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 				continue;
 			}
 
+			//only sampled pages are decoded for the range
+			if (val_pageindex % scan_step)
+			{
+				if (sequence) CloseTiff();
+				val_pageindex++;
+				if (val_pageindex >= numPages)
+					break;
+				continue;
+			}
+			if (reduce)
+				base16 = val_pageindex * pagepixels;
+
 			//tile storage
 			if (GetTiffUseTiles())
 			{
@@ -1887,7 +1961,7 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 								(uint8_t*)buf + samples*i + c,
 									sizeof(uint8_t));
 							else
-								memcpy((uint16_t*)val + valindex,
+								memcpy(val16 + (valindex - base16),
 								(uint16_t*)buf + samples*i + c,
 									sizeof(uint16_t));
 							indexinpage++;
@@ -1913,7 +1987,7 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 									(uint8_t*)buf + i*tile_w,
 										sizeof(uint8_t)*tile_w);
 								else
-									memcpy((uint16_t*)val + valindex,
+									memcpy(val16 + (valindex - base16),
 									(uint16_t*)buf + i*tile_w,
 										sizeof(uint16_t)*tile_w);
 							}
@@ -1924,7 +1998,7 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 									(uint8_t*)buf + i*tile_w,
 										sizeof(uint8_t)*tile_w_last);
 								else
-									memcpy((uint16_t*)val + valindex,
+									memcpy(val16 + (valindex - base16),
 									(uint16_t*)buf + i*tile_w,
 										sizeof(uint16_t)*tile_w_last);
 							}
@@ -1960,14 +2034,14 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 								memcpy((uint8_t*)val + valindex,
 									(uint8_t*)buf + samples*i + c, sizeof(uint8_t));
 							else
-								memcpy((uint16_t*)val + valindex,
+								memcpy(val16 + (valindex - base16),
 									(uint16_t*)buf + samples*i + c, sizeof(uint16_t));
 							if (!eight_bit && get_max)
 							{
-								if (min_value == 0 || *((uint16_t*)val + valindex) < min_value)
-									min_value = *((uint16_t*)val + valindex);
-								if (*((uint16_t*)val + valindex) > max_value)
-									max_value = *((uint16_t*)val + valindex);
+								if (min_value == 0 || val16[valindex - base16] < min_value)
+									min_value = val16[valindex - base16];
+								if (val16[valindex - base16] > max_value)
+									max_value = val16[valindex - base16];
 							}
 							valindex++;
 						}
@@ -1977,8 +2051,10 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 						valindex = val_pageindex *pagepixels +
 							strip*strip_size / (bits / 8);
 						uint64_t strip_size_used = strip_size;
-						if (valindex + strip_size / (bits / 8) >= total_size)
-							strip_size_used = (total_size - valindex) * (bits / 8);
+						uint64_t valend = reduce ? base16 + pagepixels : total_size;
+						if (valindex + strip_size / (bits / 8) >= valend)
+							strip_size_used = valindex < valend ?
+								(valend - valindex) * (bits / 8) : 0;
 						if (strip_size_used > 0)
 						{
 							if (eight_bit)
@@ -1986,11 +2062,12 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 									(uint8_t*)val + valindex, strip_size_used);
 							else
 								GetTiffStrip(sequence ? 0 : val_pageindex, strip,
-									(uint16_t*)val + valindex, strip_size_used);
+									val16 + (valindex - base16), strip_size_used);
 						}
 					}
 				}
 			}
+			reduce_page();
 			if (sequence) CloseTiff();
 			val_pageindex++;
 			if (val_pageindex >= numPages)
@@ -2005,9 +2082,17 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 	if (buf)
 		free(buf);
 	if (!sequence || isHyperstack_) CloseTiff();
+	if (reduce)
+		glbin_buffer_pool.Free(val16, page16_size * sizeof(uint16_t));
+	if (scan)
+	{
+		reducer->Finish();
+		nrrdNix(nrrdout);
+		return 0;
+	}
 
 	//write to nrrd
-	if (eight_bit)
+	if (out8)
 		nrrdWrap_va(nrrdout, (uint8_t*)val, nrrdTypeUChar,
 			3, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
 	else
@@ -2019,7 +2104,7 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 	nrrdAxisInfoSet_va(nrrdout, nrrdAxisInfoMin, 0.0, 0.0, 0.0);
 	nrrdAxisInfoSet_va(nrrdout, nrrdAxisInfoSize, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
 
-	if (!eight_bit) {
+	if (!out8) {
 		if (get_max) {
 			if (samples > 1)
 			{
@@ -2040,7 +2125,16 @@ Nrrd* TIFReader::ReadTiff(std::vector<SliceInfo> &filelist,
 		if (m_max_value > 0.0) m_scalar_scale = 65535.0 / m_max_value;
 		else m_scalar_scale = 1.0;
 	}
-	else m_max_value = 255.0;
+	else
+	{
+		m_max_value = 255.0;
+		//values from the header are for the 16-bit range
+		if (reduce)
+		{
+			m_min_value = 0.0;
+			m_scalar_scale = 1.0;
+		}
+	}
 
 	return nrrdout;
 }
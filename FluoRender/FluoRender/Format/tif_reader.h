@@ -367,7 +367,8 @@ private:
 	static bool tif_sort(const TimeDataInfo& info1, const TimeDataInfo& info2);
 	static bool tif_slice_sort(const SliceInfo& info1, const SliceInfo& info2);
 	//read tiff
-	Nrrd* ReadTiff(std::vector<SliceInfo> &filelist, int c, bool get_max);
+	//scan only samples pages for the bit reduction range
+	Nrrd* ReadTiff(std::vector<SliceInfo> &filelist, int c, bool get_max, bool scan = false);
 
 	//invalidate page info
 	bool TagInInfo(uint16_t tag);
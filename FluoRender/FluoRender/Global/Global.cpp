@@ -28,6 +28,9 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Global.h>
 #include <Names.h>
+#include <BufferPool.h>
+#include <FrameCache.h>
+#include <MemRegistry.h>
 #include <TreeFileFactory.h>
 #include <VideoEncoder.h>
 #include <Reshape.h>
@@ -91,6 +94,7 @@ DEALINGS IN THE SOFTWARE.
 #include <ClippingBoxRenderer.h>
 #include <RulerRenderer.h>
 #include <CamCenterRenderer.h>
+#include <algorithm>
 
 using namespace fluo;
 
@@ -270,6 +274,9 @@ std::string IniFile::path_sep_s_ = "";
 Global Global::instance_;
 
 Global::Global() :
+	buffer_pool_(std::make_unique<flrd::BufferPool>()),
+	frame_cache_(std::make_unique<flrd::FrameCache>()),
+	mem_registry_(std::make_unique<flrd::MemRegistry>()),
 	tree_file_factory_(std::make_unique<TreeFileFactory>()),
 	encoder_(std::make_unique<VideoEncoder>()),
 	main_settings_(std::make_unique<MainSettings>()),
@@ -575,6 +582,37 @@ void Global::apply_processor_settings()
 {
 	m_script_proc->SetBreak(glbin_settings.m_script_break);
 	m_seg_grow->SetRulerHandler(m_ruler_handler.get());
+	apply_buffer_pool_settings();
+	apply_frame_cache_settings();
+}
+
+flrd::BufferPool& Global::get_buffer_pool()
+{
+	return *buffer_pool_;
+}
+
+void Global::apply_buffer_pool_settings()
+{
+	double size = std::max(glbin_settings.m_buffer_pool_size, 0.0);
+	buffer_pool_->SetLimit(static_cast<size_t>(size * 1048576.0));
+	buffer_pool_->SetHugePage(glbin_settings.m_buffer_pool_huge);
+}
+
+flrd::FrameCache& Global::get_frame_cache()
+{
+	return *frame_cache_;
+}
+
+void Global::apply_frame_cache_settings()
+{
+	double size = std::max(glbin_settings.m_frame_cache_size, 0.0);
+	frame_cache_->SetPool(buffer_pool_.get());
+	frame_cache_->SetLimit(static_cast<size_t>(size * 1048576.0));
+}
+
+flrd::MemRegistry& Global::get_mem_registry()
+{
+	return *mem_registry_;
 }
 
 flrd::ComponentGenerator& Global::get_comp_generator()
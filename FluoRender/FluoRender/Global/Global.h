@@ -68,6 +68,9 @@ namespace fluo
 }
 namespace flrd
 {
+	class BufferPool;
+	class FrameCache;
+	class MemRegistry;
 	class EntryParams;
 	class TableHistParams;
 	class PyBase;
@@ -104,6 +107,12 @@ namespace flvr
 
 #define glbin fluo::Global::instance()
 #define glbin_cache_queue fluo::Global::instance().get_cache_queue()
+//memory pool for volume data
+#define glbin_buffer_pool fluo::Global::instance().get_buffer_pool()
+//compressed frames of time sequences
+#define glbin_frame_cache fluo::Global::instance().get_frame_cache()
+//memory use accounting
+#define glbin_mem_registry fluo::Global::instance().get_mem_registry()
 //config file handlers
 #define glbin_tree_file_factory fluo::Global::instance().get_tree_file_factory()
 //settings
@@ -192,6 +201,15 @@ namespace fluo
 		//initialize processors by setting progress func
 		void InitProgress(const std::function<void(int, const std::string&)>& f);
 
+		//memory pool for volume data
+		flrd::BufferPool& get_buffer_pool();
+		void apply_buffer_pool_settings();
+		//compressed frames of time sequences
+		flrd::FrameCache& get_frame_cache();
+		void apply_frame_cache_settings();
+		//memory use accounting
+		flrd::MemRegistry& get_mem_registry();
+
 		//config file handlers
 		TreeFileFactory& get_tree_file_factory();
 
@@ -304,6 +322,14 @@ namespace fluo
 	private:
 		static Global instance_;
 
+		//memory pool for volume data
+		//declared first to outlive the data released into it
+		std::unique_ptr<flrd::BufferPool> buffer_pool_;
+		//compressed frames, outlives the readers owning them
+		std::unique_ptr<flrd::FrameCache> frame_cache_;
+		//memory use accounting
+		std::unique_ptr<flrd::MemRegistry> mem_registry_;
+
 		//config file handlers
 		std::unique_ptr<TreeFileFactory> tree_file_factory_;
 
@@ -720,6 +720,12 @@ DEALINGS IN THE SOFTWARE.
 #define gstCleanEnable "clean enable"//clean settings
 #define gstCleanIteration "clean iteration"
 #define gstCleanSize "clean size"
+#define gstWatershedEnable "watershed enable"//watershed split settings
+#define gstWsMarker "ws marker"
+#define gstWsH "ws h"
+#define gstWsDistWeight "ws dist weight"
+#define gstCompOutCore "comp out core"//labels streamed to a file
+#define gstCompOutCoreMem "comp out core mem"
 #define gstClusterMethod "cluster method"//0:k-means; 1:em; 2:dbscan
 #define gstClusterNum "cluster num"
 #define gstClusterMaxIter "cluster max iter"
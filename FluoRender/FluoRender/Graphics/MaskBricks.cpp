@@ -0,0 +1,266 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <MaskBricks.h>
+#include <Parallel.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace flvr;
+
+//brick edge length in voxels
+static const size_t s_brick_size = 64;
+
+MaskBricks::MaskBricks()
+{
+}
+
+MaskBricks::~MaskBricks()
+{
+}
+
+void MaskBricks::SetSize(size_t nx, size_t ny, size_t nz)
+{
+	m_nx = nx;
+	m_ny = ny;
+	m_nz = nz;
+	m_bnx = (nx + s_brick_size - 1) / s_brick_size;
+	m_bny = (ny + s_brick_size - 1) / s_brick_size;
+	m_bnz = (nz + s_brick_size - 1) / s_brick_size;
+}
+
+size_t MaskBricks::Update(const unsigned char* data, MaskState& state)
+{
+	size_t num = GetNum();
+	state.resize(num);
+	if (!data || !num)
+		return 0;
+	unsigned int tn = flrd::GetThreadNum(m_thread_num);
+	std::vector<std::vector<unsigned char>> bufs(tn);
+	std::vector<size_t> count(tn, 0);
+	flrd::ParallelForDynamic(num, [&](size_t b, unsigned int t)
+	{
+		std::vector<unsigned char>& buf = bufs[t];
+		size_t n = Gather(data, b, buf);
+		if (state[b] && Equal(buf.data(), n, *state[b]))
+			return;
+		auto chunk = std::make_shared<MaskChunk>();
+		Encode(buf.data(), n, *chunk);
+		state[b] = chunk;
+		count[t]++;
+	}, 1, tn);
+	size_t sum = 0;
+	for (auto c : count)
+		sum += c;
+	return sum;
+}
+
+void MaskBricks::Restore(unsigned char* data,
+	const MaskState& state, const MaskState& ref)
+{
+	size_t num = GetNum();
+	if (!data || state.size() != num)
+		return;
+	unsigned int tn = flrd::GetThreadNum(m_thread_num);
+	std::vector<std::vector<unsigned char>> bufs(tn);
+	flrd::ParallelForDynamic(num, [&](size_t b, unsigned int t)
+	{
+		if (!state[b])
+			return;
+		if (b < ref.size() && ref[b] == state[b])
+			return;
+		size_t x0, y0, z0, x1, y1, z1;
+		GetBox(b, x0, y0, z0, x1, y1, z1);
+		if (state[b]->uniform)
+		{
+			//rows already holding the value are not written
+			//so unused zero pages stay unmapped
+			size_t w = x1 - x0;
+			unsigned char v = state[b]->value;
+			for (size_t k = z0; k < z1; ++k)
+			for (size_t j = y0; j < y1; ++j)
+			{
+				unsigned char* row = data + (k * m_ny + j) * m_nx + x0;
+				if (std::any_of(row, row + w,
+					[&](unsigned char c) { return c != v; }))
+					std::memset(row, v, w);
+			}
+			return;
+		}
+		std::vector<unsigned char>& buf = bufs[t];
+		buf.resize((x1 - x0) * (y1 - y0) * (z1 - z0));
+		Decode(*state[b], buf.size(), buf.data());
+		Scatter(data, b, buf);
+	}, 1, tn);
+}
+
+void MaskBricks::GetBox(size_t b,
+	size_t& x0, size_t& y0, size_t& z0,
+	size_t& x1, size_t& y1, size_t& z1)
+{
+	size_t bx = b % m_bnx;
+	size_t by = (b / m_bnx) % m_bny;
+	size_t bz = b / (m_bnx * m_bny);
+	x0 = bx * s_brick_size;
+	y0 = by * s_brick_size;
+	z0 = bz * s_brick_size;
+	x1 = std::min(x0 + s_brick_size, m_nx);
+	y1 = std::min(y0 + s_brick_size, m_ny);
+	z1 = std::min(z0 + s_brick_size, m_nz);
+}
+
+size_t MaskBricks::Gather(const unsigned char* data, size_t b,
+	std::vector<unsigned char>& buf)
+{
+	size_t x0, y0, z0, x1, y1, z1;
+	GetBox(b, x0, y0, z0, x1, y1, z1);
+	size_t w = x1 - x0;
+	buf.resize(w * (y1 - y0) * (z1 - z0));
+	unsigned char* dst = buf.data();
+	for (size_t k = z0; k < z1; ++k)
+	for (size_t j = y0; j < y1; ++j)
+	{
+		std::memcpy(dst, data + (k * m_ny + j) * m_nx + x0, w);
+		dst += w;
+	}
+	return buf.size();
+}
+
+void MaskBricks::Scatter(unsigned char* data, size_t b,
+	const std::vector<unsigned char>& buf)
+{
+	size_t x0, y0, z0, x1, y1, z1;
+	GetBox(b, x0, y0, z0, x1, y1, z1);
+	size_t w = x1 - x0;
+	const unsigned char* src = buf.data();
+	for (size_t k = z0; k < z1; ++k)
+	for (size_t j = y0; j < y1; ++j)
+	{
+		std::memcpy(data + (k * m_ny + j) * m_nx + x0, src, w);
+		src += w;
+	}
+}
+
+//packbits style runs
+//control byte c < 128: c + 1 literal bytes follow
+//otherwise the next byte repeats c - 126 times
+void MaskBricks::Encode(const unsigned char* src, size_t n, MaskChunk& chunk)
+{
+	chunk.code.clear();
+	chunk.uniform = n > 0 &&
+		std::all_of(src, src + n, [&](unsigned char v) { return v == src[0]; });
+	if (chunk.uniform)
+	{
+		chunk.value = src[0];
+		return;
+	}
+	size_t i = 0;
+	while (i < n)
+	{
+		size_t r = 1;
+		while (i + r < n && r < 129 && src[i + r] == src[i])
+			++r;
+		if (r > 1)
+		{
+			chunk.code.push_back(static_cast<unsigned char>(r + 126));
+			chunk.code.push_back(src[i]);
+			i += r;
+			continue;
+		}
+		size_t s = i;
+		while (i < n && i - s < 128)
+		{
+			if (i + 1 < n && src[i + 1] == src[i])
+				break;
+			++i;
+		}
+		chunk.code.push_back(static_cast<unsigned char>(i - s - 1));
+		chunk.code.insert(chunk.code.end(), src + s, src + i);
+	}
+	chunk.code.shrink_to_fit();
+}
+
+void MaskBricks::Decode(const MaskChunk& chunk, size_t n, unsigned char* dst)
+{
+	if (chunk.uniform)
+	{
+		std::memset(dst, chunk.value, n);
+		return;
+	}
+	const unsigned char* c = chunk.code.data();
+	const unsigned char* end = c + chunk.code.size();
+	size_t i = 0;
+	while (c < end && i < n)
+	{
+		size_t l = *c++;
+		if (l < 128)
+		{
+			l = std::min(l + 1, n - i);
+			std::memcpy(dst + i, c, l);
+			c += l;
+		}
+		else
+		{
+			l = std::min(l - 126, n - i);
+			std::memset(dst + i, *c++, l);
+		}
+		i += l;
+	}
+}
+
+bool MaskBricks::Equal(const unsigned char* src, size_t n, const MaskChunk& chunk)
+{
+	if (chunk.uniform)
+		return std::all_of(src, src + n,
+			[&](unsigned char v) { return v == chunk.value; });
+	const unsigned char* c = chunk.code.data();
+	const unsigned char* end = c + chunk.code.size();
+	size_t i = 0;
+	while (c < end)
+	{
+		size_t l = *c++;
+		if (l < 128)
+		{
+			l++;
+			if (i + l > n || std::memcmp(src + i, c, l))
+				return false;
+			c += l;
+		}
+		else
+		{
+			l -= 126;
+			if (i + l > n)
+				return false;
+			unsigned char v = *c++;
+			for (size_t j = i; j < i + l; ++j)
+				if (src[j] != v)
+					return false;
+		}
+		i += l;
+	}
+	return i == n;
+}
@@ -0,0 +1,93 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_MaskBricks_h
+#define FL_MaskBricks_h
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace flvr
+{
+	//run-length coded copy of one mask brick
+	struct MaskChunk
+	{
+		bool uniform = false;
+		unsigned char value = 0;
+		std::vector<unsigned char> code;
+	};
+	typedef std::shared_ptr<const MaskChunk> MaskChunkPtr;
+	//one undo state of a mask
+	//bricks unchanged between states share the same chunk
+	typedef std::vector<MaskChunkPtr> MaskState;
+
+	//splits an 8-bit mask into fixed bricks for undo snapshots
+	class MaskBricks
+	{
+	public:
+		MaskBricks();
+		~MaskBricks();
+
+		void SetSize(size_t nx, size_t ny, size_t nz);
+		bool Match(size_t nx, size_t ny, size_t nz)
+		{
+			return nx == m_nx && ny == m_ny && nz == m_nz;
+		}
+		size_t GetNum() { return m_bnx * m_bny * m_bnz; }
+		void SetThreadNum(unsigned int val) { m_thread_num = val; }
+
+		//replace the chunks of bricks that differ from data
+		//missing chunks are always filled
+		//returns the number of replaced chunks
+		size_t Update(const unsigned char* data, MaskState& state);
+		//write the bricks of state that are not shared with ref
+		void Restore(unsigned char* data,
+			const MaskState& state, const MaskState& ref);
+
+	private:
+		size_t m_nx = 0, m_ny = 0, m_nz = 0;
+		size_t m_bnx = 0, m_bny = 0, m_bnz = 0;
+		unsigned int m_thread_num = 0;
+
+		//brick extent in voxels
+		void GetBox(size_t b,
+			size_t& x0, size_t& y0, size_t& z0,
+			size_t& x1, size_t& y1, size_t& z1);
+		//copy a brick to or from a contiguous buffer
+		size_t Gather(const unsigned char* data, size_t b,
+			std::vector<unsigned char>& buf);
+		void Scatter(unsigned char* data, size_t b,
+			const std::vector<unsigned char>& buf);
+
+		static void Encode(const unsigned char* src, size_t n, MaskChunk& chunk);
+		static void Decode(const MaskChunk& chunk, size_t n, unsigned char* dst);
+		static bool Equal(const unsigned char* src, size_t n, const MaskChunk& chunk);
+	};
+}
+
+#endif//FL_MaskBricks_h
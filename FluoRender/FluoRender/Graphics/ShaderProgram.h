@@ -166,6 +166,7 @@ namespace flvr
 		bool solid = false;//vol(no transparency)
 		int vertex_type = 0;//vol
 		bool depth = false;//vol, if render a depth map
+		bool coarse = false;//vol, mask and label looked up at level 0
 
 		static bool ValidColormapProj(ColormapProj p)
 		{
@@ -265,7 +266,8 @@ namespace flvr
 			ColormapProj colormap_proj,
 			bool solid,
 			int vertex_type,
-			bool depth
+			bool depth,
+			bool coarse = false
 		)
 		{
 			ShaderParams p;
@@ -285,6 +287,7 @@ namespace flvr
 			p.solid = solid;
 			p.vertex_type = vertex_type;
 			p.depth = depth;
+			p.coarse = coarse;
 			return p;
 		}
 
@@ -315,6 +318,7 @@ namespace flvr
 				<< ", solid=" << solid
 				<< ", vertex_type=" << vertex_type
 				<< ", depth=" << depth
+				<< ", coarse=" << coarse
 				<< "}";
 			return oss.str();
 		}
@@ -345,7 +349,8 @@ namespace flvr
 			a.colormap_proj == b.colormap_proj &&
 			a.solid == b.solid &&
 			a.vertex_type == b.vertex_type &&
-			a.depth == b.depth;
+			a.depth == b.depth &&
+			a.coarse == b.coarse;
 	}
 
 	class ShaderProgramFactory
@@ -399,6 +404,7 @@ namespace flvr
 				hash_combine(p.solid);
 				hash_combine(p.vertex_type);
 				hash_combine(p.depth);
+				hash_combine(p.coarse);
 
 				return h;
 			}
@@ -31,11 +31,15 @@
 #include <ShaderProgram.h>
 #include <TextureRenderer.h>
 #include <Global.h>
+#include <BufferPool.h>
 #include <MainSettings.h>
 #include <DataManager.h>
 #include <Ray.h>
+#include <Parallel.h>
 #include <Utils.h>
 #include <algorithm>
+#include <unordered_set>
+#include <chrono>
 #include <inttypes.h>
 #include <glm/gtc/type_ptr.hpp>
 #include <Debug.h>
@@ -55,6 +59,8 @@ namespace flvr
 		use_priority_(false),
 		n_p0_(0),
 		mask_undo_pointer_(-1),
+		mask_data_(nullptr),
+		mask_data_size_(0),
 		brkxml_(false),
 		pyramid_lv_num_(0),
 		pyramid_cur_lv_(0),
@@ -72,6 +78,9 @@ namespace flvr
 
 	Texture::~Texture()
 	{
+		stop_stat_job();
+		stop_mip_job();
+		clear_mip(false);
 		if (bricks_)
 		{
 			for (int i = 0; i<(int)(*bricks_).size(); i++)
@@ -100,7 +109,7 @@ namespace flvr
 					if (type == CompType::Mask && mask_undo_num_)
 						nrrdNix(nrrd);
 					else
-						nrrdNuke(nrrd);
+						glbin_buffer_pool.Nuke(nrrd);
 				}
 			}
 		}
@@ -289,6 +298,71 @@ namespace flvr
 		return bricks_;
 	}
 
+	void Texture::compute_brick_stats()
+	{
+		stop_stat_job();
+		brick_stat_dirty_ = false;
+		if (brkxml_ || !get_bricks0())
+			return;
+		std::vector<TextureBrick*>& bricks = *get_bricks0();
+		flrd::ParallelForDynamic(bricks.size(),
+			[&](size_t i, unsigned int)
+		{
+			bricks[i]->compute_stat();
+		});
+	}
+
+	void Texture::invalid_brick_stats()
+	{
+		stop_stat_job();
+		brick_stat_dirty_ = true;
+		data_stamp_++;
+		if (!get_bricks0())
+			return;
+		for (auto b : *get_bricks0())
+			b->invalid_stat();
+	}
+
+	void Texture::update_brick_stats()
+	{
+		stop_stat_job();
+		if (brick_stat_dirty_)
+			compute_brick_stats();
+	}
+
+	bool Texture::request_brick_stats()
+	{
+		if (stat_job_.valid())
+		{
+			if (stat_job_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				return false;
+			stat_job_.get();
+			return true;
+		}
+		if (!brick_stat_dirty_)
+			return true;
+		if (brkxml_ || !get_bricks0())
+			return false;
+		//the bricks are not touched for drawing until the job is done
+		brick_stat_dirty_ = false;
+		std::vector<TextureBrick*> bricks = *get_bricks0();
+		stat_job_ = std::async(std::launch::async, [bricks]()
+		{
+			flrd::ParallelForDynamic(bricks.size(),
+				[&](size_t i, unsigned int)
+			{
+				bricks[i]->compute_stat();
+			});
+		});
+		return false;
+	}
+
+	void Texture::stop_stat_job()
+	{
+		if (stat_job_.valid())
+			stat_job_.get();
+	}
+
 	//get bricks sorted by id
 	std::vector<TextureBrick*>* Texture::get_bricks_id()
 	{
@@ -327,7 +401,13 @@ namespace flvr
 	{
 		if (!brkxml_)
 		{
-			return spacing_;
+			//coarse levels keep the extent of level 0
+			if (lv <= 0 || lv >= get_mip_num())
+				return spacing_;
+			fluo::Vector spc = mip_lv_ ? mip_spacing0_ : spacing_;
+			fluo::Vector res = mip_lv_ ? mip_res0_ : res_;
+			const Pyramid_Level& level = mip_[lv - 1];
+			return spc * res / fluo::Vector(level.szx, level.szy, level.szz);
 		}
 		else if (lv < 0 || lv >= pyramid_lv_num_ || pyramid_.empty())
 		{
@@ -420,6 +500,9 @@ namespace flvr
 				vmx != vmax())
 			{
 				clearPyramid();
+				//coarse bricks point to the old bricks
+				stop_mip_job();
+				clear_mip();
 				bricks_ = &default_vec_;
 				build_bricks((*bricks_), size, bytes);
 				set_res(size);
@@ -452,6 +535,7 @@ namespace flvr
 					n_p0_ += tb->get_priority() == 0 ? 1 : 0;
 				}
 			}
+			compute_brick_stats();
 		}
 
 		fluo::BBox tempb;
@@ -657,6 +741,47 @@ namespace flvr
 		return true;
 	}
 
+	bool Texture::read_label_src(TextureBrick* b, void* dst)
+	{
+		if (!label_src_ || !b || !dst)
+			return false;
+		auto off = b->get_off_size();
+		auto res = b->get_size();
+		int org[3] = { off.intx(), off.inty(), off.intz() };
+		int size[3] = { res.intx(), res.inty(), res.intz() };
+		return label_src_(org, size, dst);
+	}
+
+	bool Texture::load_label_src()
+	{
+		if (!label_src_)
+			return true;
+		auto c = data_.find(CompType::Label);
+		if (c == data_.end() || !c->second.data)
+			return false;
+		Nrrd* nrrd = c->second.data;
+		if (!nrrd->data)
+		{
+			int org[3] = { 0, 0, 0 };
+			int size[3] = {
+				static_cast<int>(nrrd->axis[0].size),
+				static_cast<int>(nrrd->axis[1].size),
+				static_cast<int>(nrrd->axis[2].size) };
+			size_t bytes = size_t(size[0]) * size[1] * size[2] * sizeof(unsigned int);
+			void* data = glbin_buffer_pool.Alloc(bytes);
+			if (!data)
+				return false;
+			if (!label_src_(org, size, data))
+			{
+				glbin_buffer_pool.Free(data, bytes);
+				return false;
+			}
+			nrrd->data = data;
+		}
+		label_src_ = nullptr;
+		return true;
+	}
+
 	void Texture::deact_all_mask()
 	{
 		for (size_t i = 0; i < bricks_->size(); ++i)
@@ -681,6 +806,12 @@ namespace flvr
 			(*bricks_)[i]->valid_mask();
 	}
 
+	void Texture::set_zero(CompType type, bool val)
+	{
+		for (size_t i = 0; i < bricks_->size(); ++i)
+			(*bricks_)[i]->set_zero(type, val);
+	}
+
 	int Texture::GetLevelNum()
 	{
 		return static_cast<int>(pyramid_.size());
@@ -824,25 +955,301 @@ namespace flvr
 
 	}
 
+	//levels stop at this size or number
+	static const int s_mip_min = 64;
+	static const size_t s_mip_max = 4;
+
+	//2x pooling of one level into the next
+	template <typename T>
+	static void pool_mip(const T* src, const int* ns, T* dst, const int* nd,
+		bool use_max, const std::atomic<bool>& cancel)
+	{
+		size_t sx = ns[0];
+		size_t sxy = sx * ns[1];
+		size_t dxy = size_t(nd[0]) * nd[1];
+		flrd::ParallelForDynamic(nd[2], [&](size_t k, unsigned int)
+		{
+			if (cancel)
+				return;
+			size_t z[2] = { 2 * k, std::min(2 * k + 1, size_t(ns[2] - 1)) };
+			T* out = dst + k * dxy;
+			for (int j = 0; j < nd[1]; ++j)
+			{
+				size_t y[2] = { size_t(2 * j), size_t(std::min(2 * j + 1, ns[1] - 1)) };
+				for (int i = 0; i < nd[0]; ++i)
+				{
+					size_t x[2] = { size_t(2 * i), size_t(std::min(2 * i + 1, ns[0] - 1)) };
+					unsigned int sum = 0, vmax = 0;
+					for (int c = 0; c < 8; ++c)
+					{
+						unsigned int v = src[z[c >> 2] * sxy + y[(c >> 1) & 1] * sx + x[c & 1]];
+						sum += v;
+						vmax = std::max(vmax, v);
+					}
+					*out++ = static_cast<T>(use_max ? vmax : (sum + 4) / 8);
+				}
+			}
+		});
+	}
+
+	//runs off the main thread, the data must stay valid until it returns
+	static std::vector<Nrrd*> build_mip(Nrrd* data, int mode, const std::atomic<bool>* cancel)
+	{
+		std::vector<Nrrd*> levels;
+		int bytes = data->type == nrrdTypeUChar ? 1 :
+			(data->type == nrrdTypeUShort ? 2 : 0);
+		if (!bytes || data->dim < 3)
+			return levels;
+		int offset = data->dim > 3 ? 1 : 0;
+		int ns[3] = {
+			static_cast<int>(data->axis[offset + 0].size),
+			static_cast<int>(data->axis[offset + 1].size),
+			static_cast<int>(data->axis[offset + 2].size) };
+		const void* src = data->data;
+		while (levels.size() < s_mip_max &&
+			std::max({ ns[0], ns[1], ns[2] }) > s_mip_min && !*cancel)
+		{
+			int nd[3] = { (ns[0] + 1) / 2, (ns[1] + 1) / 2, (ns[2] + 1) / 2 };
+			size_t n = size_t(nd[0]) * nd[1] * nd[2];
+			void* dst = glbin_buffer_pool.Alloc(n * bytes);
+			if (!dst)
+				break;
+			Nrrd* nrrd = nrrdNew();
+			if (bytes == 1)
+			{
+				pool_mip(static_cast<const unsigned char*>(src), ns,
+					static_cast<unsigned char*>(dst), nd, mode == 2, *cancel);
+				nrrdWrap_va(nrrd, dst, nrrdTypeUChar, 3,
+					size_t(nd[0]), size_t(nd[1]), size_t(nd[2]));
+			}
+			else
+			{
+				pool_mip(static_cast<const unsigned short*>(src), ns,
+					static_cast<unsigned short*>(dst), nd, mode == 2, *cancel);
+				nrrdWrap_va(nrrd, dst, nrrdTypeUShort, 3,
+					size_t(nd[0]), size_t(nd[1]), size_t(nd[2]));
+			}
+			levels.push_back(nrrd);
+			src = dst;
+			std::copy(nd, nd + 3, ns);
+		}
+		return levels;
+	}
+
+	void Texture::update_mip()
+	{
+		if (brkxml_ || mip_lv_)
+			return;
+		int mode = glbin_settings.m_mip_mode;
+		TexComp comp = get_nrrd(CompType::Data);
+		//coarse textures have no power of two padding
+		bool want = mode > 0 && comp.data && comp.data->data &&
+			(comp.bytes == 1 || comp.bytes == 2) &&
+			(!ShaderProgram::init() || ShaderProgram::texture_non_power_of_two()) &&
+			res_.x() * res_.y() * res_.z() * comp.bytes / 1.04e6 >= glbin_settings.m_mip_size;
+		if (!want)
+		{
+			stop_mip_job();
+			clear_mip();
+			return;
+		}
+		if (!mip_.empty() && (mip_stamp_ != data_stamp_ || mip_mode_ != mode))
+			clear_mip();
+
+		//take over a finished build
+		if (mip_job_.valid())
+		{
+			if (mip_job_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				return;
+			std::vector<Nrrd*> levels = mip_job_.get();
+			if (mip_stamp_ != data_stamp_ || mip_mode_ != mode)
+			{
+				for (auto it : levels)
+					glbin_buffer_pool.Nuke(it);
+			}
+			else
+			{
+				std::vector<TextureBrick*> all;
+				for (auto it : levels)
+				{
+					Pyramid_Level level = {};
+					level.data = it;
+					level.szx = static_cast<int>(it->axis[0].size);
+					level.szy = static_cast<int>(it->axis[1].size);
+					level.szz = static_cast<int>(it->axis[2].size);
+					build_mip_bricks(level, comp.bytes);
+					all.insert(all.end(), level.bricks.begin(), level.bricks.end());
+					mip_.push_back(level);
+				}
+				flrd::ParallelForDynamic(all.size(),
+					[&](size_t i, unsigned int)
+				{
+					all[i]->compute_stat();
+				});
+			}
+		}
+		if (mip_stamp_ == data_stamp_ && mip_mode_ == mode)
+			return;
+
+		//build from the current data
+		mip_stamp_ = data_stamp_;
+		mip_mode_ = mode;
+		mip_cancel_ = false;
+		Nrrd* data = comp.data;
+		const std::atomic<bool>* cancel = &mip_cancel_;
+		mip_job_ = std::async(std::launch::async,
+			[data, mode, cancel]() { return build_mip(data, mode, cancel); });
+	}
+
+	bool Texture::set_mip_level(int lv)
+	{
+		if (brkxml_ || lv < 0 || lv >= get_mip_num())
+			return false;
+		if (lv == mip_lv_)
+			return true;
+		if (mip_lv_ == 0)
+		{
+			mip_bricks0_ = bricks_;
+			mip_res0_ = res_;
+			mip_spacing0_ = spacing_;
+			mip_brick_res0_ = brick_res_;
+			mip_brick_num0_ = brick_num_;
+		}
+		if (lv == 0)
+		{
+			bricks_ = mip_bricks0_;
+			res_ = mip_res0_;
+			spacing_ = mip_spacing0_;
+			brick_res_ = mip_brick_res0_;
+			brick_num_ = mip_brick_num0_;
+		}
+		else
+		{
+			//the extent stays the same as the spacing grows
+			Pyramid_Level& level = mip_[lv - 1];
+			bricks_ = &level.bricks;
+			res_ = fluo::Vector(level.szx, level.szy, level.szz);
+			spacing_ = mip_spacing0_ * mip_res0_ / res_;
+			brick_res_ = fluo::Vector(level.bszx, level.bszy, level.bszz);
+			brick_num_ = fluo::Vector(level.bnx, level.bny, level.bnz);
+		}
+		mip_lv_ = lv;
+		return true;
+	}
+
+	void Texture::build_mip_bricks(Pyramid_Level& level, int bytes)
+	{
+		std::vector<TextureBrick*>& bricks0 = *get_bricks0();
+		fluo::Vector res0 = mip_lv_ ? mip_res0_ : res_;
+		fluo::Vector res(level.szx, level.szy, level.szz);
+		fluo::Vector scale = res / res0;
+		TexComp comp = { CompType::Data, bytes, level.data };
+		for (auto b0 : bricks0)
+		{
+			//coarse voxels touching the region of b0
+			fluo::Vector o0 = b0->get_off_size();
+			fluo::Vector e0 = o0 + b0->get_msize();
+			fluo::Vector o(
+				std::floor(o0.x() * scale.x()),
+				std::floor(o0.y() * scale.y()),
+				std::floor(o0.z() * scale.z()));
+			fluo::Vector e = fluo::Min(fluo::Vector(
+				std::ceil(e0.x() * scale.x()),
+				std::ceil(e0.y() * scale.y()),
+				std::ceil(e0.z() * scale.z())), res);
+			fluo::Vector n = fluo::Max(e - o, fluo::Vector(1.0));
+			//the same region is drawn, mapped to the coarse texture
+			fluo::BBox dbox(fluo::Point(o / res), fluo::Point((o + n) / res));
+			fluo::BBox bbox = b0->bbox();
+			fluo::Vector dsize = dbox.diagonal();
+			fluo::BBox tbox(
+				fluo::Point(fluo::Max(fluo::Vector(0.0),
+					(bbox.Min() - dbox.Min()) / dsize)),
+				fluo::Point(fluo::Min(fluo::Vector(1.0),
+					(bbox.Max() - dbox.Min()) / dsize)));
+			TextureBrick* b = new TextureBrick(nullptr,
+				n, bytes, o, n, bbox, tbox, dbox,
+				static_cast<unsigned int>(level.bricks.size()));
+			b->set_nrrd(CompType::Data, comp);
+			b->set_stride(res);
+			b->set_base(b0);
+			level.bricks.push_back(b);
+		}
+		fluo::Vector brick_res = brick_res_ * scale;
+		level.bszx = std::max(1, static_cast<int>(std::ceil(brick_res.x())));
+		level.bszy = std::max(1, static_cast<int>(std::ceil(brick_res.y())));
+		level.bszz = std::max(1, static_cast<int>(std::ceil(brick_res.z())));
+		level.bnx = brick_num_.intx();
+		level.bny = brick_num_.inty();
+		level.bnz = brick_num_.intz();
+	}
+
+	size_t Texture::get_mip_size()
+	{
+		size_t size = 0;
+		for (auto& it : mip_)
+			size += nrrdElementNumber(it.data) * nrrdElementSize(it.data);
+		return size;
+	}
+
+	void Texture::stop_mip_job()
+	{
+		if (!mip_job_.valid())
+			return;
+		mip_cancel_ = true;
+		std::vector<Nrrd*> levels = mip_job_.get();
+		for (auto it : levels)
+			glbin_buffer_pool.Nuke(it);
+		mip_cancel_ = false;
+		//a new build may start
+		mip_stamp_ = 0;
+	}
+
+	void Texture::clear_mip(bool gl)
+	{
+		set_mip_level(0);
+		for (auto& it : mip_)
+		{
+			if (gl)
+				TextureRenderer::clear_tex_bricks(it.bricks);
+			for (auto b : it.bricks)
+				delete b;
+			glbin_buffer_pool.Nuke(it.data);
+		}
+		mip_.clear();
+		//a new build may start
+		mip_stamp_ = 0;
+	}
+
 	//set nrrd
 	void Texture::set_nrrd(CompType type, TexComp comp)
 	{
 		Nrrd* nrrd = comp.data;
 		if (!nrrd)
 			return;
+		if (type == CompType::Data)
+		{
+			//the old data may be released below
+			set_mip_level(0);
+			stop_mip_job();
+			stop_stat_job();
+		}
 
 		bool existInPyramid = false;
 		for (int i = 0; i < pyramid_.size(); i++)
 			if (pyramid_[i].data == nrrd)
 				existInPyramid = true;
 
+		if (type == CompType::Label)
+			label_src_ = nullptr;
+
 		auto c = data_.find(type);
 		if (c != data_.end() && !existInPyramid)
 		{
 			if (type == CompType::Mask && mask_undo_num_)
 				nrrdNix(c->second.data);
 			else
-				nrrdNuke(c->second.data);
+				glbin_buffer_pool.Nuke(c->second.data);
 		}
 		data_[type] = comp;
 
@@ -850,15 +1257,24 @@ namespace flvr
 		{
 			for (int i = 0; i < (int)(*bricks_).size(); i++)
 				(*bricks_)[i]->set_nrrd(type, comp);
+			if (type == CompType::Data)
+				invalid_brick_stats();
 
 			//add to undo list
 			if (type == CompType::Mask)
-				set_mask(nrrd->data);
+				set_mask(nrrd->data,
+					nrrdElementNumber(nrrd) * nrrdElementSize(nrrd));
 		}
 	}
 
 	TexComp Texture::get_nrrd(CompType type)
 	{
+		//cpu users of labels kept in a file get all of them
+		if (type == CompType::Label && label_src_)
+			load_label_src();
+		//the caller may write the mask or label anywhere
+		if (type == CompType::Mask || type == CompType::Label)
+			set_zero(type, false);
 		auto c = data_.find(type);
 		if (c == data_.end())
 			return TexComp();
@@ -878,7 +1294,6 @@ namespace flvr
 			mask_undo_pointer_>0 &&
 			mask_undo_pointer_<mask_undos_.size())
 		{
-			delete[] (unsigned char*)(mask_undos_.front());
 			mask_undos_.erase(mask_undos_.begin());
 			mask_undo_pointer_--;
 		}
@@ -897,7 +1312,6 @@ namespace flvr
 			mask_undo_pointer_>=0 &&
 			mask_undo_pointer_<mask_undos_.size()-1)
 		{
-			delete[] (unsigned char*)(mask_undos_.back());
 			mask_undos_.pop_back();
 		}
 		return true;
@@ -921,24 +1335,61 @@ namespace flvr
 		return true;
 	}
 
-	void Texture::set_mask(void* mask_data)
+	void Texture::set_mask(void* mask_data, size_t bytes)
 	{
 		if (mask_undo_num_==0)
 			return;
 
+		size_t nx = res_.intx();
+		size_t ny = res_.inty();
+		size_t nz = res_.intz();
+		unsigned char* data = (unsigned char*)mask_data;
+		if (data == mask_data_)
+		{
+			//same buffer, only refresh the current state
+			if (mask_undo_pointer_ > -1)
+				mask_bricks_.Update(mask_data_,
+					mask_undos_[mask_undo_pointer_]);
+			return;
+		}
+		if (bytes != nx * ny * nz)
+		{
+			//a mask of another size is resampled right after
+			//only hold it so it goes back to the pool at its size
+			clear_undos();
+			mask_data_ = data;
+			mask_data_size_ = bytes;
+			return;
+		}
+		if (!mask_bricks_.Match(nx, ny, nz))
+		{
+			clear_undos();
+			mask_bricks_.SetSize(nx, ny, nz);
+		}
+		//keep the edits of the old buffer in its state
+		if (mask_data_ && mask_undo_pointer_ > -1)
+			mask_bricks_.Update(mask_data_,
+				mask_undos_[mask_undo_pointer_]);
+		//masks are malloc'd by the pool or calloc'd when empty
+		glbin_buffer_pool.Free(mask_data_, mask_data_size_);
+		mask_data_ = data;
+		mask_data_size_ = bytes;
+		MaskState state;
+		mask_bricks_.Update(mask_data_, state);
+
 		if (mask_undo_pointer_>-1 &&
 			mask_undo_pointer_<mask_undos_.size()-1)
 		{
 			mask_undos_.insert(
 				mask_undos_.begin()+mask_undo_pointer_+1,
-				mask_data);
+				std::move(state));
 			mask_undo_pointer_++;
 			if (!trim_mask_undos_head())
 				trim_mask_undos_tail();
 		}
 		else
 		{
-			mask_undos_.push_back(mask_data);
+			mask_undos_.push_back(std::move(state));
 			mask_undo_pointer_ = static_cast<int>(mask_undos_.size())-1;
 			trim_mask_undos_head();
 		}
@@ -952,44 +1403,25 @@ namespace flvr
 			mask_undo_pointer_>mask_undos_.size()-1)
 			return;
 
-		//duplicate at pointer position
-		unsigned long long mem_size = (unsigned long long)res_.intx()*
-			(unsigned long long)res_.inty()*(unsigned long long)res_.intz();
-		void* new_data = (void*)new (std::nothrow) unsigned char[mem_size];
-		memcpy(new_data, mask_undos_[mask_undo_pointer_], size_t(mem_size));
+		//only bricks changed since the last push are compressed again
+		//the new state shares the rest
+		mask_bricks_.Update(mask_data_, mask_undos_[mask_undo_pointer_]);
+		MaskState state = mask_undos_[mask_undo_pointer_];
 		if (mask_undo_pointer_<mask_undos_.size()-1)
 		{
 			mask_undos_.insert(
 				mask_undos_.begin()+mask_undo_pointer_+1,
-				new_data);
+				std::move(state));
 			mask_undo_pointer_++;
 			if (!trim_mask_undos_head())
 				trim_mask_undos_tail();
 		}
 		else
 		{
-			mask_undos_.push_back(new_data);
+			mask_undos_.push_back(std::move(state));
 			mask_undo_pointer_++;
 			trim_mask_undos_head();
 		}
-
-//#ifdef _DEBUG
-//		DBMIUINT8 img;
-//		img.nx = nx_; img.ny = ny_; img.nc = 1; img.nt = img.nx;
-//		img.data = (unsigned char*)(mask_undos_[0]);
-//		DBMIUINT8 img2;
-//		img2.nx = nx_; img2.ny = ny_; img2.nc = 1; img2.nt = img2.nx;
-//		img2.data = (unsigned char*)(mask_undos_[1]);
-//#endif
-		//update mask data
-		auto c = data_.find(CompType::Mask);
-		if (c == data_.end())
-			return;
-		Nrrd* nrrd = c->second.data;
-		nrrdWrap_va(nrrd,
-			mask_undos_[mask_undo_pointer_],
-			nrrdTypeUChar, 3, (size_t)res_.intx(),
-			(size_t)res_.inty(), (size_t)res_.intz());
 	}
 
 	void Texture::pop_mask()
@@ -1000,19 +1432,15 @@ namespace flvr
 			mask_undo_pointer_ > mask_undos_.size() - 1)
 			return;
 
-		delete[](unsigned char*)(mask_undos_.back());
+		mask_bricks_.Update(mask_data_, mask_undos_[mask_undo_pointer_]);
+		MaskState cur = mask_undos_[mask_undo_pointer_];
 		mask_undos_.pop_back();
 		mask_undo_pointer_--;
 
 		//update mask data
-		auto c = data_.find(CompType::Mask);
-		if (c == data_.end())
-			return;
-		Nrrd* nrrd = c->second.data;
-		nrrdWrap_va(nrrd,
-			mask_undos_[mask_undo_pointer_],
-			nrrdTypeUChar, 3, (size_t)res_.intx(),
-			(size_t)res_.inty(), (size_t)res_.intz());
+		set_zero(CompType::Mask, false);
+		mask_bricks_.Restore(mask_data_,
+			mask_undos_[mask_undo_pointer_], cur);
 	}
 
 	void Texture:: mask_undos_backward()
@@ -1023,18 +1451,17 @@ namespace flvr
 			mask_undo_pointer_>mask_undos_.size()-1)
 			return;
 
+		//keep edits made since the last push
+		mask_bricks_.Update(mask_data_, mask_undos_[mask_undo_pointer_]);
+
 		//move pointer
 		mask_undo_pointer_--;
 
 		//update mask data
-		auto c = data_.find(CompType::Mask);
-		if (c == data_.end())
-			return;
-		Nrrd* nrrd = c->second.data;
-		nrrdWrap_va(nrrd,
+		set_zero(CompType::Mask, false);
+		mask_bricks_.Restore(mask_data_,
 			mask_undos_[mask_undo_pointer_],
-			nrrdTypeUChar, 3, (size_t)res_.intx(),
-			(size_t)res_.inty(), (size_t)res_.intz());
+			mask_undos_[mask_undo_pointer_ + 1]);
 	}
 
 	void Texture::mask_undos_forward()
@@ -1045,30 +1472,44 @@ namespace flvr
 			mask_undo_pointer_>mask_undos_.size()-2)
 			return;
 
+		//keep edits made since the last push
+		mask_bricks_.Update(mask_data_, mask_undos_[mask_undo_pointer_]);
+
 		//move pointer
 		mask_undo_pointer_++;
 
 		//update mask data
-		auto c = data_.find(CompType::Mask);
-		if (c == data_.end())
-			return;
-		Nrrd* nrrd = c->second.data;
-		nrrdWrap_va(nrrd,
+		set_zero(CompType::Mask, false);
+		mask_bricks_.Restore(mask_data_,
 			mask_undos_[mask_undo_pointer_],
-			nrrdTypeUChar, 3, (size_t)res_.intx(),
-			(size_t)res_.inty(), (size_t)res_.intz());
+			mask_undos_[mask_undo_pointer_ - 1]);
 	}
 
 	void Texture::clear_undos()
 	{
 		//mask data now managed by the undos
-		for (size_t i=0; i<mask_undos_.size(); ++i)
-		{
-			if (mask_undos_[i])
-				delete[] (unsigned char*)(mask_undos_[i]);
-		}
 		mask_undos_.clear();
 		mask_undo_pointer_ = -1;
+		glbin_buffer_pool.Free(mask_data_, mask_data_size_);
+		mask_data_ = nullptr;
+		mask_data_size_ = 0;
+	}
+
+	size_t Texture::get_undo_size()
+	{
+		//the live mask is reported as the mask itself
+		size_t size = 0;
+		//chunks are shared between states
+		std::unordered_set<const MaskChunk*> chunks;
+		for (auto& state : mask_undos_)
+		{
+			for (auto& chunk : state)
+			{
+				if (chunk && chunks.insert(chunk.get()).second)
+					size += sizeof(MaskChunk) + chunk->code.size();
+			}
+		}
+		return size;
 	}
 
 	unsigned int Texture::negxid(unsigned int id)
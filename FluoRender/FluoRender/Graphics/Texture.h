@@ -34,9 +34,13 @@
 #include <Transform.h>
 #include <Point.h>
 #include <Vector.h>
+#include <MaskBricks.h>
 #include <glm/mat4x4.hpp>
 #include <vector>
 #include <unordered_map>
+#include <future>
+#include <atomic>
+#include <functional>
 
 #ifndef TextureBrick_h
 #define TEXTURE_MAX_COMPONENTS	4
@@ -66,6 +70,8 @@ namespace flvr
 		int bytes;
 		Nrrd* data;
 	};
+	//reads a box of voxels into dst, x fastest
+	typedef std::function<bool(const int org[3], const int size[3], void* dst)> BrickSrc;
 	class Texture 
 	{
 	public:
@@ -146,6 +152,15 @@ namespace flvr
 		//get bricks sorted by id
 		std::vector<TextureBrick*>* get_bricks_id();
 		size_t get_brick_list_size() {return (*bricks_).size();}
+		//value statistics of bricks for skipping empty space
+		//call invalid_brick_stats() when the data is changed in place
+		void compute_brick_stats();
+		void invalid_brick_stats();
+		//compute the statistics if the data has changed
+		void update_brick_stats();
+		//for drawing, the statistics are computed in the background
+		//returns true when they are up to date
+		bool request_brick_stats();
 		//quota bricks
 		std::vector<TextureBrick*>* get_quota_bricks();
 
@@ -175,17 +190,26 @@ namespace flvr
 		bool trim_mask_undos_tail();
 		bool get_undo();
 		bool get_redo();
-		void set_mask(void* mask_data);
+		void set_mask(void* mask_data, size_t bytes);
 		void push_mask();
 		void pop_mask();
 		void mask_undos_forward();
 		void mask_undos_backward();
 		void clear_undos();
+		//bytes kept for mask undos
+		size_t get_undo_size();
 
 		//add one more texture component as the volume mask
 		bool add_empty_mask();
 		//add one more texture component as the labeling volume
 		bool add_empty_label();
+		//labels kept in a file are read by brick when their textures are made
+		//the label nrrd has no data until load_label_src reads all of it
+		//setting the label nrrd again drops the source
+		void set_label_src(const BrickSrc& src) { label_src_ = src; }
+		bool has_label_src() { return label_src_ ? true : false; }
+		bool read_label_src(TextureBrick* b, void* dst);
+		bool load_label_src();
 
 		//enable mask paint for all
 		void deact_all_mask();
@@ -195,6 +219,8 @@ namespace flvr
 		void invalid_all_mask();
 		//validate all masks
 		void valid_all_mask();
+		//mark the mask or label of all bricks as zero after clearing it
+		void set_zero(CompType type, bool val);
 
 		//get priority brick number
 		void set_use_priority(bool value) {use_priority_ = value;}
@@ -214,6 +240,17 @@ namespace flvr
 		FileLocInfo *GetFileName(int id);
 		void set_FrameAndChannel(int fr, int ch);
 
+		//coarse levels of a volume held in memory, not for brkxml
+		//they are built in the background from the data and dropped when it changes
+		//level 0 is the data itself, a coarse level replaces its bricks for drawing only
+		//a coarse brick covers the region of a level 0 brick, see TextureBrick::get_base
+		//get_spacing(lv) gives the spacing of a coarse level
+		void update_mip();
+		int get_mip_num() { return static_cast<int>(mip_.size()) + 1; }
+		int get_mip_level() { return mip_lv_; }
+		bool set_mip_level(int lv);
+		size_t get_mip_size();
+
 	protected:
 		void build_bricks(std::vector<TextureBrick*> &bricks,
 			const fluo::Vector& size, int bytes);
@@ -249,12 +286,25 @@ namespace flvr
 		//priority
 		bool use_priority_;
 		int n_p0_;
+		//brick statistics are out of date
+		bool brick_stat_dirty_ = true;
+		std::future<void> stat_job_;
+		//wait for the statistics being computed
+		void stop_stat_job();
+		//bricks of level 0 while a coarse level is set
+		std::vector<TextureBrick*>* get_bricks0() { return mip_lv_ ? mip_bricks0_ : bricks_; }
 
 		std::unordered_map<CompType, TexComp> data_;
+		BrickSrc label_src_;
 
 		//undos for mask
-		std::vector<void*> mask_undos_;
+		//states are brick snapshots of the mask
+		//the mask data itself is kept by mask_data_
+		std::vector<MaskState> mask_undos_;
 		int mask_undo_pointer_;
+		unsigned char* mask_data_;
+		size_t mask_data_size_;//bytes, for releasing to the pool
+		MaskBricks mask_bricks_;
 
 		//for brkxml
 		bool brkxml_;
@@ -278,6 +328,28 @@ namespace flvr
 		//for view testing
 		fluo::Transform mv_;
 		fluo::Transform pr_;
+
+		//coarse levels, kept like the levels of a brkxml pyramid without files
+		std::vector<Pyramid_Level> mip_;
+		int mip_lv_ = 0;
+		int mip_mode_ = 0;//pooling the levels are built with
+		//level 0 while a coarse level is set
+		std::vector<TextureBrick*>* mip_bricks0_ = nullptr;
+		fluo::Vector mip_res0_;
+		fluo::Vector mip_spacing0_;
+		fluo::Vector mip_brick_res0_;
+		fluo::Vector mip_brick_num0_;
+		//changes of the data, levels built from an older stamp are stale
+		unsigned long long data_stamp_ = 1;
+		unsigned long long mip_stamp_ = 0;
+		std::future<std::vector<Nrrd*>> mip_job_;
+		std::atomic<bool> mip_cancel_{ false };
+		//wait for the build and drop its result
+		void stop_mip_job();
+		//gl is false when no context is current
+		void clear_mip(bool gl = true);
+		//bricks of a coarse level over the regions of level 0 bricks
+		void build_mip_bricks(Pyramid_Level& level, int bytes);
 	};
 
 } // namespace flvr
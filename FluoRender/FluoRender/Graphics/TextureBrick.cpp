@@ -36,6 +36,7 @@
 #include <compatibility.h>
 #include <math.h>
 #include <utility>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -384,8 +385,10 @@ namespace flvr
 		auto c = data_.find(type);
 		if (c == data_.end())
 			return nullptr;
+		//the caller may write it
+		set_zero(type, false);
 		Nrrd* nrrd = c->second.data;
-		if (!nrrd)
+		if (!nrrd || !nrrd->data)
 			return nullptr;
 
 		int bytes = c->second.bytes;
@@ -529,6 +532,139 @@ namespace flvr
 		}
 	}
 
+	bool TextureBrick::get_range(Nrrd* nrrd,
+		size_t& x0, size_t& y0, size_t& z0,
+		size_t& x1, size_t& y1, size_t& z1,
+		size_t& nx, size_t& ny)
+	{
+		if (!nrrd || !nrrd->data || nrrd->dim < 3)
+			return false;
+		size_t o = nrrd->dim > 3 ? 1 : 0;
+		nx = nrrd->axis[o].size;
+		ny = nrrd->axis[o + 1].size;
+		size_t nz = nrrd->axis[o + 2].size;
+		auto clamp = [](int v, size_t n)
+		{
+			return std::min(static_cast<size_t>(std::max(v, 0)), n);
+		};
+		x0 = clamp(off_size_.intx(), nx);
+		y0 = clamp(off_size_.inty(), ny);
+		z0 = clamp(off_size_.intz(), nz);
+		x1 = clamp(off_size_.intx() + size_.intx(), nx);
+		y1 = clamp(off_size_.inty() + size_.inty(), ny);
+		z1 = clamp(off_size_.intz() + size_.intz(), nz);
+		return x0 < x1 && y0 < y1 && z0 < z1;
+	}
+
+	template <typename T>
+	void TextureBrick::compute_stat(const T* ptr, double norm)
+	{
+		size_t x0, y0, z0, x1, y1, z1, nx, ny;
+		if (!get_range(data_[CompType::Data].data,
+			x0, y0, z0, x1, y1, z1, nx, ny))
+			return;
+		T vmin = ptr[(z0 * ny + y0) * nx + x0];
+		T vmax = vmin;
+		double sum = 0.0;
+		unsigned long long nz = 0;
+		for (size_t k = z0; k < z1; ++k)
+		for (size_t j = y0; j < y1; ++j)
+		{
+			const T* row = ptr + (k * ny + j) * nx;
+			for (size_t i = x0; i < x1; ++i)
+			{
+				T v = row[i];
+				if (v < vmin) vmin = v;
+				if (v > vmax) vmax = v;
+				if (v)
+				{
+					sum += v;
+					nz++;
+				}
+			}
+		}
+		double n = double(x1 - x0) * double(y1 - y0) * double(z1 - z0);
+		min_ = vmin / norm;
+		max_ = vmax / norm;
+		mean_ = sum / n / norm;
+		nonzero_ = nz;
+		stat_valid_ = true;
+	}
+
+	void TextureBrick::compute_stat()
+	{
+		stat_valid_ = false;
+		auto c = data_.find(CompType::Data);
+		if (c == data_.end() || !c->second.data)
+			return;
+		void* ptr = c->second.data->data;
+		if (!ptr)
+			return;
+		switch (c->second.bytes)
+		{
+		case 1:
+			compute_stat((const unsigned char*)ptr, 255.0);
+			break;
+		case 2:
+			compute_stat((const unsigned short*)ptr, 65535.0);
+			break;
+		case 4:
+			compute_stat((const unsigned int*)ptr, 4294967295.0);
+			break;
+		}
+	}
+
+	void TextureBrick::set_zero(CompType type, bool val)
+	{
+		switch (type)
+		{
+		case CompType::Mask:
+			mask_zero_ = val;
+			break;
+		case CompType::Label:
+			label_zero_ = val;
+			break;
+		default:
+			break;
+		}
+	}
+
+	bool TextureBrick::is_zero(CompType type)
+	{
+		switch (type)
+		{
+		case CompType::Mask:
+			return mask_zero_;
+		case CompType::Label:
+			return label_zero_;
+		default:
+			return false;
+		}
+	}
+
+	bool TextureBrick::is_comp_empty(CompType type)
+	{
+		if (is_zero(type))
+			return true;
+		auto c = data_.find(type);
+		if (c == data_.end() || !c->second.data)
+			return true;
+		size_t x0, y0, z0, x1, y1, z1, nx, ny;
+		if (!get_range(c->second.data, x0, y0, z0, x1, y1, z1, nx, ny))
+			return true;
+		size_t bytes = c->second.bytes;
+		const unsigned char* ptr = (const unsigned char*)(c->second.data->data);
+		size_t w = (x1 - x0) * bytes;
+		for (size_t k = z0; k < z1; ++k)
+		for (size_t j = y0; j < y1; ++j)
+		{
+			const unsigned char* row = ptr + ((k * ny + j) * nx + x0) * bytes;
+			if (std::any_of(row, row + w, [](unsigned char v) { return v != 0; }))
+				return false;
+		}
+		return true;
+	}
+
 	void TextureBrick::freeBrkData()
 	{
 		if (brkdata_) delete[] brkdata_;
@@ -139,6 +139,8 @@ namespace flvr
 			else
 				return size_;
 		}
+		inline void set_base(TextureBrick* b) { base_ = b; }
+		inline TextureBrick* get_base() { return base_; }
 
 		inline void set_drawn(int mode, bool val)
 		{ if (mode>=0 && mode<TEXTURE_RENDER_MODES) drawn_[mode] = val; }
@@ -149,7 +151,7 @@ namespace flvr
 		{ if (mode>=0 && mode<TEXTURE_RENDER_MODES) return drawn_[mode]; else return false;}
 
 		// Creator of the brick owns the nrrd memory.
-		void set_nrrd(CompType type, TexComp comp) { data_[type] = comp;}
+		void set_nrrd(CompType type, TexComp comp) { data_[type] = comp; set_zero(type, false); }
 		TexComp get_nrrd(CompType type)
 		{
 			auto c = data_.find(type);
@@ -163,6 +165,24 @@ namespace flvr
 		void set_priority();
 		inline int get_priority() {return priority_;}
 
+		//value statistics of the data, normalized to 0-1
+		//voxels shared with neighbor bricks are included
+		void compute_stat();
+		void invalid_stat() { stat_valid_ = false; }
+		bool stat_valid() { return stat_valid_; }
+		double get_min() { return min_; }
+		double get_max() { return max_; }
+		double get_mean() { return mean_; }
+		unsigned long long get_nonzero() { return nonzero_; }
+		//all data is zero
+		bool is_empty() { return stat_valid_ && nonzero_ == 0; }
+		//no data value falls in [lo, hi]
+		bool is_outside(double lo, double hi)
+		{ return stat_valid_ && (max_ < lo || min_ > hi); }
+		//no voxel of a component is non-zero
+		//scans the brick until the first non-zero voxel
+		bool is_comp_empty(CompType type);
+
 		GLenum tex_type(CompType type);
 		void* tex_data(CompType type);
 		void* tex_data(CompType type, void* raw_data);//given external raw data, using the same address in brick
@@ -196,7 +216,7 @@ namespace flvr
 		double get_data(const fluo::Point& ijk);
 
 		void freeBrkData();
-		bool read_brick(char* data, size_t size, const FileLocInfo* finfo);
+		static bool read_brick(char* data, size_t size, const FileLocInfo* finfo);
 		bool isLoaded() { return brkdata_ ? true : false; };
 		bool isLoading() { return loading_; }
 		void set_loading_state(bool val) { loading_ = val; }
@@ -216,6 +236,11 @@ namespace flvr
 		void invalid_mask() { mask_valid_ = false; }
 		bool is_mask_valid() { return mask_valid_; }
 		bool is_nbmask_valid(Texture* tex);//check 6 neighbors
+		//mask or label of the brick known to be all zero
+		//textures are made and returned without touching the data
+		//getting the data pointer clears it
+		void set_zero(CompType type, bool val);
+		bool is_zero(CompType type);
 		//activate/deactivate mask painting
 		void act_mask(bool val = true) { mask_act_ = val; }
 		void deact_mask() { mask_act_ = false; }
@@ -230,7 +255,7 @@ namespace flvr
 		size_t tex_type_size(GLenum t);
 		GLenum tex_type_aux(Nrrd* n);
 
-		bool raw_brick_reader(char* data, size_t size, const FileLocInfo* finfo);
+		static bool raw_brick_reader(char* data, size_t size, const FileLocInfo* finfo);
 
 		//! bbox edges
 		fluo::Ray edge_[12];
@@ -267,8 +292,26 @@ namespace flvr
 		bool mask_valid_;
 		//mask is active (being painted)
 		bool mask_act_;
+		//mask and label known to be zero
+		bool mask_zero_ = false;
+		bool label_zero_ = false;
+		//level 0 brick over the same region, a coarse brick draws with its mask and label
+		TextureBrick* base_ = nullptr;
 		//new label for grow ruler merge
 		bool new_grown_;
+		//data statistics
+		bool stat_valid_ = false;
+		double min_ = 0.0;
+		double max_ = 0.0;
+		double mean_ = 0.0;
+		unsigned long long nonzero_ = 0;
+		template <typename T>
+		void compute_stat(const T* ptr, double norm);
+		//voxel range clamped to the volume
+		bool get_range(Nrrd* nrrd,
+			size_t& x0, size_t& y0, size_t& z0,
+			size_t& x1, size_t& y1, size_t& z1,
+			size_t& nx, size_t& ny);
 
 		int findex_;
 		long long offset_;
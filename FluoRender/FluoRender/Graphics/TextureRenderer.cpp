@@ -43,6 +43,7 @@
 #include <Ray.h>
 #include <VolCache4D.h>
 #include <algorithm>
+#include <unordered_set>
 #include <glm/gtc/type_ptr.hpp>
 #include <compatibility.h>
 #include <thread>
@@ -195,6 +196,26 @@ namespace flvr
 		glbin_settings.m_available_mem = glbin_settings.m_mem_limit;
 	}
 
+	size_t TextureRenderer::get_tex_mem(Texture* tex)
+	{
+		std::unordered_set<TextureBrick*> bricks;
+		if (tex)
+		{
+			std::vector<TextureBrick*>* list = tex->get_bricks();
+			if (!list)
+				return 0;
+			bricks.insert(list->begin(), list->end());
+		}
+		size_t size = 0;
+		for (auto& it : tex_pool_)
+		{
+			if (!it.id || (tex && !bricks.count(it.brick)))
+				continue;
+			size += (size_t)it.nx * it.ny * it.nz * it.nb;
+		}
+		return size;
+	}
+
 	void TextureRenderer::clear_tex_current()
 	{
 		auto tex = tex_.lock();
@@ -202,12 +223,18 @@ namespace flvr
 			return;
 
 		std::vector<TextureBrick*>* bricks = tex->get_bricks();
+		if (bricks)
+			clear_tex_bricks(*bricks);
+	}
+
+	void TextureRenderer::clear_tex_bricks(const std::vector<TextureBrick*>& bricks)
+	{
 		TextureBrick* brick = 0;
 		for (size_t i = tex_pool_.size(); i > 0; --i)
 		{
-			for (size_t j = 0; j < bricks->size(); ++j)
+			for (size_t j = 0; j < bricks.size(); ++j)
 			{
-				brick = (*bricks)[j];
+				brick = bricks[j];
 				if (tex_pool_[i - 1].brick == brick/* &&
 					(tex_pool_[i].comp == 0 ||
 					tex_pool_[i].comp == brick->nmask() ||
@@ -1084,6 +1111,21 @@ namespace flvr
 			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, filter);
 			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, filter);
 
+			//a zero mask is not read, pages never written stay unmapped
+			void* tex_data = 0;
+			int sx = stride.intx();
+			int sy = stride.inty();
+			std::vector<unsigned char> zero_mask;
+			if (brick->is_zero(CompType::Mask))
+			{
+				zero_mask.resize(size_t(nx) * ny * nz * nb, 0);
+				tex_data = zero_mask.data();
+				sx = nx;
+				sy = ny;
+			}
+			else
+				tex_data = brick->tex_data(CompType::Mask);
+
 			// download texture data
 			if (ShaderProgram::no_tex_unpack_)
 			{
@@ -1092,8 +1134,8 @@ namespace flvr
 			}
 			else
 			{
-				glPixelStorei(GL_UNPACK_ROW_LENGTH, stride.intx());
-				glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, stride.inty());
+				glPixelStorei(GL_UNPACK_ROW_LENGTH, sx);
+				glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, sy);
 			}
 
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -1105,9 +1147,9 @@ namespace flvr
 				glTexImage3D(GL_TEXTURE_3D, 0, internal_format, nx, ny, nz, 0, format,
 					brick->tex_type(CompType::Mask), 0);
 
-				load_texture(brick->tex_data(CompType::Mask),
+				load_texture(tex_data,
 					nx, ny, nz, nb,
-					stride.intx(), stride.inty(),
+					sx, sy,
 					brick->tex_type(CompType::Mask), format);
 			}
 
@@ -1186,6 +1228,33 @@ namespace flvr
 			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
+			//labels kept in a file are read for this brick only
+			void* tex_data = 0;
+			int sx = stride.intx();
+			int sy = stride.inty();
+			std::vector<unsigned int> src_label;
+			auto tex = tex_.lock();
+			if (tex && tex->has_label_src())
+			{
+				//a failed read leaves the brick unlabeled
+				src_label.resize(size_t(nx) * ny * nz, 0);
+				if (!tex->read_label_src(brick, src_label.data()))
+					std::fill(src_label.begin(), src_label.end(), 0);
+				tex_data = src_label.data();
+				sx = nx;
+				sy = ny;
+			}
+			else if (brick->is_zero(CompType::Label))
+			{
+				//zero labels are not read
+				src_label.resize(size_t(nx) * ny * nz, 0);
+				tex_data = src_label.data();
+				sx = nx;
+				sy = ny;
+			}
+			else
+				tex_data = brick->tex_data(CompType::Label);
+
 			// download texture data
 			if (ShaderProgram::no_tex_unpack_)
 			{
@@ -1194,8 +1263,8 @@ namespace flvr
 			}
 			else
 			{
-				glPixelStorei(GL_UNPACK_ROW_LENGTH, stride.intx());
-				glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, stride.inty());
+				glPixelStorei(GL_UNPACK_ROW_LENGTH, sx);
+				glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, sy);
 			}
 
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
@@ -1207,9 +1276,9 @@ namespace flvr
 				glTexImage3D(GL_TEXTURE_3D, 0, internal_format, nx, ny, nz, 0, format,
 					brick->tex_type(CompType::Label), NULL);
 
-				load_texture(brick->tex_data(CompType::Label),
+				load_texture(tex_data,
 					nx, ny, nz, nb,
-					stride.intx(), stride.inty(),
+					sx, sy,
 					brick->tex_type(CompType::Label), format);
 			}
 
@@ -1225,6 +1294,14 @@ namespace flvr
 		return result;
 	}
 
+	bool TextureRenderer::has_tex(TextureBrick* brick, CompType type)
+	{
+		for (auto& it : tex_pool_)
+			if (it.brick == brick && it.comp_type == type)
+				return true;
+		return false;
+	}
+
 	bool TextureRenderer::brick_sort(const BrickDist& bd1, const BrickDist& bd2)
 	{
 		return bd1.dist > bd2.dist;
@@ -212,6 +212,8 @@ namespace flvr
 		//clear the opengl textures from the texture pool
 		static void clear_tex_pool();
 		void clear_tex_current();
+		//delete textures of bricks that are going away
+		static void clear_tex_bricks(const std::vector<TextureBrick*>& bricks);
 		void clear_tex_mask(bool skip=true);
 		void clear_tex_label();
 
@@ -241,6 +243,9 @@ namespace flvr
 		void set_sample_rate(double rate) { sample_rate_ = rate; }
 		double get_sample_rate();
 
+		//bytes of textures in the pool, only those of tex if given
+		static size_t get_tex_mem(Texture* tex = 0);
+
 		//main(cpu) memory limit
 		static void set_mainmem_buf_size(double val) { mainmem_buf_size_ = val; }
 		static double get_mainmem_buf_size() { return mainmem_buf_size_; }
@@ -389,6 +394,8 @@ namespace flvr
 		GLint load_brick_mask(TextureBrick* brick, GLint filter=GL_NEAREST, bool compression=false, int unit=0);
 		//load the texture for volume labeling into texture pool
 		GLint load_brick_label(TextureBrick* brick);
+		//if the brick has a texture of the component in the pool
+		bool has_tex(TextureBrick* brick, CompType type);
 		void load_texture(void* tex_data,
 			unsigned int nx, unsigned int ny,
 			unsigned int nz, unsigned int nb,
@@ -28,6 +28,7 @@ DEALINGS IN THE SOFTWARE.
 #include <VolCache4D.h>
 #include <Texture.h>
 #include <Global.h>
+#include <MainSettings.h>
 #include <CurrentObjects.h>
 #include <VolumeData.h>
 #include <RenderView.h>
@@ -35,6 +36,9 @@ DEALINGS IN THE SOFTWARE.
 #include <msk_reader.h>
 #include <lbl_reader.h>
 #include <msk_writer.h>
+#include <ZeroMem.h>
+#include <BufferPool.h>
+#include <FrameCache.h>
 #include <string>
 
 using namespace flvr;
@@ -143,17 +147,24 @@ void CQCallback::FreeVolCache(VolCache4D& vol_cache)
 	}
 	if (vol_cache.own_data && vol_cache.m_data)
 	{
-		nrrdNuke((Nrrd*)vol_cache.m_data);
+		//data read from files is not modified, keep it compressed
+		auto vd = vol_cache.m_vd.lock();
+		auto reader = vd ? vd->GetReader() : nullptr;
+		if (reader)
+			glbin_frame_cache.Put(reader.get(),
+				static_cast<int>(vol_cache.m_tnum), vd->GetCurChannel(),
+				vol_cache.m_data);
+		glbin_buffer_pool.Nuke((Nrrd*)vol_cache.m_data);
 		vol_cache.m_data = 0;
 	}
 	if (vol_cache.own_mask && vol_cache.m_mask)
 	{
-		nrrdNuke((Nrrd*)vol_cache.m_mask);
+		glbin_buffer_pool.Nuke((Nrrd*)vol_cache.m_mask);
 		vol_cache.m_mask = 0;
 	}
 	if (vol_cache.own_label && vol_cache.m_label)
 	{
-		nrrdNuke((Nrrd*)vol_cache.m_label);
+		glbin_buffer_pool.Nuke((Nrrd*)vol_cache.m_label);
 		vol_cache.m_label = 0;
 	}
 	vol_cache.m_valid = false;
@@ -172,8 +183,10 @@ bool CQCallback::HandleData(VolCache4D& vol_cache)
 	int frame = static_cast<int>(vol_cache.m_tnum);
 	int chan = vd->GetCurChannel();
 
-	Nrrd* data = 0;
-	data = reader->Convert(frame, chan, true);
+	//restore from compressed frames before reading the file
+	Nrrd* data = glbin_frame_cache.Get(reader.get(), frame, chan);
+	if (!data)
+		data = reader->Convert(frame, chan, true);
 	vol_cache.m_data = data;
 	vol_cache.m_valid &= (data != 0);
 	vol_cache.own_data = vol_cache.m_valid;
@@ -204,7 +217,7 @@ bool CQCallback::HandleMask(VolCache4D& vol_cache)
 		mask = nrrdNew();
 		unsigned long long mem_size = (unsigned long long)res.intx() *
 			(unsigned long long)res.inty() * (unsigned long long)res.intz();
-		uint8_t* val8 = new (std::nothrow) uint8_t[mem_size]();
+		uint8_t* val8 = flrd::AllocZero<uint8_t>(mem_size);
 		nrrdWrap_va(mask, val8, nrrdTypeUChar, 3, (size_t)res.intx(), (size_t)res.inty(), (size_t)res.intz());
 		nrrdAxisInfoSet_va(mask, nrrdAxisInfoSpacing, spc.x(), spc.y(), spc.z());
 		nrrdAxisInfoSet_va(mask, nrrdAxisInfoMin, 0.0, 0.0, 0.0);
@@ -242,7 +255,7 @@ bool CQCallback::HandleLabel(VolCache4D& vol_cache)
 		label = nrrdNew();
 		unsigned long long mem_size = (unsigned long long)res.intx() *
 			(unsigned long long)res.inty() * (unsigned long long)res.intz();
-		unsigned int* val32 = new (std::nothrow) unsigned int[mem_size]();
+		unsigned int* val32 = flrd::AllocZero<unsigned int>(mem_size);
 		nrrdWrap_va(label, val32, nrrdTypeUInt, 3, (size_t)res.intx(), (size_t)res.inty(), (size_t)res.intz());
 		nrrdAxisInfoSet_va(label, nrrdAxisInfoSpacing, spc.x(), spc.y(), spc.z());
 		nrrdAxisInfoSet_va(label, nrrdAxisInfoMin, 0.0, 0.0, 0.0);
@@ -336,6 +349,7 @@ bool CQCallback::SaveLabel(VolCache4D& vol_cache)
 	MSKWriter msk_writer;
 	msk_writer.SetData((Nrrd*)vol_cache.GetNrrdLabel());
 	msk_writer.SetSpacing(vd->GetSpacing());
+	msk_writer.SetCompact(glbin_settings.m_label_compact);
 	std::wstring filename = reader->GetCurLabelName(frame, chan);
 	msk_writer.Save(filename, 1);
 	return true;
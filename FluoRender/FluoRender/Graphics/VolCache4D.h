@@ -197,6 +197,8 @@ namespace flvr
 		inline void set_max_size(size_t size);
 		inline size_t get_max_size();
 		inline size_t size();
+		//bytes of the frames owned by the caches
+		inline size_t get_mem_size();
 		inline VolCache4D* get(size_t frame);
 		VolCache4D* get_offset(int toffset);
 		inline void set_modified(size_t frame, bool value = true);
@@ -286,6 +288,27 @@ namespace flvr
 		return m_queue.size();
 	}
 
+	inline size_t CacheQueue::get_mem_size()
+	{
+		auto bytes = [](Nrrd* nrrd)
+		{
+			if (!nrrd || !nrrd->data)
+				return size_t(0);
+			return nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+		};
+		size_t size = 0;
+		for (auto& it : m_queue)
+		{
+			if (it.own_data)
+				size += bytes(it.m_data);
+			if (it.own_mask)
+				size += bytes(it.m_mask);
+			if (it.own_label)
+				size += bytes(it.m_label);
+		}
+		return size;
+	}
+
 	inline void CacheQueue::pop_cache()
 	{
 		if (m_queue.front().m_protect)
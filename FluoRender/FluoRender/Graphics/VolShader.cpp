@@ -207,6 +207,8 @@ bool VolShaderFactory::emit_f(const ShaderParams& p, std::string& s)
 		z << VOL_UNIFORMS_MASK;
 	if (p.has_label)
 		z << VOL_UNIFORMS_LABEL;
+	if (p.coarse && (p.has_mask || p.has_label))
+		z << VOL_UNIFORMS_MASK_COARSE;
 
 	//functions
 	if (p.clip)
@@ -214,6 +216,10 @@ bool VolShaderFactory::emit_f(const ShaderParams& p, std::string& s)
 	//the common head
 	z << VOL_HEAD;
 
+	//mask and label of a coarse brick are at level 0
+	if (p.has_mask || p.has_label)
+		z << (p.coarse ? VOL_HEAD_MASK_COORD_COARSE : VOL_HEAD_MASK_COORD);
+
 	if (p.peel != 0)
 		z << VOL_HEAD_2DMAP_LOC;
 
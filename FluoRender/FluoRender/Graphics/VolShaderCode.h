@@ -173,6 +173,11 @@ inline constexpr const char* VOL_UNIFORMS_LABEL  = R"GLSHDR(
 uniform usampler3D tex3;//3d label volume
 )GLSHDR";
 
+inline constexpr const char* VOL_UNIFORMS_MASK_COARSE  = R"GLSHDR(
+//VOL_UNIFORMS_MASK_COARSE
+uniform mat4 matrix3;//coarse brick to level 0 brick texture
+)GLSHDR";
+
 inline constexpr const char* VOL_UNIFORMS_DEPTHMAP  = R"GLSHDR(
 //VOL_UNIFORMS_DEPTHMAP
 uniform sampler2D tex4;//2d depth map
@@ -185,6 +190,16 @@ void main()
 	vec3 texCoord = OutTexture;
 )GLSHDR";
 
+inline constexpr const char* VOL_HEAD_MASK_COORD  = R"GLSHDR(
+	//VOL_HEAD_MASK_COORD
+	vec3 maskCoord = texCoord;
+)GLSHDR";
+
+inline constexpr const char* VOL_HEAD_MASK_COORD_COARSE  = R"GLSHDR(
+	//VOL_HEAD_MASK_COORD_COARSE
+	vec3 maskCoord = (matrix3 * vec4(texCoord, 1.0)).xyz;
+)GLSHDR";
+
 inline constexpr const char* VOL_HEAD_2DMAP_LOC  = R"GLSHDR(
 	//VOL_HEAD_2DMAP_LOC
 	vec2 fcf = vec2(gl_FragCoord.x*loc7.x, gl_FragCoord.y*loc7.y);
@@ -279,7 +294,7 @@ inline constexpr const char* VOL_NO_MASK = R"GLSHDR(
 
 inline constexpr const char* VOL_MASK_LOOKUP = R"GLSHDR(
 	//VOL_MASK_LOOKUP
-	vec4 m = texture(tex2, texCoord);
+	vec4 m = texture(tex2, maskCoord);
 )GLSHDR";
 
 inline constexpr const char* VOL_GRAD_COMPUTE  = R"GLSHDR(
@@ -462,7 +477,7 @@ inline constexpr const char* VOL_OUT_COLOR_NO_COMP = R"GLSHDR(
 
 inline constexpr const char* VOL_OUT_COLOR_COMPONENT = R"GLSHDR(
 	//VOL_OUT_COLOR_COMPONENT
-	uint comp = texture(tex3, texCoord).x;
+	uint comp = texture(tex3, maskCoord).x;
 	out_color = vec3(0.2, 0.4, 0.4);
 	float hue, p2, p3;
 	if (comp > uint(0))
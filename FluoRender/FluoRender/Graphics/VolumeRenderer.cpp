@@ -43,7 +43,10 @@
 #include <MovieMaker.h>
 #include <VolCache4D.h>
 #include <compatibility.h>
+#include <Utils.h>
+#include <ZeroMem.h>
 #include <fstream>
+#include <limits>
 #include <iostream>
 #include <array>
 #include <glm/gtc/type_ptr.hpp>
@@ -375,6 +378,8 @@ void VolumeRenderer::draw_volume(
 		colormap_proj_ == ColormapProj::Normal;
 	bool has_mask = tex->has_comp(CompType::Mask);
 	bool has_label = tex->has_comp(CompType::Label);
+	//a coarse level draws with the mask and label of level 0
+	bool coarse = tex->get_mip_level() > 0 && (has_mask || has_label);
 	shader = glbin_shader_manager.shader(gstVolShader,
 		ShaderParams::Volume(
 			false,
@@ -392,7 +397,8 @@ void VolumeRenderer::draw_volume(
 			colormap_proj_,
 			solid_,
 			1,
-			depth));
+			depth,
+			coarse));
 	assert(shader);
 	shader->bind();
 
@@ -483,6 +489,24 @@ void VolumeRenderer::draw_volume(
 		render_mode_ == RenderMode::Overlay)
 		rate_factor = 1.0 / rate;
 
+	//bricks with all values out of the thresholds are transparent
+	bool skip_range = !inv_ && !solid_ && !has_mask && !has_label &&
+		!ShaderParams::IsTimeProj(colormap_proj_) &&
+		scalar_scale_ > 0.0 &&
+		(render_mode_ == RenderMode::Standard ||
+		render_mode_ == RenderMode::Mip);
+	//statistics of new data are computed in the background
+	if (skip_range)
+		skip_range = tex->request_brick_stats();
+	double range_lo = 0.0, range_hi = 0.0;
+	if (skip_range)
+	{
+		range_lo = (lo_thresh_ - sw_) / scalar_scale_ - fluo::Epsilon();
+		range_hi = hi_thresh_ < 1.0 ?
+			(hi_thresh_ + sw_) / scalar_scale_ + fluo::Epsilon() :
+			std::numeric_limits<double>::max();
+	}
+
 	for (size_t i = 0; i < bricks->size(); ++i)
 	{
 		//comment off when debug_ds
@@ -510,7 +534,8 @@ void VolumeRenderer::draw_volume(
 
 		if (((!glbin_settings.m_mem_swap || !interactive_) &&
 			!test_against_view(b->bbox(), !orthographic_p)) || // Clip against view
-			b->get_priority() > 0) //nothing to draw
+			b->get_priority() > 0 || //nothing to draw
+			(skip_range && b->is_outside(range_lo, range_hi)))
 		{
 			if (glbin_settings.m_mem_swap && start_update_loop_ && !done_update_loop_)
 			{
@@ -542,10 +567,11 @@ void VolumeRenderer::draw_volume(
 				continue;
 			if (ShaderParams::IsTimeProj(colormap_proj_))
 				load_brick(b, filter, compression_, 10, mode, -1);
+			TextureBrick* mb = coarse && b->get_base() ? b->get_base() : b;
 			if (has_mask)
-				load_brick_mask(b, filter);
+				load_brick_mask(mb, filter);
 			if (has_label)
-				load_brick_label(b);
+				load_brick_label(mb);
 			auto texel_b = fluo::Vector(1.0) / b->get_size();
 			shader->setLocalParam(4, texel_b.x(), texel_b.y(), texel_b.z(), rate_factor);
 
@@ -569,6 +595,20 @@ void VolumeRenderer::draw_volume(
 			matrix[14] = float(bbox.Min().z());
 			matrix[15] = 1.0f;
 			shader->setLocalParamMatrix(2, matrix);
+			if (coarse)
+			{
+				//coarse brick texture to level 0 brick texture
+				fluo::BBox mbox = mb->dbox();
+				fluo::Vector msize = mbox.diagonal();
+				fluo::Vector scale = bbox.diagonal() / msize;
+				fluo::Vector trans = (bbox.Min() - mbox.Min()) / msize;
+				float mmat[16] = {
+					float(scale.x()), 0.0f, 0.0f, 0.0f,
+					0.0f, float(scale.y()), 0.0f, 0.0f,
+					0.0f, 0.0f, float(scale.z()), 0.0f,
+					float(trans.x()), float(trans.y()), float(trans.z()), 1.0f };
+				shader->setLocalParamMatrix(3, mmat);
+			}
 
 			draw_polygons(vertex, index);
 
@@ -1265,12 +1305,45 @@ void VolumeRenderer::return_volume()
 		glPixelStorei(GL_PACK_IMAGE_HEIGHT, 0);
 		glPixelStorei(GL_PACK_ALIGNMENT, 4);
 	}
+	//data may have been changed on the gpu
+	tex->invalid_brick_stats();
 
 	//release 3d texture
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_3D, 0);
 }
 
+namespace
+{
+	//copy a brick read back from its texture into the volume
+	//rows that are zero on both sides are not written,
+	//so pages of an empty mask or label stay unmapped
+	//returns true if the brick is all zero
+	bool CopyReturned(const unsigned char* src, unsigned char* dst,
+		size_t nx, size_t ny, size_t nz, size_t sx, size_t sy, size_t nb)
+	{
+		bool zero = true;
+		size_t w = nx * nb;
+		for (size_t k = 0; k < nz; ++k)
+		for (size_t j = 0; j < ny; ++j)
+		{
+			const unsigned char* s = src + (k * ny + j) * w;
+			unsigned char* d = dst + (k * sy + j) * sx * nb;
+			if (flrd::IsZero(s, w))
+			{
+				if (!flrd::IsZero(d, w))
+					std::memset(d, 0, w);
+			}
+			else
+			{
+				std::memcpy(d, s, w);
+				zero = false;
+			}
+		}
+		return zero;
+	}
+}
+
 //return the mask volume
 void VolumeRenderer::return_mask(int order)
 {
@@ -1285,6 +1358,7 @@ void VolumeRenderer::return_mask(int order)
 	if (!tex->has_comp(CompType::Mask))
 		return;
 
+	std::vector<unsigned char> buf;
 	size_t i;
 	size_t num = bricks->size();
 	for (i = ((order == 2) ? (num - 1) : 0);
@@ -1294,24 +1368,33 @@ void VolumeRenderer::return_mask(int order)
 		TextureBrick* b = (*bricks)[i];
 		if (!b || !b->is_mask_valid())
 			continue;
+		//without a texture the mask in memory is current
+		if (!has_tex(b, CompType::Mask))
+			continue;
 
 		load_brick_mask(b);
 		glActiveTexture(GL_TEXTURE0 + 2);
 
 		// download texture data
+		auto res = b->get_size();
 		auto stride = b->get_stride();
-		glPixelStorei(GL_PACK_ROW_LENGTH, stride.intx());
-		glPixelStorei(GL_PACK_IMAGE_HEIGHT, stride.inty());
+		size_t nb = b->nb(CompType::Mask);
+		buf.resize(res.get_size_xyz() * nb);
 		glPixelStorei(GL_PACK_ALIGNMENT, 1);
-
 		GLenum type = b->tex_type(CompType::Mask);
-		void* data = b->tex_data(CompType::Mask);
 		glGetTexImage(GL_TEXTURE_3D, 0, GL_RED,
-			type, data);
-
-		glPixelStorei(GL_PACK_ROW_LENGTH, 0);
-		glPixelStorei(GL_PACK_IMAGE_HEIGHT, 0);
+			type, buf.data());
 		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+		//a brick known to be zero is left alone if still zero
+		if (b->is_zero(CompType::Mask) &&
+			flrd::IsZero(buf.data(), buf.size()))
+			continue;
+		unsigned char* data = (unsigned char*)(b->tex_data(CompType::Mask));
+		if (data && CopyReturned(buf.data(), data,
+			res.intx(), res.inty(), res.intz(),
+			stride.intx(), stride.inty(), nb))
+			b->set_zero(CompType::Mask, true);
 	}
 
 	//release mask texture
@@ -1331,26 +1414,38 @@ void VolumeRenderer::return_label()
 
 	if (!tex->has_comp(CompType::Label))
 		return;
+	//labels kept in a file are read in full before textures are returned
+	if (!tex->load_label_src())
+		return;
 
+	std::vector<unsigned char> buf;
 	for (unsigned int i = 0; i < bricks->size(); i++)
 	{
 		TextureBrick* b = (*bricks)[i];
+		//without a texture the label in memory is current
+		if (!b || !has_tex(b, CompType::Label))
+			continue;
 		load_brick_label(b);
 		glActiveTexture(GL_TEXTURE0 + 3);
 
 		//download texture data
+		auto res = b->get_size();
 		auto stride = b->get_stride();
-		glPixelStorei(GL_PACK_ROW_LENGTH, stride.intx());
-		glPixelStorei(GL_PACK_IMAGE_HEIGHT, stride.inty());
+		size_t nb = sizeof(unsigned int);
+		buf.resize(res.get_size_xyz() * nb);
 		glPixelStorei(GL_PACK_ALIGNMENT, 4);
-
 		glGetTexImage(GL_TEXTURE_3D, 0, GL_RED_INTEGER,
-			b->tex_type(CompType::Label),
-			b->tex_data(CompType::Label));
+			b->tex_type(CompType::Label), buf.data());
 
-		glPixelStorei(GL_PACK_ROW_LENGTH, 0);
-		glPixelStorei(GL_PACK_IMAGE_HEIGHT, 0);
-		//glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		//a brick known to be zero is left alone if still zero
+		if (b->is_zero(CompType::Label) &&
+			flrd::IsZero(buf.data(), buf.size()))
+			continue;
+		unsigned char* data = (unsigned char*)(b->tex_data(CompType::Label));
+		if (data && CopyReturned(buf.data(), data,
+			res.intx(), res.inty(), res.intz(),
+			stride.intx(), stride.inty(), nb))
+			b->set_zero(CompType::Label, true);
 	}
 
 	//release label texture
@@ -19,20 +19,20 @@ coordinate generation (spheremap and planar projections) + more.
 #include <stdlib.h>
 #include <assert.h>
 #include <compatibility.h>
+#include <Parallel.h>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
 
 #define T(x) (model->triangles[(x)])
 #define L(x) (model->lines[(x)])
 
 char *sgets( char * str, int num, char **input );
 
-/* _GLMnode: general purpose node */
-typedef struct _GLMnode
-{
-	GLuint index;
-	GLboolean averaged;
-	struct _GLMnode* next;
-} GLMnode;
-
 GLboolean glmLoadTGA(TextureImage *texture, const char *filename,GLuint *textureID)      // Loads A TGA File Into Memory
 {
 	GLubyte    TGAheader[12]={0,0,2,0,0,0,0,0,0,0,0,0};  // Uncompressed TGA Header
@@ -199,58 +199,137 @@ static GLboolean glmEqual(GLfloat* u, GLfloat* v, GLfloat epsilon)
 	return GL_FALSE;
 }
 
-/* glmWeldVectors: eliminate (weld) vectors that are within an
-* epsilon of each other.
+/* glmWeldIndices: find the first earlier vector within an epsilon of
+* each vector.  Vectors are hashed into a grid of epsilon sized cells,
+* so only the 27 cells around a vector are searched.  The result is
+* the same as comparing against every kept vector in order.
 *
-* vectors     - array of GLfloat[3]'s to be welded
-* numvectors - number of GLfloat[3]'s in vectors
+* vectors     - array of GLfloat[3]'s to be welded, 1-based
+* numvectors - number of vectors, returns the number of kept vectors
 * epsilon     - maximum difference between vectors
+* index       - returns the kept index of each vector, 1-based
 *
+* returns the kept vectors, to be free()'d by the caller
 */
-GLfloat* glmWeldVectors(GLfloat* vectors, GLuint* numvectors, GLfloat epsilon)
+static GLfloat* glmWeldIndices(GLfloat* vectors, GLuint* numvectors,
+	GLfloat epsilon, GLuint* index)
 {
-	GLfloat* copies;
-	GLuint copied;
-	GLuint i, j;
+	GLuint n = *numvectors;
+	GLfloat* copies = (GLfloat*)malloc(sizeof(GLfloat) * 3 * (n + 1));
+	if (!copies)
+		return 0;
+	memcpy(copies, vectors, sizeof(GLfloat) * 3 * (n + 1));
+	if (epsilon <= 0.0f)
+	{
+		//nothing is within a non-positive epsilon
+		for (GLuint i = 1; i <= n; ++i)
+			index[i] = i;
+		return copies;
+	}
 
-	copies = (GLfloat*)malloc(sizeof(GLfloat) * 3 * (*numvectors + 1));
-	memcpy(copies, vectors, (sizeof(GLfloat) * 3 * (*numvectors + 1)));
+	//grid cells, computed in parallel
+	std::vector<long long> cells(size_t(n + 1) * 3, 0);
+	double inv = 1.0 / epsilon;
+	flrd::ParallelFor(n, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		for (size_t i = i0 + 1; i <= i1; ++i)
+		for (int c = 0; c < 3; ++c)
+		{
+			double v = std::floor(vectors[3 * i + c] * inv);
+			cells[3 * i + c] = std::isfinite(v) ? (long long)v : 0;
+		}
+	});
+
+	//open addressing table from cell to its list of kept vectors
+	size_t cap = 16;
+	while (cap < size_t(n) * 2)
+		cap <<= 1;
+	std::vector<GLuint> head(cap, 0);//kept index, 0 for empty slot
+	std::vector<GLuint> next(size_t(n) + 2, 0);//next kept index in the same cell
+	std::vector<GLuint> owner(n + 2, 0);//vector that created a kept index
+	auto hash = [](long long x, long long y, long long z)
+	{
+		unsigned long long h = (unsigned long long)x * 0x9E3779B97F4A7C15ull;
+		h ^= (unsigned long long)y * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+		h ^= (unsigned long long)z * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+		return size_t(h ^ (h >> 29));
+	};
+	//slot of a cell, the cell is identified by the owner of its first kept vector
+	auto find = [&](long long x, long long y, long long z) -> size_t
+	{
+		size_t s = hash(x, y, z) & (cap - 1);
+		while (head[s])
+		{
+			const long long* c = &cells[3 * size_t(owner[head[s]])];
+			if (c[0] == x && c[1] == y && c[2] == z)
+				return s;
+			s = (s + 1) & (cap - 1);
+		}
+		return s;
+	};
 
-	copied = 1;
-	for (i = 1; i <= *numvectors; i++)
+	GLuint copied = 0;
+	for (GLuint i = 1; i <= n; ++i)
 	{
-		bool con = false;
-		for (j = 1; j <= copied; j++)
+		const long long* c = &cells[3 * size_t(i)];
+		GLuint best = 0;
+		for (int dz = -1; dz <= 1; ++dz)
+		for (int dy = -1; dy <= 1; ++dy)
+		for (int dx = -1; dx <= 1; ++dx)
 		{
-			if (glmEqual(&vectors[3 * i], &copies[3 * j], epsilon))
+			size_t s = find(c[0] + dx, c[1] + dy, c[2] + dz);
+			for (GLuint j = head[s]; j; j = next[j])
 			{
-				/* set the first component of this vector to point at the correct
-				index into the new copies array */
-				vectors[3 * i + 0] = (GLfloat)j;
-				con = true;
-				break;
+				if ((!best || j < best) &&
+					glmEqual(&vectors[3 * i], &copies[3 * j], epsilon))
+					best = j;
 			}
 		}
-
-		if (con)
+		if (best)
+		{
+			index[i] = best;
 			continue;
-
-		/* must not be any duplicates -- add to the copies array */
+		}
+		//must not be any duplicates -- add to the copies array
 		copied++;
 		copies[3 * copied + 0] = vectors[3 * i + 0];
 		copies[3 * copied + 1] = vectors[3 * i + 1];
 		copies[3 * copied + 2] = vectors[3 * i + 2];
-		j = copied;             /* pass this along for below */
-
-		/* set the first component of this vector to point at the correct
-		index into the new copies array */
-		vectors[3 * i + 0] = (GLfloat)j;
+		owner[copied] = i;
+		size_t s = find(c[0], c[1], c[2]);
+		next[copied] = head[s];
+		head[s] = copied;
+		index[i] = copied;
 	}
 
 	*numvectors = copied;
 	return copies;
 }
 
+/* glmWeldVectors: eliminate (weld) vectors that are within an
+* epsilon of each other.
+*
+* vectors     - array of GLfloat[3]'s to be welded
+* numvectors - number of GLfloat[3]'s in vectors
+* epsilon     - maximum difference between vectors
+*
+*/
+GLfloat* glmWeldVectors(GLfloat* vectors, GLuint* numvectors, GLfloat epsilon)
+{
+	std::vector<GLuint> index(size_t(*numvectors) + 1, 0);
+	GLuint n = *numvectors;
+	GLfloat* copies = glmWeldIndices(vectors, numvectors, epsilon, index.data());
+	if (!copies)
+		return 0;
+
+	/* set the first component of each vector to point at the correct
+	index into the new copies array */
+	for (GLuint i = 1; i <= n; i++)
+		vectors[3 * i + 0] = (GLfloat)index[i];
+
+	return copies;
+}
+
 /* glmFindGroup: Find a group in the model */
 GLMgroup* glmFindGroup(GLMmodel* model, char* name)
 {
@@ -619,416 +698,505 @@ char *sgets( char * str, int num, char **input )
 	return str;
 }
 
-//read custom transformation from comments
-static void glmReadTransforms(GLMmodel* model, char* file) {
-	char line[256];
-	model->valid_trans_center = false;
-	while (sgets(line, sizeof(line), &file))
-	{
-		if (strncmp(line, "# Position:", 11) == 0) {
-			SSCANF(line + 11, "%f %f %f",
-				&model->position[0],
-				&model->position[1],
-				&model->position[2]);
-		}
-		else if (strncmp(line, "# Rotation:", 11) == 0) {
-			SSCANF(line + 11, "%f %f %f",
-				&model->rotation[0],
-				&model->rotation[1],
-				&model->rotation[2]);
-		}
-		else if (strncmp(line, "# Scale:", 8) == 0) {
-			SSCANF(line + 8, "%f %f %f",
-				&model->scale[0],
-				&model->scale[1],
-				&model->scale[2]);
-		}
-		else if (strncmp(line, "# Trans_center:", 15) == 0) {
-			auto val = SSCANF(line + 15, "%f %f %f",
-				&model->trans_center[0],
-				&model->trans_center[1],
-				&model->trans_center[2]);
-			if (val == 3)
-				model->valid_trans_center = true;
+/* file reading and obj parsing helpers */
+namespace
+{
+	/* read a whole file */
+	bool glmReadFile(const char* filename, std::vector<char>& content)
+	{
+		FILE* file;
+		std::string str = filename;
+		if (!FOPEN(&file, str, "rb"))
+			return false;
+		fseek(file, 0L, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0L, SEEK_SET);
+		if (size < 0)
+		{
+			fclose(file);
+			return false;
 		}
+		content.resize(size_t(size) + 1);
+		size_t read = size ? fread(content.data(), 1, size_t(size), file) : 0;
+		fclose(file);
+		content.resize(read + 1);
+		content[read] = 0;
+		return read == size_t(size);
 	}
-}
 
-/* glmFirstPass: first pass at a Wavefront OBJ file that gets all the
-* statistics of the model (such as #vertices, #normals, etc)
-*
-* model - properly initialized GLMmodel structure
-* file  - (fopen'd) file descriptor
-*/
-static GLboolean glmFirstPass(GLMmodel* model, char* file)
-{
-	GLuint numvertices;        /* number of vertices in model */
-	GLuint numnormals;         /* number of normals in model */
-	GLuint numtexcoords;       /* number of texcoords in model */
-	GLuint numcolors;          /* number of colors in model */
-	GLuint numlines;           /* number of lines in model */
-	GLuint numtriangles;       /* number of triangles in model */
-	GLMgroup* group;           /* current group */
-	char buf[128];
-	char line[2048];
-	bool no_fail = true;
+	/* empty model with a default group */
+	GLMmodel* glmNewModel(const char* filename)
+	{
+		GLMmodel* model = (GLMmodel*)calloc(1, sizeof(GLMmodel));
+		if (!model)
+			return 0;
+		model->pathname = STRDUP(filename);
+		model->scale[0] = model->scale[1] = model->scale[2] = 1.0f;
+		return model;
+	}
 
-	/* make a default group */
-	char  tmp[] = "default";
-	group = glmAddGroup(model, tmp);
+	inline bool glmIsBlank(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
 
-	numvertices = numnormals = numtexcoords = numcolors = numlines = numtriangles = 0;
+	inline const char* glmSkipBlank(const char* p, const char* e)
+	{
+		while (p < e && glmIsBlank(*p))
+			p++;
+		return p;
+	}
 
-	while (sgets(line, sizeof(line), &file))
+	inline const char* glmSkipToken(const char* p, const char* e)
 	{
-		if (!SSCANF(line, "%s", buf))
-			break;
+		while (p < e && !glmIsBlank(*p))
+			p++;
+		return p;
+	}
 
-		switch(buf[0])
+	/* parse a float, digits are accumulated in an integer and scaled once;
+	unusual forms (inf, nan, long mantissas) go through strtof */
+	const char* glmParseFloat(const char* p, const char* e, GLfloat* val)
+	{
+		p = glmSkipBlank(p, e);
+		const char* s = p;
+		bool neg = false;
+		if (p < e && (*p == '-' || *p == '+'))
+			neg = *p++ == '-';
+		unsigned long long m = 0;
+		int digits = 0, scale = 0;
+		bool any = false;
+		for (; p < e && *p >= '0' && *p <= '9'; ++p, any = true)
 		{
-		case '#':               /* comment */
-			break;
-		case 'v':               /* v, vn, vt */
-			switch(buf[1])
-			{
-			case '\0':          /* vertex */
-				numvertices++;
-				break;
-			case 'n':           /* normal */
-				numnormals++;
-				break;
-			case 't':           /* texcoord */
-				numtexcoords++;
-				break;
-			case 'c':           /* color */
-				numcolors++;
-				break;
-			default:
-				break;
-			}
-			break;
-		case 'm':
+			if (digits < 18)
 			{
-				char mtlname[128];
-				SSCANF(line, "%s %s", mtlname, mtlname);
-				model->mtllibname = STRDUP(mtlname);
-				no_fail &= glmReadMTL(model, mtlname);
+				m = m * 10 + (*p - '0');
+				if (m) digits++;
 			}
-			break;
-		case 'u':
-			break;
-		case 'g':               /* group */
-			SSCANF(line, "%s %s", buf, buf);
-			group = glmAddGroup(model, buf);
-			break;
-		case 'l':               /* line */
-			numlines++;
-			break;
-		case 'f':               /* face */
+			else
+				scale++;
+		}
+		if (p < e && *p == '.')
+		{
+			for (++p; p < e && *p >= '0' && *p <= '9'; ++p, any = true)
 			{
-				int count = 0;
-				bool prev_is_blank = true;
-				for (int i=0; i<(int)strlen(line); i++)
-				{
-					if (line[i] == ' ' || line[i] == '\n')
-						prev_is_blank = true;
-					else
-					{
-						if (prev_is_blank)
-							count++;
-						prev_is_blank = false;
-					}
-				}
-				if (count > 3)
+				if (digits < 18)
 				{
-					numtriangles += count-3;
-					group->numtriangles += count-3;
+					m = m * 10 + (*p - '0');
+					if (m) digits++;
+					scale--;
 				}
 			}
-			break;
-		default:
-			break;
 		}
+		if (any && p < e && (*p == 'e' || *p == 'E'))
+		{
+			const char* q = p + 1;
+			bool eneg = false;
+			if (q < e && (*q == '-' || *q == '+'))
+				eneg = *q++ == '-';
+			if (q < e && *q >= '0' && *q <= '9')
+			{
+				int ex = 0;
+				for (; q < e && *q >= '0' && *q <= '9'; ++q)
+					if (ex < 10000) ex = ex * 10 + (*q - '0');
+				scale += eneg ? -ex : ex;
+				p = q;
+			}
+		}
+		if (any && (p == e || glmIsBlank(*p) || *p == '/') &&
+			scale > -300 && scale < 300)
+		{
+			static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+				1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+				1e19, 1e20, 1e21, 1e22 };
+			double d = double(m);
+			if (scale < 0)
+				d = -scale <= 22 ? d / pow10[-scale] : d * pow(10.0, scale);
+			else if (scale > 0)
+				d = scale <= 22 ? d * pow10[scale] : d * pow(10.0, scale);
+			*val = GLfloat(neg ? -d : d);
+			return p;
+		}
+		/* fall back to the c library */
+		char buf[128];
+		const char* t = glmSkipToken(s, e);
+		size_t len = std::min(size_t(t - s), sizeof(buf) - 1);
+		memcpy(buf, s, len);
+		buf[len] = 0;
+		char* end = buf;
+		*val = len ? strtof(buf, &end) : 0.0f;
+		return s + (end - buf);
+	}
+
+	/* parse an integer, returns false if there is none */
+	inline bool glmParseInt(const char*& p, const char* e, int* val)
+	{
+		bool neg = false;
+		const char* s = p;
+		if (p < e && (*p == '-' || *p == '+'))
+			neg = *p++ == '-';
+		if (p == e || *p < '0' || *p > '9')
+		{
+			p = s;
+			return false;
+		}
+		long long v = 0;
+		for (; p < e && *p >= '0' && *p <= '9'; ++p)
+			v = v * 10 + (*p - '0');
+		*val = int(neg ? -v : v);
+		return true;
 	}
 
-	/* set the stats in the model structure */
-	model->numvertices  = numvertices;
-	model->numnormals   = numnormals;
-	model->numtexcoords = numtexcoords;
-	model->numcolors = numcolors;
-	model->numlines = numlines;
-	model->numtriangles = numtriangles;
-
-	/* allocate memory for the triangles in each group */
-	group = model->groups;
-	while(group)
+	/* a range of the obj file parsed by one thread */
+	struct ObjChunk
 	{
-		if (group->numtriangles)
-			group->triangles = (GLuint*)malloc(sizeof(GLuint) * group->numtriangles);
-		group->numtriangles = 0;
-		group = group->next;
+		const char* begin = 0;
+		const char* end = 0;
+		GLuint numvertices = 0;
+		GLuint numnormals = 0;
+		GLuint numtexcoords = 0;
+		GLuint numcolors = 0;
+		GLuint numtriangles = 0;
+		GLuint numlines = 0;
+		/* lines handled in order on one thread: groups, materials, transforms */
+		std::vector<const char*> events;
+		/* triangles before the first event and after each event */
+		std::vector<GLuint> seg_tris;
+		/* group and first group slot of each segment */
+		std::vector<GLMgroup*> seg_group;
+		std::vector<GLuint> seg_start;
+		/* first indices of this chunk */
+		GLuint v0 = 0, n0 = 0, t0 = 0, c0 = 0, tri0 = 0, l0 = 0;
+	};
+
+	/* call func(line begin, keyword begin, keyword end, line end) for each line */
+	template <typename F>
+	void glmForLines(const char* b, const char* e, F&& func)
+	{
+		while (b < e)
+		{
+			const char* le = (const char*)memchr(b, '\n', e - b);
+			if (!le)
+				le = e;
+			const char* k = b;
+			while (k < le && (*k == ' ' || *k == '\t'))
+				k++;
+			const char* ke = glmSkipToken(k, le);
+			if (ke > k)
+				func(b, k, ke, le);
+			b = le + 1;
+		}
 	}
-	return no_fail;
-}
-
-/* glmSecondPass: second pass at a Wavefront OBJ file that gets all
-* the data.
-*
-* model - properly initialized GLMmodel structure
-* file  - (fopen'd) file descriptor
-*/
-static GLvoid glmSecondPass(GLMmodel* model, char* file)
-{
-	GLuint numvertices;        /* number of vertices in model */
-	GLuint numnormals;         /* number of normals in model */
-	GLuint numtexcoords;       /* number of texcoords in model */
-	GLuint numcolors;          /* number of colors in model */
-	GLuint numlines;           /* number of lines in model */
-	GLuint numtriangles;       /* number of triangles in model */
-	GLfloat* vertices;         /* array of vertices  */
-	GLfloat* normals;          /* array of normals */
-	GLfloat* texcoords;        /* array of texture coordinates */
-	GLfloat* colors;           /* array of colors */
-	GLMgroup* group;           /* current group pointer */
-	GLuint material;           /* current material */
-	int v, n, t, c;
-	char buf[128];
-	char line[2048];
 
-	/* set the pointer shortcuts */
-	vertices       = model->vertices;
-	normals    = model->normals;
-	texcoords    = model->texcoords;
-	colors = model->colors;
-	group      = model->groups;
-
-	/* on the second pass through the file, read all the data into the
-	allocated arrays */
-	numvertices = numnormals = numtexcoords = numcolors = 1;
-	numtriangles = 0;
-	numlines = 0;
-	material = 0;
+	/* the second token of a line, or the first if there is none */
+	std::string glmLineName(const char* k, const char* ke, const char* le)
+	{
+		const char* n = glmSkipBlank(ke, le);
+		const char* ne = glmSkipToken(n, le);
+		if (ne > n)
+			return std::string(n, ne);
+		return std::string(k, ke);
+	}
 
-	while (sgets(line, sizeof(line), &file))
+	bool glmIsTransform(const char* k, const char* le)
 	{
-		if (!SSCANF(line, "%s", buf ))
-			break;
+		size_t len = le - k;
+		return (len >= 11 && !strncmp(k, "# Position:", 11)) ||
+			(len >= 11 && !strncmp(k, "# Rotation:", 11)) ||
+			(len >= 8 && !strncmp(k, "# Scale:", 8)) ||
+			(len >= 15 && !strncmp(k, "# Trans_center:", 15));
+	}
 
-		switch(buf[0])
+	/* count the elements of a chunk */
+	void glmObjCount(ObjChunk& c)
+	{
+		c.seg_tris.assign(1, 0);
+		glmForLines(c.begin, c.end, [&](const char* b, const char* k,
+			const char* ke, const char* le)
 		{
-		case '#':               /* comment */
-			break;
-		case 'v':               /* v, vn, vt */
-			switch(buf[1])
+			switch (k[0])
 			{
-			case '\0':          /* vertex */
-				SSCANF(line+2, "%f %f %f",
-					&vertices[3 * numvertices + 0],
-					&vertices[3 * numvertices + 1],
-					&vertices[3 * numvertices + 2]);
-				numvertices++;
+			case '#':
+				if (glmIsTransform(k, le))
+				{
+					c.events.push_back(b);
+					c.seg_tris.push_back(0);
+				}
 				break;
-			case 'n':           /* normal */
-				SSCANF(line+3, "%f %f %f",
-					&normals[3 * numnormals + 0],
-					&normals[3 * numnormals + 1],
-					&normals[3 * numnormals + 2]);
-				numnormals++;
+			case 'v':
+				if (ke - k == 1)
+					c.numvertices++;
+				else if (k[1] == 'n')
+					c.numnormals++;
+				else if (k[1] == 't')
+					c.numtexcoords++;
+				else if (k[1] == 'c')
+					c.numcolors++;
 				break;
-			case 't':           /* texcoord */
-				SSCANF(line+3, "%f %f",
-					&texcoords[2 * numtexcoords + 0],
-					&texcoords[2 * numtexcoords + 1]);
-				numtexcoords++;
+			case 'm':
+			case 'u':
+			case 'g':
+				c.events.push_back(b);
+				c.seg_tris.push_back(0);
 				break;
-			case 'c':           /* color */
-				SSCANF(line + 3, "%f %f %f %f",
-					&colors[4 * numcolors + 0],
-					&colors[4 * numcolors + 1],
-					&colors[4 * numcolors + 2],
-					&colors[4 * numcolors + 3]);
-				numcolors++;
+			case 'l':
+				c.numlines++;
 				break;
+			case 'f':
+			{
+				GLuint count = 0;
+				const char* p = glmSkipBlank(ke, le);
+				while (p < le)
+				{
+					count++;
+					p = glmSkipBlank(glmSkipToken(p, le), le);
+				}
+				if (count > 2)
+				{
+					c.numtriangles += count - 2;
+					c.seg_tris.back() += count - 2;
+				}
 			}
 			break;
-		case 'u':
+			default:
+				break;
+			}
+		});
+	}
+
+	/* fill the arrays of a chunk */
+	void glmObjParse(GLMmodel* model, ObjChunk& c)
+	{
+		GLuint numvertices = c.v0 + 1;
+		GLuint numnormals = c.n0 + 1;
+		GLuint numtexcoords = c.t0 + 1;
+		GLuint numcolors = c.c0 + 1;
+		GLuint numtriangles = c.tri0;
+		GLuint numlines = c.l0;
+		size_t seg = 0;
+		GLMgroup* group = c.seg_group[0];
+		GLuint slot = c.seg_start[0];
+
+		auto resolve = [](int i, GLuint num)
+		{
+			return GLuint(i < 0 ? i + int(num) : i);
+		};
+
+		glmForLines(c.begin, c.end, [&](const char* b, const char* k,
+			const char* ke, const char* le)
+		{
+			if (seg < c.events.size() && b == c.events[seg])
 			{
-				char mtlname[128];
-				SSCANF(line, "%s %s", buf,
-					mtlname);
-				group->material = material = glmFindMaterial(model, mtlname);
+				seg++;
+				group = c.seg_group[seg];
+				slot = c.seg_start[seg];
+				return;
+			}
+			switch (k[0])
+			{
+			case 'v':
+				if (ke - k == 1)
+				{
+					GLfloat* v = &model->vertices[3 * numvertices++];
+					const char* p = ke;
+					for (int i = 0; i < 3; ++i)
+						p = glmParseFloat(p, le, &v[i]);
+				}
+				else if (k[1] == 'n')
+				{
+					GLfloat* v = &model->normals[3 * numnormals++];
+					const char* p = ke;
+					for (int i = 0; i < 3; ++i)
+						p = glmParseFloat(p, le, &v[i]);
+				}
+				else if (k[1] == 't')
+				{
+					GLfloat* v = &model->texcoords[2 * numtexcoords++];
+					const char* p = ke;
+					for (int i = 0; i < 2; ++i)
+						p = glmParseFloat(p, le, &v[i]);
+				}
+				else if (k[1] == 'c')
+				{
+					GLfloat* v = &model->colors[4 * numcolors++];
+					const char* p = ke;
+					for (int i = 0; i < 4; ++i)
+						p = glmParseFloat(p, le, &v[i]);
+				}
+				break;
+			case 'l':
+			{
+				std::vector<GLuint> ind;
+				const char* p = glmSkipBlank(ke, le);
+				while (p < le)
+				{
+					const char* q = p;
+					int v = 0;
+					if (glmParseInt(q, le, &v))
+						ind.push_back(resolve(v, numvertices));
+					p = glmSkipBlank(glmSkipToken(p, le), le);
+				}
+				GLMline& line = L(numlines++);
+				line.numvertices = GLuint(ind.size());
+				line.vindices = (GLuint*)malloc(sizeof(GLuint) * (ind.size() ? ind.size() : 1));
+				if (!ind.empty())
+					memcpy(line.vindices, ind.data(), sizeof(GLuint) * ind.size());
 			}
 			break;
-		case 'g':               /* group */
-			SSCANF(line, "%s %s", buf,
-				buf);
-			group = glmFindGroup(model, buf);
-			group->material = material;
-			break;
-		case 'l':               /* line */
+			case 'f':
 			{
-				int count = 0;
-				bool prev_is_blank = true;
-				for (int i=0; i<(int)strlen(line); i++)
+				/* v, v/t, v/t/n, v//n, v//n/c, v/t/n/c */
+				GLuint first[4] = { 0, 0, 0, 0 };
+				GLuint prev[4] = { 0, 0, 0, 0 };
+				GLuint count = 0;
+				const char* p = glmSkipBlank(ke, le);
+				while (p < le)
 				{
-					if (line[i] == ' ' || line[i] == '\n' || line[i] == '\r')
-						prev_is_blank = true;
-					else
+					const char* te = glmSkipToken(p, le);
+					int f[4] = { 0, 0, 0, 0 };
+					const char* q = p;
+					for (int i = 0; i < 4 && q < te; ++i)
 					{
-						if (prev_is_blank)
-							count++;
-						prev_is_blank = false;
+						glmParseInt(q, te, &f[i]);
+						if (q < te && *q == '/')
+							q++;
+						else
+							break;
 					}
-				}
-				//alocate
-				L(numlines).numvertices = count - 1;
-				L(numlines).vindices = (GLuint*)malloc(sizeof(GLuint) *
-					L(numlines).numvertices);
-				//read again
-				count = 0;
-				int buf_count = 0;
-				prev_is_blank = true;
-				for (int i=0; i<(int)strlen(line); i++)
-				{
-					if (line[i] == ' ' || line[i] == '\n' || line[i] == '\r')
+					GLuint cur[4] = {
+						resolve(f[0], numvertices),
+						resolve(f[1], numtexcoords),
+						resolve(f[2], numnormals),
+						resolve(f[3], numcolors) };
+					count++;
+					if (count == 1)
+						memcpy(first, cur, sizeof(first));
+					else if (count > 2)
 					{
-						prev_is_blank = true;
-						buf[buf_count] = 0;
-						buf_count = 0;
-
-						//add buf
-						if (count > 1)
+						/* fan triangulation */
+						GLMtriangle& t = T(numtriangles);
+						GLuint* vs[3] = { first, prev, cur };
+						for (int i = 0; i < 3; ++i)
 						{
-							if (SSCANF(buf, "%d", &v) == 1)
-								L(numlines).vindices[count-2] = v < 0 ? v + numvertices : v;
+							t.vindices[i] = vs[i][0];
+							t.tindices[i] = vs[i][1];
+							t.nindices[i] = vs[i][2];
+							t.cindices[i] = vs[i][3];
 						}
+						group->triangles[slot++] = numtriangles;
+						numtriangles++;
 					}
-					else
-					{
-						if (prev_is_blank)
-							count++;
-						prev_is_blank = false;
-						buf[buf_count] = line[i];
-						buf_count++;
-					}
+					memcpy(prev, cur, sizeof(prev));
+					p = glmSkipBlank(te, le);
 				}
 			}
-			numlines++;
 			break;
-		case 'f': /* face */
+			default:
+				break;
+			}
+		});
+	}
+}
+
+/* glmReadEvents: handle the lines that change the state of the model,
+* in file order, and set up the group of each segment of triangles
+*
+* model  - model with the default group
+* chunks - counted chunks of the file
+*/
+static bool glmReadEvents(GLMmodel* model, std::vector<ObjChunk>& chunks)
+{
+	bool no_fail = true;
+	/* materials and transforms first, so usemtl can find the materials */
+	for (auto& c : chunks)
+	for (auto b : c.events)
+	{
+		const char* le = (const char*)memchr(b, '\n', c.end - b);
+		if (!le)
+			le = c.end;
+		std::string line(b, le);
+		const char* k = line.c_str();
+		while (*k == ' ' || *k == '\t')
+			k++;
+		const char* ke = glmSkipToken(k, line.c_str() + line.size());
+		if (k[0] == 'm')
 		{
-			v = n = t = c = 0;
+			std::string name = glmLineName(k, ke, line.c_str() + line.size());
+			if (model->mtllibname)
+				free(model->mtllibname);
+			model->mtllibname = STRDUP(name.c_str());
+			no_fail &= glmReadMTL(model, (char*)name.c_str());
+		}
+		else if (k[0] == '#')
+		{
+			if (strncmp(k, "# Position:", 11) == 0) {
+				SSCANF(k + 11, "%f %f %f",
+					&model->position[0],
+					&model->position[1],
+					&model->position[2]);
+			}
+			else if (strncmp(k, "# Rotation:", 11) == 0) {
+				SSCANF(k + 11, "%f %f %f",
+					&model->rotation[0],
+					&model->rotation[1],
+					&model->rotation[2]);
+			}
+			else if (strncmp(k, "# Scale:", 8) == 0) {
+				SSCANF(k + 8, "%f %f %f",
+					&model->scale[0],
+					&model->scale[1],
+					&model->scale[2]);
+			}
+			else if (strncmp(k, "# Trans_center:", 15) == 0) {
+				auto val = SSCANF(k + 15, "%f %f %f",
+					&model->trans_center[0],
+					&model->trans_center[1],
+					&model->trans_center[2]);
+				if (val == 3)
+					model->valid_trans_center = true;
+			}
+		}
+	}
 
-			int count = 0;
-			int buf_count = 0;
-			bool prev_is_blank = true;
-			for (int i = 0; i < (int)strlen(line); i++)
+	/* groups and materials */
+	GLMgroup* group = model->groups;
+	GLuint material = 0;
+	for (auto& c : chunks)
+	{
+		c.seg_group.resize(c.seg_tris.size());
+		c.seg_start.resize(c.seg_tris.size());
+		for (size_t s = 0; s < c.seg_tris.size(); ++s)
+		{
+			if (s)
 			{
-				if (line[i] == ' ' || line[i] == '\n')
+				const char* b = c.events[s - 1];
+				const char* le = (const char*)memchr(b, '\n', c.end - b);
+				if (!le)
+					le = c.end;
+				const char* k = b;
+				while (k < le && (*k == ' ' || *k == '\t'))
+					k++;
+				const char* ke = glmSkipToken(k, le);
+				std::string name = glmLineName(k, ke, le);
+				if (k[0] == 'u')
 				{
-					prev_is_blank = true;
-					buf[buf_count] = 0;
-					buf_count = 0;
-
-					if (count > 1 && count < 5)
-					{
-						if (strstr(buf, "//"))
-						{
-							if (SSCANF(buf, "%d//%d/%d", &v, &n, &c) == 3)
-							{
-								T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-								T(numtriangles).nindices[count - 2] = n < 0 ? n + numnormals : n;
-								T(numtriangles).cindices[count - 2] = c < 0 ? c + numcolors : c;
-							}
-							else
-							{
-								SSCANF(buf, "%d//%d", &v, &n);
-								T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-								T(numtriangles).nindices[count - 2] = n < 0 ? n + numnormals : n;
-							}
-						}
-						else if (SSCANF(buf, "%d/%d/%d/%d", &v, &t, &n, &c) == 4)
-						{
-							T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-							T(numtriangles).tindices[count - 2] = t < 0 ? t + numtexcoords : t;
-							T(numtriangles).nindices[count - 2] = n < 0 ? n + numnormals : n;
-							T(numtriangles).cindices[count - 2] = c < 0 ? c + numcolors : c;
-						}
-						else if (SSCANF(buf, "%d/%d/%d", &v, &t, &n) == 3)
-						{
-							T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-							T(numtriangles).tindices[count - 2] = t < 0 ? t + numtexcoords : t;
-							T(numtriangles).nindices[count - 2] = n < 0 ? n + numnormals : n;
-						}
-						else if (SSCANF(buf, "%d/%d/%d", &v, &t, &c) == 3)
-						{
-							T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-							T(numtriangles).tindices[count - 2] = t < 0 ? t + numtexcoords : t;
-							T(numtriangles).cindices[count - 2] = c < 0 ? c + numcolors : c;
-						}
-						else if (SSCANF(buf, "%d/%d", &v, &t) == 2)
-						{
-							T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-							T(numtriangles).tindices[count - 2] = t < 0 ? t + numtexcoords : t;
-						}
-						else if (SSCANF(buf, "%d/%d", &v, &c) == 2)
-						{
-							T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-							T(numtriangles).cindices[count - 2] = c < 0 ? c + numcolors : c;
-						}
-						else
-						{
-							SSCANF(buf, "%d", &v);
-							T(numtriangles).vindices[count - 2] = v < 0 ? v + numvertices : v;
-						}
-
-						if (count == 4)
-						{
-							group->triangles[group->numtriangles++] = numtriangles;
-							numtriangles++;
-						}
-					}
-					else if (count > 4)
-					{
-						// Fan triangulation logic (same as before), extended to handle cindices
-						SSCANF(buf, "%d/%d/%d/%d", &v, &t, &n, &c);
-						T(numtriangles).vindices[0] = T(numtriangles - 1).vindices[0];
-						T(numtriangles).tindices[0] = T(numtriangles - 1).tindices[0];
-						T(numtriangles).nindices[0] = T(numtriangles - 1).nindices[0];
-						T(numtriangles).cindices[0] = T(numtriangles - 1).cindices[0];
-
-						T(numtriangles).vindices[1] = T(numtriangles - 1).vindices[2];
-						T(numtriangles).tindices[1] = T(numtriangles - 1).tindices[2];
-						T(numtriangles).nindices[1] = T(numtriangles - 1).nindices[2];
-						T(numtriangles).cindices[1] = T(numtriangles - 1).cindices[2];
-
-						T(numtriangles).vindices[2] = v < 0 ? v + numvertices : v;
-						T(numtriangles).tindices[2] = t < 0 ? t + numtexcoords : t;
-						T(numtriangles).nindices[2] = n < 0 ? n + numnormals : n;
-						T(numtriangles).cindices[2] = c < 0 ? c + numcolors : c;
-
-						group->triangles[group->numtriangles++] = numtriangles;
-						numtriangles++;
-					}
+					group->material = material =
+						glmFindMaterial(model, (char*)name.c_str());
 				}
-				else
+				else if (k[0] == 'g')
 				{
-					if (prev_is_blank)
-						count++;
-					prev_is_blank = false;
-					buf[buf_count] = line[i];
-					buf_count++;
+					group = glmAddGroup(model, (char*)name.c_str());
+					group->material = material;
 				}
 			}
-		}
-		break;
-		default:
-			break;
+			c.seg_group[s] = group;
+			c.seg_start[s] = group->numtriangles;
+			group->numtriangles += c.seg_tris[s];
 		}
 	}
+	return no_fail;
 }
 
-
 /* public functions */
 /* glmUnitize: "unitize" a model by translating it to the origin and
 * scaling it to fit in a unit cube around the origin.   Returns the
@@ -1517,14 +1685,8 @@ GLvoid glmFacetNormals(GLMmodel* model)
 */
 GLvoid glmVertexNormals(GLMmodel* model, GLfloat angle)
 {
-	GLMnode* node;
-	GLMnode* tail;
-	GLMnode** members;
-	GLfloat* normals;
-	GLuint numnormals;
-	GLfloat average[3];
-	GLfloat dot, cos_angle;
-	GLuint i, avg;
+	GLfloat cos_angle;
+	GLuint i;
 
 	assert(model);
 	assert(model->facetnorms);
@@ -1535,132 +1697,113 @@ GLvoid glmVertexNormals(GLMmodel* model, GLfloat angle)
 	/* nuke any previous normals */
 	if (model->normals)
 		free(model->normals);
+	model->normals = 0;
+	model->numnormals = 0;
 
-	/* allocate space for new normals */
-	model->numnormals = model->numtriangles * 3; /* 3 normals per triangle */
-	model->normals = (GLfloat*)malloc(sizeof(GLfloat)* 3* (model->numnormals+1));
-
-	/* allocate a structure that will hold a linked list of triangle
-	indices for each vertex */
-	members = (GLMnode**)malloc(sizeof(GLMnode*) * (model->numvertices + 1));
-	for (i = 1; i <= model->numvertices; i++)
-		members[i] = NULL;
-
-	/* for every triangle, create a node for each vertex in it */
-	for (i = 0; i < model->numtriangles; i++) {
-		node = (GLMnode*)malloc(sizeof(GLMnode));
-		node->index = i;
-		node->next  = members[T(i).vindices[0]];
-		members[T(i).vindices[0]] = node;
-
-		node = (GLMnode*)malloc(sizeof(GLMnode));
-		node->index = i;
-		node->next  = members[T(i).vindices[1]];
-		members[T(i).vindices[1]] = node;
-
-		node = (GLMnode*)malloc(sizeof(GLMnode));
-		node->index = i;
-		node->next  = members[T(i).vindices[2]];
-		members[T(i).vindices[2]] = node;
+	/* compressed lists of the triangle corners each vertex is in,
+	the latest triangle first */
+	GLuint numvertices = model->numvertices;
+	GLuint numtriangles = model->numtriangles;
+	std::vector<GLuint> offset(size_t(numvertices) + 2, 0);
+	for (i = 0; i < numtriangles; i++)
+	{
+		offset[T(i).vindices[0] + 1]++;
+		offset[T(i).vindices[1] + 1]++;
+		offset[T(i).vindices[2] + 1]++;
+	}
+	for (i = 1; i <= numvertices + 1; i++)
+		offset[i] += offset[i - 1];
+	std::vector<GLuint> corners(offset[numvertices + 1]);
+	std::vector<GLuint> pos(offset.begin(), offset.end() - 1);
+	for (i = numtriangles; i-- > 0;)
+	{
+		for (int k = 2; k >= 0; k--)
+			corners[pos[T(i).vindices[k]]++] = i * 3 + k;
 	}
 
-	/* calculate the average normal for each vertex */
-	numnormals = 1;
-	for (i = 1; i <= model->numvertices; i++) {
-		/* calculate an average normal for this vertex by averaging the
-		facet normal of every triangle this vertex is in */
-		node = members[i];
-		if (!node)
-			fprintf(stderr, "glmVertexNormals(): vertex w/o a triangle\n");
-		average[0] = 0.0; average[1] = 0.0; average[2] = 0.0;
-		avg = 0;
-		while (node) {
-			/* only average if the dot product of the angle between the two
-			facet normals is greater than the cosine of the threshold
-			angle -- or, said another way, the angle between the two
-			facet normals is less than (or equal to) the threshold angle */
-			dot = glmDot(&model->facetnorms[3 * T(node->index).findex],
-				&model->facetnorms[3 * T(members[i]->index).findex]);
-			if (dot > cos_angle) {
-				node->averaged = GL_TRUE;
-				average[0] += model->facetnorms[3 * T(node->index).findex + 0];
-				average[1] += model->facetnorms[3 * T(node->index).findex + 1];
-				average[2] += model->facetnorms[3 * T(node->index).findex + 2];
-				avg = 1;            /* we averaged at least one normal! */
-			} else {
-				node->averaged = GL_FALSE;
+	/* a facet normal is averaged if it is within the angle of the facet
+	normal of the first triangle in the list of the vertex */
+	auto averaged = [&](GLuint v, GLuint c)
+	{
+		GLuint first = corners[offset[v]] / 3;
+		return glmDot(&model->facetnorms[3 * T(c / 3).findex],
+			&model->facetnorms[3 * T(first).findex]) > cos_angle;
+	};
+
+	/* count the normals of each vertex: one average and one
+	for each facet normal that is not averaged */
+	std::vector<GLuint> first_normal(size_t(numvertices) + 2, 0);
+	flrd::ParallelFor(numvertices, [&](size_t v0, size_t v1, unsigned int t)
+	{
+		for (size_t v = v0 + 1; v <= v1; ++v)
+		{
+			GLuint count = 0;
+			bool avg = false;
+			for (GLuint j = offset[v]; j < offset[v + 1]; ++j)
+			{
+				if (averaged(GLuint(v), corners[j]))
+					avg = true;
+				else
+					count++;
 			}
-			node = node->next;
+			first_normal[v + 1] = count + (avg ? 1 : 0);
 		}
-
-		if (avg) {
-			/* normalize the averaged normal */
-			glmNormalize(average);
-
-			/* add the normal to the vertex normals list */
-			model->normals[3 * numnormals + 0] = average[0];
-			model->normals[3 * numnormals + 1] = average[1];
-			model->normals[3 * numnormals + 2] = average[2];
-			avg = numnormals;
-			numnormals++;
-		}
-
-		/* set the normal of this vertex in each triangle it is in */
-		node = members[i];
-		while (node) {
-			if (node->averaged) {
-				/* if this node was averaged, use the average normal */
-				if (T(node->index).vindices[0] == i)
-					T(node->index).nindices[0] = avg;
-				else if (T(node->index).vindices[1] == i)
-					T(node->index).nindices[1] = avg;
-				else if (T(node->index).vindices[2] == i)
-					T(node->index).nindices[2] = avg;
-			} else {
-				/* if this node wasn't averaged, use the facet normal */
-				model->normals[3 * numnormals + 0] =
-					model->facetnorms[3 * T(node->index).findex + 0];
-				model->normals[3 * numnormals + 1] =
-					model->facetnorms[3 * T(node->index).findex + 1];
-				model->normals[3 * numnormals + 2] =
-					model->facetnorms[3 * T(node->index).findex + 2];
-				if (T(node->index).vindices[0] == i)
-					T(node->index).nindices[0] = numnormals;
-				else if (T(node->index).vindices[1] == i)
-					T(node->index).nindices[1] = numnormals;
-				else if (T(node->index).vindices[2] == i)
-					T(node->index).nindices[2] = numnormals;
-				numnormals++;
+	});
+	first_normal[1] = 1;
+	for (i = 1; i <= numvertices; i++)
+		first_normal[i + 1] += first_normal[i];
+	model->numnormals = first_normal[numvertices + 1] - 1;
+	model->normals = (GLfloat*)malloc(sizeof(GLfloat) * 3 * (model->numnormals + 1));
+
+	/* calculate the average normal for each vertex and set the normal
+	of this vertex in each triangle it is in */
+	flrd::ParallelFor(numvertices, [&](size_t v0, size_t v1, unsigned int t)
+	{
+		for (size_t v = v0 + 1; v <= v1; ++v)
+		{
+			GLfloat average[3] = { 0.0f, 0.0f, 0.0f };
+			GLuint avg = 0;
+			for (GLuint j = offset[v]; j < offset[v + 1]; ++j)
+			{
+				GLuint c = corners[j];
+				if (!averaged(GLuint(v), c))
+					continue;
+				GLfloat* fn = &model->facetnorms[3 * T(c / 3).findex];
+				average[0] += fn[0];
+				average[1] += fn[1];
+				average[2] += fn[2];
+				avg = 1;
+			}
+			GLuint numnormals = first_normal[v];
+			if (avg)
+			{
+				/* normalize the averaged normal */
+				glmNormalize(average);
+				model->normals[3 * numnormals + 0] = average[0];
+				model->normals[3 * numnormals + 1] = average[1];
+				model->normals[3 * numnormals + 2] = average[2];
+				avg = numnormals;
+				numnormals++;
+			}
+			for (GLuint j = offset[v]; j < offset[v + 1]; ++j)
+			{
+				GLuint c = corners[j];
+				if (averaged(GLuint(v), c))
+				{
+					/* if this corner was averaged, use the average normal */
+					T(c / 3).nindices[c % 3] = avg;
+					continue;
+				}
+				/* if this corner wasn't averaged, use the facet normal */
+				GLfloat* fn = &model->facetnorms[3 * T(c / 3).findex];
+				model->normals[3 * numnormals + 0] = fn[0];
+				model->normals[3 * numnormals + 1] = fn[1];
+				model->normals[3 * numnormals + 2] = fn[2];
+				T(c / 3).nindices[c % 3] = numnormals;
+				numnormals++;
 			}
-			node = node->next;
-		}
-	}
-
-	model->numnormals = numnormals - 1;
-
-	/* free the member information */
-	for (i = 1; i <= model->numvertices; i++) {
-		node = members[i];
-		while (node) {
-			tail = node;
-			node = node->next;
-			free(tail);
 		}
-	}
-	free(members);
-
-	/* pack the normals array (we previously allocated the maximum
-	number of normals that could possibly be created (numtriangles *
-	3), so get rid of some of them (usually alot unless none of the
-	facet normals were averaged)) */
-	normals = model->normals;
-	model->normals = (GLfloat*)malloc(sizeof(GLfloat)* 3* (model->numnormals+1));
-	for (i = 1; i <= model->numnormals; i++) {
-		model->normals[3 * i + 0] = normals[3 * i + 0];
-		model->normals[3 * i + 1] = normals[3 * i + 1];
-		model->normals[3 * i + 2] = normals[3 * i + 2];
-	}
-	free(normals);
+	});
 }
 
 
@@ -1928,99 +2071,106 @@ void glmClearGeometry(GLMmodel* model)
 /* glmReadOBJ: Reads a model description from a Wavefront .OBJ file.
 * Returns a pointer to the created object which should be free'd with
 * glmDelete().
+* The file is split at line breaks into chunks that are counted and
+* parsed on multiple threads; group, material and transform lines are
+* applied in file order between the two passes.
 *
 * filename - name of the file containing the Wavefront .OBJ format data.
 */
 GLMmodel* glmReadOBJ(const char* filename, bool *no_fail)
 {
 	GLMmodel* model;
-	FILE* file;
 
-	/* open the file */
-	std::string str = filename;
-	if (!FOPEN(&file, str, "rb"))
+	/* read the file to memory */
+	std::vector<char> content;
+	if (!glmReadFile(filename, content))
 		return 0;
-
-	//find file size
-	fseek(file, 0L, SEEK_END);
-	long size = ftell(file);
-	fseek(file, 0L, SEEK_SET);
-
-	//read file to a string
-	char* obj_content = (char*)malloc(size+1);
-	if (!fread(obj_content, sizeof(char), size, file))
-		return 0;
-	obj_content[size] = 0;
-	/* close the file */
-	fclose(file);
+	const char* obj_content = content.data();
+	size_t size = content.size() - 1;
 
 	/* allocate a new model */
-	model = (GLMmodel*)malloc(sizeof(GLMmodel));
-	model->pathname    = STRDUP(filename);
-	model->mtllibname    = NULL;
-	model->numvertices   = 0;
-	model->vertices    = NULL;
-	model->numnormals    = 0;
-	model->normals     = NULL;
-	model->numtexcoords  = 0;
-	model->texcoords       = NULL;
-	model->numcolors = 0;
-	model->colors = NULL;
-	model->numfacetnorms = 0;
-	model->facetnorms    = NULL;
-	model->numtriangles  = 0;
-	model->triangles       = NULL;
-	model->numlines = 0;
-	model->lines = NULL;
-	model->nummaterials  = 0;
-	model->materials       = NULL;
-	model->numgroups       = 0;
-	model->groups      = NULL;
-	model->position[0]   = 0.0;
-	model->position[1]   = 0.0;
-	model->position[2]   = 0.0;
-	model->rotation[0] = 0.0f;
-	model->rotation[1] = 0.0f;
-	model->rotation[2] = 0.0f;
-	model->scale[0] = 1.0f;
-	model->scale[1] = 1.0f;
-	model->scale[2] = 1.0f;
-	model->trans_center[0] = 0.0f;
-	model->trans_center[1] = 0.0f;
-	model->trans_center[2] = 0.0f;
-	model->hastexture = GL_FALSE;
+	model = glmNewModel(filename);
+	if (!model)
+		return 0;
 
-	//read transformation info first
-	glmReadTransforms(model, obj_content);
+	/* make a default group */
+	char tmp[] = "default";
+	glmAddGroup(model, tmp);
+
+	/* chunks of at least 1MB end at line breaks */
+	size_t cn = std::min<size_t>(flrd::GetThreadNum(), size / (1 << 20) + 1);
+	std::vector<ObjChunk> chunks(cn);
+	const char* e = obj_content + size;
+	const char* b = obj_content;
+	for (size_t i = 0; i < cn; ++i)
+	{
+		const char* ce = e;
+		if (i + 1 < cn)
+		{
+			ce = std::max(b, obj_content + size / cn * (i + 1));
+			ce = (const char*)memchr(ce, '\n', e - ce);
+			ce = ce ? ce + 1 : e;
+		}
+		chunks[i].begin = b;
+		chunks[i].end = ce;
+		b = ce;
+	}
 
 	/* make a first pass through the file to get a count of the number
 	of vertices, normals, texcoords & triangles */
-	if (!glmFirstPass(model, obj_content))
-		if(no_fail) *no_fail = false;
+	flrd::ParallelFor(cn, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		for (size_t i = i0; i < i1; ++i)
+			glmObjCount(chunks[i]);
+	}, unsigned(cn));
+
+	if (!glmReadEvents(model, chunks))
+		if (no_fail) *no_fail = false;
+
+	for (auto& c : chunks)
+	{
+		c.v0 = model->numvertices;
+		c.n0 = model->numnormals;
+		c.t0 = model->numtexcoords;
+		c.c0 = model->numcolors;
+		c.tri0 = model->numtriangles;
+		c.l0 = model->numlines;
+		model->numvertices += c.numvertices;
+		model->numnormals += c.numnormals;
+		model->numtexcoords += c.numtexcoords;
+		model->numcolors += c.numcolors;
+		model->numtriangles += c.numtriangles;
+		model->numlines += c.numlines;
+	}
 
 	/* allocate memory */
 	if (model->numvertices)
-		model->vertices = (GLfloat*)malloc(sizeof(GLfloat) *
-		3 * (model->numvertices + 1));
+		model->vertices = (GLfloat*)calloc(3 * (size_t(model->numvertices) + 1),
+			sizeof(GLfloat));
 	if (model->numlines)
-		model->lines = (GLMline*)malloc(sizeof(GLMline) *
-		model->numlines);
+		model->lines = (GLMline*)calloc(model->numlines, sizeof(GLMline));
 	if (model->numtriangles)
-		model->triangles = (GLMtriangle*)malloc(sizeof(GLMtriangle) *
-		model->numtriangles);
+		model->triangles = (GLMtriangle*)calloc(model->numtriangles,
+			sizeof(GLMtriangle));
 	if (model->numnormals)
-		model->normals = (GLfloat*)malloc(sizeof(GLfloat) *
-		3 * (model->numnormals + 1));
+		model->normals = (GLfloat*)calloc(3 * (size_t(model->numnormals) + 1),
+			sizeof(GLfloat));
 	if (model->numtexcoords)
-		model->texcoords = (GLfloat*)malloc(sizeof(GLfloat) *
-		2 * (model->numtexcoords + 1));
+		model->texcoords = (GLfloat*)calloc(2 * (size_t(model->numtexcoords) + 1),
+			sizeof(GLfloat));
 	if (model->numcolors)
-		model->colors = (GLfloat*)malloc(sizeof(GLfloat) *
-		4 * (model->numcolors + 1));
-
-	glmSecondPass(model, obj_content);
+		model->colors = (GLfloat*)calloc(4 * (size_t(model->numcolors) + 1),
+			sizeof(GLfloat));
+	for (GLMgroup* group = model->groups; group; group = group->next)
+		if (group->numtriangles)
+			group->triangles = (GLuint*)malloc(sizeof(GLuint) * group->numtriangles);
 
-	free(obj_content);
+	/* second pass fills the arrays in place */
+	flrd::ParallelFor(cn, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		for (size_t i = i0; i < i1; ++i)
+			glmObjParse(model, chunks[i]);
+	}, unsigned(cn));
 
 	return model;
 }
@@ -2312,6 +2462,970 @@ GLvoid glmWriteOBJ(GLMmodel* model, const char* filename, GLuint mode)
 	fclose(file);
 }
 
+/* binary mesh formats */
+namespace
+{
+	const char glm_bin_magic[6] = { 'F', 'L', 'M', 'E', 'S', 'H' };
+	const unsigned short glm_bin_version = 1;
+
+	/* sequential reads from a file in memory */
+	struct glmBinReader
+	{
+		const char* p;
+		const char* e;
+		bool ok = true;
+
+		bool read(void* dst, size_t size)
+		{
+			if (!ok || size_t(e - p) < size)
+			{
+				ok = false;
+				return false;
+			}
+			memcpy(dst, p, size);
+			p += size;
+			return true;
+		}
+		template <typename T> T get()
+		{
+			T v{};
+			read(&v, sizeof(T));
+			return v;
+		}
+		char* str()
+		{
+			GLuint len = get<GLuint>();
+			if (!ok || size_t(e - p) < len)
+			{
+				ok = false;
+				return 0;
+			}
+			char* s = (char*)malloc(len + 1);
+			memcpy(s, p, len);
+			s[len] = 0;
+			p += len;
+			return s;
+		}
+	};
+
+	void glmBinWriteStr(FILE* file, const char* s)
+	{
+		GLuint len = s ? GLuint(strlen(s)) : 0;
+		fwrite(&len, sizeof(GLuint), 1, file);
+		if (len)
+			fwrite(s, 1, len, file);
+	}
+
+	/* a single group with all triangles */
+	void glmDefaultGroup(GLMmodel* model)
+	{
+		char tmp[] = "default";
+		GLMgroup* group = glmAddGroup(model, tmp);
+		group->numtriangles = model->numtriangles;
+		group->triangles = (GLuint*)malloc(sizeof(GLuint) *
+			(model->numtriangles ? model->numtriangles : 1));
+		for (GLuint i = 0; i < model->numtriangles; i++)
+			group->triangles[i] = i;
+	}
+
+	/* flatten the corners of a model to shared vertices that carry
+	their own normals and colors, for formats with per vertex attributes */
+	struct glmFlatMesh
+	{
+		std::vector<GLfloat> verts;
+		std::vector<GLfloat> norms;
+		std::vector<GLfloat> colors;
+		std::vector<GLuint> tris;
+	};
+
+	void glmFlatten(GLMmodel* model, glmFlatMesh& mesh)
+	{
+		bool has_norm = model->normals && model->numnormals;
+		bool has_color = model->colors && model->numcolors;
+		struct Key
+		{
+			GLuint v, n, c;
+			bool operator==(const Key& o) const
+			{
+				return v == o.v && n == o.n && c == o.c;
+			}
+		};
+		struct KeyHash
+		{
+			size_t operator()(const Key& k) const
+			{
+				return size_t(k.v) * 0x9E3779B1u ^ size_t(k.n) * 0x85EBCA77u ^ size_t(k.c) * 0xC2B2AE3Du;
+			}
+		};
+		std::unordered_map<Key, GLuint, KeyHash> map;
+		map.reserve(model->numvertices);
+		mesh.tris.resize(size_t(model->numtriangles) * 3);
+		for (GLuint i = 0; i < model->numtriangles; i++)
+		for (int j = 0; j < 3; j++)
+		{
+			Key key = { T(i).vindices[j],
+				has_norm ? T(i).nindices[j] : 0,
+				has_color ? T(i).cindices[j] : 0 };
+			auto it = map.find(key);
+			GLuint id;
+			if (it == map.end())
+			{
+				id = GLuint(mesh.verts.size() / 3);
+				map.emplace(key, id);
+				for (int k = 0; k < 3; k++)
+					mesh.verts.push_back(model->vertices[3 * key.v + k]);
+				if (has_norm)
+				for (int k = 0; k < 3; k++)
+					mesh.norms.push_back(key.n <= model->numnormals ?
+						model->normals[3 * key.n + k] : 0.0f);
+				if (has_color)
+				for (int k = 0; k < 4; k++)
+					mesh.colors.push_back(key.c <= model->numcolors ?
+						model->colors[4 * key.c + k] : 1.0f);
+			}
+			else
+				id = it->second;
+			mesh.tris[size_t(i) * 3 + j] = id;
+		}
+	}
+}
+
+/* glmReadBIN: Reads a model from a FluoRender binary mesh file.
+*
+* filename - name of the file
+* src_size - size of the source file if it is a cache, or 0
+* src_time - modification time of the source file if it is a cache, or 0
+*/
+GLMmodel* glmReadBIN(const char* filename,
+	unsigned long long* src_size, long long* src_time)
+{
+	std::vector<char> content;
+	if (!glmReadFile(filename, content))
+		return 0;
+	glmBinReader r{ content.data(), content.data() + content.size() - 1 };
+
+	char magic[6];
+	r.read(magic, 6);
+	if (!r.ok || memcmp(magic, glm_bin_magic, 6) ||
+		r.get<unsigned short>() != glm_bin_version)
+		return 0;
+	unsigned long long size = r.get<unsigned long long>();
+	long long time = r.get<long long>();
+	if (src_size)
+		*src_size = size;
+	if (src_time)
+		*src_time = time;
+
+	GLMmodel* model = glmNewModel(filename);
+	if (!model)
+		return 0;
+	model->numvertices = r.get<GLuint>();
+	model->numnormals = r.get<GLuint>();
+	model->numtexcoords = r.get<GLuint>();
+	model->numcolors = r.get<GLuint>();
+	model->numtriangles = r.get<GLuint>();
+	model->numlines = r.get<GLuint>();
+	GLuint nummaterials = r.get<GLuint>();
+	GLuint numgroups = r.get<GLuint>();
+	GLuint flags = r.get<GLuint>();
+	model->valid_trans_center = (flags & 1) != 0;
+	model->hastexture = (flags & 2) != 0;
+	r.read(model->position, sizeof(GLfloat) * 3);
+	r.read(model->rotation, sizeof(GLfloat) * 3);
+	r.read(model->scale, sizeof(GLfloat) * 3);
+	r.read(model->trans_center, sizeof(GLfloat) * 3);
+	model->mtllibname = r.str();
+	if (model->mtllibname && !model->mtllibname[0])
+	{
+		free(model->mtllibname);
+		model->mtllibname = 0;
+	}
+
+	auto read_array = [&](GLfloat*& dst, GLuint num, int comp)
+	{
+		if (!num || !r.ok)
+			return;
+		dst = (GLfloat*)calloc(size_t(comp) * (size_t(num) + 1), sizeof(GLfloat));
+		if (!dst)
+			r.ok = false;
+		else
+			r.read(dst + comp, sizeof(GLfloat) * comp * num);
+	};
+	read_array(model->vertices, model->numvertices, 3);
+	read_array(model->normals, model->numnormals, 3);
+	read_array(model->texcoords, model->numtexcoords, 2);
+	read_array(model->colors, model->numcolors, 4);
+
+	if (model->numtriangles && r.ok)
+	{
+		model->triangles = (GLMtriangle*)calloc(model->numtriangles, sizeof(GLMtriangle));
+		std::vector<GLuint> ind(size_t(model->numtriangles) * 12);
+		if (model->triangles && r.read(ind.data(), sizeof(GLuint) * ind.size()))
+		{
+			/* indices are 1-based, 0 means no attribute except for vertices */
+			std::atomic<bool> valid(true);
+			flrd::ParallelFor(model->numtriangles, [&](size_t i0, size_t i1, unsigned int t)
+			{
+				for (size_t i = i0; i < i1; ++i)
+				{
+					const GLuint* s = &ind[i * 12];
+					for (int j = 0; j < 3; ++j)
+					{
+						if (!s[j] || s[j] > model->numvertices ||
+							s[3 + j] > model->numnormals ||
+							s[6 + j] > model->numtexcoords ||
+							s[9 + j] > model->numcolors)
+						{
+							valid = false;
+							return;
+						}
+					}
+					memcpy(T(i).vindices, s, sizeof(GLuint) * 3);
+					memcpy(T(i).nindices, s + 3, sizeof(GLuint) * 3);
+					memcpy(T(i).tindices, s + 6, sizeof(GLuint) * 3);
+					memcpy(T(i).cindices, s + 9, sizeof(GLuint) * 3);
+				}
+			});
+			r.ok = valid;
+		}
+		else
+			r.ok = false;
+	}
+
+	if (model->numlines && r.ok)
+	{
+		model->lines = (GLMline*)calloc(model->numlines, sizeof(GLMline));
+		for (GLuint i = 0; i < model->numlines && r.ok; i++)
+		{
+			GLuint num = r.get<GLuint>();
+			if (!r.ok || size_t(r.e - r.p) / sizeof(GLuint) < num)
+			{
+				r.ok = false;
+				break;
+			}
+			L(i).numvertices = num;
+			L(i).vindices = (GLuint*)malloc(sizeof(GLuint) * (num ? num : 1));
+			r.read(L(i).vindices, sizeof(GLuint) * num);
+			for (GLuint j = 0; j < num && r.ok; ++j)
+				if (!L(i).vindices[j] || L(i).vindices[j] > model->numvertices)
+					r.ok = false;
+		}
+	}
+
+	if (nummaterials && r.ok)
+	{
+		model->materials = (GLMmaterial*)calloc(nummaterials, sizeof(GLMmaterial));
+		model->nummaterials = nummaterials;
+		for (GLuint i = 0; i < nummaterials && r.ok; i++)
+		{
+			GLMmaterial& m = model->materials[i];
+			m.name = r.str();
+			r.read(m.diffuse, sizeof(GLfloat) * 4);
+			r.read(m.ambient, sizeof(GLfloat) * 4);
+			r.read(m.specular, sizeof(GLfloat) * 4);
+			r.read(m.emmissive, sizeof(GLfloat) * 4);
+			m.shininess = r.get<GLfloat>();
+		}
+	}
+
+	/* groups keep their order */
+	GLMgroup** tail = &model->groups;
+	for (GLuint i = 0; i < numgroups && r.ok; i++)
+	{
+		GLMgroup* group = (GLMgroup*)calloc(1, sizeof(GLMgroup));
+		*tail = group;
+		tail = &group->next;
+		model->numgroups++;
+		group->name = r.str();
+		group->material = r.get<GLuint>();
+		GLuint num = r.get<GLuint>();
+		if (!r.ok || size_t(r.e - r.p) / sizeof(GLuint) < num)
+		{
+			r.ok = false;
+			break;
+		}
+		group->numtriangles = num;
+		group->triangles = (GLuint*)malloc(sizeof(GLuint) * (num ? num : 1));
+		r.read(group->triangles, sizeof(GLuint) * num);
+		if (group->material >= nummaterials && group->material)
+			r.ok = false;
+		for (GLuint j = 0; j < num && r.ok; ++j)
+			if (group->triangles[j] >= model->numtriangles)
+				r.ok = false;
+	}
+
+	if (!r.ok)
+	{
+		glmDelete(model);
+		return 0;
+	}
+	return model;
+}
+
+/* glmWriteBIN: Writes a model to a FluoRender binary mesh file.
+* Arrays are stored as they are in memory, little endian.
+*
+* model    - initialized GLMmodel structure
+* filename - name of the file
+* src_size - size of the source file if it is a cache, or 0
+* src_time - modification time of the source file if it is a cache, or 0
+*/
+GLboolean glmWriteBIN(GLMmodel* model, const char* filename,
+	unsigned long long src_size, long long src_time)
+{
+	FILE* file;
+	std::string str = filename;
+	if (!model || !FOPEN(&file, str, "wb"))
+		return GL_FALSE;
+
+	fwrite(glm_bin_magic, 1, 6, file);
+	fwrite(&glm_bin_version, sizeof(unsigned short), 1, file);
+	fwrite(&src_size, sizeof(unsigned long long), 1, file);
+	fwrite(&src_time, sizeof(long long), 1, file);
+	GLuint numgroups = 0;
+	for (GLMgroup* g = model->groups; g; g = g->next)
+		numgroups++;
+	GLuint counts[9] = {
+		model->vertices ? model->numvertices : 0,
+		model->normals ? model->numnormals : 0,
+		model->texcoords ? model->numtexcoords : 0,
+		model->colors ? model->numcolors : 0,
+		model->triangles ? model->numtriangles : 0,
+		model->lines ? model->numlines : 0,
+		model->materials ? model->nummaterials : 0,
+		numgroups,
+		GLuint((model->valid_trans_center ? 1 : 0) | (model->hastexture ? 2 : 0)) };
+	fwrite(counts, sizeof(GLuint), 9, file);
+	fwrite(model->position, sizeof(GLfloat), 3, file);
+	fwrite(model->rotation, sizeof(GLfloat), 3, file);
+	fwrite(model->scale, sizeof(GLfloat), 3, file);
+	fwrite(model->trans_center, sizeof(GLfloat), 3, file);
+	glmBinWriteStr(file, model->mtllibname);
+
+	if (counts[0])
+		fwrite(model->vertices + 3, sizeof(GLfloat), size_t(counts[0]) * 3, file);
+	if (counts[1])
+		fwrite(model->normals + 3, sizeof(GLfloat), size_t(counts[1]) * 3, file);
+	if (counts[2])
+		fwrite(model->texcoords + 2, sizeof(GLfloat), size_t(counts[2]) * 2, file);
+	if (counts[3])
+		fwrite(model->colors + 4, sizeof(GLfloat), size_t(counts[3]) * 4, file);
+
+	if (counts[4])
+	{
+		std::vector<GLuint> ind(size_t(counts[4]) * 12);
+		flrd::ParallelFor(counts[4], [&](size_t i0, size_t i1, unsigned int t)
+		{
+			for (size_t i = i0; i < i1; ++i)
+			{
+				GLuint* d = &ind[i * 12];
+				memcpy(d, T(i).vindices, sizeof(GLuint) * 3);
+				memcpy(d + 3, T(i).nindices, sizeof(GLuint) * 3);
+				memcpy(d + 6, T(i).tindices, sizeof(GLuint) * 3);
+				memcpy(d + 9, T(i).cindices, sizeof(GLuint) * 3);
+			}
+		});
+		fwrite(ind.data(), sizeof(GLuint), ind.size(), file);
+	}
+
+	for (GLuint i = 0; i < counts[5]; i++)
+	{
+		fwrite(&L(i).numvertices, sizeof(GLuint), 1, file);
+		if (L(i).numvertices)
+			fwrite(L(i).vindices, sizeof(GLuint), L(i).numvertices, file);
+	}
+
+	for (GLuint i = 0; i < counts[6]; i++)
+	{
+		GLMmaterial& m = model->materials[i];
+		glmBinWriteStr(file, m.name);
+		fwrite(m.diffuse, sizeof(GLfloat), 4, file);
+		fwrite(m.ambient, sizeof(GLfloat), 4, file);
+		fwrite(m.specular, sizeof(GLfloat), 4, file);
+		fwrite(m.emmissive, sizeof(GLfloat), 4, file);
+		fwrite(&m.shininess, sizeof(GLfloat), 1, file);
+	}
+
+	for (GLMgroup* g = model->groups; g; g = g->next)
+	{
+		glmBinWriteStr(file, g->name);
+		fwrite(&g->material, sizeof(GLuint), 1, file);
+		fwrite(&g->numtriangles, sizeof(GLuint), 1, file);
+		if (g->numtriangles)
+			fwrite(g->triangles, sizeof(GLuint), g->numtriangles, file);
+	}
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok ? GL_TRUE : GL_FALSE;
+}
+
+/* glmReadPLY: Reads a model from a PLY file.  Ascii and binary
+* encodings are supported.  Vertex normals and colors are kept,
+* polygons are triangulated as fans.
+*
+* filename - name of the file
+*/
+GLMmodel* glmReadPLY(const char* filename)
+{
+	std::vector<char> content;
+	if (!glmReadFile(filename, content))
+		return 0;
+	const char* p = content.data();
+	const char* e = p + content.size() - 1;
+
+	/* header */
+	struct Prop
+	{
+		std::string name;
+		int type = 0;//size in bytes, negative for signed, 5 for float, 9 for double
+		int count_type = 0;//list count type, 0 if not a list
+	};
+	struct Elem
+	{
+		std::string name;
+		size_t count = 0;
+		std::vector<Prop> props;
+	};
+	auto type_of = [](const std::string& s) -> int
+	{
+		if (s == "char" || s == "int8") return -1;
+		if (s == "uchar" || s == "uint8") return 1;
+		if (s == "short" || s == "int16") return -2;
+		if (s == "ushort" || s == "uint16") return 2;
+		if (s == "int" || s == "int32") return -4;
+		if (s == "uint" || s == "uint32") return 4;
+		if (s == "float" || s == "float32") return 5;
+		if (s == "double" || s == "float64") return 9;
+		return 0;
+	};
+	std::vector<Elem> elems;
+	int format = -1;//0: ascii, 1: little endian, 2: big endian
+	if (e - p < 3 || strncmp(p, "ply", 3))
+		return 0;
+	while (p < e)
+	{
+		const char* le = (const char*)memchr(p, '\n', e - p);
+		if (!le)
+			return 0;
+		std::string line(p, le);
+		p = le + 1;
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		char w[3][64] = {};
+		int n = SSCANF(line.c_str(), "%63s %63s %63s", w[0], w[1], w[2]);
+		if (n < 1)
+			continue;
+		std::string key = w[0];
+		if (key == "format" && n >= 2)
+		{
+			std::string f = w[1];
+			format = f == "ascii" ? 0 : f == "binary_little_endian" ? 1 :
+				f == "binary_big_endian" ? 2 : -1;
+		}
+		else if (key == "element" && n >= 3)
+		{
+			Elem el;
+			el.name = w[1];
+			el.count = size_t(strtoull(w[2], 0, 10));
+			elems.push_back(el);
+		}
+		else if (key == "property" && !elems.empty())
+		{
+			Prop pr;
+			if (std::string(w[1]) == "list")
+			{
+				char t1[64] = {}, t2[64] = {}, nm[64] = {};
+				if (SSCANF(line.c_str(), "%*s %*s %63s %63s %63s", t1, t2, nm) != 3)
+					return 0;
+				pr.count_type = type_of(t1);
+				pr.type = type_of(t2);
+				pr.name = nm;
+				if (!pr.count_type || !pr.type)
+					return 0;
+			}
+			else
+			{
+				pr.type = type_of(w[1]);
+				pr.name = w[2];
+				if (!pr.type)
+					return 0;
+			}
+			elems.back().props.push_back(pr);
+		}
+		else if (key == "end_header")
+			break;
+	}
+	if (format < 0)
+		return 0;
+
+	/* value readers */
+	bool swap = format == 2;
+	auto size_of = [](int type) { return type == 5 ? 4 : type == 9 ? 8 : std::abs(type); };
+	auto read_bin = [&](const char*& q, int type, double& v) -> bool
+	{
+		int size = size_of(type);
+		if (e - q < size)
+			return false;
+		unsigned char b[8];
+		memcpy(b, q, size);
+		if (swap)
+			std::reverse(b, b + size);
+		q += size;
+		switch (type)
+		{
+		case -1: v = double(*(signed char*)b); break;
+		case 1: v = double(*(unsigned char*)b); break;
+		case -2: { short s; memcpy(&s, b, 2); v = s; } break;
+		case 2: { unsigned short s; memcpy(&s, b, 2); v = s; } break;
+		case -4: { int s; memcpy(&s, b, 4); v = s; } break;
+		case 4: { unsigned int s; memcpy(&s, b, 4); v = s; } break;
+		case 5: { float s; memcpy(&s, b, 4); v = s; } break;
+		case 9: { double s; memcpy(&s, b, 8); v = s; } break;
+		default: return false;
+		}
+		return true;
+	};
+	auto read_val = [&](const char*& q, int type, double& v) -> bool
+	{
+		if (format)
+			return read_bin(q, type, v);
+		q = glmSkipBlank(q, e);
+		if (q == e)
+			return false;
+		char* end = 0;
+		v = strtod(q, &end);
+		if (end == q)
+			return false;
+		q = end;
+		return true;
+	};
+
+	GLMmodel* model = glmNewModel(filename);
+	if (!model)
+		return 0;
+	std::vector<GLuint> faces;//fan triangulated vertex indices
+	bool ok = true;
+	for (auto& el : elems)
+	{
+		if (!ok)
+			break;
+		if (el.name == "vertex")
+		{
+			/* columns of the vertex attributes */
+			int col[10];
+			const char* names[10] = { "x", "y", "z", "nx", "ny", "nz",
+				"red", "green", "blue", "alpha" };
+			bool fixed = format != 0;
+			size_t stride = 0;
+			std::vector<size_t> offset(el.props.size(), 0);
+			for (int k = 0; k < 10; ++k)
+				col[k] = -1;
+			for (size_t j = 0; j < el.props.size(); ++j)
+			{
+				offset[j] = stride;
+				if (el.props[j].count_type)
+					fixed = false;
+				stride += size_of(el.props[j].type);
+				for (int k = 0; k < 10; ++k)
+					if (el.props[j].name == names[k])
+						col[k] = int(j);
+			}
+			if (col[0] < 0 || col[1] < 0 || col[2] < 0)
+			{
+				ok = false;
+				break;
+			}
+			bool has_norm = col[3] >= 0 && col[4] >= 0 && col[5] >= 0;
+			bool has_color = col[6] >= 0 && col[7] >= 0 && col[8] >= 0;
+			size_t vn = el.count;
+			model->numvertices = GLuint(vn);
+			model->vertices = (GLfloat*)calloc(3 * (vn + 1), sizeof(GLfloat));
+			if (has_norm)
+			{
+				model->numnormals = GLuint(vn);
+				model->normals = (GLfloat*)calloc(3 * (vn + 1), sizeof(GLfloat));
+			}
+			if (has_color)
+			{
+				model->numcolors = GLuint(vn);
+				model->colors = (GLfloat*)calloc(4 * (vn + 1), sizeof(GLfloat));
+			}
+			auto store = [&](size_t i, const double* v)
+			{
+				for (int k = 0; k < 3; ++k)
+					model->vertices[3 * (i + 1) + k] = GLfloat(v[k]);
+				if (has_norm)
+				for (int k = 0; k < 3; ++k)
+					model->normals[3 * (i + 1) + k] = GLfloat(v[3 + k]);
+				if (has_color)
+				for (int k = 0; k < 4; ++k)
+				{
+					int j = col[6 + k];
+					double c = k == 3 && j < 0 ? 1.0 : v[6 + k];
+					/* integer colors are 0-255 */
+					if (j >= 0 && el.props[j].type != 5 && el.props[j].type != 9)
+						c /= 255.0;
+					model->colors[4 * (i + 1) + k] = GLfloat(c);
+				}
+			};
+			if (fixed)
+			{
+				/* fixed size records convert in parallel */
+				if (size_t(e - p) / (stride ? stride : 1) < vn)
+				{
+					ok = false;
+					break;
+				}
+				const char* base = p;
+				flrd::ParallelFor(vn, [&](size_t i0, size_t i1, unsigned int t)
+				{
+					for (size_t i = i0; i < i1; ++i)
+					{
+						double v[10] = { 0 };
+						for (int k = 0; k < 10; ++k)
+						{
+							if (col[k] < 0)
+								continue;
+							const char* q = base + i * stride + offset[col[k]];
+							read_bin(q, el.props[col[k]].type, v[k]);
+						}
+						store(i, v);
+					}
+				});
+				p += vn * stride;
+			}
+			else
+			{
+				std::vector<double> row(el.props.size());
+				for (size_t i = 0; i < vn && ok; ++i)
+				{
+					for (size_t j = 0; j < el.props.size() && ok; ++j)
+					{
+						const Prop& pr = el.props[j];
+						if (pr.count_type)
+						{
+							double cnt = 0.0, dummy;
+							ok = read_val(p, pr.count_type, cnt);
+							for (int c = 0; ok && c < int(cnt); ++c)
+								ok = read_val(p, pr.type, dummy);
+							row[j] = 0.0;
+						}
+						else
+							ok = read_val(p, pr.type, row[j]);
+					}
+					double v[10] = { 0 };
+					for (int k = 0; k < 10; ++k)
+						if (col[k] >= 0)
+							v[k] = row[col[k]];
+					store(i, v);
+				}
+			}
+		}
+		else
+		{
+			/* faces and other elements */
+			bool is_face = el.name == "face";
+			for (size_t i = 0; i < el.count && ok; ++i)
+			{
+				for (auto& pr : el.props)
+				{
+					if (!pr.count_type)
+					{
+						double dummy;
+						ok = read_val(p, pr.type, dummy);
+					}
+					else
+					{
+						double cnt = 0.0;
+						ok = read_val(p, pr.count_type, cnt);
+						bool index = is_face &&
+							(pr.name == "vertex_indices" || pr.name == "vertex_index");
+						double v0 = 0.0, v1 = 0.0, v;
+						for (int c = 0; ok && c < int(cnt); ++c)
+						{
+							ok = read_val(p, pr.type, v);
+							if (!index || !ok)
+								continue;
+							/* reject indices outside the vertex list */
+							if (v < 0.0 || v >= double(model->numvertices))
+							{
+								ok = false;
+								break;
+							}
+							if (c == 0)
+								v0 = v;
+							else if (c >= 2)
+							{
+								faces.push_back(GLuint(v0) + 1);
+								faces.push_back(GLuint(v1) + 1);
+								faces.push_back(GLuint(v) + 1);
+							}
+							v1 = v;
+						}
+					}
+					if (!ok)
+						break;
+				}
+			}
+		}
+	}
+	if (!ok || !model->numvertices)
+	{
+		glmDelete(model);
+		return 0;
+	}
+
+	model->numtriangles = GLuint(faces.size() / 3);
+	model->triangles = (GLMtriangle*)calloc(model->numtriangles ? model->numtriangles : 1,
+		sizeof(GLMtriangle));
+	bool has_norm = model->normals != 0;
+	bool has_color = model->colors != 0;
+	for (GLuint i = 0; i < model->numtriangles; i++)
+	for (int j = 0; j < 3; j++)
+	{
+		GLuint v = faces[size_t(i) * 3 + j];
+		T(i).vindices[j] = v;
+		if (has_norm)
+			T(i).nindices[j] = v;
+		if (has_color)
+			T(i).cindices[j] = v;
+	}
+	glmDefaultGroup(model);
+	return model;
+}
+
+/* glmWritePLY: Writes a model to a binary little endian PLY file.
+* Vertices with different normals or colors on different corners
+* are split.
+*
+* model    - initialized GLMmodel structure
+* filename - name of the file
+*/
+GLboolean glmWritePLY(GLMmodel* model, const char* filename)
+{
+	if (!model || !model->vertices)
+		return GL_FALSE;
+	glmFlatMesh mesh;
+	glmFlatten(model, mesh);
+
+	FILE* file;
+	std::string str = filename;
+	if (!FOPEN(&file, str, "wb"))
+		return GL_FALSE;
+	size_t vn = mesh.verts.size() / 3;
+	size_t tn = mesh.tris.size() / 3;
+	bool has_norm = !mesh.norms.empty();
+	bool has_color = !mesh.colors.empty();
+	fprintf(file, "ply\nformat binary_little_endian 1.0\n");
+	fprintf(file, "comment FluoRender\n");
+	fprintf(file, "element vertex %zu\n", vn);
+	fprintf(file, "property float x\nproperty float y\nproperty float z\n");
+	if (has_norm)
+		fprintf(file, "property float nx\nproperty float ny\nproperty float nz\n");
+	if (has_color)
+		fprintf(file, "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty uchar alpha\n");
+	fprintf(file, "element face %zu\n", tn);
+	fprintf(file, "property list uchar int vertex_indices\nend_header\n");
+
+	/* records are packed in memory and written at once */
+	size_t stride = 12 + (has_norm ? 12 : 0) + (has_color ? 4 : 0);
+	std::vector<char> buf(vn * stride);
+	flrd::ParallelFor(vn, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		for (size_t i = i0; i < i1; ++i)
+		{
+			char* d = &buf[i * stride];
+			memcpy(d, &mesh.verts[i * 3], 12);
+			d += 12;
+			if (has_norm)
+			{
+				memcpy(d, &mesh.norms[i * 3], 12);
+				d += 12;
+			}
+			if (has_color)
+			for (int k = 0; k < 4; ++k)
+			{
+				GLfloat c = mesh.colors[i * 4 + k];
+				c = c < 0.0f ? 0.0f : c > 1.0f ? 1.0f : c;
+				d[k] = char(GLubyte(c * 255.0f + 0.5f));
+			}
+		}
+	});
+	fwrite(buf.data(), 1, buf.size(), file);
+	buf.resize(tn * 13);
+	flrd::ParallelFor(tn, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		for (size_t i = i0; i < i1; ++i)
+		{
+			char* d = &buf[i * 13];
+			d[0] = 3;
+			memcpy(d + 1, &mesh.tris[i * 3], 12);
+		}
+	});
+	fwrite(buf.data(), 1, tn * 13, file);
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok ? GL_TRUE : GL_FALSE;
+}
+
+/* glmReadSTL: Reads a model from an STL file, binary or ascii.
+* Identical vertices of adjacent facets are merged.
+*
+* filename - name of the file
+*/
+GLMmodel* glmReadSTL(const char* filename)
+{
+	std::vector<char> content;
+	if (!glmReadFile(filename, content))
+		return 0;
+	size_t size = content.size() - 1;
+	const char* p = content.data();
+	const char* e = p + size;
+
+	std::vector<GLfloat> corners;
+	GLuint num = 0;
+	if (size >= 84)
+		memcpy(&num, p + 80, 4);
+	if (size >= 84 && size == 84 + size_t(num) * 50)
+	{
+		/* binary */
+		corners.resize(size_t(num) * 9);
+		flrd::ParallelFor(num, [&](size_t i0, size_t i1, unsigned int t)
+		{
+			for (size_t i = i0; i < i1; ++i)
+				memcpy(&corners[i * 9], p + 84 + i * 50 + 12, 36);
+		});
+	}
+	else
+	{
+		/* ascii */
+		const char* q = p;
+		while (q < e)
+		{
+			q = glmSkipBlank(q, e);
+			const char* te = glmSkipToken(q, e);
+			if (te - q == 6 && !strncmp(q, "vertex", 6))
+			{
+				GLfloat v[3];
+				te = glmParseFloat(te, e, &v[0]);
+				te = glmParseFloat(te, e, &v[1]);
+				te = glmParseFloat(te, e, &v[2]);
+				corners.insert(corners.end(), v, v + 3);
+			}
+			q = te;
+		}
+		corners.resize(corners.size() / 9 * 9);
+	}
+	if (corners.empty())
+		return 0;
+
+	/* merge identical positions */
+	struct Key
+	{
+		GLfloat v[3];
+		bool operator==(const Key& o) const
+		{
+			return !memcmp(v, o.v, sizeof(v));
+		}
+	};
+	struct KeyHash
+	{
+		size_t operator()(const Key& k) const
+		{
+			GLuint b[3];
+			memcpy(b, k.v, sizeof(b));
+			return size_t(b[0]) * 0x9E3779B1u ^ size_t(b[1]) * 0x85EBCA77u ^ size_t(b[2]) * 0xC2B2AE3Du;
+		}
+	};
+	size_t cn = corners.size() / 3;
+	std::unordered_map<Key, GLuint, KeyHash> map;
+	map.reserve(cn / 4);
+	std::vector<GLuint> index(cn);
+	std::vector<GLfloat> verts;
+	verts.reserve(cn / 2 * 3);
+	for (size_t i = 0; i < cn; ++i)
+	{
+		Key k;
+		memcpy(k.v, &corners[i * 3], sizeof(k.v));
+		/* -0 and 0 are the same vertex */
+		for (int j = 0; j < 3; ++j)
+			if (k.v[j] == 0.0f)
+				k.v[j] = 0.0f;
+		auto it = map.find(k);
+		if (it == map.end())
+		{
+			GLuint id = GLuint(verts.size() / 3) + 1;
+			map.emplace(k, id);
+			verts.insert(verts.end(), k.v, k.v + 3);
+			index[i] = id;
+		}
+		else
+			index[i] = it->second;
+	}
+
+	GLMmodel* model = glmNewModel(filename);
+	if (!model)
+		return 0;
+	model->numvertices = GLuint(verts.size() / 3);
+	model->vertices = (GLfloat*)malloc(sizeof(GLfloat) * (verts.size() + 3));
+	memcpy(model->vertices + 3, verts.data(), sizeof(GLfloat) * verts.size());
+	model->numtriangles = GLuint(cn / 3);
+	model->triangles = (GLMtriangle*)calloc(model->numtriangles, sizeof(GLMtriangle));
+	for (GLuint i = 0; i < model->numtriangles; i++)
+	for (int j = 0; j < 3; j++)
+		T(i).vindices[j] = index[size_t(i) * 3 + j];
+	glmDefaultGroup(model);
+	return model;
+}
+
+/* glmWriteSTL: Writes a model to a binary STL file.
+*
+* model    - initialized GLMmodel structure
+* filename - name of the file
+*/
+GLboolean glmWriteSTL(GLMmodel* model, const char* filename)
+{
+	if (!model || !model->vertices)
+		return GL_FALSE;
+	FILE* file;
+	std::string str = filename;
+	if (!FOPEN(&file, str, "wb"))
+		return GL_FALSE;
+
+	char header[80] = {};
+	STRCPY(header, 80, "FluoRender STL");
+	fwrite(header, 1, 80, file);
+	GLuint tn = model->numtriangles;
+	fwrite(&tn, sizeof(GLuint), 1, file);
+	std::vector<char> buf(size_t(tn) * 50, 0);
+	flrd::ParallelFor(tn, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		for (size_t i = i0; i < i1; ++i)
+		{
+			GLfloat rec[12];
+			GLfloat* v[3];
+			for (int j = 0; j < 3; ++j)
+				v[j] = &model->vertices[3 * T(i).vindices[j]];
+			GLfloat u[3] = { v[1][0] - v[0][0], v[1][1] - v[0][1], v[1][2] - v[0][2] };
+			GLfloat w[3] = { v[2][0] - v[0][0], v[2][1] - v[0][1], v[2][2] - v[0][2] };
+			glmCross(u, w, rec);
+			GLfloat l = (GLfloat)sqrt(rec[0] * rec[0] + rec[1] * rec[1] + rec[2] * rec[2]);
+			if (l > 0.0f)
+				glmNormalize(rec);
+			for (int j = 0; j < 3; ++j)
+				memcpy(&rec[3 + j * 3], v[j], sizeof(GLfloat) * 3);
+			memcpy(&buf[i * 50], rec, sizeof(rec));
+		}
+	});
+	fwrite(buf.data(), 1, buf.size(), file);
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok ? GL_TRUE : GL_FALSE;
+}
+
 /* glmWeld: eliminate (weld) vectors that are within an epsilon of
 * each other.
 *
@@ -2322,51 +3436,69 @@ GLvoid glmWriteOBJ(GLMmodel* model, const char* filename, GLuint mode)
 */
 GLvoid glmWeld(GLMmodel* model, GLfloat epsilon)
 {
-	GLfloat* vectors;
 	GLfloat* copies;
 	GLuint numvectors;
 	GLuint i;
 
 	/* vertices */
 	numvectors = model->numvertices;
-	vectors  = model->vertices;
-	copies = glmWeldVectors(vectors, &numvectors, epsilon);
+	std::vector<GLuint> index(size_t(numvectors) + 1, 0);
+	copies = glmWeldIndices(model->vertices, &numvectors, epsilon, index.data());
+	if (!copies)
+		return;
 
-	int tri = 0;
-	for (i = 0; i < model->numtriangles; i++)
+	/* remap triangles and mark the ones that collapsed */
+	GLuint numtriangles = model->numtriangles;
+	std::vector<GLuint> remap(size_t(numtriangles) + 1, 0);
+	flrd::ParallelFor(numtriangles, [&](size_t i0, size_t i1, unsigned int t)
 	{
-		GLuint ind0 = (GLuint)vectors[3 * T(i).vindices[0] + 0];
-		GLuint ind1 = (GLuint)vectors[3 * T(i).vindices[1] + 0];
-		GLuint ind2 = (GLuint)vectors[3 * T(i).vindices[2] + 0];
-
-		if (ind0!=ind1 && ind0!=ind2 && ind0!=ind2)
+		for (size_t j = i0; j < i1; ++j)
 		{
-			T(tri).vindices[0] = ind0;
-			T(tri).vindices[1] = ind1;
-			T(tri).vindices[2] = ind2;
-			tri++;
+			GLuint ind0 = index[T(j).vindices[0]];
+			GLuint ind1 = index[T(j).vindices[1]];
+			GLuint ind2 = index[T(j).vindices[2]];
+			T(j).vindices[0] = ind0;
+			T(j).vindices[1] = ind1;
+			T(j).vindices[2] = ind2;
+			remap[j] = ind0 != ind1 && ind0 != ind2 && ind1 != ind2;
 		}
+	});
+	GLuint tri = 0;
+	for (i = 0; i < numtriangles; i++)
+	{
+		if (!remap[i])
+		{
+			remap[i] = (GLuint)-1;
+			continue;
+		}
+		if (tri != i)
+			T(tri) = T(i);
+		remap[i] = tri++;
 	}
 	model->numtriangles = tri;
-	if (model->groups)
-		model->groups->numtriangles = tri;
 
-	/* free space for old vertices */
-	free(vectors);
+	/* groups keep the remaining triangles */
+	GLMgroup* group = model->groups;
+	while (group)
+	{
+		GLuint num = 0;
+		for (i = 0; i < group->numtriangles; i++)
+		{
+			GLuint t = group->triangles[i];
+			if (t < numtriangles && remap[t] != (GLuint)-1)
+				group->triangles[num++] = remap[t];
+		}
+		group->numtriangles = num;
+		group = group->next;
+	}
 
-	/* allocate space for the new vertices */
+	/* replace the old vertices with the welded ones */
+	free(model->vertices);
 	model->numvertices = numvectors;
-	model->vertices = (GLfloat*)malloc(sizeof(GLfloat) *
+	model->vertices = (GLfloat*)realloc(copies, sizeof(GLfloat) *
 		3 * (model->numvertices + 1));
-
-	/* copy the optimized vertices into the actual vertex list */
-	for (i = 1; i <= model->numvertices; i++) {
-		model->vertices[3 * i + 0] = copies[3 * i + 0];
-		model->vertices[3 * i + 1] = copies[3 * i + 1];
-		model->vertices[3 * i + 2] = copies[3 * i + 2];
-	}
-
-	free(copies);
+	if (!model->vertices)
+		model->vertices = copies;
 }
 
 /* glmReadPPM: read a PPM raw (type P6) file.  The PPM file has a header
@@ -269,6 +269,53 @@ GLMmodel* glmReadOBJ(const char* filename, bool* no_fail = 0);
 */
 GLvoid glmWriteOBJ(GLMmodel* model, const char* filename, GLuint mode);
 
+/* glmReadBIN: Reads a model from a FluoRender binary mesh (.fmsh) file.
+* Returns 0 if the file is missing or damaged.
+*
+* filename - name of the file
+* src_size - returns the size of the source file of a cache
+* src_time - returns the modification time of the source file of a cache
+*/
+GLMmodel* glmReadBIN(const char* filename,
+	unsigned long long* src_size = 0, long long* src_time = 0);
+
+/* glmWriteBIN: Writes a model to a FluoRender binary mesh (.fmsh) file.
+* All arrays, groups and materials are stored as they are in memory.
+*
+* model    - initialized GLMmodel structure
+* filename - name of the file
+* src_size - size of the source file when writing a cache
+* src_time - modification time of the source file when writing a cache
+*/
+GLboolean glmWriteBIN(GLMmodel* model, const char* filename,
+	unsigned long long src_size = 0, long long src_time = 0);
+
+/* glmReadPLY: Reads a model from an ascii or binary PLY file.
+*
+* filename - name of the file
+*/
+GLMmodel* glmReadPLY(const char* filename);
+
+/* glmWritePLY: Writes a model to a binary PLY file.
+*
+* model    - initialized GLMmodel structure
+* filename - name of the file
+*/
+GLboolean glmWritePLY(GLMmodel* model, const char* filename);
+
+/* glmReadSTL: Reads a model from an ascii or binary STL file.
+*
+* filename - name of the file
+*/
+GLMmodel* glmReadSTL(const char* filename);
+
+/* glmWriteSTL: Writes a model to a binary STL file.
+*
+* model    - initialized GLMmodel structure
+* filename - name of the file
+*/
+GLboolean glmWriteSTL(GLMmodel* model, const char* filename);
+
 /* glmWeld: eliminate (weld) vectors that are within an epsilon of
 * each other.
 *
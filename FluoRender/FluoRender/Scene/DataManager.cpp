@@ -63,10 +63,19 @@ DEALINGS IN THE SOFTWARE.
 #include <lbl_reader.h>
 #include <base_mesh_reader.h>
 #include <obj_reader.h>
+#include <ply_reader.h>
+#include <stl_reader.h>
+#include <fmsh_reader.h>
 #include <CurrentObjects.h>
 #include <MovieMaker.h>
 #include <Project.h>
 #include <Value.hpp>
+#include <MemRegistry.h>
+#include <FrameCache.h>
+#include <BufferPool.h>
+#include <KernelFactory.h>
+#include <Directory.h>
+#include <compatibility.h>
 #include <FpRangeDlg.h>
 #include <filesystem>
 
@@ -420,7 +429,10 @@ void DataManager::StartupLoad(const std::vector<std::wstring>& files, bool run_m
 		{
 			LoadVolumes(files, with_imagej);
 		}
-		else if (suffix == L".obj")
+		else if (suffix == L".obj" ||
+			suffix == L".ply" ||
+			suffix == L".stl" ||
+			suffix == L".fmsh")
 		{
 			LoadMeshFiles(files);
 		}
@@ -493,7 +505,11 @@ size_t DataManager::LoadVolumeData(const std::wstring &filename, int type, bool
 			preprocess = true;
 		}
 		if (preprocess)
+		{
+			//frames are laid out differently
+			glbin_frame_cache.Erase(reader.get());
 			reader_return = reader->Preprocess();
+		}
 	}
 	else
 	{
@@ -552,6 +568,10 @@ size_t DataManager::LoadVolumeData(const std::wstring &filename, int type, bool
 		reader->SetChannSeq(glbin_settings.m_chann_sequence);
 		reader->SetDigitOrder(glbin_settings.m_digit_order);
 		reader->SetTimeId(glbin_settings.m_time_id);
+		reader->SetBitReduce(glbin_settings.m_bit_reduce);
+		reader->SetBitReducePercentile(glbin_settings.m_bit_reduce_lo, glbin_settings.m_bit_reduce_hi);
+		reader->SetBitReduceGamma(glbin_settings.m_bit_reduce_gamma);
+		reader->SetBitReduceRange(glbin_settings.m_bit_reduce_min, glbin_settings.m_bit_reduce_max);
 		reader_return = reader->Preprocess();
 	}
 
@@ -590,7 +610,10 @@ size_t DataManager::LoadVolumeData(const std::wstring &filename, int type, bool
 	}
 
 	if (glbin_settings.m_ser_num > 0)
+	{
+		glbin_frame_cache.Erase(reader.get());
 		reader->LoadBatch(glbin_settings.m_ser_num);
+	}
 	int chan = reader->GetChanNum();
 
 	int v1, v2;
@@ -863,8 +886,15 @@ bool DataManager::LoadMeshData(const std::wstring &filename)
 	}
 	else
 	{
-		if (GET_SUFFIX(pathname) == L".obj")
+		std::wstring suffix = GET_SUFFIX(pathname);
+		if (suffix == L".obj")
 			reader = std::make_shared<ObjReader>();
+		else if (suffix == L".ply")
+			reader = std::make_shared<PlyReader>();
+		else if (suffix == L".stl")
+			reader = std::make_shared<StlReader>();
+		else if (suffix == L".fmsh")
+			reader = std::make_shared<FmshReader>();
 		else
 			return false;
 	}
@@ -1325,3 +1355,45 @@ void DataManager::UpdateStreamMode(double data_size)
 		break;
 	}
 }
+
+void DataManager::ReportMemory()
+{
+	flrd::MemRegistry& reg = glbin_mem_registry;
+	reg.Begin();
+	size_t vd_tex = 0;
+	for (auto& vd : m_vd_list)
+	{
+		if (!vd)
+			continue;
+		vd->ReportMemory(reg);
+		vd_tex += flvr::TextureRenderer::get_tex_mem(vd->GetTexture());
+		auto it = m_vd_cache_queue.find(vd.get());
+		if (it != m_vd_cache_queue.end() && it->second)
+			reg.Report(flrd::MemType::CacheQueue, ws2s(vd->GetName()),
+				it->second->get_mem_size());
+	}
+	//textures of other levels or released volumes
+	size_t tex = flvr::TextureRenderer::get_tex_mem();
+	if (tex > vd_tex)
+		reg.Report(flrd::MemType::Texture, "other", tex - vd_tex);
+	reg.Report(flrd::MemType::FrameCache, "all", glbin_frame_cache.GetSize());
+	reg.Report(flrd::MemType::BufferPool, "all", glbin_buffer_pool.GetIdleSize());
+	reg.Report(flrd::MemType::Buffer, "all", glbin_kernel_factory.get_buf_size());
+	reg.Count("Frame cache hits", glbin_frame_cache.GetHitNum());
+	reg.Count("Frame cache misses", glbin_frame_cache.GetMissNum());
+	reg.End();
+}
+
+void DataManager::UpdateMemory()
+{
+	if (glbin_mem_registry.GetElapsed() < 1.0)
+		return;
+	ReportMemory();
+	double interval = glbin_settings.m_mem_log_interval;
+	if (interval > 0.0)
+	{
+		std::filesystem::path p = GetUserSettingsRoot();
+		p /= "memory_log.csv";
+		glbin_mem_registry.Log(p.wstring(), interval);
+	}
+}
@@ -139,6 +139,11 @@ public:
 	//update stream rendering mode
 	void UpdateStreamMode(double data_size);//input is a newly loaded data size in mb
 
+	//collect memory use of all volumes, caches and buffers
+	void ReportMemory();
+	//collect once a second at most and write the memory log
+	void UpdateMemory();
+
 private:
 	MainFrame* m_frame;
 	std::unique_ptr<Root> m_root;// root of the scene graph
@@ -106,7 +106,15 @@ void MeshData::Save(const std::wstring& filename)
 	if (m_data)
 	{
 		std::string str = ws2s(filename);
-		glmWriteOBJ(m_data.get(), str.c_str(), GLM_SMOOTH | GLM_VERTC);
+		std::wstring suffix = GET_SUFFIX(filename);
+		if (suffix == L".ply")
+			glmWritePLY(m_data.get(), str.c_str());
+		else if (suffix == L".stl")
+			glmWriteSTL(m_data.get(), str.c_str());
+		else if (suffix == L".fmsh")
+			glmWriteBIN(m_data.get(), str.c_str());
+		else
+			glmWriteOBJ(m_data.get(), str.c_str(), GLM_SMOOTH | GLM_VERTC);
 		m_data_path = filename;
 	}
 }
@@ -42,6 +42,7 @@ DEALINGS IN THE SOFTWARE.
 #include <KernelProgram.h>
 #include <Texture.h>
 #include <TextureBrick.h>
+#include <FrameCache.h>
 #include <MultiVolumeRenderer.h>
 #include <TextRenderer.h>
 #include <StopWatch.hpp>
@@ -3331,12 +3332,22 @@ void RenderView::UpdateVolumeData(int frame, const std::shared_ptr<VolumeData>&
 	else
 	{
 		auto spc = vd->GetSpacing();
-
-		Nrrd* data = reader->Convert(frame, vd->GetCurChannel(), false);
+		int chan = vd->GetCurChannel();
+
+		//keep the outgoing frame compressed
+		//scripts may have changed it in place, so not when they run
+		if (!glbin_settings.m_run_script)
+			glbin_frame_cache.Put(reader.get(), vd->GetCurTime(), chan,
+				vd->GetVolume(false));
+		//restore from compressed frames before reading the file
+		Nrrd* data = glbin_frame_cache.Get(reader.get(), frame, chan);
+		bool cached = data != 0;
+		if (!cached)
+			data = reader->Convert(frame, chan, false);
 		if (!vd->Replace(data, false))
 			return;
 
-		vd->SetCurTime(reader->GetCurTime());
+		vd->SetCurTime(cached ? frame : reader->GetCurTime());
 		vd->SetSpacing(spc);
 
 		clear_pool = true;
@@ -3430,6 +3441,8 @@ void RenderView::ReloadVolumeData(int frame)
 				}
 				if (!found)
 				{
+					//cached frames belong to the previous file
+					glbin_frame_cache.Erase(reader.get());
 					reader->LoadOffset(frame);
 					reader_list.push_back(reader);
 				}
@@ -5556,6 +5569,13 @@ void RenderView::DrawVolumes(int peel)
 		m_load_update = false;
 
 		PopVolumeList();
+		//coarse levels of resident volumes
+		for (auto it = m_vd_pop_list.begin(); it != m_vd_pop_list.end(); ++it)
+		{
+			auto vd = it->lock();
+			if (vd && !vd->isBrxml())
+				switchLevel(vd.get());
+		}
 
 		std::vector<std::weak_ptr<VolumeData>> quota_vd_list;
 		if (glbin_settings.m_mem_swap)
@@ -9551,6 +9571,36 @@ void RenderView::switchLevel(VolumeData *vd)
 			vtex->set_sort_bricks();
 		}
 	}
+	else if (vtex)
+	{
+		//in-memory pyramid of a resident volume
+		//the coarsest level whose voxels stay within a few pixels is drawn while interacting
+		int new_lv = 0;
+		int lvnum = vtex->get_mip_num();
+		if (m_interactive && lvnum > 1 && m_radius > 0.0)
+		{
+			//pixels per unit length
+			double px = m_scale_factor * double(ny) / (2.0 * m_radius);
+			double scl = vd->GetScaling().y();
+			for (int i = lvnum - 1; i > 0; --i)
+			{
+				if (vtex->get_spacing(i).y() * scl * px <= glbin_settings.m_mip_pixel)
+				{
+					new_lv = i;
+					break;
+				}
+			}
+			//apply offset
+			new_lv += glbin_settings.m_detail_level_offset;
+			if (new_lv < 0) new_lv = 0;
+			if (new_lv >= lvnum) new_lv = lvnum - 1;
+		}
+		if (vd->GetMipLevel() != new_lv)
+		{
+			vd->SetMipLevel(new_lv);
+			vtex->set_sort_bricks();
+		}
+	}
 }
 
 //controller interactions
@@ -9627,6 +9677,9 @@ void RenderView::GrabRotate(const glm::mat4& pose)
 
 void RenderView::ProcessIdle(IdleState& state)
 {
+	//sample memory use and write the log
+	glbin_data_manager.UpdateMemory();
+
 	if (m_interactive &&
 		!m_rot_lock)
 		return;
@@ -431,6 +431,8 @@ bool TrackGroup::Save(const std::wstring &filename)
 {
 	m_data_path = filename;
 	glbin_trackmap_proc.SetTrackMap(m_track_map);
+	//the file is written in the background
+	//its result goes to the info output of the track dialog
 	return glbin_trackmap_proc.Export(m_data_path);
 }
 
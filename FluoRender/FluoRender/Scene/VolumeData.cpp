@@ -55,6 +55,11 @@ DEALINGS IN THE SOFTWARE.
 #include <nrrd_writer.h>
 #include <msk_writer.h>
 #include <compatibility.h>
+#include <ZeroMem.h>
+#include <BufferPool.h>
+#include <MemRegistry.h>
+#include <TextureRenderer.h>
+#include <VolumeLoader.h>
 #include <glm/gtc/matrix_transform.hpp>
 
 VolumeData::VolumeData()
@@ -69,6 +74,7 @@ VolumeData::VolumeData()
 	m_render_mode = flvr::RenderMode::Standard;
 	//stream modes
 	m_stream_mode = 0;
+	m_mip_lv = 0;
 
 	//mask mode
 	m_main_mode = flvr::ColorMode::SingleColor;
@@ -218,6 +224,7 @@ VolumeData::VolumeData(VolumeData &copy)
 	m_render_mode = copy.m_render_mode;
 	//stream modes
 	m_stream_mode = copy.m_stream_mode;
+	m_mip_lv = 0;
 
 	//mask mode
 	m_main_mode = copy.m_main_mode;
@@ -546,24 +553,26 @@ void VolumeData::AddEmptyData(int bits,
 	{
 		unsigned long long mem_size = (unsigned long long)res.intx()*
 			(unsigned long long)res.inty()*(unsigned long long)res.intz();
-		uint8_t *val8 = new (std::nothrow) uint8_t[mem_size]();
+		uint8_t *val8 = glbin_buffer_pool.Alloc<uint8_t>(mem_size);
 		if (!val8)
 		{
 			//SetProgress("Not enough memory. Please save project and restart.");
 			return;
 		}
+		flrd::ClearZero(val8, mem_size);
 		nrrdWrap_va(nv, val8, nrrdTypeUChar, 3, (size_t)res.intx(), (size_t)res.inty(), (size_t)res.intz());
 	}
 	else if (bits == 16)
 	{
 		unsigned long long mem_size = (unsigned long long)res.intx()*
 			(unsigned long long)res.inty() * (unsigned long long)res.intz();
-		uint16_t *val16 = new (std::nothrow) uint16_t[mem_size]();
+		uint16_t *val16 = glbin_buffer_pool.Alloc<uint16_t>(mem_size);
 		if (!val16)
 		{
 			//SetProgress("Not enough memory. Please save project and restart.");
 			return;
 		}
+		flrd::ClearZero(val16, mem_size * sizeof(uint16_t));
 		nrrdWrap_va(nv, val16, nrrdTypeUShort, 3, (size_t)res.intx(), (size_t)res.inty(), (size_t)res.intz());
 	}
 	nrrdAxisInfoSet_va(nv, nrrdAxisInfoSpacing, spc.x(), spc.y(), spc.z());
@@ -656,8 +665,9 @@ void VolumeData::AddEmptyMask(int mode, bool change)
 	if (empty)
 	{
 		//add the nrrd data for mask
+		//zero pages are only mapped when written
 		nrrd_mask = nrrdNew();
-		val8 = new (std::nothrow) uint8_t[mem_size];
+		val8 = flrd::AllocZero<uint8_t>(mem_size);
 		if (!val8)
 		{
 			//SetProgress("Not enough memory. Please save project and restart.");
@@ -682,13 +692,14 @@ void VolumeData::AddEmptyMask(int mode, bool change)
 
 	if (empty || change)
 	{
-		if (mode == 0 || mode == 1)
-		{
-			if (val8)
-				std::memset((void*)val8, mode ?
-					255 : 0, mem_size * sizeof(uint8_t));
-		}
+		if (val8 && mode == 1)
+			std::memset((void*)val8, 255, mem_size * sizeof(uint8_t));
+		else if (val8 && mode == 0 && !empty)
+			flrd::ClearZero(val8, mem_size * sizeof(uint8_t));
 	}
+	//bricks of a zero mask are not read for upload or written on return
+	if (val8 && mode != 1 && (empty || (change && mode == 0)))
+		m_tex->set_zero(flvr::CompType::Mask, true);
 }
 
 void VolumeData::AddMask(Nrrd* mask, int op)
@@ -711,7 +722,7 @@ void VolumeData::AddMask(Nrrd* mask, int op)
 	{
 		//add the nrrd data for mask
 		nrrd_mask = nrrdNew();
-		val8 = new (std::nothrow) uint8_t[mem_size];
+		val8 = flrd::AllocZero<uint8_t>(mem_size);
 		if (!val8)
 		{
 			//SetProgress("Not enough memory. Please save project and restart.");
@@ -769,7 +780,7 @@ void VolumeData::AddMask(Nrrd* mask, int op)
 		}
 		else//replace
 		{
-			memcpy(val8, mask->data, mem_size * sizeof(uint8_t));
+			flrd::CopyZero(val8, mask->data, mem_size * sizeof(uint8_t));
 		}
 		m_vr->clear_tex_mask(false);
 	}
@@ -795,7 +806,7 @@ void VolumeData::AddMask16(Nrrd* mask, int op, double scale)
 	{
 		//add the nrrd data for mask
 		nrrd_mask = nrrdNew();
-		val8 = new (std::nothrow) uint8_t[mem_size];
+		val8 = flrd::AllocZero<uint8_t>(mem_size);
 		if (!val8)
 		{
 			//SetProgress("Not enough memory. Please save project and restart.");
@@ -891,6 +902,36 @@ void VolumeData::LoadLabel(Nrrd* label)
 		SetMaskMode(flvr::ColorMode::Component);
 }
 
+bool VolumeData::LoadLabelSrc(const std::function<bool(const int[3], const int[3], void*)>& src)
+{
+	if (!src || !m_tex || !m_vr)
+		return false;
+
+	//the label nrrd has no data until cpu users ask for it
+	Nrrd* label = nrrdNew();
+	auto spc = m_tex->get_spacing();
+	label->type = nrrdTypeUInt;
+	label->dim = 3;
+	nrrdAxisInfoSet_va(label, nrrdAxisInfoSize, (size_t)m_size.intx(), (size_t)m_size.inty(), (size_t)m_size.intz());
+	nrrdAxisInfoSet_va(label, nrrdAxisInfoSpacing, spc.x(), spc.y(), spc.z());
+	nrrdAxisInfoSet_va(label, nrrdAxisInfoMin, 0.0, 0.0, 0.0);
+	auto max_size = spc * m_size;
+	nrrdAxisInfoSet_va(label, nrrdAxisInfoMax, max_size.x(), max_size.y(), max_size.z());
+
+	m_tex->add_empty_label();
+	flvr::TexComp comp = { flvr::CompType::Label, 4, label };
+	m_tex->set_nrrd(flvr::CompType::Label, comp);
+	m_tex->set_label_src(src);
+	m_vr->clear_tex_label();
+
+	//no mask is added, labels are shown as components
+	if (m_tex->has_comp(flvr::CompType::Mask))
+		SetMaskMode(flvr::ColorMode::Component);
+	else
+		SetMainMaskMode(flvr::ColorMode::Component);
+	return true;
+}
+
 void VolumeData::SetOrderedID(unsigned int* val)
 {
 	int res_x, res_y, res_z;
@@ -1083,7 +1124,7 @@ void VolumeData::AddEmptyLabel(int mode, bool change)
 		nrrd_label = nrrdNew();
 		unsigned long long mem_size = (unsigned long long)m_size.intx() *
 			(unsigned long long)m_size.inty() * (unsigned long long)m_size.intz();
-		val32 = new (std::nothrow) unsigned int[mem_size];
+		val32 = flrd::AllocZero<unsigned int>(mem_size);
 		if (!val32)
 		{
 			//SetProgress("Not enough memory. Please save project and restart.");
@@ -1098,7 +1139,7 @@ void VolumeData::AddEmptyLabel(int mode, bool change)
 		auto max_size = spc * m_size;
 		nrrdAxisInfoSet_va(nrrd_label, nrrdAxisInfoMax, max_size.x(), max_size.y(), max_size.z());
 
-		flvr::TexComp comp = { flvr::CompType::Label, 1, nrrd_label };
+		flvr::TexComp comp = { flvr::CompType::Label, 4, nrrd_label };
 		m_tex->set_nrrd(comp.type, comp);
 	}
 	else
@@ -1114,7 +1155,8 @@ void VolumeData::AddEmptyLabel(int mode, bool change)
 		switch (mode)
 		{
 		case 0://zeros
-			std::memset(val32, 0, sizeof(unsigned int)*GetVoxelCount());
+			if (exist)
+				flrd::ClearZero(val32, sizeof(unsigned int)*GetVoxelCount());
 			break;
 		case 1://ordered
 			SetOrderedID(val32);
@@ -1124,6 +1166,9 @@ void VolumeData::AddEmptyLabel(int mode, bool change)
 			break;
 		}
 	}
+	//bricks of zero labels are not read for upload or written on return
+	if (val32 && mode == 0 && (!exist || change))
+		m_tex->set_zero(flvr::CompType::Label, true);
 
 	//set color mode
 	if (m_tex->has_comp(flvr::CompType::Mask))
@@ -1200,6 +1245,11 @@ Nrrd* VolumeData::GetLabel(bool ret)
 	return 0;
 }
 
+bool VolumeData::HasLabel()
+{
+	return m_tex && m_tex->has_comp(flvr::CompType::Label);
+}
+
 double VolumeData::GetOriginalValue(const fluo::Point& p, flvr::TextureBrick* b)
 {
 	void *data_data = 0;
@@ -1576,6 +1626,7 @@ void VolumeData::SaveLabel(bool use_reader, int t, int c)
 	MSKWriter msk_writer;
 	msk_writer.SetData(data);
 	msk_writer.SetSpacing(spc);
+	msk_writer.SetCompact(glbin_settings.m_label_compact);
 	std::wstring filename;
 	if (use_reader)
 	{
@@ -1754,6 +1805,38 @@ flvr::Texture* VolumeData::GetTexture()
 	return m_tex.get();
 }
 
+void VolumeData::ReportMemory(flrd::MemRegistry& reg)
+{
+	auto bytes = [](Nrrd* nrrd)
+	{
+		if (!nrrd || !nrrd->data)
+			return size_t(0);
+		return nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+	};
+	std::string name = ws2s(GetName());
+	if (m_tex)
+	{
+		reg.Report(flrd::MemType::Data, name,
+			bytes(m_tex->get_nrrd(flvr::CompType::Data).data));
+		reg.Report(flrd::MemType::Data, name,
+			m_tex->get_mip_size());
+		reg.Report(flrd::MemType::Mask, name,
+			bytes(m_tex->get_nrrd(flvr::CompType::Mask).data));
+		if (!m_tex->has_label_src())
+			reg.Report(flrd::MemType::Label, name,
+				bytes(m_tex->get_nrrd(flvr::CompType::Label).data));
+		reg.Report(flrd::MemType::Undo, name,
+			m_tex->get_undo_size());
+		reg.Report(flrd::MemType::Texture, name,
+			flvr::TextureRenderer::get_tex_mem(m_tex.get()));
+	}
+	if (m_label_save)
+		reg.Report(flrd::MemType::Undo, name,
+			GetVoxelCount() * sizeof(unsigned int));
+	reg.Report(flrd::MemType::Brick, name,
+		glbin_vol_loader.GetUsedMemory(this));
+}
+
 void VolumeData::ResetVolume()
 {
 	flvr::CacheQueue* cache_queue = glbin_data_manager.GetCacheQueue(this);
@@ -1779,8 +1862,15 @@ void VolumeData::Draw(bool ortho, bool interactive, double zoom, double sf121)
 {
 	if (m_vr)
 	{
+		//the coarse level is only set while drawing
+		bool mip = interactive && m_mip_lv > 0 && m_tex &&
+			m_tex->set_mip_level(m_mip_lv);
 		m_vr->set_zoom(zoom, sf121);
 		m_vr->draw(m_test_wiref, interactive, ortho, m_stream_mode);
+		if (mip)
+			m_tex->set_mip_level(0);
+		else if (!interactive && m_tex)
+			m_tex->update_mip();
 	}
 	if (m_draw_bounds)
 		DrawBounds();
@@ -2856,6 +2946,14 @@ int VolumeData::GetLevelNum()
 		return -1;
 }
 
+int VolumeData::GetMipLevelNum()
+{
+	if (m_tex && !isBrxml())
+		return m_tex->get_mip_num();
+	else
+		return 0;
+}
+
 //bits
 int VolumeData::GetBits()
 {
@@ -38,6 +38,7 @@ DEALINGS IN THE SOFTWARE.
 #include <glm/glm.hpp>
 #include <array>
 #include <memory>
+#include <functional>
 
 namespace flvr
 {
@@ -52,6 +53,7 @@ namespace flrd
 {
 	class EntryParams;
 	class Ruler;
+	class MemRegistry;
 }
 namespace fluo
 {
@@ -125,7 +127,11 @@ public:
 	void AddMask16(Nrrd* mask, int op, double scale);//16-bit data
 	//load label
 	void LoadLabel(Nrrd* label);
+	//labels kept in a file, read by brick as they are drawn
+	//reads a box of 32-bit labels into dst, x fastest
+	bool LoadLabelSrc(const std::function<bool(const int[3], const int[3], void*)>& src);
 	Nrrd* GetLabel(bool ret);
+	bool HasLabel();
 	//empty label
 	//mode: 0-zeros;1-ordered; 2-shuffled
 	//change: whether changes label when it already exists
@@ -159,6 +165,8 @@ public:
 	flvr::VolumeRenderer *GetVR();
 	//texture
 	flvr::Texture* GetTexture();
+	//report memory use of data, undos, textures and bricks
+	void ReportMemory(flrd::MemRegistry& reg);
 
 	//bounding box
 	fluo::BBox GetBounds();
@@ -349,6 +357,10 @@ public:
 	void SetLevel(int lv);
 	int GetLevel();
 	int GetLevelNum();
+	//coarse level of the in-memory pyramid drawn while interacting
+	void SetMipLevel(int lv) { m_mip_lv = lv; }
+	int GetMipLevel() { return m_mip_lv; }
+	int GetMipLevelNum();
 
 	//bits
 	int GetBits();
@@ -519,6 +531,7 @@ private:
 	flvr::RenderMode m_render_mode;	//0-normal; 1-MIP; 2-white shading; 3-white mip
 	//modes for streaming
 	int m_stream_mode;	//0-normal; 1-MIP; 2-shading; 3-shadow, 4-mask
+	int m_mip_lv;		//coarse level for interactive drawing
 
 	//mask mode
 	flvr::ColorMode m_main_mode;
@@ -76,6 +76,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Project.h>
 #include <PyDlc.h>
 #include <VolCache4D.h>
+#include <MemRegistry.h>
 #include <Cell.h>
 #include <Directory.h>
 #include <iostream>
@@ -190,6 +191,8 @@ int ScriptProc::Run4DScript(TimeMask tm, bool rewind)
 					RunCompRuler();
 				else if (str == "generate_comp")
 					RunGenerateComp();
+				else if (str == "split_comp")
+					RunSplitComp();
 				else if (str == "ruler_profile")
 					RunRulerProfile();
 				else if (str == "roi")
@@ -198,6 +201,8 @@ int ScriptProc::Run4DScript(TimeMask tm, bool rewind)
 					RunRoiDff();
 				else if (str == "ruler_info")
 					RunRulerInfo();
+				else if (str == "memory_info")
+					RunMemoryInfo();
 				else if (str == "ruler_transform")
 					RunRulerTransform();
 				else if (str == "ruler_speed")
@@ -1446,6 +1451,33 @@ void ScriptProc::RunCompRuler()
 	}
 }
 
+namespace
+{
+	//generator settings that a task may change
+	//they are restored after the task so they are not saved as defaults
+	struct CompGenState
+	{
+		bool ws = glbin_comp_generator.GetWatershed();
+		int ws_marker = glbin_comp_generator.GetWsMarker();
+		int ws_mem = glbin_comp_generator.GetWsMem();
+		double ws_h = glbin_comp_generator.GetWsH();
+		double ws_dist_weight = glbin_comp_generator.GetWsDistWeight();
+		bool out_core = glbin_comp_generator.GetOutOfCore();
+		int out_core_mem = glbin_comp_generator.GetOutOfCoreMem();
+
+		void Restore()
+		{
+			glbin_comp_generator.SetWatershed(ws);
+			glbin_comp_generator.SetWsMarker(ws_marker);
+			glbin_comp_generator.SetWsMem(ws_mem);
+			glbin_comp_generator.SetWsH(ws_h);
+			glbin_comp_generator.SetWsDistWeight(ws_dist_weight);
+			glbin_comp_generator.SetOutOfCore(out_core);
+			glbin_comp_generator.SetOutOfCoreMem(out_core_mem);
+		}
+	};
+}
+
 void ScriptProc::RunGenerateComp()
 {
 	if (!TimeCondition())
@@ -1453,6 +1485,7 @@ void ScriptProc::RunGenerateComp()
 	std::vector<std::shared_ptr<VolumeData>> vlist;
 	if (!GetVolumes(vlist))
 		return;
+	CompGenState state;
 
 	std::wstring ml_table_file;
 	m_fconfig->Read("ml_table", &ml_table_file);
@@ -1462,6 +1495,13 @@ void ScriptProc::RunGenerateComp()
 	m_fconfig->Read("use_sel", &use_sel, false);
 	double tfac;
 	m_fconfig->Read("th_factor", &tfac, 1.0);
+	bool out_core;
+	m_fconfig->Read("out_of_core", &out_core, false);
+	int out_core_mem;
+	m_fconfig->Read("out_core_mem", &out_core_mem, 1024);
+	glbin_comp_generator.SetOutOfCore(out_core);
+	glbin_comp_generator.SetOutOfCoreMem(out_core_mem);
+	ReadSplitParams();
 	std::wstring cmdfile;
 	m_fconfig->Read("comp_command", &cmdfile);
 	cmdfile = GetInputFile(cmdfile, L"Commands");
@@ -1483,6 +1523,48 @@ void ScriptProc::RunGenerateComp()
 		else
 			glbin_comp_generator.PlayCmd(tfac);
 	}
+	state.Restore();
+}
+
+void ScriptProc::RunSplitComp()
+{
+	if (!TimeCondition())
+		return;
+	std::vector<std::shared_ptr<VolumeData>> vlist;
+	if (!GetVolumes(vlist))
+		return;
+
+	CompGenState state;
+	bool use_sel;
+	m_fconfig->Read("use_sel", &use_sel, false);
+	ReadSplitParams();
+	glbin_comp_generator.SetUseSel(use_sel);
+
+	for (auto it = vlist.begin();
+		it != vlist.end(); ++it)
+	{
+		glbin_comp_generator.SetVolumeData(*it);
+		glbin_comp_generator.Split(false);
+	}
+	state.Restore();
+}
+
+//watershed settings are only changed when given in the task
+void ScriptProc::ReadSplitParams()
+{
+	bool bval;
+	if (m_fconfig->Read("use_watershed", &bval))
+		glbin_comp_generator.SetWatershed(bval);
+	int ival;
+	if (m_fconfig->Read("ws_marker", &ival))
+		glbin_comp_generator.SetWsMarker(ival);
+	if (m_fconfig->Read("ws_mem", &ival))
+		glbin_comp_generator.SetWsMem(ival);
+	double dval;
+	if (m_fconfig->Read("ws_h", &dval))
+		glbin_comp_generator.SetWsH(dval);
+	if (m_fconfig->Read("ws_dist_weight", &dval))
+		glbin_comp_generator.SetWsDistWeight(dval);
 }
 
 void ScriptProc::RunRulerProfile()
@@ -1739,7 +1821,9 @@ void ScriptProc::RunBackgroundStat()
 	int curf = view->m_tseq_cur_num;
 	int chan_num = vlist.size();
 	int ch = 0;
-	std::string fn = std::to_string(curf);
+	//all frames in the play range at once
+	bool series;
+	m_fconfig->Read("series", &series, false);
 
 	for (auto itvol = vlist.begin();
 		itvol != vlist.end(); ++itvol, ++ch)
@@ -1764,26 +1848,43 @@ void ScriptProc::RunBackgroundStat()
 		m_fconfig->Read("gauth", &gauth, 0.0);
 		if (varth > 0.0 && gauth > 0.0)
 			bgs.SetThreshold(static_cast<float>(varth), static_cast<float>(gauth));
+		double pct;
+		m_fconfig->Read("percentile", &pct, 50.0);
+		bgs.SetPercentile(pct);
 
-		bgs.Run();
-		float result = bgs.GetResultf(iindx);
+		std::vector<std::pair<int, float>> results;
+		if (series)
+		{
+			bgs.RunSeries(view->m_begin_frame, view->m_end_frame);
+			for (size_t i = 0; i < bgs.GetFrameNum(); ++i)
+				results.push_back(std::pair<int, float>(
+					bgs.GetFrame(i), bgs.GetResultf(iindx, static_cast<int>(i))));
+		}
+		else
+		{
+			bgs.Run();
+			results.push_back(std::pair<int, float>(curf, bgs.GetResultf(iindx)));
+		}
 
-		//output
-		//time group
-		fluo::Group* timeg = m_output->getOrAddGroup(fn);
-		timeg->addSetValue("type", std::string("time"));
-		timeg->addSetValue("t", long(curf));
-		//channel group
-		fluo::Group* chg = timeg->getOrAddGroup(std::to_string(ch));
-		chg->addSetValue("type", std::string("channel"));
-		chg->addSetValue("ch", long(ch));
-		//script command
-		fluo::Group* cmdg = chg->getOrAddGroup(m_type);
-		cmdg->addSetValue("type", m_type);
-		//result node
-		fluo::Node* node = cmdg->getOrAddNode("result");
-		node->addSetValue("type", m_type);
-		node->addSetValue(bgs.GetTypeName(iindx), result);
+		for (auto& it : results)
+		{
+			//output
+			//time group
+			fluo::Group* timeg = m_output->getOrAddGroup(std::to_string(it.first));
+			timeg->addSetValue("type", std::string("time"));
+			timeg->addSetValue("t", long(it.first));
+			//channel group
+			fluo::Group* chg = timeg->getOrAddGroup(std::to_string(ch));
+			chg->addSetValue("type", std::string("channel"));
+			chg->addSetValue("ch", long(ch));
+			//script command
+			fluo::Group* cmdg = chg->getOrAddGroup(m_type);
+			cmdg->addSetValue("type", m_type);
+			//result node
+			fluo::Node* node = cmdg->getOrAddNode("result");
+			node->addSetValue("type", m_type);
+			node->addSetValue(bgs.GetTypeName(iindx), it.second);
+		}
 	}
 }
 
@@ -2065,6 +2166,51 @@ void ScriptProc::RunRulerInfo()
 	}
 }
 
+void ScriptProc::RunMemoryInfo()
+{
+	if (!TimeCondition())
+		return;
+
+	bool bval;
+	m_fconfig->Read("reset_peak", &bval, false);
+	glbin_data_manager.ReportMemory();
+	if (bval)
+		glbin_mem_registry.ResetPeak();
+
+	int curf = 0;
+	auto view = m_view.lock();
+	if (view)
+		curf = view->m_tseq_cur_num;
+	std::string fn = std::to_string(curf);
+	//output
+	//script command
+	fluo::Group* cmdg = m_output->getOrAddGroup(m_type);
+	cmdg->addSetValue("type", m_type);
+	for (int i = 0; i < static_cast<int>(flrd::MemType::Num); ++i)
+	{
+		//current use in mb for each type
+		flrd::MemType type = static_cast<flrd::MemType>(i);
+		fluo::Node* node = cmdg->getOrAddNode(flrd::MemRegistry::GetName(type));
+		node->addSetValue(fn, glbin_mem_registry.GetCurrent(type) / 1048576.0);
+	}
+
+	//table of all owners
+	std::wstring outputfile;
+	if (!m_fconfig->Read("output", &outputfile))
+		return;
+	outputfile = GetSavePath(outputfile, L"txt", false);
+	if (outputfile.empty())
+		return;
+#ifdef _WIN32
+	std::ofstream ofs(outputfile, std::ios::app);
+#else
+	std::ofstream ofs(ws2s(outputfile), std::ios::app);
+#endif
+	ofs << "Frame " << curf << "\n";
+	ofs << glbin_mem_registry.GetText(true) << "\n";
+	ofs.close();
+}
+
 void ScriptProc::RunRulerTransform()
 {
 	if (!TimeCondition())
@@ -2258,7 +2404,7 @@ void ScriptProc::RunConvertMesh()
 		glbin_conv_vol_mesh->Update(true);
 		glbin_conv_vol_mesh->MergeVertices(true);
 		auto md = glbin_conv_vol_mesh->GetMeshData();
-		if (it->GetLabel(false))
+		if (it->HasLabel())
 		{
 			glbin_color_mesh.SetUseSel(true);
 			glbin_color_mesh.SetUseComp(true);
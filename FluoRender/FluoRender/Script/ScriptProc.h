@@ -113,6 +113,7 @@ namespace flrd
 		std::wstring GetDataDir(const std::wstring &ext);
 		std::wstring GetConfigFile(const std::wstring& str, const std::wstring& ext, const std::wstring& type, int mode);//mode-0 open;1-save
 		int GetItems(const std::wstring& str, std::vector<std::wstring>& items);
+		void ReadSplitParams();
 		bool GetRegistrationTransform(fluo::Vector& transl, fluo::Point& center, fluo::Vector& euler, int sn);//sn: smooth frame number
 		
 		void RunNoiseReduction();
@@ -132,6 +133,7 @@ namespace flrd
 		void RunCompAnalysis();
 		void RunCompRuler();
 		void RunGenerateComp();
+		void RunSplitComp();
 		void RunRulerProfile();
 		void RunRoi();
 		void RunRoiDff();
@@ -143,6 +145,7 @@ namespace flrd
 		void GetRulers(const std::wstring& vrp, int &startf, int &endf);
 		void RunCameraPoints();
 		void RunRulerInfo();
+		void RunMemoryInfo();
 		void RunRulerTransform();
 		void RunRulerSpeed();
 		void RunGenerateWalk();
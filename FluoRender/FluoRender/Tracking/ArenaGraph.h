@@ -0,0 +1,444 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_ArenaGraph_h
+#define FL_ArenaGraph_h
+
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <cstddef>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/range/iterator_range.hpp>
+
+namespace flrd
+{
+	//undirected graph with vertices and edges stored in contiguous arrays
+	//descriptors are 32-bit indices that stay valid until the item is removed
+	//removed slots go to a free list and are reused by later additions
+	//iteration follows slot order, so a new item may come before older ones
+	template <typename VP, typename EP>
+	class ArenaGraph
+	{
+	public:
+		typedef unsigned int vertex_descriptor;
+		typedef size_t vertices_size_type;
+		typedef size_t edges_size_type;
+		typedef size_t degree_size_type;
+
+		//source and target follow the query, as in boost undirected graphs
+		struct edge_descriptor
+		{
+			unsigned int src = ~0u;
+			unsigned int tgt = ~0u;
+			unsigned int idx = ~0u;
+
+			bool operator==(const edge_descriptor& e) const { return idx == e.idx; }
+			bool operator!=(const edge_descriptor& e) const { return idx != e.idx; }
+			bool operator<(const edge_descriptor& e) const { return idx < e.idx; }
+		};
+
+		typedef boost::undirected_tag directed_category;
+		typedef boost::allow_parallel_edge_tag edge_parallel_category;
+		struct traversal_category :
+			public boost::incidence_graph_tag,
+			public boost::adjacency_graph_tag,
+			public boost::vertex_list_graph_tag,
+			public boost::edge_list_graph_tag {};
+
+		static vertex_descriptor null_vertex() { return ~0u; }
+
+	private:
+		struct VertRec
+		{
+			VP prop;
+			std::vector<unsigned int> out;//incident edges
+			bool alive;
+		};
+		struct EdgeRec
+		{
+			EP prop;
+			unsigned int src;
+			unsigned int tgt;
+			bool alive;
+		};
+
+	public:
+		//iterators keep indices, so adding while iterating is safe
+		//the end compares against the current size, as a list sentinel does
+		class vertex_iterator
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef vertex_descriptor value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const vertex_descriptor* pointer;
+			typedef vertex_descriptor reference;
+
+			vertex_iterator() {}
+			vertex_iterator(const ArenaGraph* g, size_t i) : m_g(g), m_i(i) { skip(); }
+			vertex_descriptor operator*() const { return static_cast<vertex_descriptor>(m_i); }
+			vertex_iterator& operator++() { ++m_i; skip(); return *this; }
+			vertex_iterator operator++(int) { vertex_iterator t = *this; ++*this; return t; }
+			bool operator==(const vertex_iterator& it) const { return at_end() ? it.at_end() : m_i == it.m_i; }
+			bool operator!=(const vertex_iterator& it) const { return !(*this == it); }
+		private:
+			const ArenaGraph* m_g = 0;
+			size_t m_i = ~size_t(0);
+			bool at_end() const { return !m_g || m_i >= m_g->m_verts.size(); }
+			void skip() { while (!at_end() && !m_g->m_verts[m_i].alive) ++m_i; }
+		};
+
+		class edge_iterator
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef edge_descriptor value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const edge_descriptor* pointer;
+			typedef edge_descriptor reference;
+
+			edge_iterator() {}
+			edge_iterator(const ArenaGraph* g, size_t i) : m_g(g), m_i(i) { skip(); }
+			edge_descriptor operator*() const { return m_g->make_edge(static_cast<unsigned int>(m_i)); }
+			edge_iterator& operator++() { ++m_i; skip(); return *this; }
+			edge_iterator operator++(int) { edge_iterator t = *this; ++*this; return t; }
+			bool operator==(const edge_iterator& it) const { return at_end() ? it.at_end() : m_i == it.m_i; }
+			bool operator!=(const edge_iterator& it) const { return !(*this == it); }
+		private:
+			const ArenaGraph* m_g = 0;
+			size_t m_i = ~size_t(0);
+			bool at_end() const { return !m_g || m_i >= m_g->m_edges.size(); }
+			void skip() { while (!at_end() && !m_g->m_edges[m_i].alive) ++m_i; }
+		};
+
+		class out_edge_iterator
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef edge_descriptor value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const edge_descriptor* pointer;
+			typedef edge_descriptor reference;
+
+			out_edge_iterator() {}
+			out_edge_iterator(const ArenaGraph* g, vertex_descriptor v, size_t i) : m_g(g), m_v(v), m_i(i) {}
+			edge_descriptor operator*() const { return m_g->make_edge(m_v, m_g->m_verts[m_v].out[m_i]); }
+			out_edge_iterator& operator++() { ++m_i; return *this; }
+			out_edge_iterator operator++(int) { out_edge_iterator t = *this; ++*this; return t; }
+			bool operator==(const out_edge_iterator& it) const { return at_end() ? it.at_end() : m_i == it.m_i; }
+			bool operator!=(const out_edge_iterator& it) const { return !(*this == it); }
+		protected:
+			const ArenaGraph* m_g = 0;
+			vertex_descriptor m_v = ~0u;
+			size_t m_i = ~size_t(0);
+			bool at_end() const { return !m_g || m_i >= m_g->m_verts[m_v].out.size(); }
+		};
+
+		class adjacency_iterator : public out_edge_iterator
+		{
+		public:
+			typedef vertex_descriptor value_type;
+			typedef const vertex_descriptor* pointer;
+			typedef vertex_descriptor reference;
+
+			adjacency_iterator() {}
+			adjacency_iterator(const ArenaGraph* g, vertex_descriptor v, size_t i) : out_edge_iterator(g, v, i) {}
+			vertex_descriptor operator*() const { return out_edge_iterator::operator*().tgt; }
+			adjacency_iterator& operator++() { out_edge_iterator::operator++(); return *this; }
+			adjacency_iterator operator++(int) { adjacency_iterator t = *this; ++*this; return t; }
+		};
+
+		ArenaGraph() : m_vert_num(0), m_edge_num(0) {}
+
+		VP& operator[](vertex_descriptor v) { return m_verts[v].prop; }
+		const VP& operator[](vertex_descriptor v) const { return m_verts[v].prop; }
+		EP& operator[](const edge_descriptor& e) { return m_edges[e.idx].prop; }
+		const EP& operator[](const edge_descriptor& e) const { return m_edges[e.idx].prop; }
+
+		vertex_descriptor add_vertex()
+		{
+			m_vert_num++;
+			if (!m_free_verts.empty())
+			{
+				unsigned int v = m_free_verts.back();
+				m_free_verts.pop_back();
+				m_verts[v].alive = true;
+				return v;
+			}
+			m_verts.push_back(VertRec{ VP(), {}, true });
+			return static_cast<vertex_descriptor>(m_verts.size() - 1);
+		}
+
+		//removes the incident edges as well
+		void remove_vertex(vertex_descriptor v)
+		{
+			if (v >= m_verts.size() || !m_verts[v].alive)
+				return;
+			while (!m_verts[v].out.empty())
+				remove_edge(make_edge(v, m_verts[v].out.back()));
+			m_verts[v].alive = false;
+			m_verts[v].prop = VP();
+			std::vector<unsigned int>().swap(m_verts[v].out);
+			m_free_verts.push_back(v);
+			m_vert_num--;
+		}
+
+		std::pair<edge_descriptor, bool> add_edge(vertex_descriptor u, vertex_descriptor v)
+		{
+			unsigned int idx;
+			if (!m_free_edges.empty())
+			{
+				idx = m_free_edges.back();
+				m_free_edges.pop_back();
+				m_edges[idx] = EdgeRec{ EP(), u, v, true };
+			}
+			else
+			{
+				idx = static_cast<unsigned int>(m_edges.size());
+				m_edges.push_back(EdgeRec{ EP(), u, v, true });
+			}
+			m_verts[u].out.push_back(idx);
+			if (u != v)
+				m_verts[v].out.push_back(idx);
+			m_edge_num++;
+			return std::make_pair(make_edge(u, idx), true);
+		}
+
+		std::pair<edge_descriptor, bool> edge(vertex_descriptor u, vertex_descriptor v) const
+		{
+			if (u < m_verts.size() && v < m_verts.size())
+			{
+				for (unsigned int idx : m_verts[u].out)
+				{
+					const EdgeRec& e = m_edges[idx];
+					if ((e.src == u && e.tgt == v) ||
+						(e.src == v && e.tgt == u))
+						return std::make_pair(make_edge(u, idx), true);
+				}
+			}
+			return std::make_pair(edge_descriptor(), false);
+		}
+
+		void remove_edge(const edge_descriptor& e)
+		{
+			if (e.idx >= m_edges.size() || !m_edges[e.idx].alive)
+				return;
+			EdgeRec& rec = m_edges[e.idx];
+			unlink(rec.src, e.idx);
+			if (rec.tgt != rec.src)
+				unlink(rec.tgt, e.idx);
+			rec.alive = false;
+			rec.prop = EP();
+			m_free_edges.push_back(e.idx);
+			m_edge_num--;
+		}
+
+		void clear()
+		{
+			m_verts.clear();
+			m_edges.clear();
+			m_free_verts.clear();
+			m_free_edges.clear();
+			m_vert_num = 0;
+			m_edge_num = 0;
+		}
+
+		size_t num_vertices() const { return m_vert_num; }
+		size_t num_edges() const { return m_edge_num; }
+		size_t degree(vertex_descriptor v) const { return m_verts[v].out.size(); }
+
+		vertex_iterator vertices_begin() const { return vertex_iterator(this, 0); }
+		vertex_iterator vertices_end() const { return vertex_iterator(this, ~size_t(0)); }
+		edge_iterator edges_begin() const { return edge_iterator(this, 0); }
+		edge_iterator edges_end() const { return edge_iterator(this, ~size_t(0)); }
+		out_edge_iterator out_begin(vertex_descriptor v) const { return out_edge_iterator(this, v, 0); }
+		out_edge_iterator out_end(vertex_descriptor v) const { return out_edge_iterator(this, v, ~size_t(0)); }
+		adjacency_iterator adj_begin(vertex_descriptor v) const { return adjacency_iterator(this, v, 0); }
+		adjacency_iterator adj_end(vertex_descriptor v) const { return adjacency_iterator(this, v, ~size_t(0)); }
+
+		edge_descriptor make_edge(vertex_descriptor from, unsigned int idx) const
+		{
+			const EdgeRec& e = m_edges[idx];
+			edge_descriptor ed;
+			ed.src = from;
+			ed.tgt = e.src == from ? e.tgt : e.src;
+			ed.idx = idx;
+			return ed;
+		}
+
+	private:
+		std::vector<VertRec> m_verts;
+		std::vector<EdgeRec> m_edges;
+		std::vector<unsigned int> m_free_verts;//removed slots to reuse
+		std::vector<unsigned int> m_free_edges;
+		size_t m_vert_num;
+		size_t m_edge_num;
+
+		edge_descriptor make_edge(unsigned int idx) const
+		{
+			edge_descriptor ed;
+			ed.src = m_edges[idx].src;
+			ed.tgt = m_edges[idx].tgt;
+			ed.idx = idx;
+			return ed;
+		}
+
+		void unlink(vertex_descriptor v, unsigned int idx)
+		{
+			std::vector<unsigned int>& out = m_verts[v].out;
+			for (size_t i = 0; i < out.size(); ++i)
+			{
+				if (out[i] == idx)
+				{
+					out.erase(out.begin() + i);
+					break;
+				}
+			}
+		}
+	};
+
+	//free functions of the boost graph interface
+	template <typename VP, typename EP>
+	inline typename ArenaGraph<VP, EP>::vertex_descriptor add_vertex(ArenaGraph<VP, EP>& g)
+	{
+		return g.add_vertex();
+	}
+
+	template <typename VP, typename EP>
+	inline void remove_vertex(typename ArenaGraph<VP, EP>::vertex_descriptor v, ArenaGraph<VP, EP>& g)
+	{
+		g.remove_vertex(v);
+	}
+
+	template <typename VP, typename EP>
+	inline std::pair<typename ArenaGraph<VP, EP>::edge_descriptor, bool> add_edge(
+		typename ArenaGraph<VP, EP>::vertex_descriptor u,
+		typename ArenaGraph<VP, EP>::vertex_descriptor v,
+		ArenaGraph<VP, EP>& g)
+	{
+		return g.add_edge(u, v);
+	}
+
+	template <typename VP, typename EP>
+	inline std::pair<typename ArenaGraph<VP, EP>::edge_descriptor, bool> edge(
+		typename ArenaGraph<VP, EP>::vertex_descriptor u,
+		typename ArenaGraph<VP, EP>::vertex_descriptor v,
+		const ArenaGraph<VP, EP>& g)
+	{
+		return g.edge(u, v);
+	}
+
+	template <typename VP, typename EP>
+	inline void remove_edge(const typename ArenaGraph<VP, EP>::edge_descriptor& e, ArenaGraph<VP, EP>& g)
+	{
+		g.remove_edge(e);
+	}
+
+	template <typename VP, typename EP>
+	inline typename ArenaGraph<VP, EP>::vertex_descriptor source(
+		const typename ArenaGraph<VP, EP>::edge_descriptor& e, const ArenaGraph<VP, EP>&)
+	{
+		return e.src;
+	}
+
+	template <typename VP, typename EP>
+	inline typename ArenaGraph<VP, EP>::vertex_descriptor target(
+		const typename ArenaGraph<VP, EP>::edge_descriptor& e, const ArenaGraph<VP, EP>&)
+	{
+		return e.tgt;
+	}
+
+	template <typename VP, typename EP>
+	inline std::pair<typename ArenaGraph<VP, EP>::vertex_iterator,
+		typename ArenaGraph<VP, EP>::vertex_iterator> vertices(const ArenaGraph<VP, EP>& g)
+	{
+		return std::make_pair(g.vertices_begin(), g.vertices_end());
+	}
+
+	template <typename VP, typename EP>
+	inline std::pair<typename ArenaGraph<VP, EP>::edge_iterator,
+		typename ArenaGraph<VP, EP>::edge_iterator> edges(const ArenaGraph<VP, EP>& g)
+	{
+		return std::make_pair(g.edges_begin(), g.edges_end());
+	}
+
+	template <typename VP, typename EP>
+	inline std::pair<typename ArenaGraph<VP, EP>::out_edge_iterator,
+		typename ArenaGraph<VP, EP>::out_edge_iterator> out_edges(
+		typename ArenaGraph<VP, EP>::vertex_descriptor v, const ArenaGraph<VP, EP>& g)
+	{
+		return std::make_pair(g.out_begin(v), g.out_end(v));
+	}
+
+	template <typename VP, typename EP>
+	inline std::pair<typename ArenaGraph<VP, EP>::adjacency_iterator,
+		typename ArenaGraph<VP, EP>::adjacency_iterator> adjacent_vertices(
+		typename ArenaGraph<VP, EP>::vertex_descriptor v, const ArenaGraph<VP, EP>& g)
+	{
+		return std::make_pair(g.adj_begin(v), g.adj_end(v));
+	}
+
+	template <typename VP, typename EP>
+	inline size_t num_vertices(const ArenaGraph<VP, EP>& g)
+	{
+		return g.num_vertices();
+	}
+
+	template <typename VP, typename EP>
+	inline size_t num_edges(const ArenaGraph<VP, EP>& g)
+	{
+		return g.num_edges();
+	}
+
+	template <typename VP, typename EP>
+	inline size_t out_degree(typename ArenaGraph<VP, EP>::vertex_descriptor v, const ArenaGraph<VP, EP>& g)
+	{
+		return g.degree(v);
+	}
+}
+
+//make the functions visible to qualified boost:: calls
+namespace boost
+{
+	using flrd::add_vertex;
+	using flrd::remove_vertex;
+	using flrd::add_edge;
+	using flrd::edge;
+	using flrd::remove_edge;
+	using flrd::source;
+	using flrd::target;
+	using flrd::vertices;
+	using flrd::edges;
+	using flrd::out_edges;
+	using flrd::adjacent_vertices;
+	using flrd::num_vertices;
+	using flrd::num_edges;
+	using flrd::out_degree;
+}
+
+#endif//FL_ArenaGraph_h
@@ -33,9 +33,8 @@ DEALINGS IN THE SOFTWARE.
 #include <Color.h>
 #include <Pca.h>
 #include <memory>
-#include <boost/graph/graph_traits.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/adjacency_iterator.hpp>
+#include <unordered_map>
+#include <ArenaGraph.h>
 
 namespace flrd
 {
@@ -92,12 +91,8 @@ namespace flrd
 		Celw cell;
 	};
 
-	//typedef boost::adjacency_list<boost::listS,
-	//	boost::listS, boost::undirectedS,
-	//	CelNode, CelEdgeNode> CellGraph;
-	class CellGraph : public boost::adjacency_list<boost::listS,
-		boost::listS, boost::undirectedS,
-		CelNode, CelEdgeNode>
+	//links of cells, with vertices and edges in flat arrays
+	class CellGraph : public ArenaGraph<CelNode, CelEdgeNode>
 	{
 	public:
 		bool Visited(Celp &celp);
@@ -254,6 +249,13 @@ namespace flrd
 		void SetBox(const fluo::BBox &box);
 		void SetProjp(fluo::Point &p);
 		void SetDistp(double dist);
+		//set accumulated statistics directly
+		void SetStats(unsigned int size_ui, double size_d,
+			unsigned int ext_ui, double ext_d,
+			double int2, double vmin, double vmax,
+			const fluo::Point& pos, const fluo::BBox& box);
+		void SetCoSize(const std::vector<unsigned int>& sumi,
+			const std::vector<double>& sumd);
 
 	private:
 		unsigned int m_id;
@@ -649,6 +651,30 @@ namespace flrd
 		m_distp = dist;
 	}
 
+	inline void Cell::SetStats(unsigned int size_ui, double size_d,
+		unsigned int ext_ui, double ext_d,
+		double int2, double vmin, double vmax,
+		const fluo::Point& pos, const fluo::BBox& box)
+	{
+		m_size_ui = size_ui;
+		m_size_d = size_d;
+		m_ext_ui = ext_ui;
+		m_ext_d = ext_d;
+		m_int2 = int2;
+		m_min = vmin;
+		m_max = vmax;
+		m_pos = pos;
+		m_box = box;
+		m_calc = false;
+	}
+
+	inline void Cell::SetCoSize(const std::vector<unsigned int>& sumi,
+		const std::vector<double>& sumd)
+	{
+		m_size_ui_list = sumi;
+		m_size_d_list = sumd;
+	}
+
 	inline void Cell::SetUseD(bool val)
 	{
 		m_use_d = val;
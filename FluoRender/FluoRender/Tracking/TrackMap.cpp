@@ -48,20 +48,153 @@ DEALINGS IN THE SOFTWARE.
 #include <VertexArray.h>
 #include <Ruler.h>
 #include <VolCache4D.h>
+#include <CompStats.h>
+#include <Parallel.h>
 #include <functional>
+#include <future>
+#include <sstream>
+#include <unordered_map>
 #include <algorithm>
 #include <limits>
 #include <boost/qvm/vec_access.hpp>
 
 using namespace flrd;
 
+namespace
+{
+	//per label sums over a slab of rows in one frame
+	struct FrameSlab
+	{
+		flrd::LabelIndexMap map;
+		std::vector<unsigned int> id;
+		std::vector<unsigned int> size_ui;
+		std::vector<unsigned int> ext_ui;
+		std::vector<double> size_d;
+		std::vector<double> ext_d;
+		std::vector<double> int2;
+		std::vector<double> vmax;
+		std::vector<double> pos;//x, y, z per label
+		std::vector<int> bmin;
+		std::vector<int> bmax;
+		//contacts of two labels in the order of first occurrence
+		//keyed by the unordered pair, stored as first id << 32 | second id
+		std::unordered_map<unsigned long long, size_t> pair_map;
+		std::vector<unsigned long long> pair;
+		std::vector<unsigned int> pair_ui;
+		std::vector<double> pair_d;
+		unsigned long long last_key = 0;
+		size_t last_pair = 0;
+
+		size_t find_add(unsigned int lid)
+		{
+			bool inserted;
+			size_t l = map.insert(lid, static_cast<unsigned int>(id.size()), inserted);
+			if (inserted)
+			{
+				id.push_back(lid);
+				size_ui.push_back(0);
+				ext_ui.push_back(0);
+				size_d.push_back(0.0);
+				ext_d.push_back(0.0);
+				int2.push_back(0.0);
+				vmax.push_back(0.0);
+				for (int a = 0; a < 3; ++a)
+				{
+					pos.push_back(0.0);
+					bmin.push_back(std::numeric_limits<int>::max());
+					bmax.push_back(std::numeric_limits<int>::min());
+				}
+			}
+			return l;
+		}
+
+		void add_pair(unsigned int id1, unsigned int id2,
+			unsigned int count, double value)
+		{
+			unsigned long long key = id1 < id2 ?
+				(unsigned long long)id1 << 32 | id2 :
+				(unsigned long long)id2 << 32 | id1;
+			if (key != last_key)
+			{
+				auto it = pair_map.try_emplace(key, pair.size());
+				if (it.second)
+				{
+					pair.push_back((unsigned long long)id1 << 32 | id2);
+					pair_ui.push_back(0);
+					pair_d.push_back(0.0);
+				}
+				last_key = key;
+				last_pair = it.first->second;
+			}
+			pair_ui[last_pair] += count;
+			pair_d[last_pair] += value;
+		}
+
+		//src follows in memory order
+		void merge(const FrameSlab& src)
+		{
+			for (size_t s = 0; s < src.id.size(); ++s)
+			{
+				size_t l = find_add(src.id[s]);
+				size_ui[l] += src.size_ui[s];
+				ext_ui[l] += src.ext_ui[s];
+				size_d[l] += src.size_d[s];
+				ext_d[l] += src.ext_d[s];
+				int2[l] += src.int2[s];
+				vmax[l] = std::max(vmax[l], src.vmax[s]);
+				for (size_t a = 0; a < 3; ++a)
+				{
+					pos[l * 3 + a] += src.pos[s * 3 + a];
+					bmin[l * 3 + a] = std::min(bmin[l * 3 + a], src.bmin[s * 3 + a]);
+					bmax[l * 3 + a] = std::max(bmax[l * 3 + a], src.bmax[s * 3 + a]);
+				}
+			}
+			for (size_t p = 0; p < src.pair.size(); ++p)
+				add_pair(static_cast<unsigned int>(src.pair[p] >> 32),
+					static_cast<unsigned int>(src.pair[p] & 0xffffffff),
+					src.pair_ui[p], src.pair_d[p]);
+		}
+	};
+
+	//overlaps of labels in two frames, keyed by first id << 32 | second id
+	struct OverlapSlab
+	{
+		std::unordered_map<unsigned long long, size_t> pair_map;
+		std::vector<unsigned long long> pair;
+		std::vector<unsigned int> pair_ui;
+		std::vector<double> pair_d;
+		unsigned long long last_key = ~0ull;
+		size_t last_pair = 0;
+
+		void add_pair(unsigned long long key,
+			unsigned int count, double value)
+		{
+			if (key != last_key)
+			{
+				auto it = pair_map.try_emplace(key, pair.size());
+				if (it.second)
+				{
+					pair.push_back(key);
+					pair_ui.push_back(0);
+					pair_d.push_back(0.0);
+				}
+				last_key = key;
+				last_pair = it.first->second;
+			}
+			pair_ui[last_pair] += count;
+			pair_d[last_pair] += value;
+		}
+	};
+}
+
 TrackMap::TrackMap() :
 	m_counter(0),
 	m_frame_num(0),
 	m_size(0),
 	m_data_bits(8),
 	m_scale(1.0f),
-	m_spacing(1.0)
+	m_spacing(1.0),
+	m_load_failed(false)
 {
 }
 
@@ -125,32 +258,39 @@ void TrackMapProcessor::GenMap()
 	//start timing
 	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
 	//initialization
-	for (int i = 0; i < frames; ++i)
+	size_t ahead = glbin_settings.m_track_ahead > 0 ?
+		static_cast<size_t>(glbin_settings.m_track_ahead) : 0;
+	if (ahead && frames > 1)
+		PipelineFrames(frames, ahead, count, ticks, info_str);
+	else
 	{
-		InitializeFrame(i);
-		WriteInfo(L"Time point " + std::to_wstring(i) + L" initialized.\n");
-		SetProgress(static_cast<int>(100.0 * count / ticks), info_str);
-		count++;
+		for (int i = 0; i < frames; ++i)
+		{
+			InitializeFrame(i);
+			WriteInfo(L"Time point " + std::to_wstring(i) + L" initialized.\n");
+			SetProgress(static_cast<int>(100.0 * count / ticks), info_str);
+			count++;
 
-		if (i < 1)
-			continue;
+			if (i < 1)
+				continue;
 
-		//link maps 1 and 2
-		LinkFrames(i - 1, i);
-		WriteInfo(L"Time point " + std::to_wstring(i) + L" linked.\n");
+			//link maps 1 and 2
+			LinkFrames(i - 1, i);
+			WriteInfo(L"Time point " + std::to_wstring(i) + L" linked.\n");
 
-		//check contacts and merge cells
-		ResolveGraph(i - 1, i);
-		ResolveGraph(i, i - 1);
-		WriteInfo(L"Time point " + std::to_wstring(i) + L" merged.\n");
+			//check contacts and merge cells
+			ResolveGraph(i - 1, i);
+			ResolveGraph(i, i - 1);
+			WriteInfo(L"Time point " + std::to_wstring(i) + L" merged.\n");
 
-		if (i < 2)
-			continue;
+			if (i < 2)
+				continue;
 
-		//further process
-		ProcessFrames(i - 2, i - 1);
-		ProcessFrames(i - 1, i - 2);
-		WriteInfo(L"Time point " + std::to_wstring(i) + L" processed.\n");
+			//further process
+			ProcessFrames(i - 2, i - 1);
+			ProcessFrames(i - 1, i - 2);
+			WriteInfo(L"Time point " + std::to_wstring(i) + L" processed.\n");
+		}
 	}
 	//last frame
 	ProcessFrames(frames - 2, frames - 1);
@@ -197,6 +337,110 @@ void TrackMapProcessor::GenMap()
 	view->GetTraces(false);
 }
 
+void TrackMapProcessor::PipelineFrames(int frames, size_t ahead,
+	size_t& count, size_t ticks, const std::string& info_str)
+{
+	auto vd = glbin_current.vol_data.lock();
+	if (!vd)
+		return;
+	flvr::CacheQueue* cache_queue = glbin_data_manager.GetCacheQueue(vd.get());
+	if (!cache_queue)
+		return;
+	//frames in flight stay protected, keep room for loading
+	cache_queue->set_max_size(std::max(cache_queue->get_max_size(), ahead + 4));
+	unsigned int tn = std::max(GetThreadNum() / static_cast<unsigned int>(ahead + 1), 1u);
+
+	struct Job
+	{
+		void* data = 0;
+		unsigned int* label = 0;
+		FrameScan scan;
+		FrameOverlap overlap;//with the previous frame
+		std::shared_future<void> scanned;
+		std::future<void> linked;
+	};
+	std::vector<Job> jobs(frames);
+
+	//loading stays on this thread, the cache queue is not thread safe
+	int launched = 0;
+	auto launch = [&](int f)
+	{
+		Job& job = jobs[f];
+		flvr::VolCache4D* cache = cache_queue->get(f);
+		if (cache)
+		{
+			job.data = cache->GetRawData();
+			job.label = (unsigned int*)cache->GetRawLabel();
+		}
+		if (!job.data || !job.label)
+			return;
+		cache_queue->protect(f);
+		job.scanned = std::async(std::launch::async, [this, &job, tn]()
+		{
+			ScanFrame(job.data, job.label, job.scan, tn);
+		}).share();
+		if (f < 1 || !jobs[f - 1].scanned.valid())
+			return;
+		//pruned labels of both frames are needed
+		Job& prev = jobs[f - 1];
+		job.linked = std::async(std::launch::async, [this, &prev, &job, tn]()
+		{
+			prev.scanned.wait();
+			job.scanned.wait();
+			ScanOverlap(prev.data, prev.label, job.data, job.label,
+				job.overlap, tn);
+		});
+	};
+
+	//commit in the order of the sequential loop
+	for (int i = 0; i < frames; ++i)
+	{
+		for (; launched < frames &&
+			static_cast<size_t>(launched) <= i + ahead; ++launched)
+			launch(launched);
+
+		Job& job = jobs[i];
+		if (job.scanned.valid())
+		{
+			job.scanned.get();
+			//label modified, save before delete
+			cache_queue->set_modified(i);
+			AddFrame(job.scan);
+		}
+		WriteInfo(L"Time point " + std::to_wstring(i) + L" initialized.\n");
+		SetProgress(static_cast<int>(100.0 * count / ticks), info_str);
+		count++;
+
+		if (i < 1)
+			continue;
+
+		//link maps 1 and 2
+		if (job.linked.valid())
+		{
+			job.linked.get();
+			LinkOverlap(i - 1, i, job.overlap);
+		}
+		cache_queue->unprotect(i - 1);
+		jobs[i - 1] = Job();
+		WriteInfo(L"Time point " + std::to_wstring(i) + L" linked.\n");
+
+		//check contacts and merge cells
+		ResolveGraph(i - 1, i);
+		ResolveGraph(i, i - 1);
+		WriteInfo(L"Time point " + std::to_wstring(i) + L" merged.\n");
+
+		if (i < 2)
+			continue;
+
+		//further process
+		ProcessFrames(i - 2, i - 1);
+		ProcessFrames(i - 1, i - 2);
+		WriteInfo(L"Time point " + std::to_wstring(i) + L" processed.\n");
+	}
+	if (frames > 0)
+		cache_queue->unprotect(frames - 1);
+}
+
 void TrackMapProcessor::RefineMap(int t, bool erase_v)
 {
 	auto view = glbin_current.render_view.lock();
@@ -353,217 +597,216 @@ bool TrackMapProcessor::InitializeFrame(size_t frame)
 	if (!cache)
 		return false;
 	void* data = cache->GetRawData();
-	void* label = cache->GetRawLabel();
+	unsigned int* label = (unsigned int*)cache->GetRawLabel();
 	if (!data || !label)
 		return false;
 
-	//add one empty cell list to track_map
-	m_map->m_celp_list.push_back(CelpList());
-	CelpList &cell_list = m_map->m_celp_list.back();
-	CelpListIter iter;
-	//in the meanwhile build the intra graph
-	m_map->m_intra_graph_list.push_back(CellGraph());
+	FrameScan scan;
+	ScanFrame(data, label, scan, 0);
+	//label modified, save before delete
+	cache_queue->set_modified(frame);
+	AddFrame(scan);
+	return true;
+}
 
-	size_t index;
-	size_t i, j, k;
+void TrackMapProcessor::ScanFrame(void* data, unsigned int* label,
+	FrameScan& scan, unsigned int thread_num)
+{
 	size_t nx = m_map->m_size.intx();
 	size_t ny = m_map->m_size.inty();
 	size_t nz = m_map->m_size.intz();
-	float data_value;
-	unsigned int label_value;
-
-	//build cell list
-	for (i = 0; i < nx; ++i)
-	for (j = 0; j < ny; ++j)
-	for (k = 0; k < nz; ++k)
-	{
-		index = nx*ny*k + nx*j + i;
-		label_value = ((unsigned int*)label)[index];
-
-		if (!label_value)
-			continue;
+	size_t nxy = nx * ny;
+	size_t rows = ny * nz;
+	size_t data_bits = m_map->m_data_bits;
+	float scale = m_map->m_scale;
+	float contact_thresh = m_contact_thresh;
+	auto get_value = [&](size_t index)
+	{
+		if (data_bits == 8)
+			return ((unsigned char*)data)[index] / 255.0f;
+		else if (data_bits == 16)
+			return ((unsigned short*)data)[index] * scale / 65535.0f;
+		return 0.0f;
+	};
+
+	//one sweep in memory order for cell sizes, surfaces and contacts
+	unsigned int tn = GetThreadNum(thread_num);
+	if (tn > rows)
+		tn = static_cast<unsigned int>(std::max(rows, size_t(1)));
+	std::vector<FrameSlab> slabs(tn);
+	ParallelFor(rows, [&](size_t r0, size_t r1, unsigned int t)
+	{
+		FrameSlab& st = slabs[t];
+		unsigned int last_id = 0;
+		size_t l = 0;
+		for (size_t r = r0; r < r1; ++r)
+		{
+			size_t k = r / ny;
+			size_t j = r % ny;
+			size_t index = r * nx;
+			for (size_t i = 0; i < nx; ++i, ++index)
+			{
+				unsigned int id = label[index];
+				if (!id)
+					continue;
+				float value = get_value(index);
 
-		if (m_map->m_data_bits == 8)
-			data_value = ((unsigned char*)data)[index] / 255.0f;
-		else if (m_map->m_data_bits == 16)
-			data_value = ((unsigned short*)data)[index] * m_map->m_scale / 65535.0f;
+				//labels come in runs, skip the lookup
+				if (id != last_id)
+				{
+					l = st.find_add(id);
+					last_id = id;
+				}
+				st.size_ui[l]++;
+				st.size_d[l] += value;
+				st.int2[l] += double(value) * value;
+				st.vmax[l] = std::max(st.vmax[l], double(value));
+				int c[3] = { int(i), int(j), int(k) };
+				for (int a = 0; a < 3; ++a)
+				{
+					st.pos[l * 3 + a] += c[a];
+					st.bmin[l * 3 + a] = std::min(st.bmin[l * 3 + a], c[a]);
+					st.bmax[l * 3 + a] = std::max(st.bmax[l * 3 + a], c[a]);
+				}
 
-		iter = cell_list.find(label_value);
-		if (iter != cell_list.end())
-		{
-			iter->second->Inc(fluo::Point(i, j, k), data_value);
-		}
-		else
-		{
-			Cell* cell = new Cell(label_value);
-			cell->Inc(fluo::Point(i, j, k), data_value);
-			cell_list.insert(std::pair<unsigned int, Celp>
-				(label_value, Celp(cell)));
+				//face neighbors
+				int ec = 0;
+				auto check = [&](bool edge, size_t indexn)
+				{
+					if (edge)
+					{
+						ec++;
+						return;
+					}
+					unsigned int idn = label[indexn];
+					if (idn == id)
+						return;
+					ec++;
+					if (!idn)
+						return;
+					float contact_value = std::min(value, get_value(indexn));
+					if (contact_value > contact_thresh)
+						st.add_pair(id, idn, 1, contact_value);
+				};
+				check(i == 0, index - 1);
+				check(i >= nx - 1, index + 1);
+				check(j == 0, index - nx);
+				check(j >= ny - 1, index + nx);
+				check(k == 0, index - nxy);
+				check(k >= nz - 1, index + nxy);
+				if (ec)
+				{
+					st.ext_ui[l]++;
+					st.ext_d[l] += value;
+				}
+			}
 		}
+	}, tn);
+
+	//reduce in slab order
+	FrameSlab all;
+	for (auto& st : slabs)
+	{
+		all.merge(st);
+		st = FrameSlab();
+	}
+
+	//cells, skipping small ones
+	size_t num = all.id.size();
+	std::vector<unsigned int> cell_index(num, LabelIndexMap::invalid);
+	scan.cells.reserve(num);
+	for (size_t l = 0; l < num; ++l)
+	{
+		Celp celp(new Cell(all.id[l]));
+		//min starts from 0 as in Cell::Inc()
+		celp->SetStats(all.size_ui[l], all.size_d[l],
+			all.ext_ui[l], all.ext_d[l],
+			all.int2[l], 0.0, all.vmax[l],
+			fluo::Point(all.pos[l * 3], all.pos[l * 3 + 1], all.pos[l * 3 + 2]),
+			fluo::BBox(
+				fluo::Point(all.bmin[l * 3], all.bmin[l * 3 + 1], all.bmin[l * 3 + 2]),
+				fluo::Point(all.bmax[l * 3], all.bmax[l * 3 + 1], all.bmax[l * 3 + 2])));
+		if (celp->GetSize() < m_size_thresh)
+			continue;
+		cell_index[l] = static_cast<unsigned int>(scan.cells.size());
+		scan.cells.push_back(celp);
 	}
 
-	//prune list
-	for (auto celli = cell_list.begin();
-		celli != cell_list.end(); )
-	{
-		if (celli->second->GetSize() < m_size_thresh)
-			celli = cell_list.erase(celli);
-		else
-			++celli;
-	}
 	//prune data
-	size_t tsize = nx * ny * nz;
-	for (index = 0; index < tsize; ++index)
+	if (scan.cells.size() < num)
 	{
-		label_value = ((unsigned int*)label)[index];
-		if (label_value &&
-			cell_list.find(label_value) ==
-			cell_list.end())
-			((unsigned int*)label)[index] = 0;
+		ParallelFor(nxy * nz, [&](size_t i0, size_t i1, unsigned int)
+		{
+			unsigned int last_id = 0;
+			bool keep = true;
+			for (size_t index = i0; index < i1; ++index)
+			{
+				unsigned int id = label[index];
+				if (!id)
+					continue;
+				if (id != last_id)
+				{
+					keep = cell_index[all.map.find(id)] != LabelIndexMap::invalid;
+					last_id = id;
+				}
+				if (!keep)
+					label[index] = 0;
+			}
+		}, tn);
 	}
-	//label modified, save before delete
-	cache_queue->set_modified(frame);
 
-	//build intra graph
-	for (i = 0; i < nx; ++i)
-	for (j = 0; j < ny; ++j)
-	for (k = 0; k < nz; ++k)
+	//contacts between remaining cells
+	for (size_t p = 0; p < all.pair.size(); ++p)
 	{
-		index = nx*ny*k + nx*j + i;
-		label_value = ((unsigned int*)label)[index];
-		if (!label_value)
+		unsigned int c1 = cell_index[all.map.find(
+			static_cast<unsigned int>(all.pair[p] >> 32))];
+		unsigned int c2 = cell_index[all.map.find(
+			static_cast<unsigned int>(all.pair[p] & 0xffffffff))];
+		if (c1 == LabelIndexMap::invalid ||
+			c2 == LabelIndexMap::invalid)
 			continue;
-
-		iter = cell_list.find(label_value);
-		if (iter != cell_list.end())
-		{
-			CheckCellContact(iter->second, data, label,
-				i, j, k);
-		}
+		scan.pairs.push_back((unsigned long long)c1 << 32 | c2);
+		scan.pair_ui.push_back(all.pair_ui[p]);
+		scan.pair_d.push_back(all.pair_d[p]);
 	}
+}
+
+void TrackMapProcessor::AddFrame(FrameScan& scan)
+{
+	//add one cell list to track_map
+	m_map->m_celp_list.push_back(CelpList());
+	CelpList &cell_list = m_map->m_celp_list.back();
+	//in the meanwhile build the intra graph
+	m_map->m_intra_graph_list.push_back(CellGraph());
+	CellGraph &intra_graph = m_map->m_intra_graph_list.back();
+
+	cell_list.reserve(scan.cells.size());
+	for (auto& celp : scan.cells)
+		cell_list.insert(std::pair<unsigned int, Celp>
+			(celp->Id(), celp));
+	for (size_t p = 0; p < scan.pairs.size(); ++p)
+		AddContact(intra_graph,
+			scan.cells[scan.pairs[p] >> 32],
+			scan.cells[scan.pairs[p] & 0xffffffff],
+			scan.pair_d[p], scan.pair_ui[p]);
 
 	//build vertex list
 	m_map->m_vertices_list.push_back(VertexList());
 	VertexList &vertex_list = m_map->m_vertices_list.back();
-	for (iter = cell_list.begin();
-	iter != cell_list.end(); ++iter)
+	for (auto& celp : scan.cells)
 	{
-		if (iter->second->GetSize() < m_size_thresh)
-			continue;
-		Verp vertex(new Vertex(iter->second->Id()));
-		vertex->SetCenter(iter->second->GetCenter());
-		vertex->SetSizeUi(iter->second->GetSizeUi());
-		vertex->SetSizeD(iter->second->GetSizeD());
-		vertex->AddCell(iter->second);
-		iter->second->AddVertex(vertex);
+		Verp vertex(new Vertex(celp->Id()));
+		vertex->SetCenter(celp->GetCenter());
+		vertex->SetSizeUi(celp->GetSizeUi());
+		vertex->SetSizeD(celp->GetSizeD());
+		vertex->AddCell(celp);
+		celp->AddVertex(vertex);
 		vertex_list.insert(std::pair<unsigned int, Verp>
 			(vertex->Id(), vertex));
 	}
 
 	m_map->m_frame_num++;
-	return true;
-}
-
-#define ADD_CONTACT \
-	idn = ((unsigned int*)label)[indexn]; \
-	if (!idn) \
-		ec++; \
-		else if (idn != id) \
-	{ \
-		ec++; \
-		if (data_bits == 8) \
-			valuen = ((unsigned char*)data)[indexn] / 255.0f; \
-		else if (data_bits == 16) \
-			valuen = ((unsigned short*)data)[indexn] * scale / 65535.0f; \
-		contact_value = std::min(value, valuen); \
-		if (contact_value > m_contact_thresh) \
-		{ \
-			cc++; \
-			iter = cell_list.find(idn); \
-			if (iter != cell_list.end()) \
-				AddContact(intra_graph, celp, iter->second, contact_value); \
-		} \
-	}
-
-bool TrackMapProcessor::CheckCellContact(
-	Celp &celp, void *data, void *label,
-	size_t ci, size_t cj, size_t ck)
-{
-	int ec = 0;//external count
-	int cc = 0;//contact count
-	size_t nx = m_map->m_size.intx();
-	size_t ny = m_map->m_size.inty();
-	size_t nz = m_map->m_size.intz();
-	size_t indexn;//neighbor index
-	unsigned int idn;//neighbor id
-	float valuen;//neighbor vlaue
-	size_t index = nx*ny*ck + nx*cj + ci;
-	unsigned int id = celp->Id();
-	float value;
-	size_t data_bits = m_map->m_data_bits;
-	float scale = m_map->m_scale;
-	if (data_bits == 8)
-		value = ((unsigned char*)data)[index] / 255.0f;
-	else if (data_bits == 16)
-		value = ((unsigned short*)data)[index] * scale / 65535.0f;
-	float contact_value;
-	CellGraph &intra_graph = m_map->m_intra_graph_list.back();
-	CelpList &cell_list = m_map->m_celp_list.back();
-	CelpListIter iter;
-
-	if (ci == 0)
-		ec++;
-	else
-	{
-		indexn = index - 1;
-		ADD_CONTACT;
-	}
-	if (ci >= nx - 1)
-		ec++;
-	else
-	{
-		indexn = index + 1;
-		ADD_CONTACT;
-	}
-	if (cj == 0)
-		ec++;
-	else
-	{
-		indexn = index - nx;
-		ADD_CONTACT;
-	}
-	if (cj >= ny - 1)
-		ec++;
-	else
-	{
-		indexn = index + nx;
-		ADD_CONTACT;
-	}
-	if (ck == 0)
-		ec++;
-	else
-	{
-		indexn = index - nx*ny;
-		ADD_CONTACT;
-	}
-	if (ck >= nz - 1)
-		ec++;
-	else
-	{
-		indexn = index + nx*ny;
-		ADD_CONTACT;
-	}
-
-	if (ec)
-	{
-		celp->IncExt(value);
-
-		//expand search range if it's external but not contacting
-		//if (cc == 0)
-		//	CheckCellDist(cell, label, ci, cj, ck);
-	}
-
-	return true;
+	scan = FrameScan();
 }
 
 bool TrackMapProcessor::CheckCellDist(
@@ -610,7 +853,8 @@ bool TrackMapProcessor::CheckCellDist(
 }
 
 bool TrackMapProcessor::AddContact(CellGraph& graph,
-	Celp &celp1, Celp &celp2, float contact_value)
+	Celp &celp1, Celp &celp2, double contact_value,
+	unsigned int count)
 {
 	CelVrtx v1 = celp1->GetCelVrtx();
 	CelVrtx v2 = celp2->GetCelVrtx();
@@ -633,14 +877,14 @@ bool TrackMapProcessor::AddContact(CellGraph& graph,
 	if (!e.second)
 	{
 		e = boost::add_edge(v1, v2, graph);
-		graph[e.first].size_ui = 1;
+		graph[e.first].size_ui = count;
 		graph[e.first].size_d = contact_value;
 		graph[e.first].dist_v = 0.0f;
 		graph[e.first].dist_s = 0.0f;
 	}
 	else
 	{
-		graph[e.first].size_ui++;
+		graph[e.first].size_ui += count;
 		graph[e.first].size_d += contact_value;
 		graph[e.first].dist_v = 0.0f;
 		graph[e.first].dist_s = 0.0f;
@@ -712,59 +956,93 @@ bool TrackMapProcessor::LinkFrames(
 	if (!cache)
 		return false;
 	void* data1 = cache->GetRawData();
-	void* label1 = cache->GetRawLabel();
+	unsigned int* label1 = (unsigned int*)cache->GetRawLabel();
 	if (!data1 || !label1)
 		return false;
 	cache = cache_queue->get(f2);
 	if (!cache)
 		return false;
 	void* data2 = cache->GetRawData();
-	void* label2 = cache->GetRawLabel();
+	unsigned int* label2 = (unsigned int*)cache->GetRawLabel();
 	if (!data2 || !label2)
 		return false;
 	cache_queue->protect(f1);
 
-	m_map->m_inter_graph_list.push_back(InterGraph());
-	InterGraph &inter_graph = m_map->m_inter_graph_list.back();
-	inter_graph.index = f1;
-	inter_graph.counter = 0;
+	FrameOverlap overlap;
+	ScanOverlap(data1, label1, data2, label2, overlap, 0);
+	LinkOverlap(f1, f2, overlap);
 
-	size_t index;
-	size_t i, j, k;
-	size_t nx = m_map->m_size.intx();
-	size_t ny = m_map->m_size.inty();
-	size_t nz = m_map->m_size.intz();
-	float data_value1, data_value2;
-	unsigned int label_value1, label_value2;
-	Verp v1, v2;
-	Celp cl1, cl2;
-
-	for (i = 0; i < nx; ++i)
-	for (j = 0; j < ny; ++j)
-	for (k = 0; k < nz; ++k)
-	{
-		index = nx*ny*k + nx*j + i;
-		label_value1 = ((unsigned int*)label1)[index];
-		label_value2 = ((unsigned int*)label2)[index];
+	cache_queue->unprotect(f1);
 
-		if (!label_value1 || !label_value2)
-			continue;
+	return true;
+}
 
-		if (m_map->m_data_bits == 8)
-		{
-			data_value1 = ((unsigned char*)data1)[index] / 255.0f;
-			data_value2 = ((unsigned char*)data2)[index] / 255.0f;
-		}
-		else if (m_map->m_data_bits == 16)
+void TrackMapProcessor::ScanOverlap(void* data1, unsigned int* label1,
+	void* data2, unsigned int* label2,
+	FrameOverlap& overlap, unsigned int thread_num)
+{
+	size_t size = (size_t)m_map->m_size.intx() *
+		m_map->m_size.inty() * m_map->m_size.intz();
+	size_t data_bits = m_map->m_data_bits;
+	float scale = m_map->m_scale;
+	auto get_value = [&](void* data, size_t index)
+	{
+		if (data_bits == 8)
+			return ((unsigned char*)data)[index] / 255.0f;
+		else if (data_bits == 16)
+			return ((unsigned short*)data)[index] * scale / 65535.0f;
+		return 0.0f;
+	};
+
+	//overlaps in memory order
+	unsigned int tn = GetThreadNum(thread_num);
+	if (tn > size)
+		tn = static_cast<unsigned int>(std::max(size, size_t(1)));
+	std::vector<OverlapSlab> slabs(tn);
+	ParallelFor(size, [&](size_t i0, size_t i1, unsigned int t)
+	{
+		OverlapSlab& st = slabs[t];
+		for (size_t index = i0; index < i1; ++index)
 		{
-			data_value1 = ((unsigned short*)data1)[index] * m_map->m_scale / 65535.0f;
-			data_value2 = ((unsigned short*)data2)[index] * m_map->m_scale / 65535.0f;
+			unsigned int label_value1 = label1[index];
+			unsigned int label_value2 = label2[index];
+			if (!label_value1 || !label_value2)
+				continue;
+			st.add_pair((unsigned long long)label_value1 << 32 | label_value2,
+				1, std::min(get_value(data1, index), get_value(data2, index)));
 		}
+	}, tn);
 
-		cl1 = GetCell(f1, label_value1);
-		cl2 = GetCell(f2, label_value2);
-		v1 = GetVertex(cl1);
-		v2 = GetVertex(cl2);
+	//reduce in slab order
+	OverlapSlab all;
+	for (auto& st : slabs)
+	{
+		for (size_t p = 0; p < st.pair.size(); ++p)
+			all.add_pair(st.pair[p], st.pair_ui[p], st.pair_d[p]);
+		st = OverlapSlab();
+	}
+	overlap.pairs.swap(all.pair);
+	overlap.pair_ui.swap(all.pair_ui);
+	overlap.pair_d.swap(all.pair_d);
+}
+
+bool TrackMapProcessor::LinkOverlap(size_t f1, size_t f2, FrameOverlap& overlap)
+{
+	size_t frame_num = m_map->m_frame_num;
+	if (f1 >= frame_num || f2 >= frame_num || f1 == f2)
+		return false;
+
+	m_map->m_inter_graph_list.push_back(InterGraph());
+	InterGraph &inter_graph = m_map->m_inter_graph_list.back();
+	inter_graph.index = f1;
+	inter_graph.counter = 0;
+
+	for (size_t p = 0; p < overlap.pairs.size(); ++p)
+	{
+		Celp cl1 = GetCell(f1, static_cast<unsigned int>(overlap.pairs[p] >> 32));
+		Celp cl2 = GetCell(f2, static_cast<unsigned int>(overlap.pairs[p] & 0xffffffff));
+		Verp v1 = GetVertex(cl1);
+		Verp v2 = GetVertex(cl2);
 		if (!v1 || !v2)
 			continue;
 
@@ -774,17 +1052,17 @@ bool TrackMapProcessor::LinkFrames(
 
 		LinkVertices(inter_graph,
 			v1, v2, f1, f2,
-			std::min(data_value1, data_value2));
+			overlap.pair_d[p], overlap.pair_ui[p]);
 	}
 
-	cache_queue->unprotect(f1);
-
+	overlap = FrameOverlap();
 	return true;
 }
 
 bool TrackMapProcessor::LinkVertices(InterGraph& graph,
 	Verp &vertex1, Verp &vertex2,
-	size_t f1, size_t f2, float overlap_value)
+	size_t f1, size_t f2, double overlap_value,
+	unsigned int count)
 {
 	Vrtx v1 = vertex1->GetInterVert(graph);
 	Vrtx v2 = vertex2->GetInterVert(graph);
@@ -811,7 +1089,7 @@ bool TrackMapProcessor::LinkVertices(InterGraph& graph,
 	if (!e.second)
 	{
 		e = boost::add_edge(v1, v2, graph);
-		graph[e.first].size_ui = 1;
+		graph[e.first].size_ui = count;
 		graph[e.first].size_d = overlap_value;
 		fluo::Point p1 = vertex1->GetCenter();
 		fluo::Point p2 = vertex2->GetCenter();
@@ -821,7 +1099,7 @@ bool TrackMapProcessor::LinkVertices(InterGraph& graph,
 	}
 	else
 	{
-		graph[e.first].size_ui++;
+		graph[e.first].size_ui += count;
 		graph[e.first].size_d += overlap_value;
 	}
 
@@ -844,7 +1122,7 @@ bool TrackMapProcessor::LinkOrphans(InterGraph& graph, Verp &vertex)
 
 	//find closest
 	VertexListIter iter;
-	VertexList &vertex_list = m_map->m_vertices_list.at(m_frame2);
+	VertexList &vertex_list = m_map->GetVertexList(m_frame2);
 	for (iter = vertex_list.begin();
 		iter != vertex_list.end(); ++iter)
 	{
@@ -1051,10 +1329,10 @@ bool TrackMapProcessor::ResolveGraph(size_t frame1, size_t frame2)
 		frame1 == frame2)
 		return false;
 
-	VertexList &vertex_list1 = m_map->m_vertices_list.at(frame1);
-	VertexList &vertex_list2 = m_map->m_vertices_list.at(frame2);
-	CellGraph &intra_graph = m_map->m_intra_graph_list.at(frame2);
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	VertexList &vertex_list1 = m_map->GetVertexList(frame1);
+	VertexList &vertex_list2 = m_map->GetVertexList(frame2);
+	CellGraph &intra_graph = m_map->GetIntraGraph(frame2);
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 
 	VertexListIter iter;
@@ -1111,8 +1389,8 @@ bool TrackMapProcessor::ProcessFrames(size_t frame1, size_t frame2, bool erase_v
 		frame1 == frame2)
 		return false;
 
-	VertexList &vertex_list = m_map->m_vertices_list.at(frame1);
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	VertexList &vertex_list = m_map->GetVertexList(frame1);
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 	m_frame1 = frame1;
 	m_frame2 = frame2;
@@ -1233,7 +1511,7 @@ bool TrackMapProcessor::MakeConsistent(size_t f1, size_t f2)
 		(unsigned long long)ny * (unsigned long long)nz;
 	unsigned long long index;
 
-	//InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	//InterGraph &inter_graph = m_map->GetInterGraph(
 	//	f1 > f2 ? f2 : f1);
 	CellIDMap id_map;
 	//scan label for cell ids
@@ -1286,7 +1564,7 @@ bool TrackMapProcessor::ClearCounters()
 	size_t listsize = m_map->m_inter_graph_list.size();
 	for (size_t i = 0; i < listsize; ++i)
 	{
-		InterGraph &graph = m_map->m_inter_graph_list.at(i);
+		InterGraph &graph = m_map->GetInterGraph(i);
 		graph.counter = 0;
 
 		for (auto iv : boost::make_iterator_range(vertices(graph)))
@@ -1845,7 +2123,7 @@ bool TrackMapProcessor::MergeEdges(InterGraph &graph, Verp &vertex,
 	if (ClusterCellsMerge(list, frame))
 	{
 		//modify vertex list 2 if necessary
-		VertexList &vertex_list = m_map->m_vertices_list.at(frame);
+		VertexList &vertex_list = m_map->GetVertexList(frame);
 		MergeCells(vertex_list, cell_bin, frame);
 		return true;
 	}
@@ -1887,7 +2165,7 @@ bool TrackMapProcessor::SplitVertex(InterGraph &graph, Verp &vertex,
 		size_t gindex = graph.index == frame ? frame - 1 : frame;
 		if (gindex < m_map->m_frame_num - 1)
 		{
-			InterGraph &graph2 = m_map->m_inter_graph_list.at(gindex);
+			InterGraph &graph2 = m_map->GetInterGraph(gindex);
 			RemoveVertex(graph2, vertex);
 		}
 
@@ -2608,12 +2886,12 @@ bool TrackMapProcessor::MergeCells(
 			//relink inter graph
 			if (frame > 0)
 			{
-				InterGraph &graph = m_map->m_inter_graph_list.at(frame - 1);
+				InterGraph &graph = m_map->GetInterGraph(frame - 1);
 				RelinkInterGraph(vertex, vertex0, frame, graph, false);
 			}
 			if (frame < m_map->m_frame_num - 1)
 			{
-				InterGraph &graph = m_map->m_inter_graph_list.at(frame);
+				InterGraph &graph = m_map->GetInterGraph(frame);
 				RelinkInterGraph(vertex, vertex0, frame, graph, false);
 			}
 
@@ -2748,7 +3026,7 @@ bool TrackMapProcessor::RemoveVertex(InterGraph& graph, Verp &vertex)
 		//remove the vertex from inter graph
 		//edges are NOT removed!
 		boost::remove_vertex(inter_vert, graph);
-		vertex->SetInterVert(graph, 0);
+		vertex->SetInterVert(graph, InterGraph::null_vertex());
 		//it needs to be actually removed from the list later
 		return true;
 	}
@@ -2757,6 +3035,16 @@ bool TrackMapProcessor::RemoveVertex(InterGraph& graph, Verp &vertex)
 
 bool TrackMapProcessor::Export(const std::wstring &filename)
 {
+	//a previous export may still be writing
+	WaitExport();
+
+	//all frames are needed
+	//an incomplete map would overwrite the file with missing frames
+	if (!m_map->LoadAll())
+	{
+		WriteInfo(L"Track file not saved, some frames could not be read.\n");
+		return false;
+	}
 	if (m_map->m_frame_num == 0 ||
 		m_map->m_frame_num != m_map->m_celp_list.size() ||
 		m_map->m_frame_num != m_map->m_vertices_list.size() ||
@@ -2768,171 +3056,232 @@ bool TrackMapProcessor::Export(const std::wstring &filename)
 #else
     std::ofstream ofs(ws2s(filename), std::ios::out | std::ios::binary);
 #endif
-	if (ofs.bad())
+	if (!ofs.is_open() || ofs.bad())
 		return false;
 
-	//header
-	std::string header = "FluoRender links";
-	ofs.write(header.c_str(), header.size());
+	//frames only read the map, serialize them in parallel
+	size_t num = m_map->m_frame_num;
+	std::vector<std::string> blocks(num);
+	std::vector<unsigned long long> splits(num, 0);
+	ParallelForDynamic(num, [&](size_t i, unsigned int)
+	{
+		std::ostringstream oss(std::ios::out | std::ios::binary);
+		WriteFrame(oss, i);
+		if (i > 0)
+		{
+			splits[i] = static_cast<unsigned long long>(oss.tellp());
+			WriteInterEdges(oss, i);
+		}
+		blocks[i] = oss.str();
+	});
+	unsigned int counter = m_map->m_counter;
 
-	//last operation
-	WriteTag(ofs, TAG_FPCOUNT);
-	WriteUint(ofs, m_map->m_counter);
+	//file writing goes to the background
+	m_export = std::async(std::launch::async,
+		[this, counter, filename, ofs = std::move(ofs),
+		blocks = std::move(blocks), splits = std::move(splits)]() mutable
+	{
+		size_t num = blocks.size();
+		//header
+		std::string header = "FluoRender track";
+		ofs.write(header.c_str(), header.size());
+		WriteUint(ofs, TRACK_FILE_VER);
+		//number of frames
+		WriteTag(ofs, TAG_NUM);
+		WriteUint(ofs, static_cast<unsigned int>(num));
+		//last operation
+		WriteTag(ofs, TAG_FPCOUNT);
+		WriteUint(ofs, counter);
+		//table offset, filled in at the end
+		WriteTag(ofs, TAG_TABLE);
+		unsigned long long table_pos = static_cast<unsigned long long>(ofs.tellp());
+		WriteUint64(ofs, 0);
+
+		//frame blocks
+		std::vector<unsigned long long> offsets(num * 2, 0);
+		for (size_t i = 0; i < num; ++i)
+		{
+			unsigned long long pos = static_cast<unsigned long long>(ofs.tellp());
+			offsets[i * 2] = pos;
+			offsets[i * 2 + 1] = i > 0 ? pos + splits[i] : 0;
+			std::string& block = blocks[i];
+			ofs.write(block.data(), block.size());
+			std::string().swap(block);
+		}
 
-	//number of frames
-	WriteTag(ofs, TAG_NUM);
-	size_t num = m_map->m_frame_num;
-	WriteUint(ofs, static_cast<unsigned int>(num));
+		//table
+		unsigned long long table = static_cast<unsigned long long>(ofs.tellp());
+		WriteTag(ofs, TAG_TABLE);
+		for (size_t i = 0; i < num * 2; ++i)
+			WriteUint64(ofs, offsets[i]);
+		ofs.seekp(static_cast<std::streamoff>(table_pos));
+		WriteUint64(ofs, table);
+		ofs.close();
+		bool ok = !ofs.fail();
+		WriteInfo((ok ? L"Track file saved: " :
+			L"Failed to write track file: ") + filename + L"\n");
+		return ok;
+	});
 
+	return true;
+}
+
+bool TrackMapProcessor::WaitExport()
+{
+	if (!m_export.valid())
+		return true;
+	return m_export.get();
+}
+
+void TrackMapProcessor::WriteFrame(std::ostream& ofs, size_t frame)
+{
 	VertexListIter iter;
 	Verp vertex;
 	CelEdgeIter intra_iter;
 	std::pair<CelEdgeIter, CelEdgeIter> intra_pair;
 	CelVrtx intra_vert;
+	size_t edge_num;
+
+	WriteTag(ofs, TAG_FRAM);
+	//frame id
+	WriteUint(ofs, static_cast<unsigned int>(frame));
+
+	//vertex list
+	VertexList &vertex_list = m_map->m_vertices_list.at(frame);
+	//vertex number
+	WriteUint(ofs, static_cast<unsigned int>(vertex_list.size()));
+	//write each vertex
+	for (iter = vertex_list.begin();
+	iter != vertex_list.end(); ++iter)
+	{
+		vertex = iter->second;
+		WriteVertex(ofs, vertex);
+	}
+	//write intra edges
+	CellGraph &intra_graph = m_map->m_intra_graph_list.at(frame);
+	//intra edge num
+	edge_num = num_edges(intra_graph);
+	WriteUint(ofs, static_cast<unsigned int>(edge_num));
+	//write each intra edge
+	intra_pair = edges(intra_graph);
+	for (intra_iter = intra_pair.first;
+	intra_iter != intra_pair.second;
+		++intra_iter)
+	{
+		WriteTag(ofs, TAG_INTRA_EDGE);
+		//first cell
+		intra_vert = boost::source(*intra_iter, intra_graph);
+		WriteUint(ofs, intra_graph[intra_vert].id);
+		//second cell
+		intra_vert = boost::target(*intra_iter, intra_graph);
+		WriteUint(ofs, intra_graph[intra_vert].id);
+		//size
+		WriteUint(ofs, intra_graph[*intra_iter].size_ui);
+		WriteDouble(ofs, intra_graph[*intra_iter].size_d);
+		//distance
+		WriteTag(ofs, TAG_VER220);
+		WriteDouble(ofs, intra_graph[*intra_iter].dist_v);
+		WriteDouble(ofs, intra_graph[*intra_iter].dist_s);
+	}
+}
+
+void TrackMapProcessor::WriteInterEdges(std::ostream& ofs, size_t frame)
+{
 	EdgeIter inter_iter;
 	std::pair<EdgeIter, EdgeIter> inter_pair;
 	Vrtx inter_vert0, inter_vert1;
 	size_t edge_num;
-	//write each frame
-	for (size_t i = 0; i < num; ++i)
-	{
-		WriteTag(ofs, TAG_FRAM);
-		//frame id
-		WriteUint(ofs, static_cast<unsigned int>(i));
 
-		//vertex list
-		VertexList &vertex_list = m_map->m_vertices_list.at(i);
-		//vertex number
-		WriteUint(ofs, static_cast<unsigned int>(vertex_list.size()));
-		//write each vertex
-		for (iter = vertex_list.begin();
-		iter != vertex_list.end(); ++iter)
+	InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame - 1);
+	//write index and counter
+	WriteTag(ofs, TAG_VER220);
+	//index
+	WriteUint(ofs, static_cast<unsigned int>(inter_graph.index));
+	//counter
+	WriteUint(ofs, static_cast<unsigned int>(inter_graph.counter));
+	//inter edge number
+	edge_num = num_edges(inter_graph);
+	WriteUint(ofs, static_cast<unsigned int>(edge_num));
+	//write each inter edge
+	inter_pair = boost::edges(inter_graph);
+	for (inter_iter = inter_pair.first;
+	inter_iter != inter_pair.second;
+		++inter_iter)
+	{
+		WriteTag(ofs, TAG_INTER_EDGE);
+		inter_vert0 = boost::source(*inter_iter, inter_graph);
+		inter_vert1 = boost::target(*inter_iter, inter_graph);
+		if (inter_graph[inter_vert0].frame <
+			inter_graph[inter_vert1].frame)
 		{
-			vertex = iter->second;
-			WriteVertex(ofs, vertex);
+			//first vertex
+			WriteUint(ofs, inter_graph[inter_vert0].id);
+			//second vertex
+			WriteUint(ofs, inter_graph[inter_vert1].id);
 		}
-		//write intra edges
-		CellGraph &intra_graph = m_map->m_intra_graph_list.at(i);
-		intra_pair = edges(intra_graph);
-		edge_num = 0;
-		for (intra_iter = intra_pair.first;
-		intra_iter != intra_pair.second;
-			++intra_iter)
-			edge_num++;
-		//intra edge num
-		WriteUint(ofs, static_cast<unsigned int>(edge_num));
-		//write each intra edge
-		for (intra_iter = intra_pair.first;
-		intra_iter != intra_pair.second;
-			++intra_iter)
+		else
 		{
-			WriteTag(ofs, TAG_INTRA_EDGE);
-			//first cell
-			intra_vert = boost::source(*intra_iter, intra_graph);
-			WriteUint(ofs, intra_graph[intra_vert].id);
-			//second cell
-			intra_vert = boost::target(*intra_iter, intra_graph);
-			WriteUint(ofs, intra_graph[intra_vert].id);
-			//size
-			WriteUint(ofs, intra_graph[*intra_iter].size_ui);
-			WriteDouble(ofs, intra_graph[*intra_iter].size_d);
-			//distance
-			WriteTag(ofs, TAG_VER220);
-			WriteDouble(ofs, intra_graph[*intra_iter].dist_v);
-			WriteDouble(ofs, intra_graph[*intra_iter].dist_s);
+			//first vertex
+			WriteUint(ofs, inter_graph[inter_vert1].id);
+			//second vertex
+			WriteUint(ofs, inter_graph[inter_vert0].id);
 		}
-		//write inter edges
-		if (i == 0)
-			continue;
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(i - 1);
-		//write index and counter
-		WriteTag(ofs, TAG_VER220);
-		//index
-		WriteUint(ofs, static_cast<unsigned int>(inter_graph.index));
-		//counter
-		WriteUint(ofs, static_cast<unsigned int>(inter_graph.counter));
-		//get edge number
-		inter_pair = boost::edges(inter_graph);
-		edge_num = 0;
-		for (inter_iter = inter_pair.first;
-		inter_iter != inter_pair.second;
-			++inter_iter)
-			edge_num++;
-		//inter edge number
-		WriteUint(ofs, static_cast<unsigned int>(edge_num));
-		//write each inter edge
-		for (inter_iter = inter_pair.first;
-		inter_iter != inter_pair.second;
-			++inter_iter)
+		//size
+		WriteUint(ofs, inter_graph[*inter_iter].size_ui);
+		WriteDouble(ofs, inter_graph[*inter_iter].size_d);
+		WriteDouble(ofs, inter_graph[*inter_iter].dist);
+		WriteUint(ofs, inter_graph[*inter_iter].link);
+		//uncertainty
+		WriteTag(ofs, TAG_VER219);
+		if (inter_graph[inter_vert0].frame <
+			inter_graph[inter_vert1].frame)
 		{
-			WriteTag(ofs, TAG_INTER_EDGE);
-			inter_vert0 = boost::source(*inter_iter, inter_graph);
-			inter_vert1 = boost::target(*inter_iter, inter_graph);
-			if (inter_graph[inter_vert0].frame <
-				inter_graph[inter_vert1].frame)
-			{
-				//first vertex
-				WriteUint(ofs, inter_graph[inter_vert0].id);
-				//second vertex
-				WriteUint(ofs, inter_graph[inter_vert1].id);
-			}
-			else
-			{
-				//first vertex
-				WriteUint(ofs, inter_graph[inter_vert1].id);
-				//second vertex
-				WriteUint(ofs, inter_graph[inter_vert0].id);
-			}
-			//size
-			WriteUint(ofs, inter_graph[*inter_iter].size_ui);
-			WriteDouble(ofs, inter_graph[*inter_iter].size_d);
-			WriteDouble(ofs, inter_graph[*inter_iter].dist);
-			WriteUint(ofs, inter_graph[*inter_iter].link);
-			//uncertainty
-			WriteTag(ofs, TAG_VER219);
-			if (inter_graph[inter_vert0].frame <
-				inter_graph[inter_vert1].frame)
-			{
-				//first vertex
-				WriteUint(ofs, inter_graph[inter_vert0].count);
-				//second vertex
-				WriteUint(ofs, inter_graph[inter_vert1].count);
-			}
-			else
-			{
-				//first vertex
-				WriteUint(ofs, inter_graph[inter_vert1].count);
-				//second vertex
-				WriteUint(ofs, inter_graph[inter_vert0].count);
-			}
-			WriteUint(ofs, inter_graph[*inter_iter].count);
+			//first vertex
+			WriteUint(ofs, inter_graph[inter_vert0].count);
+			//second vertex
+			WriteUint(ofs, inter_graph[inter_vert1].count);
 		}
+		else
+		{
+			//first vertex
+			WriteUint(ofs, inter_graph[inter_vert1].count);
+			//second vertex
+			WriteUint(ofs, inter_graph[inter_vert0].count);
+		}
+		WriteUint(ofs, inter_graph[*inter_iter].count);
 	}
-
-	return true;
 }
 
 bool TrackMapProcessor::Import(const std::wstring &filename)
 {
+	//the file may still be written
+	WaitExport();
+
 	//clear everything
 	m_map->Clear();
 
 #ifdef _WIN32
-	std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+	auto ifs = std::make_shared<std::ifstream>(filename, std::ios::in | std::ios::binary);
 #else
-    std::ifstream ifs(ws2s(filename), std::ios::in | std::ios::binary);
+	auto ifs = std::make_shared<std::ifstream>(ws2s(filename), std::ios::in | std::ios::binary);
 #endif
-	if (ifs.bad())
+	if (ifs->bad())
 		return false;
 
 	//header
 	char cheader[17];
-	ifs.read(cheader, 16);
+	ifs->read(cheader, 16);
 	cheader[16] = 0;
 	std::string header = cheader;
-	if (header != "FluoRender links")
-		return false;
+	if (header == "FluoRender links")
+		return ImportLinks(*ifs);
+	else if (header == "FluoRender track")
+		return ImportTrack(ifs);
+	return false;
+}
 
+bool TrackMapProcessor::ImportLinks(std::istream& ifs)
+{
 	//last operation
 	if (ReadTag(ifs) == TAG_FPCOUNT)
 		m_map->m_counter = ReadUint(ifs);
@@ -2949,147 +3298,233 @@ bool TrackMapProcessor::Import(const std::wstring &filename)
 		num = ReadUint(ifs);
 	}
 
-	size_t vertex_num;
-	size_t edge_num;
-	unsigned id1, id2;
-	Celp celp1, celp2;
-	CelpListIter cell_iter;
-	unsigned int size_ui;
-	double size_f;
-	double dist_v, dist_s;
-	Verp vertex1, vertex2;
-	VertexListIter vertex_iter;
-	double dist;
-	unsigned int link;
-	bool edge_exist;
 	//read each frame
 	for (size_t i = 0; i < num; ++i)
 	{
-		if (ReadTag(ifs) != TAG_FRAM)
+		m_map->m_vertices_list.push_back(VertexList());
+		m_map->m_celp_list.push_back(CelpList());
+		m_map->m_intra_graph_list.push_back(CellGraph());
+		if (!ReadFrame(ifs, *m_map, i))
+			return false;
+		if (i == 0)
+			continue;
+		m_map->m_inter_graph_list.push_back(InterGraph());
+		if (!ReadInterEdges(ifs, *m_map, i))
 			return false;
-		//frame id
-		ReadUint(ifs);
+	}
+
+	m_map->m_frame_num = num;
+	return true;
+}
 
-		//vertex list
+bool TrackMapProcessor::ImportTrack(const std::shared_ptr<std::ifstream>& ifs)
+{
+	if (ReadUint(*ifs) > TRACK_FILE_VER)
+		return false;
+	if (ReadTag(*ifs) != TAG_NUM)
+		return false;
+	size_t num = ReadUint(*ifs);
+	if (ReadTag(*ifs) != TAG_FPCOUNT)
+		return false;
+	unsigned int counter = ReadUint(*ifs);
+	if (ReadTag(*ifs) != TAG_TABLE)
+		return false;
+	unsigned long long table = ReadUint64(*ifs);
+
+	//offset table
+	auto offsets = std::make_shared<std::vector<unsigned long long>>(num * 2);
+	ifs->seekg(static_cast<std::streamoff>(table));
+	if (ReadTag(*ifs) != TAG_TABLE)
+		return false;
+	for (size_t i = 0; i < num * 2; ++i)
+		(*offsets)[i] = ReadUint64(*ifs);
+	if (!*ifs)
+		return false;
+
+	//empty frames, filled on first access
+	for (size_t i = 0; i < num; ++i)
+	{
 		m_map->m_vertices_list.push_back(VertexList());
-		VertexList &vertex_list1 = m_map->m_vertices_list.back();
-		//cell list
 		m_map->m_celp_list.push_back(CelpList());
-		CelpList &cell_list = m_map->m_celp_list.back();
-		//vertex number
-		vertex_num = ReadUint(ifs);
-		//read each vertex
-		for (size_t j = 0; j < vertex_num; ++j)
-			ReadVertex(ifs, vertex_list1, cell_list);
-		//intra graph
 		m_map->m_intra_graph_list.push_back(CellGraph());
-		CellGraph &intra_graph = m_map->m_intra_graph_list.back();
-		//intra edge num
-		edge_num = ReadUint(ifs);
-		//read each intra edge
-		for (size_t j = 0; j < edge_num; ++j)
-		{
-			edge_exist = true;
-			if (ReadTag(ifs) != TAG_INTRA_EDGE)
-				return false;
-			//first cell
-			id1 = ReadUint(ifs);
-			cell_iter = cell_list.find(id1);
-			if (cell_iter == cell_list.end())
-				edge_exist = false;
-			else
-				celp1 = cell_iter->second;
-			//second cell
-			id2 = ReadUint(ifs);
-			cell_iter = cell_list.find(id2);
-			if (cell_iter == cell_list.end())
-				edge_exist = false;
-			else
-				celp2 = cell_iter->second;
-			//add edge
-			size_ui = ReadUint(ifs);
-			size_f = ReadDouble(ifs);
-			if (ReadTag(ifs) == TAG_VER220)
-			{
-				dist_v = ReadDouble(ifs);
-				dist_s = ReadDouble(ifs);
-			}
-			else
-			{
-				ifs.unget();
-				dist_v = dist_s = 0.0f;
-			}
-			if (edge_exist)
-				AddIntraEdge(intra_graph, celp1, celp2,
-					size_ui, size_f, dist_v, dist_s);
-		}
-		//inter graph
 		if (i == 0)
 			continue;
-		//old vertex list
-		VertexList &vertex_list0 = m_map->m_vertices_list.at(i - 1);
 		m_map->m_inter_graph_list.push_back(InterGraph());
-		InterGraph &inter_graph = m_map->m_inter_graph_list.back();
-		//read index and counter
+		m_map->m_inter_graph_list.back().index = i - 1;
+		m_map->m_inter_graph_list.back().counter = 0;
+	}
+	m_map->m_counter = counter;
+	m_map->m_frame_num = num;
+
+	//the map owns the loaders, which keep the file open
+	m_map->SetLoader(
+		[this, ifs, offsets](TrackMap& map, size_t frame)
+		{
+			ifs->clear();
+			ifs->seekg(static_cast<std::streamoff>((*offsets)[frame * 2]));
+			if (ReadFrame(*ifs, map, frame))
+				return true;
+			WriteInfo(L"Failed to read frame " + std::to_wstring(frame) +
+				L" from the track file.\n");
+			return false;
+		},
+		[this, ifs, offsets](TrackMap& map, size_t frame)
+		{
+			//links from frame to frame + 1 are stored in frame + 1
+			ifs->clear();
+			ifs->seekg(static_cast<std::streamoff>((*offsets)[frame * 2 + 3]));
+			if (ReadInterEdges(*ifs, map, frame + 1))
+				return true;
+			WriteInfo(L"Failed to read links of frame " + std::to_wstring(frame) +
+				L" from the track file.\n");
+			return false;
+		});
+	return true;
+}
+
+bool TrackMapProcessor::ReadFrame(std::istream& ifs, TrackMap& map, size_t frame)
+{
+	if (ReadTag(ifs) != TAG_FRAM)
+		return false;
+	//frame id
+	ReadUint(ifs);
+
+	size_t vertex_num;
+	size_t edge_num;
+	unsigned id1, id2;
+	Celp celp1, celp2;
+	CelpListIter cell_iter;
+	unsigned int size_ui;
+	double size_f;
+	double dist_v, dist_s;
+	bool edge_exist;
+
+	//vertex list
+	VertexList &vertex_list = map.m_vertices_list.at(frame);
+	//cell list
+	CelpList &cell_list = map.m_celp_list.at(frame);
+	//vertex number
+	vertex_num = ReadUint(ifs);
+	//read each vertex
+	for (size_t j = 0; j < vertex_num; ++j)
+		ReadVertex(ifs, vertex_list, cell_list);
+	//intra graph
+	CellGraph &intra_graph = map.m_intra_graph_list.at(frame);
+	//intra edge num
+	edge_num = ReadUint(ifs);
+	//read each intra edge
+	for (size_t j = 0; j < edge_num; ++j)
+	{
+		edge_exist = true;
+		if (ReadTag(ifs) != TAG_INTRA_EDGE)
+			return false;
+		//first cell
+		id1 = ReadUint(ifs);
+		cell_iter = cell_list.find(id1);
+		if (cell_iter == cell_list.end())
+			edge_exist = false;
+		else
+			celp1 = cell_iter->second;
+		//second cell
+		id2 = ReadUint(ifs);
+		cell_iter = cell_list.find(id2);
+		if (cell_iter == cell_list.end())
+			edge_exist = false;
+		else
+			celp2 = cell_iter->second;
+		//add edge
+		size_ui = ReadUint(ifs);
+		size_f = ReadDouble(ifs);
 		if (ReadTag(ifs) == TAG_VER220)
 		{
-			//index
-			inter_graph.index = ReadUint(ifs);
-			//counter
-			inter_graph.counter = ReadUint(ifs);
+			dist_v = ReadDouble(ifs);
+			dist_s = ReadDouble(ifs);
 		}
 		else
 		{
 			ifs.unget();
-			inter_graph.index = i - 1;
-			inter_graph.counter = 0;
+			dist_v = dist_s = 0.0f;
 		}
-		//inter edge num
-		edge_num = ReadUint(ifs);
-		//read each inter edge
-		for (size_t j = 0; j < edge_num; ++j)
+		if (edge_exist)
+			AddIntraEdge(intra_graph, celp1, celp2,
+				size_ui, size_f, dist_v, dist_s);
+	}
+	return true;
+}
+
+bool TrackMapProcessor::ReadInterEdges(std::istream& ifs, TrackMap& map, size_t frame)
+{
+	size_t edge_num;
+	unsigned id1, id2;
+	unsigned int size_ui;
+	double size_f;
+	Verp vertex1, vertex2;
+	VertexListIter vertex_iter;
+	double dist;
+	unsigned int link;
+	bool edge_exist;
+
+	//old and new vertex lists
+	VertexList &vertex_list0 = map.m_vertices_list.at(frame - 1);
+	VertexList &vertex_list1 = map.m_vertices_list.at(frame);
+	InterGraph &inter_graph = map.m_inter_graph_list.at(frame - 1);
+	//read index and counter
+	if (ReadTag(ifs) == TAG_VER220)
+	{
+		//index
+		inter_graph.index = ReadUint(ifs);
+		//counter
+		inter_graph.counter = ReadUint(ifs);
+	}
+	else
+	{
+		ifs.unget();
+		inter_graph.index = frame - 1;
+		inter_graph.counter = 0;
+	}
+	//inter edge num
+	edge_num = ReadUint(ifs);
+	//read each inter edge
+	for (size_t j = 0; j < edge_num; ++j)
+	{
+		edge_exist = true;
+		if (ReadTag(ifs) != TAG_INTER_EDGE)
+			return false;
+		//first vertex
+		id1 = ReadUint(ifs);
+		vertex_iter = vertex_list0.find(id1);
+		if (vertex_iter == vertex_list0.end())
+			edge_exist = false;
+		else
+			vertex1 = vertex_iter->second;
+		//second vertex
+		id2 = ReadUint(ifs);
+		vertex_iter = vertex_list1.find(id2);
+		if (vertex_iter == vertex_list1.end())
+			edge_exist = false;
+		else
+			vertex2 = vertex_iter->second;
+		//add edge
+		size_ui = ReadUint(ifs);
+		size_f = ReadDouble(ifs);
+		dist = ReadDouble(ifs);
+		link = ReadUint(ifs);
+		unsigned int v1_count = 0;
+		unsigned int v2_count = 0;
+		unsigned int edge_count = 0;
+		if (ReadTag(ifs) == TAG_VER219)
 		{
-			edge_exist = true;
-			if (ReadTag(ifs) != TAG_INTER_EDGE)
-				return false;
-			//first vertex
-			id1 = ReadUint(ifs);
-			vertex_iter = vertex_list0.find(id1);
-			if (vertex_iter == vertex_list0.end())
-				edge_exist = false;
-			else
-				vertex1 = vertex_iter->second;
-			//second vertex
-			id2 = ReadUint(ifs);
-			vertex_iter = vertex_list1.find(id2);
-			if (vertex_iter == vertex_list1.end())
-				edge_exist = false;
-			else
-				vertex2 = vertex_iter->second;
-			//add edge
-			size_ui = ReadUint(ifs);
-			size_f = ReadDouble(ifs);
-			dist = ReadDouble(ifs);
-			link = ReadUint(ifs);
-			unsigned int v1_count = 0;
-			unsigned int v2_count = 0;
-			unsigned int edge_count = 0;
-			if (ReadTag(ifs) == TAG_VER219)
-			{
-				v1_count = ReadUint(ifs);
-				v2_count = ReadUint(ifs);
-				edge_count = ReadUint(ifs);
-			}
-			else
-				ifs.unget();
-			if (edge_exist)
-				AddInterEdge(inter_graph, vertex1, vertex2,
-					i-1, i, size_ui, size_f, dist, link,
-					v1_count, v2_count, edge_count);
+			v1_count = ReadUint(ifs);
+			v2_count = ReadUint(ifs);
+			edge_count = ReadUint(ifs);
 		}
+		else
+			ifs.unget();
+		if (edge_exist)
+			AddInterEdge(inter_graph, vertex1, vertex2,
+				frame - 1, frame, size_ui, size_f, dist, link,
+				v1_count, v2_count, edge_count);
 	}
-
-	m_map->m_frame_num = num;
 	return true;
 }
 
@@ -3097,7 +3532,7 @@ bool TrackMapProcessor::ResetVertexIDs()
 {
 	for (size_t fi = 0; fi < m_map->m_frame_num; ++fi)
 	{
-		VertexList &vertex_list = m_map->m_vertices_list.at(fi);
+		VertexList &vertex_list = m_map->GetVertexList(fi);
 		for (VertexListIter vertex_iter = vertex_list.begin();
 		vertex_iter != vertex_list.end(); ++vertex_iter)
 		{
@@ -3124,14 +3559,14 @@ bool TrackMapProcessor::ResetVertexIDs()
 				vertex->Id(max_id);
 				if (fi > 0)
 				{
-					InterGraph &inter_graph = m_map->m_inter_graph_list.at(fi - 1);
+					InterGraph &inter_graph = m_map->GetInterGraph(fi - 1);
 					Vrtx inter_vert = vertex->GetInterVert(inter_graph);
 					if (inter_vert != InterGraph::null_vertex())
 						inter_graph[inter_vert].id = max_id;
 				}
 				if (fi < m_map->m_frame_num - 1)
 				{
-					InterGraph &inter_graph = m_map->m_inter_graph_list.at(fi);
+					InterGraph &inter_graph = m_map->GetInterGraph(fi);
 					Vrtx inter_vert = vertex->GetInterVert(inter_graph);
 					if (inter_vert != InterGraph::null_vertex())
 						inter_graph[inter_vert].id = max_id;
@@ -3143,7 +3578,7 @@ bool TrackMapProcessor::ResetVertexIDs()
 	return true;
 }
 
-void TrackMapProcessor::WriteVertex(std::ofstream& ofs, const Verp &vertex)
+void TrackMapProcessor::WriteVertex(std::ostream& ofs, const Verp &vertex)
 {
 	WriteTag(ofs, TAG_VERT);
 	WriteUint(ofs, vertex->Id());
@@ -3165,7 +3600,7 @@ void TrackMapProcessor::WriteVertex(std::ofstream& ofs, const Verp &vertex)
 	}
 }
 
-void TrackMapProcessor::ReadVertex(std::ifstream& ifs,
+void TrackMapProcessor::ReadVertex(std::istream& ifs,
 	VertexList& vertex_list, CelpList& cell_list)
 {
 	if (ReadTag(ifs) != TAG_VERT)
@@ -3293,7 +3728,7 @@ unsigned int TrackMapProcessor::GetTrackedID(
 		frame1 == frame2)
 		return false;
 
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 
 	Celp celp = GetCell(frame1, id);
@@ -3347,8 +3782,8 @@ bool TrackMapProcessor::GetMappedCells(
 		frame1 == frame2)
 		return false;
 
-	CelpList &cell_list1 = m_map->m_celp_list.at(frame1);
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	CelpList &cell_list1 = m_map->GetCellList(frame1);
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 	CelpListIter sel_iter, cell_iter;
 	Verp vertex1, vertex2;
@@ -3424,8 +3859,8 @@ bool TrackMapProcessor::LinkCells(bool exclusive)
 	VertexList vlist1, vlist2;
 	CelpListIter citer1, citer2;
 
-	CelpList &cell_list1 = m_map->m_celp_list.at(frame1);
-	CelpList &cell_list2 = m_map->m_celp_list.at(frame2);
+	CelpList &cell_list1 = m_map->GetCellList(frame1);
+	CelpList &cell_list2 = m_map->GetCellList(frame2);
 	CelpListIter cell;
 	unsigned int cell_id;
 
@@ -3468,7 +3903,7 @@ bool TrackMapProcessor::LinkCells(bool exclusive)
 		vlist2.size() == 0)
 		return false;
 
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 	
 	VertexListIter viter1, viter2;
@@ -3536,8 +3971,8 @@ bool TrackMapProcessor::LinkCells(Celp &celp1, Celp &celp2,
 
 	VertexList vlist1, vlist2;
 
-	CelpList &cell_list1 = m_map->m_celp_list.at(frame1);
-	CelpList &cell_list2 = m_map->m_celp_list.at(frame2);
+	CelpList &cell_list1 = m_map->GetCellList(frame1);
+	CelpList &cell_list2 = m_map->GetCellList(frame2);
 	CelpListIter cell;
 	unsigned int cell_id;
 
@@ -3556,7 +3991,7 @@ bool TrackMapProcessor::LinkCells(Celp &celp1, Celp &celp2,
 	if (!vert1 || !vert2)
 		return false;
 
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 
 	if (exclusive)
@@ -3587,7 +4022,7 @@ bool TrackMapProcessor::IsolateCells()
 	VertexList vlist;
 	CelpListIter citer;
 
-	CelpList &cell_list = m_map->m_celp_list.at(frame);
+	CelpList &cell_list = m_map->GetCellList(frame);
 	CelpListIter cell;
 
 	for (citer = m_list_in.begin();
@@ -3607,7 +4042,7 @@ bool TrackMapProcessor::IsolateCells()
 
 	if (frame > 0)
 	{
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame - 1);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame - 1);
 		VertexListIter viter;
 		for (viter = vlist.begin();
 		viter != vlist.end(); ++viter)
@@ -3615,7 +4050,7 @@ bool TrackMapProcessor::IsolateCells()
 	}
 	if (frame < frame_num - 1)
 	{
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame);
 		VertexListIter viter;
 		for (viter = vlist.begin();
 		viter != vlist.end(); ++viter)
@@ -3646,8 +4081,8 @@ bool TrackMapProcessor::UnlinkCells()
 	VertexList vlist1, vlist2;
 	CelpListIter citer1, citer2;
 
-	CelpList &cell_list1 = m_map->m_celp_list.at(frame1);
-	CelpList &cell_list2 = m_map->m_celp_list.at(frame2);
+	CelpList &cell_list1 = m_map->GetCellList(frame1);
+	CelpList &cell_list2 = m_map->GetCellList(frame2);
 	CelpListIter cell;
 
 	for (citer1 = m_list_in.begin();
@@ -3677,7 +4112,7 @@ bool TrackMapProcessor::UnlinkCells()
 		vlist2.size() == 0)
 		return false;
 
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 
 	VertexListIter viter1, viter2;
@@ -3714,8 +4149,8 @@ bool TrackMapProcessor::AddCell(
 	if (!m_map->ExtendFrameNum(frame))
 		return false;
 
-	CelpList &cell_list = m_map->m_celp_list.at(frame);
-	VertexList &vert_list = m_map->m_vertices_list.at(frame);
+	CelpList &cell_list = m_map->GetCellList(frame);
+	VertexList &vert_list = m_map->GetVertexList(frame);
 
 	if (cell_list.find(celp->Id()) != cell_list.end() ||
 		vert_list.find(celp->Id()) != vert_list.end())
@@ -3741,8 +4176,8 @@ bool TrackMapProcessor::AddCells(CelpList &list, size_t frame)
 	if (!m_map->ExtendFrameNum(frame))
 		return false;
 
-	CelpList &cell_list = m_map->m_celp_list.at(frame);
-	VertexList &vert_list = m_map->m_vertices_list.at(frame);
+	CelpList &cell_list = m_map->GetCellList(frame);
+	VertexList &vert_list = m_map->GetVertexList(frame);
 
 	for (auto iter = list.begin();
 		iter != list.end(); ++iter)
@@ -3773,8 +4208,8 @@ bool TrackMapProcessor::RemoveCells(CelpList &list, size_t frame)
 	if (!m_map->ExtendFrameNum(frame))
 		return false;
 
-	CelpList &cell_list = m_map->m_celp_list.at(frame);
-	VertexList &vert_list = m_map->m_vertices_list.at(frame);
+	CelpList &cell_list = m_map->GetCellList(frame);
+	VertexList &vert_list = m_map->GetVertexList(frame);
 
 	for (auto iter = list.begin();
 		iter != list.end(); ++iter)
@@ -3834,7 +4269,7 @@ bool TrackMapProcessor::LinkAddedCells(CelpList &list, size_t f1, size_t f2)
 		return false;
 	cache_queue->protect(f1);
 
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		f1 > f2 ? f2 : f1);
 	Verp v1, v2;
 	Celp cl1, cl2;
@@ -3917,8 +4352,8 @@ bool TrackMapProcessor::CombineCells(
 	if (!m_map->ExtendFrameNum(frame))
 		return false;
 
-	CelpList &cell_list = m_map->m_celp_list.at(frame);
-	VertexList &vert_list = m_map->m_vertices_list.at(frame);
+	CelpList &cell_list = m_map->GetCellList(frame);
+	VertexList &vert_list = m_map->GetVertexList(frame);
 
 	//find the largest cell
 	auto cell_iter = cell_list.find(celp->Id());
@@ -3948,12 +4383,12 @@ bool TrackMapProcessor::CombineCells(
 				//relink inter graph
 				if (frame > 0)
 				{
-					InterGraph &graph = m_map->m_inter_graph_list.at(frame - 1);
+					InterGraph &graph = m_map->GetInterGraph(frame - 1);
 					RelinkInterGraph(vertex1, vertex0, frame, graph, true);
 				}
 				if (frame < m_map->m_frame_num - 1)
 				{
-					InterGraph &graph = m_map->m_inter_graph_list.at(frame);
+					InterGraph &graph = m_map->GetInterGraph(frame);
 					RelinkInterGraph(vertex1, vertex0, frame, graph, true);
 				}
 
@@ -3987,8 +4422,8 @@ bool TrackMapProcessor::DivideCells()
 	if (!m_map->ExtendFrameNum(frame))
 		return false;
 
-	CelpList &cell_list = m_map->m_celp_list.at(frame);
-	VertexList &vert_list = m_map->m_vertices_list.at(frame);
+	CelpList &cell_list = m_map->GetCellList(frame);
+	VertexList &vert_list = m_map->GetVertexList(frame);
 
 	//temporary vertex list
 	VertexList vlist;
@@ -4429,7 +4864,7 @@ bool TrackMapProcessor::ReplaceCellID(
 	if (frame >= m_map->m_frame_num)
 		return false;
 
-	CelpList &cell_list = m_map->m_celp_list.at(frame);
+	CelpList &cell_list = m_map->GetCellList(frame);
 	auto iter = cell_list.find(old_id);
 	if (iter == cell_list.end())
 		return false;
@@ -4456,7 +4891,7 @@ bool TrackMapProcessor::ReplaceCellID(
 	}
 
 	//intra graph
-	CellGraph &graph = m_map->m_intra_graph_list.at(frame);
+	CellGraph &graph = m_map->GetIntraGraph(frame);
 	CelVrtx intra_vert = new_celp->GetCelVrtx();
 	if (intra_vert != CellGraph::null_vertex())
 	{
@@ -4528,7 +4963,7 @@ void TrackMapProcessor::GetLinkLists(
 	if (frame >= m_map->m_frame_num)
 		return;
 
-	VertexList &vertex_list = m_map->m_vertices_list.at(frame);
+	VertexList &vertex_list = m_map->GetVertexList(frame);
 
 	Vrtx v0, v1;
 	std::pair<AdjIter, AdjIter> adj_verts;
@@ -4538,7 +4973,7 @@ void TrackMapProcessor::GetLinkLists(
 	//in lists
 	if (frame > 0)
 	{
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame - 1);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame - 1);
 		for (VertexListIter iter = vertex_list.begin();
 		iter != vertex_list.end(); ++iter)
 		{
@@ -4576,7 +5011,7 @@ void TrackMapProcessor::GetLinkLists(
 	//out lists
 	if (frame < m_map->m_frame_num - 1)
 	{
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame);
 		for (VertexListIter iter = vertex_list.begin();
 		iter != vertex_list.end(); ++iter)
 		{
@@ -4649,11 +5084,11 @@ void TrackMapProcessor::GetCellsByUncertainty(bool filter_in_list)
 	Celp celp;
 	CellBinIter pwcell_iter;
 	CelpListIter cell_iter;
-	//VertexList &vertex_list = m_map->m_vertices_list.at(frame);
+	//VertexList &vertex_list = m_map->GetVertexList(frame);
 	if (frame > 0)
 	{
 		InterGraph &inter_graph = 
-			m_map->m_inter_graph_list.at(frame-1);
+			m_map->GetInterGraph(frame-1);
 		for (auto ie : boost::make_iterator_range(edges(inter_graph)))
 		{
 			count = inter_graph[ie].count;
@@ -4713,7 +5148,7 @@ void TrackMapProcessor::GetCellsByUncertainty(bool filter_in_list)
 	if (frame < m_map->m_frame_num - 1)
 	{
 		InterGraph &inter_graph =
-			m_map->m_inter_graph_list.at(frame);
+			m_map->GetInterGraph(frame);
 		for (auto ie : boost::make_iterator_range(edges(inter_graph)))
 		{
 			count = inter_graph[ie].count;
@@ -4783,7 +5218,7 @@ void TrackMapProcessor::GetCellUncertainty()
 	if (frame >= m_map->m_frame_num)
 		return;
 
-	VertexList &vertex_list = m_map->m_vertices_list.at(frame);
+	VertexList &vertex_list = m_map->GetVertexList(frame);
 
 	Vrtx v0;
 	Verp vertex;
@@ -4794,7 +5229,7 @@ void TrackMapProcessor::GetCellUncertainty()
 	//in lists
 	if (frame > 0)
 	{
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame - 1);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame - 1);
 		for (VertexListIter iter = vertex_list.begin();
 			iter != vertex_list.end(); ++iter)
 		{
@@ -4833,7 +5268,7 @@ void TrackMapProcessor::GetCellUncertainty()
 	//out lists
 	if (frame < m_map->m_frame_num - 1)
 	{
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame);
 		for (VertexListIter iter = vertex_list.begin();
 			iter != vertex_list.end(); ++iter)
 		{
@@ -4890,7 +5325,7 @@ void TrackMapProcessor::GetUncertainHist()
 	if (frame >= m_map->m_frame_num)
 		return;
 
-	VertexList &vertex_list = m_map->m_vertices_list.at(frame);
+	VertexList &vertex_list = m_map->GetVertexList(frame);
 
 	//in lists
 	if (frame > 0)
@@ -4898,7 +5333,7 @@ void TrackMapProcessor::GetUncertainHist()
 		//header
 		WriteInfo(L"In\n");
 		WriteInfo(L"Level\tFrequency\n");
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame - 1);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame - 1);
 		UncertainHist hist;
 		GetUncertainHist(hist, vertex_list, inter_graph);
 	}
@@ -4911,7 +5346,7 @@ void TrackMapProcessor::GetUncertainHist()
 		//header
 		WriteInfo(L"Out\n");
 		WriteInfo(L"Level\tFrequency\n");
-		InterGraph &inter_graph = m_map->m_inter_graph_list.at(frame);
+		InterGraph &inter_graph = m_map->GetInterGraph(frame);
 		UncertainHist hist;
 		GetUncertainHist(hist, vertex_list, inter_graph);
 	}
@@ -5024,8 +5459,8 @@ void TrackMapProcessor::GetPaths(PathList &path_list, size_t frame1, size_t fram
 		frame1 == frame2)
 		return;
 
-	CelpList &cell_list1 = m_map->m_celp_list.at(frame1);
-	InterGraph &inter_graph = m_map->m_inter_graph_list.at(
+	CelpList &cell_list1 = m_map->GetCellList(frame1);
+	InterGraph &inter_graph = m_map->GetInterGraph(
 		frame1 > frame2 ? frame2 : frame1);
 	VertexList vertex_list;
 	CelpListIter cell_iter;
@@ -33,6 +33,9 @@ DEALINGS IN THE SOFTWARE.
 #include <Progress.h>
 #include <fstream>
 #include <memory>
+#include <functional>
+#include <future>
+#include <vector>
 #include <deque>
 #include <map>
 
@@ -48,6 +51,13 @@ DEALINGS IN THE SOFTWARE.
 							//order: v1, v2, edge
 #define TAG_VER220		9	//new values added in v2.20
 #define TAG_VER221		10	//new values added in v2.21
+#define TAG_TABLE		11	//frame offsets of the indexed format
+
+//indexed format, frames are stored as in the sequential one
+//header, version, frame number, counter, offset of the table,
+//frame blocks, and the table with the offsets of each frame
+//and of its links to the previous frame
+#define TRACK_FILE_VER	1
 
 namespace flrd
 {
@@ -56,6 +66,24 @@ namespace flrd
 	typedef std::weak_ptr<TrackMap> pwTrackMap;
 	typedef std::function<void(const std::wstring&)> InfoOutFunc;
 
+	//cells of one frame before they are added to the map
+	struct FrameScan
+	{
+		std::vector<Celp> cells;
+		//contacts as cell index1 << 32 | index2, with voxel counts and values
+		std::vector<unsigned long long> pairs;
+		std::vector<unsigned int> pair_ui;
+		std::vector<double> pair_d;
+	};
+	//overlapping labels of two frames as id1 << 32 | id2,
+	//in the order of first occurrence
+	struct FrameOverlap
+	{
+		std::vector<unsigned long long> pairs;
+		std::vector<unsigned int> pair_ui;
+		std::vector<double> pair_d;
+	};
+
 	class TrackMapProcessor : public Progress
 	{
 	public:
@@ -114,8 +142,14 @@ namespace flrd
 		//clear counters
 		bool ClearCounters();
 
+		//export writes the indexed format on a background thread
+		//true only means the write started, see WaitExport
+		//the result is also sent to the info output when the write ends
 		bool Export(const std::wstring &filename);
+		//reads both formats, frames of the indexed one are loaded on demand
 		bool Import(const std::wstring &filename);
+		//wait for a background export and get its result
+		bool WaitExport();
 
 		bool ResetVertexIDs();
 
@@ -215,12 +249,24 @@ namespace flrd
 		CelpList m_list_out;
 
 	private:
+		//frame initialization and linking split into a scan, which only
+		//reads the settings and can run on worker threads, and a commit to the map
+		void ScanFrame(void* data, unsigned int* label,
+			FrameScan& scan, unsigned int thread_num);
+		void AddFrame(FrameScan& scan);
+		void ScanOverlap(void* data1, unsigned int* label1,
+			void* data2, unsigned int* label2,
+			FrameOverlap& overlap, unsigned int thread_num);
+		bool LinkOverlap(size_t f1, size_t f2, FrameOverlap& overlap);
+		//initialization loop of GenMap with frames scanned ahead
+		void PipelineFrames(int frames, size_t ahead,
+			size_t& count, size_t ticks, const std::string& info_str);
+
 		//modification
-		bool CheckCellContact(Celp &celp, void *data, void *label,
-			size_t ci, size_t cj, size_t ck);
+		//count: number of voxels summed up in contact_value
 		bool AddContact(CellGraph& graph,
 			Celp &celp1, Celp &celp2,
-			float contact_value);
+			double contact_value, unsigned int count = 1);
 		bool CheckCellDist(Celp &celp, void *label,
 			size_t ci, size_t cj, size_t ck);
 		bool AddNeighbor(CellGraph& graph,
@@ -229,7 +275,7 @@ namespace flrd
 		bool LinkVertices(InterGraph& graph,
 			Verp &vertex1, Verp &vertex2,
 			size_t f1, size_t f2,
-			float overlap_value);
+			double overlap_value, unsigned int count = 1);
 		bool IsolateVertex(InterGraph& graph,
 			Verp &vertex);
 		bool ForceVertices(InterGraph& graph,
@@ -347,23 +393,33 @@ namespace flrd
 		bool similar_count(unsigned int count1, unsigned int count2);
 
 		//export
-		void WriteBool(std::ofstream& ofs, const bool value);
-		void WriteTag(std::ofstream& ofs, const unsigned char tag);
-		void WriteUint(std::ofstream& ofs, const unsigned int value);
-		void WriteFloat(std::ofstream& ofs, const float value);
-		void WriteDouble(std::ofstream& ofs, const double value);
-		void WritePoint(std::ofstream& ofs, const fluo::Point &point);
-		void WriteCell(std::ofstream& ofs, const Celp &celp);
-		void WriteVertex(std::ofstream& ofs, const Verp &vertex);
+		void WriteBool(std::ostream& ofs, const bool value);
+		void WriteTag(std::ostream& ofs, const unsigned char tag);
+		void WriteUint(std::ostream& ofs, const unsigned int value);
+		void WriteFloat(std::ostream& ofs, const float value);
+		void WriteDouble(std::ostream& ofs, const double value);
+		void WritePoint(std::ostream& ofs, const fluo::Point &point);
+		void WriteCell(std::ostream& ofs, const Celp &celp);
+		void WriteVertex(std::ostream& ofs, const Verp &vertex);
 		//import
-		bool ReadBool(std::ifstream& ifs);
-		unsigned char ReadTag(std::ifstream& ifs);
-		unsigned int ReadUint(std::ifstream& ifs);
-		float ReadFloat(std::ifstream& ifs);
-		double ReadDouble(std::ifstream& ifs);
-		fluo::Point ReadPoint(std::ifstream& ifs);
-		Celp ReadCell(std::ifstream& ifs, CelpList& list);
-		void ReadVertex(std::ifstream& ifs, VertexList& vertex_list, CelpList& list);
+		bool ReadBool(std::istream& ifs);
+		unsigned char ReadTag(std::istream& ifs);
+		unsigned int ReadUint(std::istream& ifs);
+		float ReadFloat(std::istream& ifs);
+		double ReadDouble(std::istream& ifs);
+		fluo::Point ReadPoint(std::istream& ifs);
+		Celp ReadCell(std::istream& ifs, CelpList& list);
+		void ReadVertex(std::istream& ifs, VertexList& vertex_list, CelpList& list);
+		void WriteUint64(std::ostream& ofs, const unsigned long long value);
+		unsigned long long ReadUint64(std::istream& ifs);
+		//cells, vertices and intra edges of one frame
+		void WriteFrame(std::ostream& ofs, size_t frame);
+		bool ReadFrame(std::istream& ifs, TrackMap& map, size_t frame);
+		//links from frame - 1 to frame
+		void WriteInterEdges(std::ostream& ofs, size_t frame);
+		bool ReadInterEdges(std::istream& ifs, TrackMap& map, size_t frame);
+		bool ImportLinks(std::istream& ifs);
+		bool ImportTrack(const std::shared_ptr<std::ifstream>& ifs);
 		bool AddIntraEdge(CellGraph& graph,
 			Celp &celp1, Celp &celp2,
 			unsigned int size_ui, double size_d,
@@ -383,10 +439,13 @@ namespace flrd
 				m_info_out(str);
 		}
 		InfoOutFunc m_info_out;
+
+		std::future<bool> m_export;
 	};
 
 	inline TrackMapProcessor::~TrackMapProcessor()
 	{
+		WaitExport();
 	}
 
 	inline void TrackMapProcessor::SetContactThresh(double value)
@@ -449,32 +508,32 @@ namespace flrd
 		m_info_out = nullptr;
 	}
 
-	inline void TrackMapProcessor::WriteBool(std::ofstream& ofs, const bool value)
+	inline void TrackMapProcessor::WriteBool(std::ostream& ofs, const bool value)
 	{
 		ofs.write(reinterpret_cast<const char*>(&value), sizeof(bool));
 	}
 
-	inline void TrackMapProcessor::WriteTag(std::ofstream& ofs, const unsigned char tag)
+	inline void TrackMapProcessor::WriteTag(std::ostream& ofs, const unsigned char tag)
 	{
 		ofs.write(reinterpret_cast<const char*>(&tag), sizeof(unsigned char));
 	}
 
-	inline void TrackMapProcessor::WriteUint(std::ofstream& ofs, const unsigned int value)
+	inline void TrackMapProcessor::WriteUint(std::ostream& ofs, const unsigned int value)
 	{
 		ofs.write(reinterpret_cast<const char*>(&value), sizeof(unsigned int));
 	}
 
-	inline void TrackMapProcessor::WriteFloat(std::ofstream& ofs, const float value)
+	inline void TrackMapProcessor::WriteFloat(std::ostream& ofs, const float value)
 	{
 		ofs.write(reinterpret_cast<const char*>(&value), sizeof(float));
 	}
 
-	inline void TrackMapProcessor::WriteDouble(std::ofstream& ofs, const double value)
+	inline void TrackMapProcessor::WriteDouble(std::ostream& ofs, const double value)
 	{
 		ofs.write(reinterpret_cast<const char*>(&value), sizeof(double));
 	}
 
-	inline void TrackMapProcessor::WritePoint(std::ofstream& ofs, const fluo::Point &point)
+	inline void TrackMapProcessor::WritePoint(std::ostream& ofs, const fluo::Point &point)
 	{
 		double x = point.x();
 		ofs.write(reinterpret_cast<const char*>(&x), sizeof(double));
@@ -484,7 +543,7 @@ namespace flrd
 		ofs.write(reinterpret_cast<const char*>(&x), sizeof(double));
 	}
 
-	inline void TrackMapProcessor::WriteCell(std::ofstream& ofs, const Celp &celp)
+	inline void TrackMapProcessor::WriteCell(std::ostream& ofs, const Celp &celp)
 	{
 		WriteTag(ofs, TAG_CELL);
 		WriteUint(ofs, celp->Id());
@@ -500,42 +559,54 @@ namespace flrd
 		WritePoint(ofs, celp->GetBox().Max());
 	}
 
-	inline bool TrackMapProcessor::ReadBool(std::ifstream& ifs)
+	inline void TrackMapProcessor::WriteUint64(std::ostream& ofs, const unsigned long long value)
+	{
+		ofs.write(reinterpret_cast<const char*>(&value), sizeof(unsigned long long));
+	}
+
+	inline bool TrackMapProcessor::ReadBool(std::istream& ifs)
 	{
 		bool value;
 		ifs.read(reinterpret_cast<char*>(&value), sizeof(bool));
 		return value;
 	}
 
-	inline unsigned char TrackMapProcessor::ReadTag(std::ifstream& ifs)
+	inline unsigned char TrackMapProcessor::ReadTag(std::istream& ifs)
 	{
 		unsigned char tag;
 		ifs.read(reinterpret_cast<char*>(&tag), sizeof(unsigned char));
 		return tag;
 	}
 
-	inline unsigned int TrackMapProcessor::ReadUint(std::ifstream& ifs)
+	inline unsigned int TrackMapProcessor::ReadUint(std::istream& ifs)
 	{
 		unsigned int value;
 		ifs.read(reinterpret_cast<char*>(&value), sizeof(unsigned int));
 		return value;
 	}
 
-	inline float TrackMapProcessor::ReadFloat(std::ifstream& ifs)
+	inline unsigned long long TrackMapProcessor::ReadUint64(std::istream& ifs)
+	{
+		unsigned long long value = 0;
+		ifs.read(reinterpret_cast<char*>(&value), sizeof(unsigned long long));
+		return value;
+	}
+
+	inline float TrackMapProcessor::ReadFloat(std::istream& ifs)
 	{
 		float value;
 		ifs.read(reinterpret_cast<char*>(&value), sizeof(float));
 		return value;
 	}
 
-	inline double TrackMapProcessor::ReadDouble(std::ifstream& ifs)
+	inline double TrackMapProcessor::ReadDouble(std::istream& ifs)
 	{
 		double value;
 		ifs.read(reinterpret_cast<char*>(&value), sizeof(double));
 		return value;
 	}
 
-	inline fluo::Point TrackMapProcessor::ReadPoint(std::ifstream& ifs)
+	inline fluo::Point TrackMapProcessor::ReadPoint(std::istream& ifs)
 	{
 		double x, y, z;
 		ifs.read(reinterpret_cast<char*>(&x), sizeof(double));
@@ -544,7 +615,7 @@ namespace flrd
 		return fluo::Point(x, y, z);
 	}
 
-	inline Celp TrackMapProcessor::ReadCell(std::ifstream& ifs, CelpList& list)
+	inline Celp TrackMapProcessor::ReadCell(std::istream& ifs, CelpList& list)
 	{
 		Celp celp;
 		if (ReadTag(ifs) != TAG_CELL)
@@ -614,6 +685,17 @@ namespace flrd
 		bool ExtendFrameNum(size_t frame);
 		void Clear();
 
+		//frames of an indexed track file are read on first access
+		//frame reads cells, vertices and intra edges of one frame
+		//inter reads the links from frame to frame + 1
+		//loaders return false if the file could not be read
+		typedef std::function<bool(TrackMap&, size_t)> FrameLoader;
+		void SetLoader(const FrameLoader& frame, const FrameLoader& inter);
+		//read all remaining frames and release the file
+		//false if any frame failed to read
+		bool LoadAll();
+		bool GetLoadFailed() { return m_load_failed; }
+
 	private:
 		unsigned int m_counter;//counter for frame processing
 		//data information
@@ -629,6 +711,16 @@ namespace flrd
 		std::deque<CellGraph> m_intra_graph_list;
 		std::deque<InterGraph> m_inter_graph_list;
 
+		//lazy loading
+		FrameLoader m_load_frame;
+		FrameLoader m_load_inter;
+		std::vector<char> m_frame_loaded;
+		std::vector<char> m_inter_loaded;
+		bool m_load_failed;//frames read so far are incomplete
+
+		void Load(size_t frame);
+		void LoadInter(size_t frame);
+
 		friend class TrackMapProcessor;
 	};
 
@@ -639,24 +731,73 @@ namespace flrd
 
 	inline CelpList &TrackMap::GetCellList(size_t frame)
 	{
+		Load(frame);
 		return m_celp_list.at(frame);
 	}
 
 	inline VertexList &TrackMap::GetVertexList(size_t frame)
 	{
+		Load(frame);
 		return m_vertices_list.at(frame);
 	}
 
 	inline CellGraph &TrackMap::GetIntraGraph(size_t frame)
 	{
+		Load(frame);
 		return m_intra_graph_list.at(frame);
 	}
 
 	inline InterGraph &TrackMap::GetInterGraph(size_t frame)
 	{
+		LoadInter(frame);
 		return m_inter_graph_list.at(frame);
 	}
 
+	inline void TrackMap::SetLoader(const FrameLoader& frame, const FrameLoader& inter)
+	{
+		m_load_frame = frame;
+		m_load_inter = inter;
+		m_frame_loaded.assign(m_frame_num, 0);
+		m_inter_loaded.assign(m_frame_num ? m_frame_num - 1 : 0, 0);
+		m_load_failed = false;
+	}
+
+	inline void TrackMap::Load(size_t frame)
+	{
+		if (frame >= m_frame_loaded.size() ||
+			m_frame_loaded[frame])
+			return;
+		m_frame_loaded[frame] = 1;
+		if (m_load_frame && !m_load_frame(*this, frame))
+			m_load_failed = true;
+	}
+
+	inline void TrackMap::LoadInter(size_t frame)
+	{
+		if (frame >= m_inter_loaded.size() ||
+			m_inter_loaded[frame])
+			return;
+		//both vertex lists are needed
+		Load(frame);
+		Load(frame + 1);
+		m_inter_loaded[frame] = 1;
+		if (m_load_inter && !m_load_inter(*this, frame))
+			m_load_failed = true;
+	}
+
+	inline bool TrackMap::LoadAll()
+	{
+		for (size_t i = 0; i < m_frame_loaded.size(); ++i)
+			Load(i);
+		for (size_t i = 0; i < m_inter_loaded.size(); ++i)
+			LoadInter(i);
+		m_load_frame = nullptr;
+		m_load_inter = nullptr;
+		m_frame_loaded.clear();
+		m_inter_loaded.clear();
+		return !m_load_failed;
+	}
+
 	inline bool TrackMap::ExtendFrameNum(size_t frame)
 	{
 		size_t sframe = m_frame_num;
@@ -681,6 +822,11 @@ namespace flrd
 		m_vertices_list.clear();
 		m_intra_graph_list.clear();
 		m_inter_graph_list.clear();
+		m_load_frame = nullptr;
+		m_load_inter = nullptr;
+		m_frame_loaded.clear();
+		m_inter_loaded.clear();
+		m_load_failed = false;
 		m_frame_num = 0;
 		m_size = fluo::Vector(0);
 		m_data_bits = 8;
@@ -694,7 +840,7 @@ namespace flrd
 		if (frame >= m_map->m_frame_num)
 			return nullptr;
 
-		CelpList &list = m_map->m_celp_list.at(frame);
+		CelpList &list = m_map->GetCellList(frame);
 		auto it = list.find(id);
 		if (it == list.end())
 			return nullptr;
@@ -731,7 +877,7 @@ namespace flrd
 	{
 		bool wrap = false;
 		//cell list
-		CelpList &list = m_map->m_celp_list.at(frame);
+		CelpList &list = m_map->GetCellList(frame);
 		unsigned int newid = id+(inc?253:0);
 		newid = newid < id ? (wrap = true, (id % 253)) : newid;
 		while (list.find(newid) != list.end())
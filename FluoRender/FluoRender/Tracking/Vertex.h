@@ -30,9 +30,8 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Cell.h>
 #include <vector>
-#include <boost/graph/graph_traits.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/adjacency_iterator.hpp>
+#include <map>
+#include <unordered_map>
 
 namespace flrd
 {
@@ -71,9 +70,7 @@ namespace flrd
 	};
 
 	class InterGraph :
-		public boost::adjacency_list<boost::listS,
-		boost::listS, boost::undirectedS,
-		VertNode, EdgeNode>
+		public ArenaGraph<VertNode, EdgeNode>
 	{
 	public:
 		size_t index;
@@ -31,6 +31,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Vertex.h>
 #include <unordered_map>
 #include <deque>
+#include <set>
 #include <iostream>
 
 namespace flrd
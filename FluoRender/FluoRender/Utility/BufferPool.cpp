@@ -0,0 +1,185 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <BufferPool.h>
+#include <cstdlib>
+#include <cstdint>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+using namespace flrd;
+
+//smaller buffers are left to the heap
+static const size_t s_pool_min = 1 << 20;
+//a buffer can be handed out for a request up to 1/s_pool_slack smaller
+static const size_t s_pool_slack = 8;
+//huge page size
+static const size_t s_huge_page = 1 << 21;
+
+BufferPool::BufferPool() :
+	m_idle_size(0),
+	m_limit(0),
+	m_huge_page(false),
+	m_stamp(0),
+	m_hit(0),
+	m_miss(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+	Trim(0);
+}
+
+void BufferPool::SetLimit(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_limit = bytes;
+	Evict(m_limit);
+}
+
+void* BufferPool::Alloc(size_t bytes)
+{
+	if (!bytes)
+		return 0;
+	if (bytes >= s_pool_min)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_idle.lower_bound(bytes);
+		if (it != m_idle.end() &&
+			it->first - bytes <= bytes / s_pool_slack)
+		{
+			void* ptr = it->second.ptr;
+			m_idle_size -= it->first;
+			m_idle.erase(it);
+			m_hit++;
+			return ptr;
+		}
+		m_miss++;
+	}
+
+	void* ptr = std::malloc(bytes);
+	if (!ptr)
+	{
+		//give idle memory back and retry
+		Trim(0);
+		ptr = std::malloc(bytes);
+	}
+	if (ptr && bytes >= s_pool_min && m_huge_page)
+		Advise(ptr, bytes);
+	return ptr;
+}
+
+void BufferPool::Free(void* ptr, size_t bytes)
+{
+	if (!ptr)
+		return;
+	if (bytes < s_pool_min)
+	{
+		std::free(ptr);
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (bytes > m_limit)
+	{
+		std::free(ptr);
+		return;
+	}
+	Evict(m_limit - bytes);
+	m_idle.insert(std::make_pair(bytes, Block{ ptr, m_stamp++ }));
+	m_idle_size += bytes;
+}
+
+void BufferPool::Nuke(Nrrd* nrrd)
+{
+	if (!nrrd)
+		return;
+	if (nrrd->data)
+	{
+		size_t bytes = nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+		Free(nrrd->data, bytes);
+		nrrd->data = 0;
+	}
+	nrrdNix(nrrd);
+}
+
+void* BufferPool::Shrink(void* ptr, size_t bytes)
+{
+	if (!ptr || !bytes)
+		return ptr;
+	void* res = std::realloc(ptr, bytes);
+	return res ? res : ptr;
+}
+
+void BufferPool::Trim(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Evict(bytes);
+}
+
+size_t BufferPool::GetIdleSize()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_idle_size;
+}
+
+size_t BufferPool::GetIdleNum()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_idle.size();
+}
+
+void BufferPool::Evict(size_t bytes)
+{
+	while (m_idle_size > bytes && !m_idle.empty())
+	{
+		auto old = m_idle.begin();
+		for (auto it = m_idle.begin(); it != m_idle.end(); ++it)
+			if (it->second.stamp < old->second.stamp)
+				old = it;
+		std::free(old->second.ptr);
+		m_idle_size -= old->first;
+		m_idle.erase(old);
+	}
+}
+
+void BufferPool::Advise(void* ptr, size_t bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	//only whole huge pages inside the buffer can be advised
+	uintptr_t b = reinterpret_cast<uintptr_t>(ptr);
+	uintptr_t e = b + bytes;
+	b = (b + s_huge_page - 1) & ~(uintptr_t)(s_huge_page - 1);
+	e &= ~(uintptr_t)(s_huge_page - 1);
+	if (e > b)
+		madvise(reinterpret_cast<void*>(b), e - b, MADV_HUGEPAGE);
+#else
+	(void)ptr;
+	(void)bytes;
+#endif
+}
@@ -0,0 +1,101 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_BufferPool_h
+#define FL_BufferPool_h
+
+#include <nrrd.h>
+#include <map>
+#include <mutex>
+#include <cstddef>
+
+namespace flrd
+{
+	//recycles large buffers of volume data
+	//buffers released to the pool are kept idle up to a limit
+	//and handed out again for requests of about the same size
+	//all buffers come from malloc, so one may still be released
+	//by free or nrrdNuke, it just does not return to the pool
+	class BufferPool
+	{
+	public:
+		BufferPool();
+		~BufferPool();
+
+		//bytes kept idle for reuse, 0 disables pooling
+		void SetLimit(size_t bytes);
+		size_t GetLimit() { return m_limit; }
+		//advise the os to back large buffers with huge pages
+		void SetHugePage(bool val) { m_huge_page = val; }
+		bool GetHugePage() { return m_huge_page; }
+
+		//content is not initialized
+		void* Alloc(size_t bytes);
+		template <typename T>
+		T* Alloc(size_t n)
+		{
+			return static_cast<T*>(Alloc(n * sizeof(T)));
+		}
+		//bytes is the size requested when allocated
+		void Free(void* ptr, size_t bytes);
+		//same as nrrdNuke but the data goes back to the pool
+		void Nuke(Nrrd* nrrd);
+		//give back the tail of a buffer whose content got smaller
+		//the content is kept, ptr is returned if it cannot be moved
+		void* Shrink(void* ptr, size_t bytes);
+		//release idle buffers until at most bytes are kept
+		void Trim(size_t bytes = 0);
+
+		//stats
+		size_t GetIdleSize();
+		size_t GetIdleNum();
+		unsigned long long GetHitNum() { return m_hit; }
+		unsigned long long GetMissNum() { return m_miss; }
+
+	private:
+		struct Block
+		{
+			void* ptr;
+			unsigned long long stamp;//release order
+		};
+		std::mutex m_mutex;
+		//idle buffers by size
+		std::multimap<size_t, Block> m_idle;
+		size_t m_idle_size;
+		size_t m_limit;
+		bool m_huge_page;
+		unsigned long long m_stamp;
+		unsigned long long m_hit;
+		unsigned long long m_miss;
+
+		//drop the oldest idle buffers, lock held
+		void Evict(size_t bytes);
+		void Advise(void* ptr, size_t bytes);
+	};
+}
+
+#endif//FL_BufferPool_h
@@ -0,0 +1,314 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <FrameCache.h>
+#include <BufferPool.h>
+#include <Parallel.h>
+#include <zlib.h>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+using namespace flrd;
+
+//chunk size for parallel packing, a multiple of all element sizes
+static const size_t s_chunk = 1 << 20;
+
+FrameCache::FrameCache() :
+	m_pool(0),
+	m_size(0),
+	m_raw_size(0),
+	m_limit(0),
+	m_stamp(0),
+	m_hit(0),
+	m_miss(0)
+{
+}
+
+FrameCache::~FrameCache()
+{
+	Clear();
+}
+
+void FrameCache::SetLimit(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_limit = bytes;
+	Evict(m_limit);
+}
+
+Nrrd* FrameCache::Get(const void* owner, int frame, int chan)
+{
+	std::shared_ptr<Frame> fr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_limit)
+			return 0;
+		auto it = m_frames.find(Key{ owner, frame, chan });
+		if (it == m_frames.end())
+		{
+			m_miss++;
+			return 0;
+		}
+		fr = it->second;
+		m_hit++;
+	}
+
+	unsigned char* data = m_pool ?
+		m_pool->Alloc<unsigned char>(fr->bytes) :
+		static_cast<unsigned char*>(std::malloc(fr->bytes));
+	if (!data)
+		return 0;
+	if (!Unpack(*fr, data))
+	{
+		if (m_pool)
+			m_pool->Free(data, fr->bytes);
+		else
+			std::free(data);
+		return 0;
+	}
+
+	Nrrd* nrrd = nrrdNew();
+	nrrdWrap_va(nrrd, data, fr->type, 3, fr->size[0], fr->size[1], fr->size[2]);
+	nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSpacing, fr->spc[0], fr->spc[1], fr->spc[2]);
+	nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoMin, fr->min[0], fr->min[1], fr->min[2]);
+	nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoMax, fr->max[0], fr->max[1], fr->max[2]);
+	nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSize, fr->size[0], fr->size[1], fr->size[2]);
+	return nrrd;
+}
+
+bool FrameCache::Put(const void* owner, int frame, int chan, Nrrd* nrrd)
+{
+	if (!nrrd || !nrrd->data || nrrd->dim != 3)
+		return false;
+	Key key{ owner, frame, chan };
+	size_t elem = nrrdElementSize(nrrd);
+	size_t bytes = nrrdElementNumber(nrrd) * elem;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_size >= m_limit ||
+			m_frames.find(key) != m_frames.end())
+			return false;
+		//estimate from the ratio of the frames already in
+		//so packing is skipped once the cache is full
+		if (m_raw_size)
+		{
+			double est = double(bytes) * double(m_size) / double(m_raw_size);
+			if (double(m_size) + est > double(m_limit))
+				return false;
+		}
+	}
+
+	auto fr = std::make_shared<Frame>();
+	fr->type = nrrd->type;
+	fr->elem = elem;
+	fr->bytes = bytes;
+	for (int i = 0; i < 3; ++i)
+	{
+		fr->size[i] = nrrd->axis[i].size;
+		fr->spc[i] = nrrd->axis[i].spacing;
+		fr->min[i] = nrrd->axis[i].min;
+		fr->max[i] = nrrd->axis[i].max;
+	}
+	if (!fr->bytes ||
+		!Pack(static_cast<const unsigned char*>(nrrd->data), fr->bytes, fr->elem, *fr))
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_size + fr->packed > m_limit ||
+		m_frames.find(key) != m_frames.end())
+		return false;
+	fr->stamp = m_stamp++;
+	m_size += fr->packed;
+	m_raw_size += fr->bytes;
+	m_frames.insert(std::make_pair(key, fr));
+	return true;
+}
+
+bool FrameCache::Has(const void* owner, int frame, int chan)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_frames.find(Key{ owner, frame, chan }) != m_frames.end();
+}
+
+void FrameCache::Erase(const void* owner)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	//keys are ordered by owner first
+	auto it = m_frames.lower_bound(Key{ owner, INT_MIN, INT_MIN });
+	while (it != m_frames.end() && it->first.owner == owner)
+		Remove(it++);
+}
+
+void FrameCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_frames.clear();
+	m_size = 0;
+	m_raw_size = 0;
+}
+
+size_t FrameCache::GetSize()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_size;
+}
+
+size_t FrameCache::GetRawSize()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_raw_size;
+}
+
+size_t FrameCache::GetNum()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_frames.size();
+}
+
+void FrameCache::Evict(size_t bytes)
+{
+	while (m_size > bytes && !m_frames.empty())
+	{
+		auto old = m_frames.begin();
+		for (auto it = m_frames.begin(); it != m_frames.end(); ++it)
+			if (it->second->stamp < old->second->stamp)
+				old = it;
+		Remove(old);
+	}
+}
+
+void FrameCache::Remove(std::map<Key, std::shared_ptr<Frame>>::iterator it)
+{
+	m_size -= it->second->packed;
+	m_raw_size -= it->second->bytes;
+	m_frames.erase(it);
+}
+
+bool FrameCache::Pack(const unsigned char* src, size_t bytes, size_t elem, Frame& frame)
+{
+	size_t num = (bytes + s_chunk - 1) / s_chunk;
+	frame.chunks.resize(num);
+	unsigned int tn = GetThreadNum();
+	//scratch for byte planes and deflate output per thread
+	std::vector<std::vector<unsigned char>> shuf(tn);
+	std::vector<std::vector<unsigned char>> out(tn);
+	std::atomic<bool> ok(true);
+
+	ParallelForDynamic(num, [&](size_t i, unsigned int t)
+	{
+		size_t off = i * s_chunk;
+		size_t len = std::min(s_chunk, bytes - off);
+		const unsigned char* in = src + off;
+		//group bytes of the same significance so that
+		//high bytes of 16-bit intensities become long runs
+		if (elem > 1 && len % elem == 0)
+		{
+			shuf[t].resize(len);
+			size_t n = len / elem;
+			for (size_t b = 0; b < elem; ++b)
+			{
+				unsigned char* plane = shuf[t].data() + b * n;
+				for (size_t j = 0; j < n; ++j)
+					plane[j] = in[j * elem + b];
+			}
+			in = shuf[t].data();
+		}
+		uLongf out_len = compressBound(static_cast<uLong>(len));
+		out[t].resize(out_len);
+		Chunk& chunk = frame.chunks[i];
+		if (compress2(out[t].data(), &out_len, in,
+			static_cast<uLong>(len), Z_BEST_SPEED) == Z_OK &&
+			out_len < len)
+		{
+			chunk.buf.assign(out[t].data(), out[t].data() + out_len);
+			chunk.raw = false;
+		}
+		else
+		{
+			chunk.buf.assign(src + off, src + off + len);
+			chunk.raw = true;
+		}
+		if (chunk.buf.empty())
+			ok = false;
+	}, 1, tn);
+
+	frame.packed = 0;
+	for (auto& chunk : frame.chunks)
+		frame.packed += chunk.buf.size();
+	return ok;
+}
+
+bool FrameCache::Unpack(const Frame& frame, unsigned char* dst)
+{
+	size_t num = frame.chunks.size();
+	size_t elem = frame.elem;
+	unsigned int tn = GetThreadNum();
+	std::vector<std::vector<unsigned char>> shuf(tn);
+	std::atomic<bool> ok(true);
+
+	ParallelForDynamic(num, [&](size_t i, unsigned int t)
+	{
+		size_t off = i * s_chunk;
+		size_t len = std::min(s_chunk, frame.bytes - off);
+		const Chunk& chunk = frame.chunks[i];
+		unsigned char* out = dst + off;
+		if (chunk.raw)
+		{
+			std::memcpy(out, chunk.buf.data(), len);
+			return;
+		}
+		bool shuffled = elem > 1 && len % elem == 0;
+		if (shuffled)
+		{
+			shuf[t].resize(len);
+			out = shuf[t].data();
+		}
+		uLongf out_len = static_cast<uLongf>(len);
+		if (uncompress(out, &out_len, chunk.buf.data(),
+			static_cast<uLong>(chunk.buf.size())) != Z_OK ||
+			out_len != len)
+		{
+			ok = false;
+			return;
+		}
+		if (shuffled)
+		{
+			size_t n = len / elem;
+			unsigned char* res = dst + off;
+			for (size_t b = 0; b < elem; ++b)
+			{
+				const unsigned char* plane = out + b * n;
+				for (size_t j = 0; j < n; ++j)
+					res[j * elem + b] = plane[j];
+			}
+		}
+	}, 1, tn);
+
+	return ok;
+}
@@ -0,0 +1,130 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_FrameCache_h
+#define FL_FrameCache_h
+
+#include <nrrd.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+namespace flrd
+{
+	class BufferPool;
+	//keeps frames of time sequences compressed in memory
+	//so they can be restored without reading the files again
+	//frames are split into chunks that are packed and unpacked in parallel
+	//frames are added when they leave the uncompressed caches,
+	//until the limit is reached, frames already in are kept, so a sequence
+	//larger than the limit still hits on the part that fits when played in a loop
+	//owners erase their frames when they switch to another file or series
+	class FrameCache
+	{
+	public:
+		FrameCache();
+		~FrameCache();
+
+		//compressed bytes kept, 0 disables the cache
+		void SetLimit(size_t bytes);
+		size_t GetLimit() { return m_limit; }
+		//new buffers are taken from the pool if set
+		void SetPool(BufferPool* pool) { m_pool = pool; }
+
+		//owner is the reader of the frames
+		//returns a new nrrd or 0 if the frame is not cached
+		Nrrd* Get(const void* owner, int frame, int chan);
+		//keep a compressed copy, the nrrd is unchanged
+		//frames that are not expected to fit are not packed
+		bool Put(const void* owner, int frame, int chan, Nrrd* nrrd);
+		bool Has(const void* owner, int frame, int chan);
+		//remove all frames of an owner
+		void Erase(const void* owner);
+		void Clear();
+
+		//stats
+		size_t GetSize();//compressed
+		size_t GetRawSize();//uncompressed
+		size_t GetNum();
+		unsigned long long GetHitNum() { return m_hit; }
+		unsigned long long GetMissNum() { return m_miss; }
+
+	private:
+		struct Key
+		{
+			const void* owner;
+			int frame;
+			int chan;
+			bool operator<(const Key& k) const
+			{
+				if (owner != k.owner)
+					return owner < k.owner;
+				if (frame != k.frame)
+					return frame < k.frame;
+				return chan < k.chan;
+			}
+		};
+		struct Chunk
+		{
+			std::vector<unsigned char> buf;
+			bool raw;//stored as is
+		};
+		struct Frame
+		{
+			int type;
+			size_t elem;//element size
+			size_t size[3];
+			double spc[3];
+			double min[3];
+			double max[3];
+			size_t bytes;//uncompressed
+			size_t packed;//compressed
+			unsigned long long stamp;//insertion order
+			std::vector<Chunk> chunks;
+		};
+		std::mutex m_mutex;
+		//frames are shared so they can be unpacked outside the lock
+		std::map<Key, std::shared_ptr<Frame>> m_frames;
+		BufferPool* m_pool;
+		size_t m_size;
+		size_t m_raw_size;
+		size_t m_limit;
+		unsigned long long m_stamp;
+		unsigned long long m_hit;
+		unsigned long long m_miss;
+
+		//drop the oldest frames, lock held
+		void Evict(size_t bytes);
+		void Remove(std::map<Key, std::shared_ptr<Frame>>::iterator it);
+		static bool Pack(const unsigned char* src, size_t bytes, size_t elem, Frame& frame);
+		static bool Unpack(const Frame& frame, unsigned char* dst);
+	};
+}
+
+#endif//FL_FrameCache_h
@@ -0,0 +1,131 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <LabelCompact.h>
+#include <unordered_set>
+#include <atomic>
+#include <sstream>
+
+using namespace flrd;
+
+bool LabelCompact::Build(const unsigned int* data, size_t n, size_t max_num)
+{
+	m_table.clear();
+	if (!data)
+		return false;
+
+	unsigned int tn = GetThreadNum();
+	std::vector<std::vector<unsigned int>> ids(tn);
+	std::atomic<bool> over(false);
+	ParallelFor(n, [&](size_t b, size_t e, unsigned int t)
+	{
+		std::unordered_set<unsigned int> set;
+		unsigned int last = 0;
+		for (size_t i = b; i < e; ++i)
+		{
+			unsigned int v = data[i];
+			if (v == last)
+				continue;
+			last = v;
+			if (v && set.insert(v).second)
+			{
+				if (set.size() > max_num)
+					over = true;
+				if (over)
+					return;
+			}
+		}
+		ids[t].assign(set.begin(), set.end());
+	}, tn);
+	if (over)
+		return false;
+
+	for (auto& i : ids)
+	{
+		m_table.insert(m_table.end(), i.begin(), i.end());
+		std::vector<unsigned int>().swap(i);
+	}
+	std::sort(m_table.begin(), m_table.end());
+	m_table.erase(std::unique(m_table.begin(), m_table.end()), m_table.end());
+	if (m_table.size() > max_num)
+	{
+		m_table.clear();
+		return false;
+	}
+	return true;
+}
+
+size_t LabelCompact::GetElemSize() const
+{
+	if (m_table.size() <= 0xff)
+		return 1;
+	if (m_table.size() <= 0xffff)
+		return 2;
+	return 4;
+}
+
+bool LabelCompact::SetTable(const std::vector<unsigned int>& table)
+{
+	//ids must be nonzero and strictly increasing
+	for (size_t i = 0; i < table.size(); ++i)
+	{
+		if (!table[i] || (i && table[i] <= table[i - 1]))
+		{
+			m_table.clear();
+			return false;
+		}
+	}
+	m_table = table;
+	return true;
+}
+
+std::string LabelCompact::GetTableString() const
+{
+	std::ostringstream oss;
+	for (size_t i = 0; i < m_table.size(); ++i)
+	{
+		if (i)
+			oss << ' ';
+		oss << m_table[i];
+	}
+	return oss.str();
+}
+
+bool LabelCompact::SetTableString(const std::string& str)
+{
+	std::vector<unsigned int> table;
+	std::istringstream iss(str);
+	unsigned int id;
+	while (iss >> id)
+		table.push_back(id);
+	if (!iss.eof())
+	{
+		m_table.clear();
+		return false;
+	}
+	return SetTable(table);
+}
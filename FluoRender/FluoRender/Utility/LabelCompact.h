@@ -0,0 +1,115 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_LabelCompact_h
+#define FL_LabelCompact_h
+
+#include <Parallel.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstddef>
+
+namespace flrd
+{
+	//remaps sparse label ids to a dense range 1..n
+	//the table keeps the original ids so they stay stable outside
+	//0 is background and always maps to itself
+	//used for label files and the 4d cache files only,
+	//labels in memory, textures and kernels are always 32 bits
+	class LabelCompact
+	{
+	public:
+		LabelCompact() {}
+
+		//collect the ids in data
+		//false if there are more than max_num
+		bool Build(const unsigned int* data, size_t n, size_t max_num = 0xffff);
+		size_t GetNum() const { return m_table.size(); }
+		//smallest element size holding the dense ids: 1, 2 or 4
+		size_t GetElemSize() const;
+
+		//dense id i+1 is original id table[i], sorted
+		const std::vector<unsigned int>& GetTable() const { return m_table; }
+		bool SetTable(const std::vector<unsigned int>& table);
+		//text form stored in file headers
+		std::string GetTableString() const;
+		bool SetTableString(const std::string& str);
+
+		//original ids to dense ids
+		template <typename T>
+		void Compact(const unsigned int* src, T* dst, size_t n) const
+		{
+			ParallelFor(n, [&](size_t b, size_t e, unsigned int)
+			{
+				//labels come in runs, look up only when the id changes
+				unsigned int last = 0;
+				T dense = 0;
+				for (size_t i = b; i < e; ++i)
+				{
+					unsigned int v = src[i];
+					if (v != last)
+					{
+						last = v;
+						dense = static_cast<T>(Find(v));
+					}
+					dst[i] = dense;
+				}
+			});
+		}
+		//dense ids back to original ids
+		template <typename T>
+		void Expand(const T* src, unsigned int* dst, size_t n) const
+		{
+			size_t num = m_table.size();
+			ParallelFor(n, [&](size_t b, size_t e, unsigned int)
+			{
+				for (size_t i = b; i < e; ++i)
+				{
+					size_t v = static_cast<size_t>(src[i]);
+					dst[i] = v && v <= num ? m_table[v - 1] : 0;
+				}
+			});
+		}
+
+	private:
+		std::vector<unsigned int> m_table;
+
+		//dense id of an original id, 0 if not found
+		size_t Find(unsigned int id) const
+		{
+			if (!id)
+				return 0;
+			auto it = std::lower_bound(m_table.begin(), m_table.end(), id);
+			if (it == m_table.end() || *it != id)
+				return 0;
+			return static_cast<size_t>(it - m_table.begin()) + 1;
+		}
+	};
+}
+
+#endif//FL_LabelCompact_h
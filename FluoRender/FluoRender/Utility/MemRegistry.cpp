@@ -0,0 +1,286 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#include <MemRegistry.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace flrd;
+
+static const double s_mb = 1048576.0;
+
+MemRegistry::MemRegistry() :
+	m_main_peak(0),
+	m_video_peak(0),
+	m_logged(false)
+{
+	std::fill(m_current, m_current + s_num, size_t(0));
+	std::fill(m_peak, m_peak + s_num, size_t(0));
+	m_start = std::chrono::steady_clock::now();
+	m_pass_time = m_start;
+	m_log_time = m_start;
+}
+
+MemRegistry::~MemRegistry()
+{
+}
+
+void MemRegistry::Begin()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending.clear();
+	m_pending_counts.clear();
+}
+
+void MemRegistry::Report(MemType type, const std::string& owner, size_t bytes)
+{
+	if (!bytes || type == MemType::Num)
+		return;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	//same owner reported twice is summed
+	for (auto& it : m_pending)
+	{
+		if (it.type == type && it.owner == owner)
+		{
+			it.bytes += bytes;
+			return;
+		}
+	}
+	m_pending.push_back(Entry{ type, owner, bytes });
+}
+
+void MemRegistry::Count(const std::string& name, unsigned long long value)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending_counts.push_back(std::make_pair(name, value));
+}
+
+void MemRegistry::End()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.swap(m_pending);
+	m_pending.clear();
+	m_counts.swap(m_pending_counts);
+	m_pending_counts.clear();
+	std::fill(m_current, m_current + s_num, size_t(0));
+	for (auto& it : m_entries)
+		m_current[static_cast<int>(it.type)] += it.bytes;
+	for (int i = 0; i < s_num; ++i)
+		m_peak[i] = std::max(m_peak[i], m_current[i]);
+	m_main_peak = std::max(m_main_peak, Total(false));
+	m_video_peak = std::max(m_video_peak, Total(true));
+	m_pass_time = std::chrono::steady_clock::now();
+}
+
+double MemRegistry::GetElapsed()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::chrono::duration<double> d = std::chrono::steady_clock::now() - m_pass_time;
+	return d.count();
+}
+
+size_t MemRegistry::GetCurrent(MemType type)
+{
+	if (type == MemType::Num)
+		return 0;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_current[static_cast<int>(type)];
+}
+
+size_t MemRegistry::GetPeak(MemType type)
+{
+	if (type == MemType::Num)
+		return 0;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_peak[static_cast<int>(type)];
+}
+
+size_t MemRegistry::GetMainTotal()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return Total(false);
+}
+
+size_t MemRegistry::GetMainPeak()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_main_peak;
+}
+
+size_t MemRegistry::GetVideoTotal()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return Total(true);
+}
+
+size_t MemRegistry::GetVideoPeak()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_video_peak;
+}
+
+std::vector<std::pair<std::string, size_t>> MemRegistry::GetEntries(MemType type)
+{
+	std::vector<std::pair<std::string, size_t>> result;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& it : m_entries)
+		if (it.type == type)
+			result.push_back(std::make_pair(it.owner, it.bytes));
+	return result;
+}
+
+void MemRegistry::ResetPeak()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::copy(m_current, m_current + s_num, m_peak);
+	m_main_peak = Total(false);
+	m_video_peak = Total(true);
+}
+
+std::string MemRegistry::GetText(bool detail)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(1);
+	oss << std::left << std::setw(24) << "Type" <<
+		std::right << std::setw(12) << "Current MB" <<
+		std::setw(12) << "Peak MB" << "\n";
+	for (int i = 0; i < s_num; ++i)
+	{
+		MemType type = static_cast<MemType>(i);
+		oss << std::left << std::setw(24) << GetName(type) <<
+			std::right << std::setw(12) << m_current[i] / s_mb <<
+			std::setw(12) << m_peak[i] / s_mb << "\n";
+		if (!detail)
+			continue;
+		for (auto& it : m_entries)
+		{
+			if (it.type != type)
+				continue;
+			std::string owner = "  " + it.owner;
+			if (owner.size() > 22)
+				owner = owner.substr(0, 19) + "...";
+			oss << std::left << std::setw(24) << owner <<
+				std::right << std::setw(12) << it.bytes / s_mb << "\n";
+		}
+	}
+	oss << std::left << std::setw(24) << "Main memory" <<
+		std::right << std::setw(12) << Total(false) / s_mb <<
+		std::setw(12) << m_main_peak / s_mb << "\n";
+	oss << std::left << std::setw(24) << "Graphics memory" <<
+		std::right << std::setw(12) << Total(true) / s_mb <<
+		std::setw(12) << m_video_peak / s_mb << "\n";
+	for (auto& it : m_counts)
+		oss << std::left << std::setw(24) << it.first <<
+			std::right << std::setw(12) << it.second << "\n";
+	return oss.str();
+}
+
+bool MemRegistry::Log(const std::wstring& filename, double interval)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto now = std::chrono::steady_clock::now();
+	std::chrono::duration<double> d = now - m_log_time;
+	if (m_logged && d.count() < interval)
+		return false;
+
+	std::filesystem::path p(filename);
+	bool header = !std::filesystem::exists(p);
+	std::ofstream ofs(p, std::ios::app);
+	if (!ofs)
+		return false;
+	if (header)
+	{
+		ofs << "Time";
+		for (int i = 0; i < s_num; ++i)
+			ofs << "," << GetName(static_cast<MemType>(i));
+		ofs << ",Main memory,Graphics memory";
+		for (auto& it : m_counts)
+			ofs << "," << it.first;
+		ofs << "\n";
+	}
+	ofs << std::fixed << std::setprecision(1);
+	std::chrono::duration<double> t = now - m_start;
+	ofs << t.count();
+	for (int i = 0; i < s_num; ++i)
+		ofs << "," << m_current[i] / s_mb;
+	ofs << "," << Total(false) / s_mb <<
+		"," << Total(true) / s_mb;
+	for (auto& it : m_counts)
+		ofs << "," << it.second;
+	ofs << "\n";
+	m_log_time = now;
+	m_logged = true;
+	return true;
+}
+
+const char* MemRegistry::GetName(MemType type)
+{
+	switch (type)
+	{
+	case MemType::Data:
+		return "Volume data";
+	case MemType::Mask:
+		return "Volume masks";
+	case MemType::Label:
+		return "Volume labels";
+	case MemType::Undo:
+		return "Undo history";
+	case MemType::CacheQueue:
+		return "4D cache queues";
+	case MemType::FrameCache:
+		return "Compressed frames";
+	case MemType::BufferPool:
+		return "Idle buffers";
+	case MemType::Brick:
+		return "Streamed bricks";
+	case MemType::Texture:
+		return "Textures";
+	case MemType::Buffer:
+		return "OpenCL buffers";
+	default:
+		return "";
+	}
+}
+
+bool MemRegistry::IsVideo(MemType type)
+{
+	return type == MemType::Texture ||
+		type == MemType::Buffer;
+}
+
+size_t MemRegistry::Total(bool video)
+{
+	size_t sum = 0;
+	for (int i = 0; i < s_num; ++i)
+		if (IsVideo(static_cast<MemType>(i)) == video)
+			sum += m_current[i];
+	return sum;
+}
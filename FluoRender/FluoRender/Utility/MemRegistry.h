@@ -0,0 +1,120 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_MemRegistry_h
+#define FL_MemRegistry_h
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+namespace flrd
+{
+	enum class MemType : int
+	{
+		Data = 0,	//volume data
+		Mask,		//volume masks
+		Label,		//volume labels
+		Undo,		//mask undo states and saved labels
+		CacheQueue,	//frames held by 4d cache queues
+		FrameCache,	//compressed frames
+		BufferPool,	//idle buffers kept for reuse
+		Brick,		//bricks loaded for streamed rendering
+		Texture,	//textures in graphics memory
+		Buffer,		//opencl buffers
+		Num
+	};
+
+	//bookkeeping of memory use
+	//subsystems report their current use in a collection pass
+	//peaks are the highest values seen over all passes
+	class MemRegistry
+	{
+	public:
+		MemRegistry();
+		~MemRegistry();
+
+		//collection pass
+		void Begin();
+		void Report(MemType type, const std::string& owner, size_t bytes);
+		//counters listed with the table, such as cache hits
+		void Count(const std::string& name, unsigned long long value);
+		void End();
+		//seconds since the last pass
+		double GetElapsed();
+
+		size_t GetCurrent(MemType type);
+		size_t GetPeak(MemType type);
+		//main and graphics memory
+		size_t GetMainTotal();
+		size_t GetMainPeak();
+		size_t GetVideoTotal();
+		size_t GetVideoPeak();
+		//owners and bytes of a type in the last pass
+		std::vector<std::pair<std::string, size_t>> GetEntries(MemType type);
+		void ResetPeak();
+
+		//table of all types in MB, with owners if detail
+		std::string GetText(bool detail = true);
+		//append current use as a line of csv to a file
+		//the header is written if the file is new
+		//interval in seconds between lines
+		bool Log(const std::wstring& filename, double interval);
+
+		static const char* GetName(MemType type);
+		static bool IsVideo(MemType type);
+
+	private:
+		static const int s_num = static_cast<int>(MemType::Num);
+		struct Entry
+		{
+			MemType type;
+			std::string owner;
+			size_t bytes;
+		};
+		std::mutex m_mutex;
+		std::vector<Entry> m_entries;//last pass
+		std::vector<Entry> m_pending;//current pass
+		typedef std::vector<std::pair<std::string, unsigned long long>> Counts;
+		Counts m_counts;//last pass
+		Counts m_pending_counts;//current pass
+		size_t m_current[s_num];
+		size_t m_peak[s_num];
+		size_t m_main_peak;
+		size_t m_video_peak;
+		std::chrono::steady_clock::time_point m_start;
+		std::chrono::steady_clock::time_point m_pass_time;
+		std::chrono::steady_clock::time_point m_log_time;
+		bool m_logged;
+
+		size_t Total(bool video);//lock held
+	};
+}
+
+#endif//FL_MemRegistry_h
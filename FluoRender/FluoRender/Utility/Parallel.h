@@ -0,0 +1,125 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_Parallel_h
+#define FL_Parallel_h
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+namespace flrd
+{
+	//number of worker threads for cpu processing
+	//0 uses all hardware threads
+	inline unsigned int GetThreadNum(unsigned int req = 0)
+	{
+		unsigned int hw = std::thread::hardware_concurrency();
+		if (hw == 0)
+			hw = 1;
+		if (req == 0 || req > hw)
+			return hw;
+		return req;
+	}
+
+	//split [0, n) into contiguous ranges, one per thread
+	//func(size_t begin, size_t end, unsigned int thread_id)
+	//ranges are fixed for a given thread number so reductions done
+	//in thread id order are deterministic
+	template <typename F>
+	void ParallelFor(size_t n, F&& func, unsigned int thread_num = 0)
+	{
+		if (n == 0)
+			return;
+		unsigned int tn = GetThreadNum(thread_num);
+		if (tn > n)
+			tn = static_cast<unsigned int>(n);
+		if (tn <= 1)
+		{
+			func(size_t(0), n, 0u);
+			return;
+		}
+		std::vector<std::thread> threads;
+		threads.reserve(tn - 1);
+		size_t chunk = n / tn;
+		size_t rem = n % tn;
+		size_t begin = 0;
+		for (unsigned int t = 0; t < tn; ++t)
+		{
+			size_t end = begin + chunk + (t < rem ? 1 : 0);
+			if (t == tn - 1)
+				func(begin, end, t);
+			else
+				threads.emplace_back([&func, begin, end, t]() { func(begin, end, t); });
+			begin = end;
+		}
+		for (auto& th : threads)
+			th.join();
+	}
+
+	//dynamic scheduling for items of uneven cost
+	//func(size_t item, unsigned int thread_id)
+	template <typename F>
+	void ParallelForDynamic(size_t n, F&& func, size_t grain = 1, unsigned int thread_num = 0)
+	{
+		if (n == 0)
+			return;
+		grain = std::max(grain, size_t(1));
+		unsigned int tn = GetThreadNum(thread_num);
+		size_t tasks = (n + grain - 1) / grain;
+		if (tn > tasks)
+			tn = static_cast<unsigned int>(tasks);
+		std::atomic<size_t> next(0);
+		auto worker = [&](unsigned int t)
+		{
+			for (;;)
+			{
+				size_t begin = next.fetch_add(grain);
+				if (begin >= n)
+					break;
+				size_t end = std::min(begin + grain, n);
+				for (size_t i = begin; i < end; ++i)
+					func(i, t);
+			}
+		};
+		if (tn <= 1)
+		{
+			worker(0);
+			return;
+		}
+		std::vector<std::thread> threads;
+		threads.reserve(tn - 1);
+		for (unsigned int t = 1; t < tn; ++t)
+			threads.emplace_back(worker, t);
+		worker(0);
+		for (auto& th : threads)
+			th.join();
+	}
+}
+
+#endif//FL_Parallel_h
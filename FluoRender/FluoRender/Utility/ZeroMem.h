@@ -0,0 +1,108 @@
+﻿/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2026 Scientific Computing and Imaging Institute,
+University of Utah.
+
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+#ifndef FL_ZeroMem_h
+#define FL_ZeroMem_h
+
+#include <Parallel.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+namespace flrd
+{
+	//block size for skipping zero memory, one page
+	static const size_t s_zero_block = 4096;
+
+	//zero filled buffer for masks and labels
+	//large blocks are mapped from the os on demand, pages never
+	//written read as zero and take no memory
+	//release with free, same as nrrdNuke
+	template <typename T>
+	T* AllocZero(size_t n)
+	{
+		return static_cast<T*>(std::calloc(n, sizeof(T)));
+	}
+
+	inline bool IsZero(const void* data, size_t bytes)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		size_t i = 0;
+		for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t))
+		{
+			uint64_t v;
+			std::memcpy(&v, p + i, sizeof(uint64_t));
+			if (v)
+				return false;
+		}
+		for (; i < bytes; ++i)
+			if (p[i])
+				return false;
+		return true;
+	}
+
+	//zero a buffer, writing only blocks that are not zero already
+	//so pages that were never used stay unmapped
+	inline void ClearZero(void* data, size_t bytes, unsigned int thread_num = 0)
+	{
+		unsigned char* p = static_cast<unsigned char*>(data);
+		size_t bn = (bytes + s_zero_block - 1) / s_zero_block;
+		ParallelFor(bn, [&](size_t b0, size_t b1, unsigned int)
+		{
+			for (size_t b = b0; b < b1; ++b)
+			{
+				size_t off = b * s_zero_block;
+				size_t len = std::min(s_zero_block, bytes - off);
+				if (!IsZero(p + off, len))
+					std::memset(p + off, 0, len);
+			}
+		}, thread_num);
+	}
+
+	//copy src to dst, skipping blocks where both are zero
+	inline void CopyZero(void* dst, const void* src, size_t bytes, unsigned int thread_num = 0)
+	{
+		unsigned char* d = static_cast<unsigned char*>(dst);
+		const unsigned char* s = static_cast<const unsigned char*>(src);
+		size_t bn = (bytes + s_zero_block - 1) / s_zero_block;
+		ParallelFor(bn, [&](size_t b0, size_t b1, unsigned int)
+		{
+			for (size_t b = b0; b < b1; ++b)
+			{
+				size_t off = b * s_zero_block;
+				size_t len = std::min(s_zero_block, bytes - off);
+				if (!IsZero(s + off, len))
+					std::memcpy(d + off, s + off, len);
+				else if (!IsZero(d + off, len))
+					std::memset(d + off, 0, len);
+			}
+		}, thread_num);
+	}
+}
+
+#endif//FL_ZeroMem_h